@@ -0,0 +1,148 @@
+#pragma once
+#include "IUSBDevice.h"
+#include "ILogger.h"
+#include <cstring>
+#include <vector>
+
+/*
+ * USB fakes for the benchmarks: no gmock here, a mock call would cost more than the code measured.
+ * The interface returns 'reportDescriptor' to any control transfer input (GET_DESCRIPTOR).
+ */
+
+class BenchmarkUSBEndpoint : public IUSBEndpoint
+{
+public:
+    BenchmarkUSBEndpoint(Direction direction) : m_direction(direction)
+    {
+        memset(&m_descriptor, 0, sizeof(m_descriptor));
+        m_descriptor.bEndpointAddress = direction;
+        m_descriptor.wMaxPacketSize = 64;
+    }
+
+    ControllerResult Open(int maxPacketSize) override
+    {
+        (void)maxPacketSize;
+        return CONTROLLER_STATUS_SUCCESS;
+    }
+
+    void Close() override {}
+
+    ControllerResult Write(const uint8_t *inBuffer, size_t bufferSize) override
+    {
+        (void)inBuffer;
+        (void)bufferSize;
+        return CONTROLLER_STATUS_SUCCESS;
+    }
+
+    ControllerResult Read(uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) override
+    {
+        (void)outBuffer;
+        (void)aTimeoutUs;
+        *bufferSizeInOut = 0;
+        return CONTROLLER_STATUS_TIMEOUT;
+    }
+
+    Direction GetDirection() override { return m_direction; }
+    EndpointDescriptor *GetDescriptor() override { return &m_descriptor; }
+
+private:
+    Direction m_direction;
+    EndpointDescriptor m_descriptor;
+};
+
+class BenchmarkUSBInterface : public IUSBInterface
+{
+public:
+    BenchmarkUSBInterface(const std::vector<uint8_t> &reportDescriptor = {})
+        : m_reportDescriptor(reportDescriptor),
+          m_inEndpoint(IUSBEndpoint::USB_ENDPOINT_IN),
+          m_outEndpoint(IUSBEndpoint::USB_ENDPOINT_OUT)
+    {
+        memset(&m_descriptor, 0, sizeof(m_descriptor));
+    }
+
+    ControllerResult Open() override { return CONTROLLER_STATUS_SUCCESS; }
+    void Close() override {}
+
+    ControllerResult ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength) override
+    {
+        (void)bmRequestType;
+        (void)bmRequest;
+        (void)wValue;
+        (void)wIndex;
+
+        if (*wLength < m_reportDescriptor.size())
+            return CONTROLLER_STATUS_UNEXPECTED_DATA;
+
+        memcpy(buffer, m_reportDescriptor.data(), m_reportDescriptor.size());
+        *wLength = m_reportDescriptor.size();
+        return CONTROLLER_STATUS_SUCCESS;
+    }
+
+    ControllerResult ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength) override
+    {
+        (void)bmRequestType;
+        (void)bmRequest;
+        (void)wValue;
+        (void)wIndex;
+        (void)buffer;
+        (void)wLength;
+        return CONTROLLER_STATUS_SUCCESS;
+    }
+
+    IUSBEndpoint *GetEndpoint(IUSBEndpoint::Direction direction, uint8_t index) override
+    {
+        if (index != 0)
+            return nullptr;
+
+        return (direction == IUSBEndpoint::USB_ENDPOINT_IN) ? &m_inEndpoint : &m_outEndpoint;
+    }
+
+    InterfaceDescriptor *GetDescriptor() override { return &m_descriptor; }
+    ControllerResult Reset() override { return CONTROLLER_STATUS_SUCCESS; }
+
+private:
+    std::vector<uint8_t> m_reportDescriptor;
+    BenchmarkUSBEndpoint m_inEndpoint;
+    BenchmarkUSBEndpoint m_outEndpoint;
+    InterfaceDescriptor m_descriptor;
+};
+
+class BenchmarkDevice : public IUSBDevice
+{
+public:
+    BenchmarkDevice(uint16_t vendorID = 0x0000, uint16_t productID = 0x0000, std::unique_ptr<IUSBInterface> &&interface = nullptr)
+    {
+        m_vendorID = vendorID;
+        m_productID = productID;
+        if (interface)
+            m_interfaces.push_back(std::move(interface));
+    }
+
+    ControllerResult Open() override { return CONTROLLER_STATUS_SUCCESS; }
+    void Close() override {}
+    void Reset() override {}
+};
+
+class BenchmarkLogger : public ILogger
+{
+public:
+    void Log(LogLevel aLogLevel, const char *format, ...) override
+    {
+        (void)aLogLevel;
+        (void)format;
+    }
+
+    void LogBuffer(LogLevel aLogLevel, const uint8_t *buffer, size_t size) override
+    {
+        (void)aLogLevel;
+        (void)buffer;
+        (void)size;
+    }
+
+    bool IsEnabled(LogLevel aLogLevel) override
+    {
+        (void)aLogLevel;
+        return false;
+    }
+};
@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include "config_handler.h"
+#include "filemanager_std.h"
+
+/*
+ * config.ini load path (Shipped config.ini): global section, and controller lookup (Profile + vid-pid: worst case)
+ * The config cache is not enabled: this is the cost paid the first time a controller is plugged.
+ * BM_ParseControllerConfig drops the in-memory index on each iteration: tokenizing + parsing the whole file.
+ */
+
+namespace
+{
+    void BM_LoadGlobalConfig(benchmark::State &state)
+    {
+        ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+
+        for (auto _ : state)
+        {
+            ::syscon::config::GlobalConfig config;
+            int rc = ::syscon::config::LoadGlobalConfig(BENCHMARK_CONFIG_FULLPATH, &config);
+            if (rc != 0)
+            {
+                state.SkipWithError("Unable to load config.ini");
+                break;
+            }
+        }
+    }
+
+    void BM_LoadControllerConfig(benchmark::State &state)
+    {
+        ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+
+        for (auto _ : state)
+        {
+            ControllerConfig config;
+            int rc = ::syscon::config::LoadControllerConfig(BENCHMARK_CONFIG_FULLPATH, &config, 0x045e, 0x02dd, false, "");
+            if (rc != 0)
+            {
+                state.SkipWithError("Unable to load config.ini");
+                break;
+            }
+        }
+    }
+
+    void BM_ParseControllerConfig(benchmark::State &state)
+    {
+        for (auto _ : state)
+        {
+            ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>()); // Drop the index
+
+            ControllerConfig config;
+            int rc = ::syscon::config::LoadControllerConfig(BENCHMARK_CONFIG_FULLPATH, &config, 0x045e, 0x02dd, false, "");
+            if (rc != 0)
+            {
+                state.SkipWithError("Unable to load config.ini");
+                break;
+            }
+        }
+    }
+} // namespace
+
+BENCHMARK(BM_LoadGlobalConfig)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LoadControllerConfig)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseControllerConfig)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include "BenchmarkDevice.h"
+#include "Controllers/Dualshock3Controller.h"
+#include "Controllers/GenericHIDController.h"
+#include "Controllers/SteamController2026.h"
+#include "Controllers/SwitchController.h"
+#include "Controllers/WiiController.h"
+#include "Controllers/Xbox360Controller.h"
+#include "Controllers/Xbox360WirelessController.h"
+#include "Controllers/XboxController.h"
+#include "Controllers/XboxOneController.h"
+
+/*
+ * ParseData of each driver, with reports recorded from real controllers (Same reports as the unit tests when available)
+ */
+
+namespace
+{
+    // Gamepad: X, Y, Z, Rz (8 bits), hat switch (4 bits), 12 buttons - 6 bytes report, no report ID
+    const std::vector<uint8_t> kGenericGamepadReportDescriptor = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00,
+        0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x75, 0x08, 0x95, 0x04, 0x81, 0x02, 0x25, 0x07,
+        0x46, 0x3B, 0x01, 0x75, 0x04, 0x95, 0x01, 0x65, 0x14, 0x09, 0x39, 0x81, 0x42, 0x65, 0x00, 0x75,
+        0x01, 0x95, 0x0C, 0x25, 0x01, 0x45, 0x01, 0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x81, 0x02, 0xC0};
+
+    std::vector<uint8_t> Report(std::initializer_list<uint8_t> bytes, size_t size)
+    {
+        std::vector<uint8_t> report(bytes);
+        report.resize(size, 0x00);
+        return report;
+    }
+
+    template <typename Controller>
+    void RunParseData(benchmark::State &state, Controller &controller, std::vector<uint8_t> report)
+    {
+        RawInputData rawData;
+        uint16_t input_idx = 0;
+
+        if (controller.ParseData(report.data(), report.size(), &rawData, &input_idx) != CONTROLLER_STATUS_SUCCESS)
+        {
+            state.SkipWithError("Report not parsed");
+            return;
+        }
+
+        for (auto _ : state)
+        {
+            input_idx = 0;
+            ControllerResult result = controller.ParseData(report.data(), report.size(), &rawData, &input_idx);
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(rawData);
+        }
+    }
+
+    template <typename Controller>
+    void BM_ParseData(benchmark::State &state, std::vector<uint8_t> report)
+    {
+        ControllerConfig config;
+        Controller controller(std::make_unique<BenchmarkDevice>(), config, std::make_unique<BenchmarkLogger>());
+
+        RunParseData(state, controller, report);
+    }
+
+    void BM_ParseData_GenericHID(benchmark::State &state)
+    {
+        ControllerConfig config;
+        GenericHIDController controller(std::make_unique<BenchmarkDevice>(0x0079, 0x0006, std::make_unique<BenchmarkUSBInterface>(kGenericGamepadReportDescriptor)), config, std::make_unique<BenchmarkLogger>());
+
+        if (controller.Initialize() != CONTROLLER_STATUS_SUCCESS)
+        {
+            state.SkipWithError("Report descriptor not parsed");
+            return;
+        }
+
+        RunParseData(state, controller, {0x80, 0x7F, 0x80, 0x80, 0x1F, 0x00});
+    }
+} // namespace
+
+// BENCHMARK_CAPTURE doesn't accept templates: the drivers are registered before main()
+const bool kParseDataBenchmarksRegistered = []() {
+    const std::vector<uint8_t> dualshock3 = Report({0x01, 0x00, 0x20, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+                                                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xEF, 0x14,
+                                                    0x00, 0x00, 0x00, 0x00, 0x23, 0x18, 0x77, 0x01, 0x1D, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02,
+                                                    0x00},
+                                                   64);
+    const std::vector<uint8_t> steam2026 = Report({0x42, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x45, 0x02, 0x41, 0x02, 0xD2, 0xFE,
+                                                   0x8E, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                   0xD0, 0x6A, 0x0D, 0x00, 0x10, 0x14, 0xE7, 0x1B, 0xFE, 0x35, 0x27, 0x01, 0x6C, 0x00,
+                                                   0xEB, 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+                                                  54);
+    const std::vector<uint8_t> switchpro = Report({0x30, 0x0D, 0x91, 0x01, 0x80, 0x00, 0xB9, 0x77, 0x7D, 0xDB, 0xF7, 0x7B, 0x09, 0x00, 0x00, 0x00}, 64);
+    const std::vector<uint8_t> wii = Report({0x10, 0x10, 0x00, 0x82, 0x82, 0x7B, 0x81, 0x17, 0x1A}, 9);
+    const std::vector<uint8_t> xbox360 = Report({0x00, 0x14, 0x10, 0x10, 0x00, 0xFF, 0x00, 0x80, 0xFF, 0x7F, 0x34, 0x12, 0xCC, 0xED}, 20);
+    const std::vector<uint8_t> xbox360wireless = Report({0x00, 0x01, 0x00, 0xF0, 0x00, 0x13, 0x10, 0x10, 0x00, 0xFF, 0x00, 0x80, 0xFF, 0x7F, 0x34, 0x12, 0xCC, 0xED}, 29);
+    const std::vector<uint8_t> xbox = Report({0x00, 0x14, 0x01, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0xFF, 0x7F, 0x34, 0x12, 0xCC, 0xED}, 20);
+    const std::vector<uint8_t> xboxone = Report({0x20, 0x00, 0x10, 0x0E, 0x10, 0x00, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x80, 0xFF, 0x7F, 0x34, 0x12, 0xCC, 0xED}, 18);
+
+    benchmark::RegisterBenchmark("BM_ParseData/dualshock3", BM_ParseData<Dualshock3Controller>, dualshock3);
+    benchmark::RegisterBenchmark("BM_ParseData/steam2026", BM_ParseData<SteamController2026>, steam2026);
+    benchmark::RegisterBenchmark("BM_ParseData/switchpro", BM_ParseData<SwitchController>, switchpro);
+    benchmark::RegisterBenchmark("BM_ParseData/wii", BM_ParseData<WiiController>, wii);
+    benchmark::RegisterBenchmark("BM_ParseData/xbox360", BM_ParseData<Xbox360Controller>, xbox360);
+    benchmark::RegisterBenchmark("BM_ParseData/xbox360wireless", BM_ParseData<Xbox360WirelessController>, xbox360wireless);
+    benchmark::RegisterBenchmark("BM_ParseData/xbox", BM_ParseData<XboxController>, xbox);
+    benchmark::RegisterBenchmark("BM_ParseData/xboxone", BM_ParseData<XboxOneController>, xboxone);
+    benchmark::RegisterBenchmark("BM_ParseData/generichid", BM_ParseData_GenericHID);
+    return true;
+}();
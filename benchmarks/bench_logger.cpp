@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include "logger.h"
+#include "filemanager_std.h"
+
+#include <filesystem>
+#include <memory>
+
+/*
+ * Caller side cost of a log record (The flusher thread writes the file in the background), formatted or binary,
+ * and of a record whose level is disabled
+ */
+
+#define BENCHMARK_LOG_PATH  "bench_logger/log.txt"
+#define BENCHMARK_LOG_BATCH 64 // Less than the ring size: Measure the caller cost, not the drops
+
+namespace
+{
+    void StartLogger()
+    {
+        std::filesystem::remove_all("bench_logger");
+        ::syscon::logger::Initialize(BENCHMARK_LOG_PATH, std::make_unique<syscon::StdFileManager>());
+        ::syscon::logger::SetLogLevel(LOG_LEVEL_TRACE);
+    }
+
+    void StopLogger()
+    {
+        ::syscon::logger::Exit();
+        ::syscon::logger::SetLogLevel(LOG_LEVEL_TRACE);
+        std::filesystem::remove_all("bench_logger");
+    }
+
+    void BM_LogRecord(benchmark::State &state)
+    {
+        StartLogger();
+        ::syscon::logger::SetBinaryLogging(state.range(0) != 0);
+
+        int i = 0;
+        for (auto _ : state)
+        {
+            ::syscon::logger::LogPerf("Read: %d us, Map: %d us, Total: %d us", i, i * 2, i * 3);
+
+            if (++i % BENCHMARK_LOG_BATCH == 0)
+            {
+                state.PauseTiming();
+                ::syscon::logger::Flush();
+                state.ResumeTiming();
+            }
+        }
+
+        StopLogger();
+    }
+
+    // Level disabled at runtime: The function formats nothing but still evaluates the arguments and pays the call
+    void BM_DisabledLogFunction(benchmark::State &state)
+    {
+        StartLogger();
+        ::syscon::logger::SetLogLevel(LOG_LEVEL_INFO);
+
+        int i = 0;
+        for (auto _ : state)
+        {
+            ::syscon::logger::LogDebug("Controller[%04x-%04x] Reading: %d us", 0x045e, 0x02dd, i++);
+        }
+
+        StopLogger();
+    }
+
+    void BM_DisabledLogMacro(benchmark::State &state)
+    {
+        StartLogger();
+        ::syscon::logger::SetLogLevel(LOG_LEVEL_INFO);
+
+        int i = 0;
+        for (auto _ : state)
+        {
+            SYSCON_LOG_DEBUG("Controller[%04x-%04x] Reading: %d us", 0x045e, 0x02dd, i++);
+            benchmark::DoNotOptimize(i);
+        }
+
+        StopLogger();
+    }
+} // namespace
+
+BENCHMARK(BM_LogRecord)->ArgName("binary")->Arg(0)->Arg(1);
+BENCHMARK(BM_DisabledLogFunction);
+BENCHMARK(BM_DisabledLogMacro);
@@ -0,0 +1,135 @@
+#include <benchmark/benchmark.h>
+#include "BenchmarkDevice.h"
+#include "Controllers/BaseController.h"
+#include "config_handler.h"
+#include "filemanager_std.h"
+
+/*
+ * Per report helpers of BaseController: mapping (with several config shapes), Normalize, ApplyDeadzone and ReadBitsLE
+ */
+
+namespace
+{
+    class MappingBenchmarkController : public BaseController
+    {
+    public:
+        using BaseController::BaseController;
+        using BaseController::MapRawInputToNormalized;
+
+        ControllerResult ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx) override
+        {
+            (void)buffer;
+            (void)size;
+            (void)rawData;
+            (void)input_idx;
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+    };
+
+    enum ConfigShape
+    {
+        ConfigShape_Default = 0, // Nothing mapped
+        ConfigShape_Shipped,     // xboxone profile from the shipped config.ini
+        ConfigShape_Full,        // Deadzones, analog buttons and combos
+    };
+
+    ControllerConfig MakeConfig(ConfigShape shape)
+    {
+        ControllerConfig config;
+
+        if (shape == ConfigShape_Shipped || shape == ConfigShape_Full)
+        {
+            ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+            ::syscon::config::LoadControllerConfig(BENCHMARK_CONFIG_FULLPATH, &config, 0x045e, 0x02dd, false, "");
+        }
+
+        if (shape == ConfigShape_Full)
+        {
+            for (int i = 0; i < ControllerAnalogBinding_Count; i++)
+                config.analogDeadzonePercent[i] = 10;
+
+            config.buttonsAnalogUsed = true;
+            config.buttonsAnalog[ControllerButton::ZL] = {1.0f, ControllerAnalogBinding_Rx};
+            config.buttonsAnalog[ControllerButton::ZR] = {1.0f, ControllerAnalogBinding_Ry};
+
+            config.simulateCombos[0] = {ControllerButton::HOME, {ControllerButton::MINUS, ControllerButton::DPAD_UP}};
+            config.simulateCombos[1] = {ControllerButton::CAPTURE, {ControllerButton::MINUS, ControllerButton::DPAD_DOWN}};
+            config.simulateCombos[2] = {ControllerButton::LSTICK_CLICK, {ControllerButton::L, ControllerButton::ZL}};
+            config.simulateCombos[3] = {ControllerButton::RSTICK_CLICK, {ControllerButton::R, ControllerButton::ZR}};
+        }
+
+        return config;
+    }
+
+    void BM_MapRawInputToNormalized(benchmark::State &state)
+    {
+        MappingBenchmarkController controller(std::make_unique<BenchmarkDevice>(), MakeConfig(static_cast<ConfigShape>(state.range(0))), std::make_unique<BenchmarkLogger>());
+
+        RawInputData rawData;
+        rawData.buttons[1] = true;
+        rawData.buttons[5] = true;
+        rawData.buttons[DPAD_UP_BUTTON_ID] = true;
+        rawData.analog[ControllerAnalogType_X] = 0.5f;
+        rawData.analog[ControllerAnalogType_Y] = -0.25f;
+        rawData.analog[ControllerAnalogType_Z] = 0.05f;
+        rawData.analog[ControllerAnalogType_Rz] = -1.0f;
+        rawData.analog[ControllerAnalogType_Rx] = 0.75f;
+
+        for (auto _ : state)
+        {
+            RawInputData data = rawData; // Mapping modifies the raw data (deadzones)
+            NormalizedButtonData normalData = {};
+            controller.MapRawInputToNormalized(data, &normalData);
+            benchmark::DoNotOptimize(normalData);
+        }
+    }
+
+    void BM_Normalize(benchmark::State &state)
+    {
+        int32_t value = -32768;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(BaseController::Normalize(value, -32768, 32767));
+            value = (value + 257) & 0xFFFF;
+        }
+    }
+
+    void BM_NormalizeCenter(benchmark::State &state)
+    {
+        int32_t value = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(BaseController::Normalize(value, 0, 1023, 480));
+            value = (value + 7) & 0x3FF;
+        }
+    }
+
+    void BM_ApplyDeadzone(benchmark::State &state)
+    {
+        float value = -1.0f;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(BaseController::ApplyDeadzone(15, value));
+            value = (value > 1.0f) ? -1.0f : value + 0.01f;
+        }
+    }
+
+    void BM_ReadBitsLE(benchmark::State &state)
+    {
+        uint8_t buffer[16] = {0x30, 0x0D, 0x91, 0x01, 0x80, 0x00, 0xB9, 0x77, 0x7D, 0xDB, 0xF7, 0x7B, 0x09, 0x00, 0x00, 0x00};
+        const uint32_t bitLength = static_cast<uint32_t>(state.range(0));
+
+        uint32_t bitOffset = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(BaseController::ReadBitsLE(buffer, bitOffset, bitLength));
+            bitOffset = (bitOffset + 3) % (sizeof(buffer) * 8 - bitLength);
+        }
+    }
+} // namespace
+
+BENCHMARK(BM_MapRawInputToNormalized)->ArgName("config")->Arg(ConfigShape_Default)->Arg(ConfigShape_Shipped)->Arg(ConfigShape_Full);
+BENCHMARK(BM_Normalize);
+BENCHMARK(BM_NormalizeCenter);
+BENCHMARK(BM_ApplyDeadzone);
+BENCHMARK(BM_ReadBitsLE)->Arg(1)->Arg(12)->Arg(32);
@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include "SwitchSharedMemoryCopy.h"
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Copy of the HID shared memory: SharedMemoryCopy against the previous volatile 64-bit loop (memcpy_64)
+ */
+
+#define BENCHMARK_SHARED_MEMORY_SIZE 0x40000 // 256 KiB
+
+namespace
+{
+    // Previous implementation, kept as reference
+    void LegacyMemcpy64(void *dest, const void *src, size_t n)
+    {
+        const volatile uint64_t *s = reinterpret_cast<const volatile uint64_t *>(src);
+        volatile uint64_t *d = reinterpret_cast<volatile uint64_t *>(dest);
+        for (size_t i = 0; i < (n / 8); i++)
+            d[i] = s[i];
+    }
+
+    void BM_LegacyMemcpy64(benchmark::State &state)
+    {
+        std::vector<uint64_t> src(BENCHMARK_SHARED_MEMORY_SIZE / sizeof(uint64_t), 0x5A);
+        std::vector<uint64_t> dst(BENCHMARK_SHARED_MEMORY_SIZE / sizeof(uint64_t));
+
+        for (auto _ : state)
+        {
+            LegacyMemcpy64(dst.data(), src.data(), BENCHMARK_SHARED_MEMORY_SIZE);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * BENCHMARK_SHARED_MEMORY_SIZE);
+    }
+
+    void BM_SharedMemoryCopy(benchmark::State &state)
+    {
+        std::vector<uint64_t> src(BENCHMARK_SHARED_MEMORY_SIZE / sizeof(uint64_t), 0x5A);
+        std::vector<uint64_t> dst(BENCHMARK_SHARED_MEMORY_SIZE / sizeof(uint64_t));
+
+        for (auto _ : state)
+        {
+            SharedMemoryCopy(dst.data(), src.data(), BENCHMARK_SHARED_MEMORY_SIZE);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * BENCHMARK_SHARED_MEMORY_SIZE);
+    }
+} // namespace
+
+BENCHMARK(BM_LegacyMemcpy64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SharedMemoryCopy)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Compare a SysConBenchmarks run against the checked-in baseline
+
+Usage:
+    SysConBenchmarks --benchmark_repetitions=5 --benchmark_report_aggregates_only=true \
+                     --benchmark_out=current.json --benchmark_out_format=json
+    python3 benchmarks/compare.py benchmarks/baseline.json current.json [--threshold 10]
+
+Benchmarks are matched by name. A benchmark is a regression when its cpu_time is more than
+'threshold' percent above the baseline. Exit code is 1 if at least one regression is found.
+"""
+
+import argparse
+import json
+import sys
+
+TIME_UNIT_NS = {"ns": 1.0, "us": 1000.0, "ms": 1000000.0, "s": 1000000000.0}
+
+
+def load_benchmarks(path):
+    with open(path, "r", encoding="utf-8") as file:
+        data = json.load(file)
+
+    benchmarks = {}
+    for benchmark in data.get("benchmarks", []):
+        # With --benchmark_repetitions, only the median is compared (less sensitive to a noisy run than the mean)
+        if benchmark.get("run_type") == "aggregate" and benchmark.get("aggregate_name") != "median":
+            continue
+        if "error_occurred" in benchmark and benchmark["error_occurred"]:
+            continue
+
+        name = benchmark.get("run_name", benchmark["name"])
+        unit = TIME_UNIT_NS.get(benchmark.get("time_unit", "ns"), 1.0)
+        benchmarks[name] = benchmark["cpu_time"] * unit
+
+    return benchmarks
+
+
+def format_ns(value):
+    if value >= 1000000.0:
+        return "%.2f ms" % (value / 1000000.0)
+    if value >= 1000.0:
+        return "%.2f us" % (value / 1000.0)
+    return "%.1f ns" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare SysConBenchmarks results against a baseline")
+    parser.add_argument("baseline", help="Baseline JSON (benchmarks/baseline.json)")
+    parser.add_argument("current", help="JSON written by --benchmark_out")
+    parser.add_argument("--threshold", type=float, default=10.0, help="Regression threshold in percent (Default: 10)")
+    args = parser.parse_args()
+
+    baseline = load_benchmarks(args.baseline)
+    current = load_benchmarks(args.current)
+
+    regressions = 0
+    print("%-45s %12s %12s %8s" % ("Benchmark", "Baseline", "Current", "Diff"))
+
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            print("%-45s %12s %12s %8s" % (name, format_ns(baseline[name]), "-", "missing"))
+            continue
+        if name not in baseline:
+            print("%-45s %12s %12s %8s" % (name, "-", format_ns(current[name]), "new"))
+            continue
+
+        diff = (current[name] - baseline[name]) * 100.0 / baseline[name]
+        status = ""
+        if diff > args.threshold:
+            status = "  <-- REGRESSION"
+            regressions += 1
+
+        print("%-45s %12s %12s %+7.1f%%%s" % (name, format_ns(baseline[name]), format_ns(current[name]), diff, status))
+
+    if regressions > 0:
+        print("\n%d benchmark(s) slower than the baseline by more than %.0f%%" % (regressions, args.threshold))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/*
+ * Runtime metrics of a controller (and of the switch handler driving it)
+ *
+ * Fixed size and lock free: counters and histograms are only updated with relaxed atomic operations,
+ * the input thread never waits for a reader. A snapshot can be taken at any time from another thread
+ * (The values of a snapshot are not taken at the exact same instant, which is fine for statistics).
+ *
+ * Histograms are HDR-like: values (in us) are stored in log2 buckets, each one split in 8 linear sub-buckets.
+ * The relative error is below 12.5% from 1us up to 16s, with 176 buckets only.
+ */
+
+#define CONTROLLER_HISTOGRAM_SUB_BUCKET_BITS 3
+#define CONTROLLER_HISTOGRAM_SUB_BUCKETS     (1 << CONTROLLER_HISTOGRAM_SUB_BUCKET_BITS)
+#define CONTROLLER_HISTOGRAM_MAX_EXPONENT    24 // Values >= 2^24 us (~16s) are stored in the last bucket
+#define CONTROLLER_HISTOGRAM_BUCKETS         ((CONTROLLER_HISTOGRAM_MAX_EXPONENT - CONTROLLER_HISTOGRAM_SUB_BUCKET_BITS + 1) * CONTROLLER_HISTOGRAM_SUB_BUCKETS)
+
+enum ControllerCounter
+{
+    ControllerCounter_ReportsRead = 0, // USB transfers read, drained ones included (A Wii U adapter transfer holds 4 inputs)
+    ControllerCounter_ReportsParsed,   // Inputs successfully parsed
+    ControllerCounter_ReportsDuplicated,
+    ControllerCounter_ReportsSide, // Status and ignored reports, see ControllerReportKind
+    ControllerCounter_ParseErrors,
+    ControllerCounter_ReadTimeouts,
+    ControllerCounter_ReadErrors,
+    ControllerCounter_IpcSubmitted, // State sent to HID (HDL or shared memory)
+    ControllerCounter_IpcFailed,
+    ControllerCounter_RumbleWrites,
+
+    ControllerCounter_Count
+};
+
+enum ControllerHistogram
+{
+    ControllerHistogram_ReadToSubmitUs = 0, // From the end of the USB read to the last state of the transfer sent to HID
+    ControllerHistogram_InterReportUs,      // Between 2 transfers read (Not the drained ones, queued before the read)
+
+    ControllerHistogram_Count
+};
+
+inline const char *ControllerCounterName(ControllerCounter counter)
+{
+    static const char *names[ControllerCounter_Count] = {
+        "reports_read",
+        "reports_parsed",
+        "reports_duplicated",
+        "reports_side",
+        "parse_errors",
+        "read_timeouts",
+        "read_errors",
+        "ipc_submitted",
+        "ipc_failed",
+        "rumble_writes",
+    };
+
+    return names[counter];
+}
+
+inline const char *ControllerHistogramName(ControllerHistogram histogram)
+{
+    static const char *names[ControllerHistogram_Count] = {
+        "read_to_submit_us",
+        "inter_report_us",
+    };
+
+    return names[histogram];
+}
+
+class ControllerHistogramSnapshot
+{
+public:
+    uint32_t buckets[CONTROLLER_HISTOGRAM_BUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint32_t max = 0;
+
+    uint32_t Mean() const
+    {
+        return (count == 0) ? 0 : static_cast<uint32_t>(sum / count);
+    }
+
+    // Highest value equivalent to the percentile (percentile: 0.0 to 100.0)
+    uint32_t Percentile(double percentile) const;
+};
+
+class ControllerLatencyHistogram
+{
+public:
+    static uint32_t BucketIndex(uint32_t value)
+    {
+        if (value < CONTROLLER_HISTOGRAM_SUB_BUCKETS)
+            return value;
+
+        uint32_t exponent = 31 - __builtin_clz(value);
+        if (exponent >= CONTROLLER_HISTOGRAM_MAX_EXPONENT)
+            return CONTROLLER_HISTOGRAM_BUCKETS - 1;
+
+        uint32_t subBucket = (value >> (exponent - CONTROLLER_HISTOGRAM_SUB_BUCKET_BITS)) & (CONTROLLER_HISTOGRAM_SUB_BUCKETS - 1);
+        return (exponent - CONTROLLER_HISTOGRAM_SUB_BUCKET_BITS + 1) * CONTROLLER_HISTOGRAM_SUB_BUCKETS + subBucket;
+    }
+
+    // Highest value stored in the bucket
+    static uint32_t BucketUpperBound(uint32_t index)
+    {
+        if (index < CONTROLLER_HISTOGRAM_SUB_BUCKETS)
+            return index;
+
+        uint32_t shift = index / CONTROLLER_HISTOGRAM_SUB_BUCKETS - 1;
+        uint32_t subBucket = index % CONTROLLER_HISTOGRAM_SUB_BUCKETS;
+        return ((CONTROLLER_HISTOGRAM_SUB_BUCKETS + subBucket + 1) << shift) - 1;
+    }
+
+    void Record(uint32_t value)
+    {
+        m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint32_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void Snapshot(ControllerHistogramSnapshot *snapshot) const
+    {
+        for (uint32_t i = 0; i < CONTROLLER_HISTOGRAM_BUCKETS; i++)
+            snapshot->buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+
+        snapshot->count = m_count.load(std::memory_order_relaxed);
+        snapshot->sum = m_sum.load(std::memory_order_relaxed);
+        snapshot->max = m_max.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> m_buckets[CONTROLLER_HISTOGRAM_BUCKETS] = {};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint32_t> m_max{0};
+};
+
+inline uint32_t ControllerHistogramSnapshot::Percentile(double percentile) const
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < CONTROLLER_HISTOGRAM_BUCKETS; i++)
+        total += buckets[i];
+
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>((percentile / 100.0) * total + 0.5);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < CONTROLLER_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t value = ControllerLatencyHistogram::BucketUpperBound(i);
+            return (value < max) ? value : max;
+        }
+    }
+
+    return max;
+}
+
+class ControllerMetricsSnapshot
+{
+public:
+    uint64_t uptime_us = 0;
+    uint64_t counters[ControllerCounter_Count] = {};
+    ControllerHistogramSnapshot histograms[ControllerHistogram_Count];
+
+    // Human readable dump, one value per line, each line is prefixed by 'indent'
+    void Format(std::string *out, const char *indent) const
+    {
+        char line[192];
+        double uptime_s = uptime_us / 1000000.0;
+
+        snprintf(line, sizeof(line), "%suptime_s: %.1f\n", indent, uptime_s);
+        out->append(line);
+
+        for (int i = 0; i < ControllerCounter_Count; i++)
+        {
+            snprintf(line, sizeof(line), "%s%s: %llu (%.1f/s)\n", indent, ControllerCounterName(static_cast<ControllerCounter>(i)),
+                     (unsigned long long)counters[i], (uptime_s > 0) ? counters[i] / uptime_s : 0.0);
+            out->append(line);
+        }
+
+        for (int i = 0; i < ControllerHistogram_Count; i++)
+        {
+            const ControllerHistogramSnapshot &histogram = histograms[i];
+            snprintf(line, sizeof(line), "%s%s: count=%llu mean=%u p50=%u p90=%u p99=%u p99.9=%u max=%u\n", indent,
+                     ControllerHistogramName(static_cast<ControllerHistogram>(i)), (unsigned long long)histogram.count, histogram.Mean(),
+                     histogram.Percentile(50.0), histogram.Percentile(90.0), histogram.Percentile(99.0), histogram.Percentile(99.9), histogram.max);
+            out->append(line);
+        }
+    }
+};
+
+class ControllerMetrics
+{
+public:
+    ControllerMetrics() : m_start(std::chrono::steady_clock::now()) {}
+
+    inline void Increment(ControllerCounter counter)
+    {
+        m_counters[counter].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void Record(ControllerHistogram histogram, uint32_t value_us)
+    {
+        m_histograms[histogram].Record(value_us);
+    }
+
+    void Snapshot(ControllerMetricsSnapshot *snapshot) const
+    {
+        snapshot->uptime_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+
+        for (int i = 0; i < ControllerCounter_Count; i++)
+            snapshot->counters[i] = m_counters[i].load(std::memory_order_relaxed);
+
+        for (int i = 0; i < ControllerHistogram_Count; i++)
+            m_histograms[i].Snapshot(&snapshot->histograms[i]);
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic<uint64_t> m_counters[ControllerCounter_Count] = {};
+    ControllerLatencyHistogram m_histograms[ControllerHistogram_Count];
+};
@@ -0,0 +1,121 @@
+#include "ControllerRegistry.h"
+#include "Controllers.h"
+
+#define USB_CLASS_VENDOR_SPEC 0xFF
+
+namespace
+{
+    template <class T>
+    std::unique_ptr<IController> CreateDriver(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger)
+    {
+        return std::make_unique<T>(std::move(device), config, std::move(logger));
+    }
+
+    ControllerMatchRule VidPid(uint16_t vendor_id, uint16_t product_id)
+    {
+        return {ControllerMatchType_VidPid, vendor_id, product_id, 0, 0, 0};
+    }
+
+    ControllerMatchRule Interface(uint8_t iclass, uint8_t isubclass, uint8_t iprotocol)
+    {
+        return {ControllerMatchType_Interface, 0, 0, iclass, isubclass, iprotocol};
+    }
+} // namespace
+
+void ControllerRegistry::Register(ControllerDriver &&driver)
+{
+    m_drivers.push_back(std::move(driver));
+}
+
+void ControllerRegistry::BuildIndex()
+{
+    m_byName.clear();
+    m_byVidPid.clear();
+    m_byInterface.clear();
+    m_interfaceRules.clear();
+    m_fallback = SIZE_MAX;
+
+    for (size_t i = 0; i < m_drivers.size(); i++)
+    {
+        const ControllerDriver &driver = m_drivers[i];
+
+        if (driver.name.empty())
+        {
+            if (m_fallback == SIZE_MAX)
+                m_fallback = i;
+        }
+        else
+            m_byName.emplace(driver.name, i);
+
+        for (const ControllerMatchRule &rule : driver.rules)
+        {
+            if (rule.type == ControllerMatchType_VidPid)
+                m_byVidPid.emplace(VidPidKey(rule.vendor_id, rule.product_id), i);
+            else if (m_byInterface.emplace(InterfaceKey(rule.interface_class, rule.interface_subclass, rule.interface_protocol), i).second)
+                m_interfaceRules.push_back(rule);
+        }
+    }
+}
+
+const ControllerDriver *ControllerRegistry::FindByName(std::string_view name) const
+{
+    auto it = m_byName.find(std::string(name));
+    if (it != m_byName.end())
+        return &m_drivers[it->second];
+
+    return m_fallback != SIZE_MAX ? &m_drivers[m_fallback] : nullptr;
+}
+
+const ControllerDriver *ControllerRegistry::FindByDevice(uint16_t vendor_id, uint16_t product_id, const IUSBInterface::InterfaceDescriptor &descriptor) const
+{
+    auto it = m_byVidPid.find(VidPidKey(vendor_id, product_id));
+    if (it == m_byVidPid.end())
+        it = m_byVidPid.find(VidPidKey(vendor_id, 0));
+    if (it != m_byVidPid.end())
+        return &m_drivers[it->second];
+
+    it = m_byInterface.find(InterfaceKey(descriptor.bInterfaceClass, descriptor.bInterfaceSubClass, descriptor.bInterfaceProtocol));
+    if (it != m_byInterface.end())
+        return &m_drivers[it->second];
+
+    return nullptr;
+}
+
+void ControllerRegistry::SetProbeFailed(uint16_t vendor_id, uint16_t product_id, int32_t interface_id, uint64_t now_us)
+{
+    m_failedProbes[VidPidKey(vendor_id, product_id)] = {interface_id, now_us};
+}
+
+void ControllerRegistry::ClearProbeFailed(uint16_t vendor_id, uint16_t product_id)
+{
+    m_failedProbes.erase(VidPidKey(vendor_id, product_id));
+}
+
+bool ControllerRegistry::IsProbeBlocked(uint16_t vendor_id, uint16_t product_id, int32_t interface_id, uint64_t now_us) const
+{
+    auto it = m_failedProbes.find(VidPidKey(vendor_id, product_id));
+    if (it == m_failedProbes.end())
+        return false;
+
+    // Unplugged and plugged again: It might work this time
+    if (it->second.interface_id != interface_id)
+        return false;
+
+    return now_us - it->second.time_us < CONTROLLER_PROBE_RETRY_US;
+}
+
+void ControllerRegistry::RegisterBuiltIn()
+{
+    // Same detection as before the registry: Xbox controllers by their interface, the others from config.ini
+    Register({"xbox360", "Xbox 360 controller", CreateDriver<Xbox360Controller>, false, {Interface(USB_CLASS_VENDOR_SPEC, 0x5D, 0x01)}});
+    Register({"xbox360w", "Xbox 360 Wireless controller", CreateDriver<Xbox360WirelessController>, false, {Interface(USB_CLASS_VENDOR_SPEC, 0x5D, 0x81)}});
+    Register({"xboxone", "Xbox One controller", CreateDriver<XboxOneController>, false, {Interface(USB_CLASS_VENDOR_SPEC, 0x47, 0xD0)}});
+    Register({"xbox", "Xbox 1st gen", CreateDriver<XboxController>, false, {Interface(0x58, 0x42, 0x00)}});
+    Register({"dualshock3", "Dualshock 3 controller", CreateDriver<Dualshock3Controller>, false, {VidPid(0x054c, 0x0268)}});
+    Register({"switch", "Switch", CreateDriver<SwitchController>, false, {VidPid(0x057e, 0x2009)}});
+    Register({"wii", "Wii", CreateDriver<WiiController>, false, {VidPid(0x057e, 0x0337)}});
+    Register({"steam2026", "Steam Controller 2026", CreateDriver<SteamController2026>, false, {VidPid(0x28de, 0x1302), VidPid(0x28de, 0x1304)}});
+
+    // For now if Generic controller expose more than 1 interface, we will create as many GenericHIDController as we have interfaces
+    Register({"", "Generic controller", CreateDriver<GenericHIDController>, true, {}});
+}
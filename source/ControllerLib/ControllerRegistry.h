@@ -0,0 +1,98 @@
+#pragma once
+#include "IController.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Registry of the drivers
+ *
+ * Each driver registers its name (config.driver), a factory and the rules used to detect it when a device is not
+ * in config.ini: its VID/PID, or the class/subclass/protocol of its first interface. BuildIndex() builds hash tables
+ * from the rules, the lookups (By name or by device) don't iterate on the drivers.
+ * The driver without name is the fallback (Generic HID): Returned for an unknown name.
+ *
+ * Probes that failed are remembered per VID/PID, a device that can't be initialized is not retried on each USB event
+ * until CONTROLLER_PROBE_RETRY_US are elapsed. Only the interface that failed is blocked: The same device plugged
+ * again (New interface ID) is probed right away.
+ *
+ * This class has no dependency on the sysmodule, it is shared with the simulator and the tests.
+ */
+
+#define CONTROLLER_PROBE_RETRY_US (30 * 1000000ULL)
+
+using ControllerFactory = std::unique_ptr<IController> (*)(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger);
+
+enum ControllerMatchType : uint8_t
+{
+    ControllerMatchType_VidPid = 0, // product_id 0: All the products of the vendor
+    ControllerMatchType_Interface,  // Class, subclass and protocol of the first interface
+};
+
+struct ControllerMatchRule
+{
+    ControllerMatchType type;
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t interface_class;
+    uint8_t interface_subclass;
+    uint8_t interface_protocol;
+};
+
+struct ControllerDriver
+{
+    std::string name;        // config.driver, empty for the fallback driver
+    std::string description; // Logs
+    ControllerFactory factory = nullptr;
+    bool single_interface = false; // Only the first interface of the device is given to the driver
+    std::vector<ControllerMatchRule> rules;
+};
+
+class ControllerRegistry
+{
+public:
+    // Rules are matched in their order of registration (The first driver registering a rule keeps it)
+    void Register(ControllerDriver &&driver);
+    void BuildIndex();
+
+    // Driver of config.driver, the fallback driver if the name is unknown (nullptr if there is none)
+    const ControllerDriver *FindByName(std::string_view name) const;
+
+    // Driver detected for a device: VID/PID first, then its first interface (nullptr if none)
+    const ControllerDriver *FindByDevice(uint16_t vendor_id, uint16_t product_id, const IUSBInterface::InterfaceDescriptor &descriptor) const;
+
+    // Interface rules of all the drivers (In their order of registration), used to query the USB stack
+    const std::vector<ControllerMatchRule> &GetInterfaceRules() const { return m_interfaceRules; }
+
+    // interface_id: First interface given to the driver (UsbHsInterface.inf.ID on the console)
+    void SetProbeFailed(uint16_t vendor_id, uint16_t product_id, int32_t interface_id, uint64_t now_us);
+    void ClearProbeFailed(uint16_t vendor_id, uint16_t product_id);
+    // The last probe of this VID/PID failed less than CONTROLLER_PROBE_RETRY_US ago, on the same interface
+    bool IsProbeBlocked(uint16_t vendor_id, uint16_t product_id, int32_t interface_id, uint64_t now_us) const;
+
+    // Register all the drivers of ControllerLib, BuildIndex() is still to be called
+    void RegisterBuiltIn();
+
+private:
+    static inline uint32_t VidPidKey(uint16_t vendor_id, uint16_t product_id) { return (static_cast<uint32_t>(vendor_id) << 16) | product_id; }
+    static inline uint32_t InterfaceKey(uint8_t iclass, uint8_t isubclass, uint8_t iprotocol) { return (static_cast<uint32_t>(iclass) << 16) | (static_cast<uint32_t>(isubclass) << 8) | iprotocol; }
+
+    std::vector<ControllerDriver> m_drivers;
+    size_t m_fallback = SIZE_MAX;
+
+    std::unordered_map<std::string, size_t> m_byName;
+    std::unordered_map<uint32_t, size_t> m_byVidPid; // product_id 0 for a whole vendor
+    std::unordered_map<uint32_t, size_t> m_byInterface;
+    std::vector<ControllerMatchRule> m_interfaceRules;
+
+    struct FailedProbe
+    {
+        int32_t interface_id;
+        uint64_t time_us;
+    };
+
+    std::unordered_map<uint32_t, FailedProbe> m_failedProbes; // VID/PID -> Last failure
+};
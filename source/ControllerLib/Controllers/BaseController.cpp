@@ -26,6 +26,9 @@ ControllerResult BaseController::Initialize()
         return result;
     }
 
+    InvalidateInputStates();
+    m_inputStateConfigEpoch = GetConfigEpoch();
+
     return CONTROLLER_STATUS_SUCCESS;
 }
 
@@ -132,17 +135,68 @@ ControllerResult BaseController::SetRumble(uint16_t input_idx, float amp_high, f
     return CONTROLLER_STATUS_NOT_IMPLEMENTED;
 }
 
-ControllerResult BaseController::ReadEndpointLatest(uint16_t endpoint_idx, uint8_t *buffer, size_t *size, uint32_t timeout_us)
+ControllerResult BaseController::WriteRumble(IUSBEndpoint *endpoint, const uint8_t *buffer, size_t size)
+{
+    m_metrics.Increment(ControllerCounter_RumbleWrites);
+    return endpoint->Write(buffer, size);
+}
+
+void BaseController::UpdateReadMetrics(const uint8_t *buffer, size_t size, uint16_t endpoint_idx)
+{
+    m_metrics.Increment(ControllerCounter_ReportsRead);
+
+    if (endpoint_idx >= CONTROLLER_METRICS_MAX_ENDPOINTS)
+        return;
+
+    // FNV-1a (64 bits): Same report as the previous one on this endpoint ?
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= buffer[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    if (hash == m_lastReportHash[endpoint_idx])
+        m_metrics.Increment(ControllerCounter_ReportsDuplicated);
+    m_lastReportHash[endpoint_idx] = hash;
+}
+
+void BaseController::RecordReport(uint16_t endpoint_idx, ControllerResult result, const uint8_t *buffer, size_t size)
 {
-    const size_t capacity = std::min((size_t)m_inPipe[endpoint_idx]->GetDescriptor()->wMaxPacketSize, *size);
+    // Started with the first report: The endpoints are opened by Initialize, which can be overridden by the drivers
+    if (!m_recorderStarted)
+    {
+        m_recorder->Begin(m_device->GetVendor(), m_device->GetProduct(), m_interfaces.data(), m_interfaces.size());
+        m_recorderStarted = true;
+    }
+
+    m_recorder->Record(static_cast<uint8_t>(std::min<uint16_t>(endpoint_idx, REPORT_RECORD_ENDPOINT_UNKNOWN)), result, buffer, size);
+}
+
+ControllerResult BaseController::ReadEndpointLatest(uint16_t endpoint_idx, IUSBEndpoint::ReadBuffer *latest, size_t max_size, uint32_t timeout_us)
+{
+    IUSBEndpoint *endpoint = m_inPipe[endpoint_idx];
+    const size_t capacity = std::min((size_t)endpoint->GetDescriptor()->wMaxPacketSize, max_size);
 
-    size_t latestSize = capacity;
-    ControllerResult result = m_inPipe[endpoint_idx]->Read(buffer, &latestSize, timeout_us);
+    ControllerResult result = endpoint->AcquireRead(latest, capacity, timeout_us);
     if (result != CONTROLLER_STATUS_SUCCESS)
+    {
+        if (m_recorder && result != CONTROLLER_STATUS_TIMEOUT && result != CONTROLLER_STATUS_NOTHING_TODO)
+            RecordReport(endpoint_idx, result, nullptr, 0);
         return result;
+    }
 
-    if (latestSize == 0)
+    if (latest->size == 0)
+    {
+        endpoint->ReleaseRead(*latest);
         return CONTROLLER_STATUS_NOTHING_TODO;
+    }
+
+    m_lastReadTime = std::chrono::steady_clock::now();
+
+    // Raw transfers as received (Before any split into inputs), so the record can be replayed
+    if (m_recorder)
+        RecordReport(endpoint_idx, result, latest->data, latest->size);
 
     /*
      Drain any further reports that are already queued, keeping only the freshest one.
@@ -150,29 +204,69 @@ ControllerResult BaseController::ReadEndpointLatest(uint16_t endpoint_idx, uint8
      than we poll and in bursts; without draining we would replay stale frames and fall
      progressively behind. For a gamepad only the latest state matters.
     */
-    uint8_t drainBuffer[CONTROLLER_INPUT_BUFFER_SIZE];
+    /*
+     Only input reports are coalesced: a status report (e.g. a wireless pad connection) queued
+     before the latest input would be lost, it is handled on the side path as soon as it is drained.
+    */
+    /*
+     The reports stay in the transfer buffers of the endpoint: keeping the latest one only
+     gives back the previous buffer, nothing is copied.
+    */
+    ControllerReportKind latestKind = ClassifyReport(latest->data, latest->size);
+    if (latestKind == ControllerReportKind_Input)
+    {
+        // Interval between the transfers we waited for: The drained ones were queued, their arrival time is unknown
+        if (m_lastReportTime.time_since_epoch().count() != 0)
+            m_metrics.Record(ControllerHistogram_InterReportUs, std::chrono::duration_cast<std::chrono::microseconds>(m_lastReadTime - m_lastReportTime).count());
+        m_lastReportTime = m_lastReadTime;
+
+        UpdateReadMetrics(latest->data, latest->size, endpoint_idx);
+    }
+
     for (;;)
     {
-        size_t drainSize = capacity;
-        if (m_inPipe[endpoint_idx]->Read(drainBuffer, &drainSize, 0) != CONTROLLER_STATUS_SUCCESS || drainSize == 0)
+        IUSBEndpoint::ReadBuffer drained;
+        if (endpoint->AcquireRead(&drained, capacity, 0) != CONTROLLER_STATUS_SUCCESS)
+            break;
+
+        if (drained.size == 0)
+        {
+            endpoint->ReleaseRead(drained);
             break;
+        }
 
-        memcpy(buffer, drainBuffer, drainSize);
-        latestSize = drainSize;
+        if (m_recorder)
+            RecordReport(endpoint_idx, CONTROLLER_STATUS_SUCCESS, drained.data, drained.size);
+
+        uint16_t side_idx = endpoint_idx;
+        ControllerReportKind drainKind = ClassifyReport(drained.data, drained.size);
+        if (drainKind != ControllerReportKind_Input)
+        {
+            HandleSideReport(drainKind, drained.data, drained.size, &side_idx);
+            endpoint->ReleaseRead(drained);
+            continue;
+        }
+
+        m_lastReadTime = std::chrono::steady_clock::now();
+        UpdateReadMetrics(drained.data, drained.size, endpoint_idx);
+
+        if (latestKind != ControllerReportKind_Input)
+            HandleSideReport(latestKind, latest->data, latest->size, &side_idx);
+
+        endpoint->ReleaseRead(*latest);
+        *latest = drained;
+        latestKind = drainKind;
     }
 
-    *size = latestSize;
     return CONTROLLER_STATUS_SUCCESS;
 }
 
-ControllerResult BaseController::ReadNextBuffer(uint8_t *buffer, size_t *size, uint16_t *input_idx, uint32_t timeout_us)
+ControllerResult BaseController::ReadNextReport(ControllerReport *report, size_t max_size, uint16_t *input_idx, uint32_t timeout_us)
 {
     const size_t endpoint_count = m_inPipe.size();
     if (endpoint_count == 0)
         return CONTROLLER_STATUS_NOTHING_TODO;
 
-    const size_t requested_size = *size;
-
     /*
      Fast pass: probe every endpoint without blocking and service the first one that has data.
      A non-blocking read still posts (and keeps posted) the underlying async transfer, so this
@@ -185,11 +279,10 @@ ControllerResult BaseController::ReadNextBuffer(uint8_t *buffer, size_t *size, u
     {
         uint16_t endpoint_idx = (m_current_controller_idx + i) % endpoint_count;
 
-        size_t sz = requested_size;
-        if (ReadEndpointLatest(endpoint_idx, buffer, &sz, 0) == CONTROLLER_STATUS_SUCCESS)
+        if (ReadEndpointLatest(endpoint_idx, &report->buffer, max_size, 0) == CONTROLLER_STATUS_SUCCESS)
         {
             m_current_controller_idx = (endpoint_idx + 1) % endpoint_count; // rotate so every endpoint gets a turn
-            *size = sz;
+            report->endpoint = m_inPipe[endpoint_idx];
             *input_idx = endpoint_idx;
             return CONTROLLER_STATUS_SUCCESS;
         }
@@ -203,47 +296,153 @@ ControllerResult BaseController::ReadNextBuffer(uint8_t *buffer, size_t *size, u
     uint16_t endpoint_idx = m_current_controller_idx;
     m_current_controller_idx = (endpoint_idx + 1) % endpoint_count;
 
-    size_t sz = requested_size;
-    ControllerResult result = ReadEndpointLatest(endpoint_idx, buffer, &sz, timeout_us);
+    ControllerResult result = ReadEndpointLatest(endpoint_idx, &report->buffer, max_size, timeout_us);
     if (result != CONTROLLER_STATUS_SUCCESS)
         return result;
 
-    *size = sz;
+    report->endpoint = m_inPipe[endpoint_idx];
     *input_idx = endpoint_idx;
     return CONTROLLER_STATUS_SUCCESS;
 }
 
+void BaseController::ReleaseReport(const ControllerReport &report)
+{
+    if (report.endpoint != nullptr)
+        report.endpoint->ReleaseRead(report.buffer);
+}
+
 ControllerResult BaseController::ReadInput(NormalizedButtonData *normalData, uint16_t *input_idx, uint32_t timeout_us)
 {
     RawInputData rawData;
-    uint8_t input_bytes[CONTROLLER_INPUT_BUFFER_SIZE];
-    size_t size = std::min(sizeof(input_bytes), GetMaxInputBufferSize());
+    ControllerReport report;
 
     auto read_start = std::chrono::high_resolution_clock::now();
-    ControllerResult result = ReadNextBuffer(input_bytes, &size, input_idx, timeout_us);
+    ControllerResult result = ReadNextReport(&report, std::min<size_t>(CONTROLLER_INPUT_BUFFER_SIZE, GetMaxInputBufferSize()), input_idx, timeout_us);
     if (result != CONTROLLER_STATUS_SUCCESS)
+    {
+        if (result == CONTROLLER_STATUS_TIMEOUT)
+            m_metrics.Increment(ControllerCounter_ReadTimeouts);
+        else if (result != CONTROLLER_STATUS_NOTHING_TODO)
+            m_metrics.Increment(ControllerCounter_ReadErrors);
         return result;
+    }
+
+    // Parsed in place, in the transfer buffer of the endpoint
+    uint8_t *buffer = report.buffer.data;
+    size_t size = report.buffer.size;
+
+    ControllerReportKind kind = ClassifyReport(buffer, size);
+    if (kind != ControllerReportKind_Input)
+    {
+        result = HandleSideReport(kind, buffer, size, input_idx);
+        ReleaseReport(report);
+        return result;
+    }
+
+    // New config (e.g. mapping): The unchanged states are submitted again to apply it
+    uint64_t configEpoch = GetConfigEpoch();
+    if (configEpoch != m_inputStateConfigEpoch)
+    {
+        m_inputStateConfigEpoch = configEpoch;
+        InvalidateInputStates();
+    }
 
     auto parse_start = std::chrono::high_resolution_clock::now();
-    result = ParseData(input_bytes, size, &rawData, input_idx);
+    result = ParseData(buffer, size, &rawData, input_idx);
+
+    ReleaseReport(report);
+
     if (result != CONTROLLER_STATUS_SUCCESS)
+    {
+        // NOTHING_TODO: Report intentionally ignored by the driver (e.g. not an input report)
+        if (result != CONTROLLER_STATUS_NOTHING_TODO)
+            m_metrics.Increment(ControllerCounter_ParseErrors);
         return result;
+    }
+
+    m_metrics.Increment(ControllerCounter_ReportsParsed);
 
     auto map_start = std::chrono::high_resolution_clock::now();
     MapRawInputToNormalized(rawData, normalData);
 
     auto end = std::chrono::high_resolution_clock::now();
-    if (m_logger->IsEnabled(LogLevelPerf))
+    CONTROLLER_LOG_PERF(m_logger, "Controller[%04x-%04x] Reading: %dus, Parsing: %dus, Mapping: %dus",
+                        m_device->GetVendor(),
+                        m_device->GetProduct(),
+                        std::chrono::duration_cast<std::chrono::microseconds>(parse_start - read_start).count(),
+                        std::chrono::duration_cast<std::chrono::microseconds>(map_start - parse_start).count(),
+                        std::chrono::duration_cast<std::chrono::microseconds>(end - map_start).count());
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult BaseController::ReadInputs(ControllerInputBatch *inputs, uint32_t timeout_us)
+{
+    ControllerResult result = IController::ReadInputs(inputs, timeout_us);
+    inputs->read_time = m_lastReadTime;
+
+    // Other inputs of the same transfer: Already received, decoded without waiting for the next loop
+    while (inputs->count < CONTROLLER_MAX_INPUTS && HasBufferedInput())
     {
-        m_logger->Log(LogLevelPerf, "Controller[%04x-%04x] Reading: %dus, Parsing: %dus, Mapping: %dus",
-                      m_device->GetVendor(),
-                      m_device->GetProduct(),
-                      std::chrono::duration_cast<std::chrono::microseconds>(parse_start - read_start).count(),
-                      std::chrono::duration_cast<std::chrono::microseconds>(map_start - parse_start).count(),
-                      std::chrono::duration_cast<std::chrono::microseconds>(end - map_start).count());
+        uint16_t i = inputs->count++;
+        inputs->input_idx[i] = 0;
+        inputs->data[i] = {};
+        inputs->result[i] = ReadInput(&inputs->data[i], &inputs->input_idx[i], 0);
     }
 
-    return CONTROLLER_STATUS_SUCCESS;
+    return result;
+}
+
+bool BaseController::HasBufferedInput()
+{
+    return false;
+}
+
+void BaseController::SetReportRules(const ControllerReportRule *rules, size_t count, ControllerReportKind unmatched)
+{
+    m_reportRules = rules;
+    m_reportRuleCount = count;
+    m_unmatchedReportKind = unmatched;
+}
+
+ControllerReportKind BaseController::ClassifyReport(const uint8_t *buffer, size_t size) const
+{
+    for (size_t i = 0; i < m_reportRuleCount; i++)
+    {
+        const ControllerReportRule &rule = m_reportRules[i];
+        if (size < rule.size)
+            continue;
+
+        size_t j = 0;
+        while (j < rule.size && (buffer[j] & rule.mask[j]) == rule.value[j])
+            j++;
+
+        if (j == rule.size)
+            return rule.kind;
+    }
+
+    return m_reportRuleCount == 0 ? ControllerReportKind_Input : m_unmatchedReportKind;
+}
+
+ControllerResult BaseController::HandleSideReport(ControllerReportKind kind, uint8_t *buffer, size_t size, uint16_t *input_idx)
+{
+    m_metrics.Increment(ControllerCounter_ReportsRead);
+    m_metrics.Increment(ControllerCounter_ReportsSide);
+
+    ControllerResult result = CONTROLLER_STATUS_NOTHING_TODO;
+    if (kind == ControllerReportKind_Status)
+    {
+        // Only the driver state is updated (e.g. connection): The decoded input is not used
+        RawInputData rawData;
+        result = ParseData(buffer, size, &rawData, input_idx);
+        if (result == CONTROLLER_STATUS_SUCCESS)
+            result = CONTROLLER_STATUS_NOTHING_TODO;
+    }
+
+    if (result != CONTROLLER_STATUS_NOTHING_TODO)
+        m_metrics.Increment(ControllerCounter_ParseErrors);
+
+    return result;
 }
 
 class StickButton
@@ -258,60 +457,60 @@ public:
 
 void BaseController::MapRawInputToNormalized(RawInputData &rawData, NormalizedButtonData *normalData)
 {
-    if (m_logger->IsEnabled(LogLevelDebug))
-    {
-        m_logger->Log(LogLevelDebug, "Controller[%04x-%04x] B1=%d B2=%d B3=%d B4=%d B5=%d B6=%d B7=%d B8=%d B9=%d B10=%d B11=%d B12=%d B13=%d B14=%d B15=%d B16=%d B17=%d B18=%d DPAD(UP=%d RIGHT=%d DOWN=%d LEFT=%d)",
-                      m_device->GetVendor(),
-                      m_device->GetProduct(),
-                      rawData.buttons[1] ? 1 : 0,
-                      rawData.buttons[2] ? 1 : 0,
-                      rawData.buttons[3] ? 1 : 0,
-                      rawData.buttons[4] ? 1 : 0,
-                      rawData.buttons[5] ? 1 : 0,
-                      rawData.buttons[6] ? 1 : 0,
-                      rawData.buttons[7] ? 1 : 0,
-                      rawData.buttons[8] ? 1 : 0,
-                      rawData.buttons[9] ? 1 : 0,
-                      rawData.buttons[10] ? 1 : 0,
-                      rawData.buttons[11] ? 1 : 0,
-                      rawData.buttons[12] ? 1 : 0,
-                      rawData.buttons[13] ? 1 : 0,
-                      rawData.buttons[14] ? 1 : 0,
-                      rawData.buttons[15] ? 1 : 0,
-                      rawData.buttons[16] ? 1 : 0,
-                      rawData.buttons[17] ? 1 : 0,
-                      rawData.buttons[18] ? 1 : 0,
-                      rawData.buttons[DPAD_UP_BUTTON_ID] ? 1 : 0,
-                      rawData.buttons[DPAD_RIGHT_BUTTON_ID] ? 1 : 0,
-                      rawData.buttons[DPAD_DOWN_BUTTON_ID] ? 1 : 0,
-                      rawData.buttons[DPAD_LEFT_BUTTON_ID] ? 1 : 0);
-
-        m_logger->Log(LogLevelDebug, "Controller[%04x-%04x] X=%d%%, Y=%d%%, Z=%d%%, Rx=%d%%, Ry=%d%%, Rz=%d%%, Slider=%d%%, Dial=%d%%, Brake=%d%%, Accelerator=%d%%",
-                      m_device->GetVendor(),
-                      m_device->GetProduct(),
-                      (int)(rawData.analog[ControllerAnalogBinding_X] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Y] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Z] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Rx] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Ry] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Rz] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Slider] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Dial] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Brake] * 100.0),
-                      (int)(rawData.analog[ControllerAnalogBinding_Accelerator] * 100.0));
-    }
+    // Load the config snapshot once, a config reload must not be applied in the middle of a report
+    const ControllerConfig &config = GetConfig();
+
+    CONTROLLER_LOG_DEBUG(m_logger, "Controller[%04x-%04x] B1=%d B2=%d B3=%d B4=%d B5=%d B6=%d B7=%d B8=%d B9=%d B10=%d B11=%d B12=%d B13=%d B14=%d B15=%d B16=%d B17=%d B18=%d DPAD(UP=%d RIGHT=%d DOWN=%d LEFT=%d)",
+                         m_device->GetVendor(),
+                         m_device->GetProduct(),
+                         rawData.buttons[1] ? 1 : 0,
+                         rawData.buttons[2] ? 1 : 0,
+                         rawData.buttons[3] ? 1 : 0,
+                         rawData.buttons[4] ? 1 : 0,
+                         rawData.buttons[5] ? 1 : 0,
+                         rawData.buttons[6] ? 1 : 0,
+                         rawData.buttons[7] ? 1 : 0,
+                         rawData.buttons[8] ? 1 : 0,
+                         rawData.buttons[9] ? 1 : 0,
+                         rawData.buttons[10] ? 1 : 0,
+                         rawData.buttons[11] ? 1 : 0,
+                         rawData.buttons[12] ? 1 : 0,
+                         rawData.buttons[13] ? 1 : 0,
+                         rawData.buttons[14] ? 1 : 0,
+                         rawData.buttons[15] ? 1 : 0,
+                         rawData.buttons[16] ? 1 : 0,
+                         rawData.buttons[17] ? 1 : 0,
+                         rawData.buttons[18] ? 1 : 0,
+                         rawData.buttons[DPAD_UP_BUTTON_ID] ? 1 : 0,
+                         rawData.buttons[DPAD_RIGHT_BUTTON_ID] ? 1 : 0,
+                         rawData.buttons[DPAD_DOWN_BUTTON_ID] ? 1 : 0,
+                         rawData.buttons[DPAD_LEFT_BUTTON_ID] ? 1 : 0);
+
+    CONTROLLER_LOG_DEBUG(m_logger, "Controller[%04x-%04x] X=%d%%, Y=%d%%, Z=%d%%, Rx=%d%%, Ry=%d%%, Rz=%d%%, Slider=%d%%, Dial=%d%%, Brake=%d%%, Accelerator=%d%%",
+                         m_device->GetVendor(),
+                         m_device->GetProduct(),
+                         (int)(rawData.analog[ControllerAnalogBinding_X] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Y] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Z] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Rx] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Ry] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Rz] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Slider] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Dial] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Brake] * 100.0),
+                         (int)(rawData.analog[ControllerAnalogBinding_Accelerator] * 100.0));
 
     rawData.analog[ControllerAnalogBinding_Unknown] = 0.0f;
-    rawData.analog[ControllerAnalogBinding_X] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_X], rawData.analog[ControllerAnalogBinding_X]);
-    rawData.analog[ControllerAnalogBinding_Y] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Y], rawData.analog[ControllerAnalogBinding_Y]);
-    rawData.analog[ControllerAnalogBinding_Z] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Z], rawData.analog[ControllerAnalogBinding_Z]);
-    rawData.analog[ControllerAnalogBinding_Rz] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Rz], rawData.analog[ControllerAnalogBinding_Rz]);
-    rawData.analog[ControllerAnalogBinding_Rx] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Rx], rawData.analog[ControllerAnalogBinding_Rx]);
-    rawData.analog[ControllerAnalogBinding_Ry] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Ry], rawData.analog[ControllerAnalogBinding_Ry]);
-    rawData.analog[ControllerAnalogBinding_Slider] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Slider], rawData.analog[ControllerAnalogBinding_Slider]);
-    rawData.analog[ControllerAnalogBinding_Dial] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Dial], rawData.analog[ControllerAnalogBinding_Dial]);
-    rawData.analog[ControllerAnalogBinding_Brake] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Brake], rawData.analog[ControllerAnalogBinding_Brake]);
-    rawData.analog[ControllerAnalogBinding_Accelerator] = BaseController::ApplyDeadzone(GetConfig().analogDeadzonePercent[ControllerAnalogBinding_Accelerator], rawData.analog[ControllerAnalogBinding_Accelerator]);
+    rawData.analog[ControllerAnalogBinding_X] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_X], rawData.analog[ControllerAnalogBinding_X]);
+    rawData.analog[ControllerAnalogBinding_Y] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Y], rawData.analog[ControllerAnalogBinding_Y]);
+    rawData.analog[ControllerAnalogBinding_Z] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Z], rawData.analog[ControllerAnalogBinding_Z]);
+    rawData.analog[ControllerAnalogBinding_Rz] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Rz], rawData.analog[ControllerAnalogBinding_Rz]);
+    rawData.analog[ControllerAnalogBinding_Rx] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Rx], rawData.analog[ControllerAnalogBinding_Rx]);
+    rawData.analog[ControllerAnalogBinding_Ry] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Ry], rawData.analog[ControllerAnalogBinding_Ry]);
+    rawData.analog[ControllerAnalogBinding_Slider] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Slider], rawData.analog[ControllerAnalogBinding_Slider]);
+    rawData.analog[ControllerAnalogBinding_Dial] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Dial], rawData.analog[ControllerAnalogBinding_Dial]);
+    rawData.analog[ControllerAnalogBinding_Brake] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Brake], rawData.analog[ControllerAnalogBinding_Brake]);
+    rawData.analog[ControllerAnalogBinding_Accelerator] = BaseController::ApplyDeadzone(config.analogDeadzonePercent[ControllerAnalogBinding_Accelerator], rawData.analog[ControllerAnalogBinding_Accelerator]);
 
     StickButton sticks_list[] = {
         // button value_addr, sign
@@ -328,12 +527,12 @@ void BaseController::MapRawInputToNormalized(RawInputData &rawData, NormalizedBu
     // Analog value
     for (auto &&stick : sticks_list)
     {
-        ControllerAnalogConfig analogCfg = GetConfig().buttonsAnalog[stick.button];
-        float value = (analogCfg.sign * rawData.analog[analogCfg.bind]) * (GetConfig().analogFactorPercent[analogCfg.bind] / 100.0f);
+        ControllerAnalogConfig analogCfg = config.buttonsAnalog[stick.button];
+        float value = (analogCfg.sign * rawData.analog[analogCfg.bind]) * (config.analogFactorPercent[analogCfg.bind] / 100.0f);
         if (value > 1.0f)
             value = 1.0f;
 
-        if (rawData.buttons[GetConfig().buttonsPin[stick.button][0]] || rawData.buttons[GetConfig().buttonsPin[stick.button][1]])
+        if (rawData.buttons[config.buttonsPin[stick.button][0]] || rawData.buttons[config.buttonsPin[stick.button][1]])
             *stick.value_addr = stick.sign * 1.0f;
         else if (value > 0.0f) // Is positive
             *stick.value_addr = stick.sign * value;
@@ -360,18 +559,18 @@ void BaseController::MapRawInputToNormalized(RawInputData &rawData, NormalizedBu
         ControllerButton::DPAD_LEFT};
 
     for (ControllerButton controllerButton : controllerButtonList)
-        normalData->buttons[controllerButton] = rawData.buttons[GetConfig().buttonsPin[controllerButton][0]] || rawData.buttons[GetConfig().buttonsPin[controllerButton][1]];
+        normalData->buttons[controllerButton] = rawData.buttons[config.buttonsPin[controllerButton][0]] || rawData.buttons[config.buttonsPin[controllerButton][1]];
 
-    if (GetConfig().buttonsAnalogUsed)
+    if (config.buttonsAnalogUsed)
     {
         for (ControllerButton controllerButton : controllerButtonList)
-            normalData->buttons[controllerButton] |= (GetConfig().buttonsAnalog[controllerButton].sign * rawData.analog[GetConfig().buttonsAnalog[controllerButton].bind]) > 0.0f;
+            normalData->buttons[controllerButton] |= (config.buttonsAnalog[controllerButton].sign * rawData.analog[config.buttonsAnalog[controllerButton].bind]) > 0.0f;
     }
 
     // Simulate buttons
     for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
     {
-        const ControllerComboConfig *combo = &GetConfig().simulateCombos[i];
+        const ControllerComboConfig *combo = &config.simulateCombos[i];
         if (combo->buttonSimulated == ControllerButton::NONE)
             break; // Stop at the first empty combo
 
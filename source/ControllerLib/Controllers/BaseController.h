@@ -1,8 +1,12 @@
 #pragma once
 
 #include "IController.h"
+#include <chrono>
 #include <vector>
 
+#define CONTROLLER_METRICS_MAX_ENDPOINTS 16 // Duplicated reports are only detected on the first endpoints
+#define CONTROLLER_REPORT_RULE_BYTES     4  // First bytes of a report used to classify it
+
 enum ControllerAnalogType
 {
     ControllerAnalogType_Unknown = 0,
@@ -27,6 +31,70 @@ public:
     float analog[ControllerAnalogType_Count] = {};
 };
 
+/*
+ * Last state decoded for one input, for drivers receiving partial reports (e.g. XboxOne home button in its own report)
+ * Each report only sets the fields it carries, the state is handed off to ReadInput only if one of them changed.
+ */
+class RawInputState
+{
+public:
+    RawInputData data;
+    bool dirty = true; // The first report is always handed off
+
+    inline void SetButton(int button, bool value)
+    {
+        if (data.buttons[button] != value)
+        {
+            data.buttons[button] = value;
+            dirty = true;
+        }
+    }
+
+    inline void SetAnalog(ControllerAnalogType type, float value)
+    {
+        if (data.analog[type] != value)
+        {
+            data.analog[type] = value;
+            dirty = true;
+        }
+    }
+
+    // Copy the state to 'rawData' if it changed since the last hand off, return false otherwise
+    inline bool HandOff(RawInputData *rawData)
+    {
+        if (!dirty)
+            return false;
+
+        *rawData = data;
+        dirty = false;
+        return true;
+    }
+};
+
+// What ReadInput does with a report, see BaseController::SetReportRules
+enum ControllerReportKind : uint8_t
+{
+    ControllerReportKind_Input = 0, // Parsed, mapped and submitted
+    ControllerReportKind_Status,    // Parsed only, to update the driver state (e.g. connection), never mapped nor submitted
+    ControllerReportKind_Ignore,    // Dropped without parsing (e.g. acks, heartbeats)
+};
+
+// Reports starting with 'value' (After applying 'mask' on their first 'size' bytes)
+struct ControllerReportRule
+{
+    uint8_t size;
+    uint8_t mask[CONTROLLER_REPORT_RULE_BYTES];
+    uint8_t value[CONTROLLER_REPORT_RULE_BYTES];
+    ControllerReportKind kind;
+};
+
+// Report to parse: lent by 'endpoint' until BaseController::ReleaseReport (Zero-copy), or in a buffer of the driver (endpoint is nullptr)
+struct ControllerReport
+{
+    IUSBEndpoint *endpoint = nullptr;
+    IUSBEndpoint::ReadBuffer buffer;
+};
+
 class BaseController : public IController
 {
 protected:
@@ -35,12 +103,47 @@ protected:
     std::vector<IUSBInterface *> m_interfaces;
     uint8_t m_current_controller_idx = 0;
 
-    virtual ControllerResult ReadNextBuffer(uint8_t *buffer, size_t *size, uint16_t *input_idx, uint32_t timeout_us);
+    // Metrics: hash of the last report read on each endpoint, time of the last transfer and end of the last USB read
+    uint64_t m_lastReportHash[CONTROLLER_METRICS_MAX_ENDPOINTS] = {};
+    std::chrono::steady_clock::time_point m_lastReportTime;
+    std::chrono::steady_clock::time_point m_lastReadTime;
+
+    bool m_recorderStarted = false;
+    uint64_t m_inputStateConfigEpoch = 0; // Config epoch of the last input states handed off, see InvalidateInputStates
+
+    // Report classification (Static table of the driver), none: every report is an input
+    const ControllerReportRule *m_reportRules = nullptr;
+    size_t m_reportRuleCount = 0;
+    ControllerReportKind m_unmatchedReportKind = ControllerReportKind_Input;
+
+    // Next report of the controller (Up to max_size bytes), given back with ReleaseReport once parsed
+    virtual ControllerResult ReadNextReport(ControllerReport *report, size_t max_size, uint16_t *input_idx, uint32_t timeout_us);
+    void ReleaseReport(const ControllerReport &report);
     // Read the freshest report from a single endpoint, draining any already-queued reports (keep-latest).
-    ControllerResult ReadEndpointLatest(uint16_t endpoint_idx, uint8_t *buffer, size_t *size, uint32_t timeout_us);
+    ControllerResult ReadEndpointLatest(uint16_t endpoint_idx, IUSBEndpoint::ReadBuffer *latest, size_t max_size, uint32_t timeout_us);
     virtual void MapRawInputToNormalized(RawInputData &rawData, NormalizedButtonData *normalData);
 
     virtual ControllerResult ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx) = 0;
+    // Inputs of the last transfer not returned yet (Reports holding several inputs, see ReadInputs)
+    virtual bool HasBufferedInput();
+    // The config changed or the controller was (re)initialized: The unchanged states kept by the driver (RawInputState) must be handed off again
+    virtual void InvalidateInputStates() {}
+
+    /*
+        Drivers receiving several kinds of reports on the same endpoint register a table of rules (First match wins):
+        status and ignored reports take a side path in ReadInput, without mapping, timings nor submission to HID,
+        and a status report is never dropped when ReadEndpointLatest drains the queued reports.
+        'rules' must stay valid for the whole life of the controller.
+    */
+    void SetReportRules(const ControllerReportRule *rules, size_t count, ControllerReportKind unmatched);
+    ControllerReportKind ClassifyReport(const uint8_t *buffer, size_t size) const;
+    ControllerResult HandleSideReport(ControllerReportKind kind, uint8_t *buffer, size_t size, uint16_t *input_idx);
+
+    // Write a rumble command (Counted in the metrics)
+    ControllerResult WriteRumble(IUSBEndpoint *endpoint, const uint8_t *buffer, size_t size);
+    // Once per USB transfer (Not per decoded input), drained reports included
+    void UpdateReadMetrics(const uint8_t *buffer, size_t size, uint16_t endpoint_idx);
+    void RecordReport(uint16_t endpoint_idx, ControllerResult result, const uint8_t *buffer, size_t size);
 
 public:
     BaseController(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger);
@@ -57,6 +160,7 @@ public:
     virtual uint16_t GetInputCount() override;
 
     ControllerResult ReadInput(NormalizedButtonData *normalData, uint16_t *input_idx, uint32_t timeout_us) override;
+    ControllerResult ReadInputs(ControllerInputBatch *inputs, uint32_t timeout_us) override;
 
     ControllerResult SetRumble(uint16_t input_idx, float amp_high, float amp_low) override;
 
@@ -43,6 +43,17 @@ ControllerResult GenericHIDController::Initialize()
     if (result != CONTROLLER_STATUS_SUCCESS)
         m_logger->Log(LogLevelError, "GenericHIDController[%04x-%04x] SET_IDLE failed, continue anyway ...", m_device->GetVendor(), m_device->GetProduct());
 
+    // Woken up: The report descriptor was already parsed before the sleep
+    if (m_resumeData)
+    {
+        const GenericHIDResumeData *resumeData = static_cast<const GenericHIDResumeData *>(m_resumeData.get());
+        m_joystick = resumeData->joystick;
+        m_joystick_count = resumeData->joystick_count;
+
+        m_logger->Log(LogLevelInfo, "GenericHIDController[%04x-%04x] USB joystick resumed (%d inputs) !", m_device->GetVendor(), m_device->GetProduct(), GetInputCount());
+        return CONTROLLER_STATUS_SUCCESS;
+    }
+
     // Get HID report descriptor
     result = m_interfaces[0]->ControlTransferInput((uint8_t)IUSBEndpoint::USB_ENDPOINT_IN | (uint8_t)USB_RECIPIENT_INTERFACE, USB_REQUEST_GET_DESCRIPTOR, (USB_DT_REPORT << 8), m_interfaces[0]->GetDescriptor()->bInterfaceNumber, buffer, &size);
     if (result != CONTROLLER_STATUS_SUCCESS)
@@ -71,6 +82,17 @@ ControllerResult GenericHIDController::Initialize()
     return CONTROLLER_STATUS_SUCCESS;
 }
 
+std::shared_ptr<const ControllerResumeData> GenericHIDController::GetResumeData()
+{
+    if (!m_joystick || m_joystick_count == 0)
+        return nullptr;
+
+    std::shared_ptr<GenericHIDResumeData> data = std::make_shared<GenericHIDResumeData>();
+    data->joystick = m_joystick;
+    data->joystick_count = m_joystick_count;
+    return data;
+}
+
 uint16_t GenericHIDController::GetInputCount()
 {
     return std::min((int)m_joystick_count, CONTROLLER_MAX_INPUTS);
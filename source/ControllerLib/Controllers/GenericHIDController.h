@@ -5,6 +5,14 @@
 
 class HIDJoystick;
 
+// Parsed HID report descriptor, the device does not need to send it again after a sleep
+class GenericHIDResumeData : public ControllerResumeData
+{
+public:
+    std::shared_ptr<HIDJoystick> joystick;
+    uint8_t joystick_count = 0;
+};
+
 class GenericHIDController : public BaseController
 {
 private:
@@ -17,6 +25,8 @@ public:
 
     virtual ControllerResult Initialize() override;
 
+    virtual std::shared_ptr<const ControllerResumeData> GetResumeData() override;
+
     virtual uint16_t GetInputCount() override;
 
     virtual ControllerResult ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx) override;
@@ -2,6 +2,14 @@
 #include <vector>
 #include <chrono>
 
+// Other reports (e.g. the IMU only reports of the dongle) are dropped before parsing
+static constexpr ControllerReportRule reportRules[]{
+    {1, {0xff}, {REPORT_INPUT}, ControllerReportKind_Input},
+    {1, {0xff}, {REPORT_INPUT_BLE}, ControllerReportKind_Input},
+    {1, {0xff}, {REPORT_WIRELESS_STATUS_X}, ControllerReportKind_Status},
+    {1, {0xff}, {REPORT_WIRELESS_STATUS}, ControllerReportKind_Status},
+};
+
 SteamController2026::SteamController2026(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger)
     : BaseController(std::move(device), std::move(config), std::move(logger))
 {
@@ -11,6 +19,8 @@ SteamController2026::SteamController2026(std::unique_ptr<IUSBDevice> &&device, c
 
     for (int i = 0; i < STEAMCONTROLLER_MAX_INPUTS; i++)
         m_controllerInfo[i].m_is_connected = false;
+
+    SetReportRules(reportRules, sizeof(reportRules) / sizeof(reportRules[0]), ControllerReportKind_Ignore);
 }
 
 SteamController2026::~SteamController2026()
@@ -44,35 +54,40 @@ ControllerResult SteamController2026::ParseData(uint8_t *buffer, size_t size, Ra
             return CONTROLLER_STATUS_UNEXPECTED_DATA;
         }
 
-        m_rawInput.buttons[1] = controllerData->buttons.a;
-        m_rawInput.buttons[2] = controllerData->buttons.b;
-        m_rawInput.buttons[3] = controllerData->buttons.y;
-        m_rawInput.buttons[4] = controllerData->buttons.x;
-        m_rawInput.buttons[5] = controllerData->buttons.l1;
-        m_rawInput.buttons[6] = controllerData->buttons.r1;
-        m_rawInput.buttons[7] = controllerData->buttons.l2;
-        m_rawInput.buttons[8] = controllerData->buttons.r2;
-        m_rawInput.buttons[9] = controllerData->buttons.view;
-        m_rawInput.buttons[10] = controllerData->buttons.menu;
-        m_rawInput.buttons[11] = controllerData->buttons.quickaccess;
-        m_rawInput.buttons[12] = controllerData->buttons.steam;
-        m_rawInput.buttons[13] = controllerData->buttons.lstick;
-        m_rawInput.buttons[14] = controllerData->buttons.rstick;
-
-        m_rawInput.analog[ControllerAnalogType_X] = BaseController::Normalize(controllerData->left_stick_x, -32768, 32767);
-        m_rawInput.analog[ControllerAnalogType_Y] = BaseController::Normalize(-controllerData->left_stick_y, -32768, 32767);
-        m_rawInput.analog[ControllerAnalogType_Z] = BaseController::Normalize(controllerData->right_stick_x, -32768, 32767);
-        m_rawInput.analog[ControllerAnalogType_Rz] = BaseController::Normalize(-controllerData->right_stick_y, -32768, 32767);
-
-        m_rawInput.buttons[DPAD_UP_BUTTON_ID] = controllerData->buttons.dpad_up;
-        m_rawInput.buttons[DPAD_RIGHT_BUTTON_ID] = controllerData->buttons.dpad_right;
-        m_rawInput.buttons[DPAD_DOWN_BUTTON_ID] = controllerData->buttons.dpad_down;
-        m_rawInput.buttons[DPAD_LEFT_BUTTON_ID] = controllerData->buttons.dpad_left;
-
-        *rawData = m_rawInput;
+        RawInputState &state = m_rawInput[*input_idx];
+
+        state.SetButton(1, controllerData->buttons.a);
+        state.SetButton(2, controllerData->buttons.b);
+        state.SetButton(3, controllerData->buttons.y);
+        state.SetButton(4, controllerData->buttons.x);
+        state.SetButton(5, controllerData->buttons.l1);
+        state.SetButton(6, controllerData->buttons.r1);
+        state.SetButton(7, controllerData->buttons.l2);
+        state.SetButton(8, controllerData->buttons.r2);
+        state.SetButton(9, controllerData->buttons.view);
+        state.SetButton(10, controllerData->buttons.menu);
+        state.SetButton(11, controllerData->buttons.quickaccess);
+        state.SetButton(12, controllerData->buttons.steam);
+        state.SetButton(13, controllerData->buttons.lstick);
+        state.SetButton(14, controllerData->buttons.rstick);
+
+        state.SetAnalog(ControllerAnalogType_X, BaseController::Normalize(controllerData->left_stick_x, -32768, 32767));
+        state.SetAnalog(ControllerAnalogType_Y, BaseController::Normalize(-controllerData->left_stick_y, -32768, 32767));
+        state.SetAnalog(ControllerAnalogType_Z, BaseController::Normalize(controllerData->right_stick_x, -32768, 32767));
+        state.SetAnalog(ControllerAnalogType_Rz, BaseController::Normalize(-controllerData->right_stick_y, -32768, 32767));
+
+        state.SetButton(DPAD_UP_BUTTON_ID, controllerData->buttons.dpad_up);
+        state.SetButton(DPAD_RIGHT_BUTTON_ID, controllerData->buttons.dpad_right);
+        state.SetButton(DPAD_DOWN_BUTTON_ID, controllerData->buttons.dpad_down);
+        state.SetButton(DPAD_LEFT_BUTTON_ID, controllerData->buttons.dpad_left);
+
         if (!m_controllerInfo[*input_idx].m_is_connected)
             OnControllerConnect(*input_idx);
 
+        // Same state as the previous report of this pad (e.g. only the IMU changed): Nothing to submit
+        if (!state.HandOff(rawData))
+            return CONTROLLER_STATUS_NOTHING_TODO;
+
         return CONTROLLER_STATUS_SUCCESS;
     }
     else if (report_id == REPORT_WIRELESS_STATUS_X || report_id == REPORT_WIRELESS_STATUS)
@@ -99,10 +114,17 @@ bool SteamController2026::IsControllerConnected(uint16_t input_idx)
     return m_controllerInfo[input_idx].m_is_connected;
 }
 
+void SteamController2026::InvalidateInputStates()
+{
+    for (RawInputState &state : m_rawInput)
+        state.dirty = true;
+}
+
 ControllerResult SteamController2026::OnControllerConnect(uint16_t input_idx)
 {
     m_logger->Log(LogLevelInfo, "SteamController2026 controller connected (Idx: %d) ...", input_idx);
     m_controllerInfo[input_idx].m_is_connected = true;
+    m_rawInput[input_idx].dirty = true; // The state is submitted again, even if unchanged
     return UpdateLizard(input_idx);
 }
 
@@ -123,7 +123,7 @@ struct SteamControllerInfo
 class SteamController2026 : public BaseController
 {
 private:
-    RawInputData m_rawInput;
+    RawInputState m_rawInput[STEAMCONTROLLER_MAX_INPUTS]; // By pad: The puck reports each one on its own endpoint
     SteamControllerInfo m_controllerInfo[STEAMCONTROLLER_MAX_INPUTS];
     uint8_t m_controller_count;
 
@@ -131,6 +131,8 @@ private:
     ControllerResult OnControllerDisconnect(uint16_t input_idx);
     ControllerResult UpdateLizard(uint16_t input_idx);
 
+    void InvalidateInputStates() override;
+
 public:
     SteamController2026(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger);
     virtual ~SteamController2026() override;
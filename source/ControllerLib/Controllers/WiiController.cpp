@@ -45,24 +45,32 @@ uint16_t WiiController::GetInputCount()
     return WII_MAX_INPUTS;
 }
 
-ControllerResult WiiController::ReadNextBuffer(uint8_t *buffer, size_t *size, uint16_t *input_idx, uint32_t timeout_us)
+ControllerResult WiiController::ReadNextReport(ControllerReport *report, size_t max_size, uint16_t *input_idx, uint32_t timeout_us)
 {
-    ControllerResult result = CONTROLLER_STATUS_SUCCESS;
+    (void)max_size;
+
     if (m_current_wii_controller_idx == 0)
     {
-        *size = WII_INPUT_BUFFER_SIZE;
+        ControllerReport usbReport;
         uint16_t input_idx_tmp = 0;
 
-        result = BaseController::ReadNextBuffer(m_buffer, size, &input_idx_tmp, timeout_us);
+        ControllerResult result = BaseController::ReadNextReport(&usbReport, WII_INPUT_BUFFER_SIZE, &input_idx_tmp, timeout_us);
         if (result != CONTROLLER_STATUS_SUCCESS)
             return result;
 
-        if (m_buffer[0] != 0x21 || *size < WII_INPUT_BUFFER_SIZE)
+        // Decoded over the next calls: The transfer buffer is given back right away
+        bool valid = usbReport.buffer.size >= WII_INPUT_BUFFER_SIZE && usbReport.buffer.data[0] == 0x21;
+        if (valid)
+            memcpy(m_buffer, usbReport.buffer.data, WII_INPUT_BUFFER_SIZE);
+        ReleaseReport(usbReport);
+
+        if (!valid)
             return CONTROLLER_STATUS_UNEXPECTED_DATA;
     }
 
-    memcpy(buffer, &m_buffer[1 + (m_current_wii_controller_idx * 9)], 9);
-    *size = 9;
+    report->endpoint = nullptr;
+    report->buffer.data = &m_buffer[1 + (m_current_wii_controller_idx * 9)];
+    report->buffer.size = 9;
 
     *input_idx = m_current_wii_controller_idx;
     m_current_wii_controller_idx = (m_current_wii_controller_idx + 1) % WII_MAX_INPUTS;
@@ -70,6 +78,12 @@ ControllerResult WiiController::ReadNextBuffer(uint8_t *buffer, size_t *size, ui
     return CONTROLLER_STATUS_SUCCESS;
 }
 
+// The 4 ports are in the same report: The next ones are decoded from the buffer, without reading the USB
+bool WiiController::HasBufferedInput()
+{
+    return m_current_wii_controller_idx != 0;
+}
+
 ControllerResult WiiController::ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx)
 {
     if (size < 9)
@@ -122,5 +136,5 @@ ControllerResult WiiController::SetRumble(uint16_t input_idx, float amp_high, fl
 
     rumbleData[1 + input_idx] = (uint8_t)(amp_high * 255);
 
-    return m_outPipe[0]->Write(rumbleData, sizeof(rumbleData));
+    return WriteRumble(m_outPipe[0], rumbleData, sizeof(rumbleData));
 }
@@ -14,7 +14,8 @@ protected:
     bool m_rumble_supported[WII_MAX_INPUTS];
     uint8_t rumbleData[5] = {0x11, 0, 0, 0, 0};
 
-    ControllerResult ReadNextBuffer(uint8_t *buffer, size_t *size, uint16_t *input_idx, uint32_t timeout_us) override;
+    ControllerResult ReadNextReport(ControllerReport *report, size_t max_size, uint16_t *input_idx, uint32_t timeout_us) override;
+    bool HasBufferedInput() override;
 
 public:
     WiiController(std::unique_ptr<IUSBDevice> &&device,
@@ -77,7 +77,7 @@ ControllerResult Xbox360Controller::SetRumble(uint16_t input_idx, float amp_high
     if (m_outPipe.size() <= input_idx)
         return CONTROLLER_STATUS_INVALID_INDEX;
 
-    return m_outPipe[input_idx]->Write(rumbleData, sizeof(rumbleData));
+    return WriteRumble(m_outPipe[input_idx], rumbleData, sizeof(rumbleData));
 }
 
 ControllerResult Xbox360Controller::SetLED(uint16_t input_idx, Xbox360LEDValue value)
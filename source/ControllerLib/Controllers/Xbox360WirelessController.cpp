@@ -6,11 +6,19 @@ static constexpr uint8_t reconnectPacket[]{0x08, 0x00, 0x0F, 0xC0, 0x00, 0x00, 0
 static constexpr uint8_t poweroffPacket[]{0x00, 0x00, 0x08, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 static constexpr uint8_t initDriverPacket[]{0x00, 0x00, 0x02, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
+// The receiver also sends acks and link reports: Only the connection status and the controller data are parsed
+static constexpr ControllerReportRule reportRules[]{
+    {1, {0x08}, {0x08}, ControllerReportKind_Status},                                  // Connect/Disconnect
+    {4, {0xff, 0xff, 0xff, 0xff}, {0x00, 0x01, 0x00, 0xf0}, ControllerReportKind_Input}, // Controller Data
+};
+
 Xbox360WirelessController::Xbox360WirelessController(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger)
     : BaseController(std::move(device), config, std::move(logger))
 {
     for (int i = 0; i < XBOX360_MAX_INPUTS; i++)
         m_is_connected[i] = false;
+
+    SetReportRules(reportRules, sizeof(reportRules) / sizeof(reportRules[0]), ControllerReportKind_Ignore);
 }
 
 Xbox360WirelessController::~Xbox360WirelessController()
@@ -121,7 +129,7 @@ ControllerResult Xbox360WirelessController::SetRumble(uint16_t input_idx, float
     if (m_outPipe.size() <= input_idx)
         return CONTROLLER_STATUS_INVALID_INDEX;
 
-    return m_outPipe[input_idx]->Write(rumbleData, sizeof(rumbleData));
+    return WriteRumble(m_outPipe[input_idx], rumbleData, sizeof(rumbleData));
 }
 
 bool Xbox360WirelessController::IsControllerConnected(uint16_t input_idx)
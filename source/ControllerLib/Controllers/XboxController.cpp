@@ -59,5 +59,5 @@ ControllerResult XboxController::SetRumble(uint16_t input_idx, float amp_high, f
     if (m_outPipe.size() <= input_idx)
         return CONTROLLER_STATUS_INVALID_INDEX;
 
-    return m_outPipe[input_idx]->Write(rumbleData, sizeof(rumbleData));
+    return WriteRumble(m_outPipe[input_idx], rumbleData, sizeof(rumbleData));
 }
@@ -150,9 +150,16 @@ static const struct xboxone_init_packet xboxone_init_packets[] = {
 };
 */
 
+// Announce, status and acks of the controller are dropped before parsing
+static const ControllerReportRule xboxone_report_rules[] = {
+    {1, {0xff}, {GIP_CMD_INPUT}, ControllerReportKind_Input},
+    {1, {0xff}, {GIP_CMD_VIRTUAL_KEY}, ControllerReportKind_Input},
+};
+
 XboxOneController::XboxOneController(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger)
     : BaseController(std::move(device), std::move(config), std::move(logger))
 {
+    SetReportRules(xboxone_report_rules, sizeof(xboxone_report_rules) / sizeof(xboxone_report_rules[0]), ControllerReportKind_Ignore);
 }
 
 XboxOneController::~XboxOneController()
@@ -172,11 +179,21 @@ ControllerResult XboxOneController::Initialize()
     return CONTROLLER_STATUS_SUCCESS;
 }
 
+void XboxOneController::InvalidateInputStates()
+{
+    for (RawInputState &state : m_rawInput)
+        state.dirty = true;
+}
+
 ControllerResult XboxOneController::ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx)
 {
-    (void)input_idx;
     XboxOneButtonData *buttonData = reinterpret_cast<XboxOneButtonData *>(buffer);
 
+    if (*input_idx >= CONTROLLER_MAX_INPUTS)
+        return CONTROLLER_STATUS_INVALID_INDEX;
+
+    RawInputState &state = m_rawInput[*input_idx];
+
     if (buttonData->type == GIP_CMD_INPUT) // Button data
     {
         if (size < sizeof(XboxOneButtonData))
@@ -185,34 +202,33 @@ ControllerResult XboxOneController::ParseData(uint8_t *buffer, size_t size, RawI
             return CONTROLLER_STATUS_UNEXPECTED_DATA;
         }
 
-        m_rawInput.buttons[1] = buttonData->button1;
-        m_rawInput.buttons[2] = buttonData->button2;
-        m_rawInput.buttons[3] = buttonData->button3;
-        m_rawInput.buttons[4] = buttonData->button4;
-        m_rawInput.buttons[5] = buttonData->button5;
-        m_rawInput.buttons[6] = buttonData->button6;
-        m_rawInput.buttons[7] = buttonData->button7;
-        m_rawInput.buttons[8] = buttonData->button8;
-        m_rawInput.buttons[9] = buttonData->button9;
-        m_rawInput.buttons[10] = buttonData->button10;
-        m_rawInput.buttons[11] = buttonData->button11;
-
-        m_rawInput.analog[ControllerAnalogType_Rx] = BaseController::Normalize(buttonData->trigger_left, 0, 1023);
-        m_rawInput.analog[ControllerAnalogType_Ry] = BaseController::Normalize(buttonData->trigger_right, 0, 1023);
-
-        m_rawInput.analog[ControllerAnalogType_X] = BaseController::Normalize(buttonData->stick_left_x, -32768, 32767);
-        m_rawInput.analog[ControllerAnalogType_Y] = BaseController::Normalize(-buttonData->stick_left_y, -32768, 32767);
-        m_rawInput.analog[ControllerAnalogType_Z] = BaseController::Normalize(buttonData->stick_right_x, -32768, 32767);
-        m_rawInput.analog[ControllerAnalogType_Rz] = BaseController::Normalize(-buttonData->stick_right_y, -32768, 32767);
-
-        m_rawInput.buttons[DPAD_UP_BUTTON_ID] = buttonData->dpad_up;
-        m_rawInput.buttons[DPAD_RIGHT_BUTTON_ID] = buttonData->dpad_right;
-        m_rawInput.buttons[DPAD_DOWN_BUTTON_ID] = buttonData->dpad_down;
-        m_rawInput.buttons[DPAD_LEFT_BUTTON_ID] = buttonData->dpad_left;
-
-        *rawData = m_rawInput;
-
-        return CONTROLLER_STATUS_SUCCESS;
+        state.SetButton(1, buttonData->button1);
+        state.SetButton(2, buttonData->button2);
+        state.SetButton(3, buttonData->button3);
+        state.SetButton(4, buttonData->button4);
+        state.SetButton(5, buttonData->button5);
+        state.SetButton(6, buttonData->button6);
+        state.SetButton(7, buttonData->button7);
+        state.SetButton(8, buttonData->button8);
+        state.SetButton(9, buttonData->button9);
+        state.SetButton(10, buttonData->button10);
+        state.SetButton(11, buttonData->button11);
+
+        state.SetAnalog(ControllerAnalogType_Rx, BaseController::Normalize(buttonData->trigger_left, 0, 1023));
+        state.SetAnalog(ControllerAnalogType_Ry, BaseController::Normalize(buttonData->trigger_right, 0, 1023));
+
+        state.SetAnalog(ControllerAnalogType_X, BaseController::Normalize(buttonData->stick_left_x, -32768, 32767));
+        state.SetAnalog(ControllerAnalogType_Y, BaseController::Normalize(-buttonData->stick_left_y, -32768, 32767));
+        state.SetAnalog(ControllerAnalogType_Z, BaseController::Normalize(buttonData->stick_right_x, -32768, 32767));
+        state.SetAnalog(ControllerAnalogType_Rz, BaseController::Normalize(-buttonData->stick_right_y, -32768, 32767));
+
+        state.SetButton(DPAD_UP_BUTTON_ID, buttonData->dpad_up);
+        state.SetButton(DPAD_RIGHT_BUTTON_ID, buttonData->dpad_right);
+        state.SetButton(DPAD_DOWN_BUTTON_ID, buttonData->dpad_down);
+        state.SetButton(DPAD_LEFT_BUTTON_ID, buttonData->dpad_left);
+
+        // Same state as the previous report: Nothing to submit
+        return state.HandOff(rawData) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_NOTHING_TODO;
     }
     else if (buttonData->type == GIP_CMD_VIRTUAL_KEY) // Mode button (XBOX center button)
     {
@@ -222,7 +238,7 @@ ControllerResult XboxOneController::ParseData(uint8_t *buffer, size_t size, RawI
             return CONTROLLER_STATUS_UNEXPECTED_DATA;
         }
 
-        m_rawInput.buttons[12] = buffer[4];
+        state.SetButton(12, buffer[4]);
 
         if (buffer[1] == (GIP_OPT_ACK | GIP_OPT_INTERNAL))
         {
@@ -231,9 +247,7 @@ ControllerResult XboxOneController::ParseData(uint8_t *buffer, size_t size, RawI
                 return result;
         }
 
-        *rawData = m_rawInput;
-
-        return CONTROLLER_STATUS_SUCCESS;
+        return state.HandOff(rawData) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_NOTHING_TODO;
     }
 
     return CONTROLLER_STATUS_NOTHING_TODO;
@@ -312,5 +326,5 @@ ControllerResult XboxOneController::SetRumble(uint16_t input_idx, float amp_high
     if (m_outPipe.size() <= input_idx)
         return CONTROLLER_STATUS_INVALID_INDEX;
 
-    return m_outPipe[input_idx]->Write(rumble_data, sizeof(rumble_data));
+    return WriteRumble(m_outPipe[input_idx], rumble_data, sizeof(rumble_data));
 }
\ No newline at end of file
@@ -43,10 +43,12 @@ _PACKED(struct XboxOneButtonData {
 class XboxOneController : public BaseController
 {
 private:
-    RawInputData m_rawInput;
+    RawInputState m_rawInput[CONTROLLER_MAX_INPUTS]; // By input (Endpoint)
     ControllerResult SendInitBytes(uint16_t input_idx);
     ControllerResult WriteAckModeReport(uint16_t input_idx, uint8_t sequence);
 
+    void InvalidateInputStates() override;
+
 public:
     XboxOneController(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger);
     virtual ~XboxOneController() override;
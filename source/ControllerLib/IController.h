@@ -4,6 +4,13 @@
 #include "ControllerTypes.h"
 #include "ControllerConfig.h"
 #include "ControllerResult.h"
+#include "ControllerMetrics.h"
+#include "ReportRecorder.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 struct NormalizedStick
 {
@@ -17,18 +24,69 @@ struct NormalizedButtonData
     NormalizedStick sticks[2];
 };
 
+// Inputs decoded from a single transfer, see IController::ReadInputs
+struct ControllerInputBatch
+{
+    uint16_t count;
+    uint16_t input_idx[CONTROLLER_MAX_INPUTS];
+    ControllerResult result[CONTROLLER_MAX_INPUTS]; // Same meaning as the result of ReadInput, for each input
+    NormalizedButtonData data[CONTROLLER_MAX_INPUTS];
+    std::chrono::steady_clock::time_point read_time; // End of the USB read of the transfer (Start of the read-to-submit latency)
+};
+
+/*
+    Results of an initialization that stay valid as long as the device is the same (e.g. its parsed HID report descriptor)
+    The sysmodule keeps them across a sleep: the controller initialized after the wake up skips the handshakes that produced them.
+    A driver with such results subclasses it, the data is only given back to the driver that produced it for the same VID/PID.
+    Only GenericHIDController has some: The other drivers (e.g. XboxOne, Switch) only send handshakes the device forgets.
+*/
+class ControllerResumeData
+{
+public:
+    virtual ~ControllerResumeData() = default;
+};
+
 class IController
 {
 protected:
     std::unique_ptr<IUSBDevice> m_device;
-    ControllerConfig m_config;
+    std::atomic<const ControllerConfig *> m_config; // Current (immutable) config snapshot
     std::unique_ptr<ILogger> m_logger;
+    ControllerMetrics m_metrics;
+    std::unique_ptr<IReportRecorder> m_recorder; // Optional, see ReportRecorder.h
+    std::shared_ptr<const ControllerResumeData> m_resumeData; // Optional, see SetResumeData
+
+    /*
+        Quiescent state of the input thread (Called between 2 input cycles, see ReadInputs): From there, it doesn't use the
+        config snapshots loaded before, it will load the current one. The snapshots replaced before this point can be freed.
+    */
+    void EnterConfigQuiescentState() { m_configReaderEpoch.store(m_configEpoch.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Incremented by each SetConfig replacing a snapshot
+    uint64_t GetConfigEpoch() const { return m_configEpoch.load(std::memory_order_acquire); }
+
+private:
+    /*
+        Snapshots replaced by SetConfig (epoch: m_configEpoch once replaced) are kept until the input thread goes through
+        its quiescent state, it might still be using them. They are freed by the next SetConfig, only a few are alive.
+    */
+    struct RetiredConfig
+    {
+        std::unique_ptr<const ControllerConfig> config;
+        uint64_t epoch;
+    };
+
+    std::unique_ptr<const ControllerConfig> m_currentConfig;
+    std::vector<RetiredConfig> m_retiredConfigs;
+    std::atomic<uint64_t> m_configEpoch{0};
+    std::atomic<uint64_t> m_configReaderEpoch{0};
 
 public:
     IController(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger) : m_device(std::move(device)),
-                                                                                                                           m_config(config),
+                                                                                                                           m_config(nullptr),
                                                                                                                            m_logger(std::move(logger))
     {
+        SetConfig(config);
     }
     virtual ~IController() = default;
 
@@ -38,6 +96,23 @@ public:
     virtual uint16_t GetInputCount() = 0;
     virtual ControllerResult ReadInput(NormalizedButtonData *normalData, uint16_t *input_idx, uint32_t timeout_us) = 0;
 
+    /*
+        Read all the inputs decoded from the next transfer (e.g. the 4 ports of the Wii U adapter), at least one entry
+        is returned, with the result of its ReadInput. The returned value is the result of the transfer itself.
+        Default: A single ReadInput, drivers decoding one input per report don't need anything else.
+    */
+    virtual ControllerResult ReadInputs(ControllerInputBatch *inputs, uint32_t timeout_us)
+    {
+        EnterConfigQuiescentState();
+
+        inputs->count = 1;
+        inputs->input_idx[0] = 0;
+        inputs->data[0] = {};
+        inputs->result[0] = ReadInput(&inputs->data[0], &inputs->input_idx[0], timeout_us);
+        inputs->read_time = std::chrono::steady_clock::now(); // The driver doesn't say when its read completed
+        return inputs->result[0];
+    }
+
     virtual bool Support(ControllerFeature aFeature) = 0;
 
     virtual ControllerResult SetRumble(uint16_t input_idx, float amp_high, float amp_low) = 0;
@@ -48,7 +123,48 @@ public:
         return true;
     }
 
-    inline const ControllerConfig &GetConfig() const { return m_config; }
+    /*
+        Lock free. The input thread can use the returned reference until its next ReadInputs,
+        other threads must not call it concurrently with SetConfig (The sysmodule serializes them).
+    */
+    inline const ControllerConfig &GetConfig() const { return *m_config.load(std::memory_order_acquire); }
+
+    /*
+        Publish a new config snapshot (e.g. config.ini modified)
+        Not thread safe against another SetConfig, there must be a single writer.
+        Only settings used while reading inputs (mapping, deadzones, factors, combos) are applied live,
+        driver, packet sizes, controller type and colors are used during the initialization only.
+    */
+    void SetConfig(const ControllerConfig &config)
+    {
+        std::unique_ptr<const ControllerConfig> snapshot = std::make_unique<const ControllerConfig>(config);
+        m_config.store(snapshot.get(), std::memory_order_release);
+
+        if (m_currentConfig)
+            m_retiredConfigs.push_back({std::move(m_currentConfig), m_configEpoch.fetch_add(1, std::memory_order_acq_rel) + 1});
+        m_currentConfig = std::move(snapshot);
+
+        // Free the snapshots the input thread can't be using anymore
+        uint64_t readerEpoch = m_configReaderEpoch.load(std::memory_order_acquire);
+        m_retiredConfigs.erase(std::remove_if(m_retiredConfigs.begin(), m_retiredConfigs.end(), [readerEpoch](const RetiredConfig &retired) { return retired.epoch <= readerEpoch; }),
+                               m_retiredConfigs.end());
+    }
+
+    // Replaced snapshots not freed yet (Waiting for the input thread)
+    inline size_t GetRetiredConfigCount() const { return m_retiredConfigs.size(); }
 
     inline IUSBDevice *GetDevice() { return m_device.get(); }
+    inline ILogger *GetLogger() { return m_logger.get(); }
+
+    // Record every report read (Debug): Must be set before Initialize(), the recorder is then used by the input thread only
+    void SetReportRecorder(std::unique_ptr<IReportRecorder> &&recorder) { m_recorder = std::move(recorder); }
+
+    // Immutable results of the initialization to keep across a sleep (nullptr: Nothing to keep)
+    virtual std::shared_ptr<const ControllerResumeData> GetResumeData() { return nullptr; }
+
+    // Must be set before Initialize(), 'data' was returned by GetResumeData of the same driver for the same VID/PID
+    void SetResumeData(std::shared_ptr<const ControllerResumeData> data) { m_resumeData = std::move(data); }
+
+    // Lock free, also updated by the switch handler (IPC submissions, latency)
+    inline ControllerMetrics &GetMetrics() { return m_metrics; }
 };
\ No newline at end of file
@@ -11,6 +11,28 @@ typedef enum LogLevel
     LogLevelError
 } LogLevel;
 
+/*
+    Same gate as the sysmodule logger (logger.h): Logs below SYSCON_LOG_MIN_LEVEL are removed at compile time (e.g. make LOG_MIN_LEVEL=3),
+    above it IsEnabled is checked before evaluating the arguments. Use the macros on the input path (Called for every report).
+*/
+#ifndef SYSCON_LOG_MIN_LEVEL
+    #define SYSCON_LOG_MIN_LEVEL 0
+#endif
+
+#define CONTROLLER_LOG_IF(logger, lvl, call)         \
+    do                                               \
+    {                                                \
+        if constexpr ((lvl) >= SYSCON_LOG_MIN_LEVEL) \
+        {                                            \
+            if ((logger)->IsEnabled(lvl))            \
+                (logger)->call;                      \
+        }                                            \
+    } while (0)
+
+#define CONTROLLER_LOG_TRACE(logger, ...) CONTROLLER_LOG_IF(logger, LogLevelTrace, Log(LogLevelTrace, __VA_ARGS__))
+#define CONTROLLER_LOG_DEBUG(logger, ...) CONTROLLER_LOG_IF(logger, LogLevelDebug, Log(LogLevelDebug, __VA_ARGS__))
+#define CONTROLLER_LOG_PERF(logger, ...)  CONTROLLER_LOG_IF(logger, LogLevelPerf, Log(LogLevelPerf, __VA_ARGS__))
+
 class ILogger
 {
 public:
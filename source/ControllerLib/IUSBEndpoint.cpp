@@ -0,0 +1,33 @@
+#include "IUSBEndpoint.h"
+#include "ControllerTypes.h"
+#include <algorithm>
+
+ControllerResult IUSBEndpoint::AcquireRead(ReadBuffer *buffer, size_t maxSize, uint64_t aTimeoutUs)
+{
+    if (!m_readBuffers)
+        m_readBuffers = std::make_unique<uint8_t[]>(USB_ENDPOINT_READ_BUFFERS * CONTROLLER_INPUT_BUFFER_SIZE);
+
+    uint8_t slot = 0;
+    while (slot < USB_ENDPOINT_READ_BUFFERS && m_readAcquired[slot])
+        slot++;
+
+    if (slot == USB_ENDPOINT_READ_BUFFERS)
+        return CONTROLLER_STATUS_OUT_OF_MEMORY; // All the buffers are lent
+
+    buffer->data = &m_readBuffers[slot * CONTROLLER_INPUT_BUFFER_SIZE];
+    buffer->size = std::min<size_t>(maxSize, CONTROLLER_INPUT_BUFFER_SIZE);
+    buffer->slot = slot;
+
+    ControllerResult result = Read(buffer->data, &buffer->size, aTimeoutUs);
+    if (result != CONTROLLER_STATUS_SUCCESS)
+        return result;
+
+    m_readAcquired[slot] = true;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+void IUSBEndpoint::ReleaseRead(const ReadBuffer &buffer)
+{
+    if (buffer.slot < USB_ENDPOINT_READ_BUFFERS)
+        m_readAcquired[buffer.slot] = false;
+}
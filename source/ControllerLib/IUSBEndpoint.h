@@ -2,6 +2,9 @@
 #include "ControllerResult.h"
 #include <cstdint>
 #include <cstddef>
+#include <memory>
+
+#define USB_ENDPOINT_READ_BUFFERS 2 // Transfer buffers an endpoint can lend at once (Latest report + the one drained after it)
 
 class IUSBEndpoint
 {
@@ -22,6 +25,14 @@ public:
         uint8_t bInterval;
     };
 
+    // Completed transfer lent by AcquireRead
+    struct ReadBuffer
+    {
+        uint8_t *data = nullptr;
+        size_t size = 0;
+        uint8_t slot = 0; // Private to the endpoint
+    };
+
     virtual ~IUSBEndpoint() = default;
 
     // Open and close the endpoint. if maxPacketSize is not set, it uses wMaxPacketSize from the descriptor.
@@ -34,8 +45,21 @@ public:
     // This will read from the endpoint and put the data in the outBuffer pointer for the specified size.
     virtual ControllerResult Read(uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) = 0;
 
+    /*
+     Zero-copy read: 'buffer' receives the transfer buffer of the next report (Up to maxSize bytes). It is not
+     touched by the endpoint until it is given back with ReleaseRead, up to USB_ENDPOINT_READ_BUFFERS can be held.
+     The default implementation goes through Read, in buffers owned by the endpoint (One copy, up to CONTROLLER_INPUT_BUFFER_SIZE bytes).
+    */
+    virtual ControllerResult AcquireRead(ReadBuffer *buffer, size_t maxSize, uint64_t aTimeoutUs);
+    virtual void ReleaseRead(const ReadBuffer &buffer);
+
     // Get endpoint's direction. (IN or OUT)
     virtual IUSBEndpoint::Direction GetDirection() = 0;
     // Get the endpoint descriptor
     virtual EndpointDescriptor *GetDescriptor() = 0;
+
+private:
+    // Default AcquireRead: USB_ENDPOINT_READ_BUFFERS buffers of CONTROLLER_INPUT_BUFFER_SIZE bytes, allocated on the first read
+    std::unique_ptr<uint8_t[]> m_readBuffers;
+    bool m_readAcquired[USB_ENDPOINT_READ_BUFFERS] = {};
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include "IUSBInterface.h"
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Report recorder (.rec files)
+ *
+ * When enabled, BaseController::ReadEndpointLatest gives every USB transfer read on the IN endpoints to the recorder:
+ * raw transfers (Before a driver splits them into inputs, e.g. the 4 ports of the Wii U adapter), the ones drained
+ * behind the latest included. Read errors are recorded too (without data), timeouts are not.
+ * The file is replayed on a computer with ReplayCapture.
+ *
+ * The file starts with a ReportRecordFileHeader, followed by 'interface_count' ReportRecordInterface, each one followed
+ * by its 'endpoint_count' ReportRecordEndpoint (IN endpoints first, then OUT endpoints, in the order of their index).
+ * Then comes a sequence of ReportRecordHeader, each one followed by 'size' bytes of report.
+ * Control transfers and writes are not recorded.
+ *
+ * This header has no dependency on the sysmodule, it is shared with ControllerReplay.
+ */
+
+#define REPORT_RECORD_MAGIC   0x43455253 // "SREC"
+#define REPORT_RECORD_VERSION 2 // 1: Reports after the driver split them, with the result of their parsing
+
+#define REPORT_RECORD_ENDPOINT_UNKNOWN 0xFF // Endpoint index too high to be recorded
+
+struct ReportRecordFileHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t interface_count;
+    uint16_t vendor_id;
+    uint16_t product_id;
+};
+
+struct ReportRecordInterface
+{
+    uint8_t number;
+    uint8_t interface_class;
+    uint8_t interface_subclass;
+    uint8_t interface_protocol;
+    uint8_t endpoint_count;
+    uint8_t reserved[3];
+};
+
+struct ReportRecordEndpoint
+{
+    uint8_t address;
+    uint8_t interval;
+    uint16_t max_packet_size;
+};
+
+struct ReportRecordHeader
+{
+    uint32_t delta_us; // Since the previous record (Monotonic clock, saturated at ~71 minutes)
+    uint16_t size;
+    uint8_t endpoint; // Index of the IN endpoint, all interfaces included (BaseController::m_inPipe)
+    uint8_t result;   // ControllerResult of the read
+};
+
+class IReportRecorder
+{
+public:
+    virtual ~IReportRecorder() = default;
+
+    // Called with the opened interfaces, before the first report
+    virtual void Begin(uint16_t vendor_id, uint16_t product_id, IUSBInterface *const *interfaces, size_t interfaceCount) = 0;
+
+    // Called by the input thread for every transfer: Must never block
+    virtual void Record(uint8_t endpoint, ControllerResult result, const uint8_t *buffer, size_t size) = 0;
+};
@@ -0,0 +1,185 @@
+#include "VirtualGamepadHandler.h"
+#include <chrono>
+
+namespace
+{
+    int64_t ElapsedUs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+VirtualGamepadHandler::VirtualGamepadHandler(std::unique_ptr<IController> &&controller, int32_t polling_timeout_ms)
+    : m_controller(std::move(controller)),
+      m_polling_timeout_ms(polling_timeout_ms)
+{
+}
+
+uint32_t VirtualGamepadHandler::GetPollingTimeoutUs()
+{
+    return (m_polling_timeout_ms * 1000) / m_controller->GetDevice()->GetInterfaces().size();
+}
+
+ControllerResult VirtualGamepadHandler::RunCycle(uint32_t timeout_us)
+{
+    auto startTimer = std::chrono::steady_clock::now();
+
+    ControllerResult rc = UpdateInput(timeout_us);
+    (void)UpdateOutput();
+
+    int64_t execution_time_us = ElapsedUs(startTimer);
+    if ((rc != CONTROLLER_STATUS_TIMEOUT) && (execution_time_us > VIRTUAL_GAMEPAD_SLOW_CYCLE_US))
+        m_controller->GetLogger()->Log(LogLevelWarning, "VirtualGamepadHandler[%04x-%04x] UpdateInputOutput took: %d ms !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), (int)(execution_time_us / 1000));
+
+    return rc;
+}
+
+bool VirtualGamepadHandler::NeedsBackOff(ControllerResult rc)
+{
+    return rc != CONTROLLER_STATUS_SUCCESS && rc != CONTROLLER_STATUS_TIMEOUT && rc != CONTROLLER_STATUS_NOTHING_TODO;
+}
+
+ControllerResult VirtualGamepadHandler::UpdateInput(uint32_t timeout_us)
+{
+    bool submitted = false;
+    return SubmitInputs(ReadInputs(timeout_us), &submitted);
+}
+
+ControllerResult VirtualGamepadHandler::UpdateOutput()
+{
+    // Vibrations are not supported
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult VirtualGamepadHandler::ReadInputs(uint32_t timeout_us)
+{
+    return m_controller->ReadInputs(&m_inputs, timeout_us);
+}
+
+ControllerResult VirtualGamepadHandler::SubmitInputs(ControllerResult read_rc, bool *submitted)
+{
+    // All the inputs of the transfer are submitted in the same pass (e.g. 4 ports of the Wii U adapter)
+    ControllerResult rc = read_rc;
+    *submitted = false;
+
+    for (uint16_t i = 0; i < m_inputs.count; i++)
+    {
+        ControllerResult input_rc = UpdateInputState(m_inputs.input_idx[i], m_inputs.result[i], m_inputs.data[i], submitted);
+
+        // Keep the most relevant result for the caller: A failure, unless it's just "no data"
+        if (i == 0 || (input_rc != CONTROLLER_STATUS_SUCCESS && !NeedsBackOff(rc)))
+            rc = input_rc;
+    }
+
+    // Once per transfer, from the end of its USB read
+    if (*submitted)
+        m_controller->GetMetrics().Record(ControllerHistogram_ReadToSubmitUs, ElapsedUs(m_inputs.read_time));
+
+    return rc;
+}
+
+ControllerResult VirtualGamepadHandler::UpdateInputState(uint16_t input_idx, ControllerResult read_rc, const NormalizedButtonData &buttonData, bool *submitted)
+{
+    ILogger *logger = m_controller->GetLogger();
+
+    /*
+        Note: We must not return here if readInput fail, because it might have change the ControllerConnected state.
+        So, we must check if the controller is connected and detach it if it's not.
+        This case happen with wireless Xbox 360 controllers
+    */
+
+    if (m_is_connected[input_idx] != m_controller->IsControllerConnected(input_idx)) // State changed ?
+    {
+        logger->Log(LogLevelDebug, "VirtualGamepadHandler[%04x-%04x] Controller connection state changed on idx: %d !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
+
+        m_is_connected[input_idx] = m_controller->IsControllerConnected(input_idx);
+        if (m_is_connected[input_idx])
+        {
+            // If state change to connected, we need to re-attach the controller ASAP
+            m_reattach_controller[input_idx] = true;
+        }
+        else
+        {
+            logger->Log(LogLevelDebug, "VirtualGamepadHandler[%04x-%04x] Detaching controller on idx: %d !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
+            DetachController(input_idx);
+        }
+    }
+
+    if (m_is_connected[input_idx] == false)
+        return read_rc; // No need to update the controller state if it's not connected
+
+    if (read_rc != CONTROLLER_STATUS_SUCCESS)
+        return read_rc;
+
+    auto startTimer = std::chrono::steady_clock::now();
+
+    uint64_t buttons = ConvertButtons(buttonData);
+    VirtualGamepadStick stick_l;
+    VirtualGamepadStick stick_r;
+    ConvertAxisToSwitchAxis(buttonData.sticks[0].axis_x, buttonData.sticks[0].axis_y, &stick_l.x, &stick_l.y);
+    ConvertAxisToSwitchAxis(buttonData.sticks[1].axis_x, buttonData.sticks[1].axis_y, &stick_r.x, &stick_r.y);
+
+    if (!IsControllerAttached(input_idx) && !m_reattach_controller[input_idx])
+        m_reattach_controller[input_idx] = (buttons & VirtualGamepadButton_L) && (buttons & VirtualGamepadButton_R); // L+R on the switch allow to re-attach the controller
+
+    if (m_reattach_controller[input_idx])
+    {
+        logger->Log(LogLevelDebug, "VirtualGamepadHandler[%04x-%04x] Re-attaching controller on idx: %d !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
+        AttachController(input_idx);
+        m_reattach_controller[input_idx] = false;
+    }
+
+    // We get the button inputs from the input packet and update the state of our controller
+    ControllerResult rc = UpdateControllerState(buttons, stick_l, stick_r, input_idx);
+    *submitted = true;
+
+    CONTROLLER_LOG_PERF(logger, "VirtualGamepadHandler[%04x-%04x] UpdateInput took: %d us for idx: %d !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), (int)ElapsedUs(startTimer), input_idx);
+
+    return rc;
+}
+
+uint64_t VirtualGamepadHandler::ConvertButtons(const NormalizedButtonData &buttonData)
+{
+    static const struct
+    {
+        ControllerButton button;
+        uint64_t npadButton;
+    } buttonList[] = {
+        {ControllerButton::X, VirtualGamepadButton_X},
+        {ControllerButton::A, VirtualGamepadButton_A},
+        {ControllerButton::B, VirtualGamepadButton_B},
+        {ControllerButton::Y, VirtualGamepadButton_Y},
+        {ControllerButton::LSTICK_CLICK, VirtualGamepadButton_StickL},
+        {ControllerButton::RSTICK_CLICK, VirtualGamepadButton_StickR},
+        {ControllerButton::L, VirtualGamepadButton_L},
+        {ControllerButton::R, VirtualGamepadButton_R},
+        {ControllerButton::ZL, VirtualGamepadButton_ZL},
+        {ControllerButton::ZR, VirtualGamepadButton_ZR},
+        {ControllerButton::MINUS, VirtualGamepadButton_Minus},
+        {ControllerButton::PLUS, VirtualGamepadButton_Plus},
+        {ControllerButton::DPAD_UP, VirtualGamepadButton_Up},
+        {ControllerButton::DPAD_RIGHT, VirtualGamepadButton_Right},
+        {ControllerButton::DPAD_DOWN, VirtualGamepadButton_Down},
+        {ControllerButton::DPAD_LEFT, VirtualGamepadButton_Left},
+        {ControllerButton::CAPTURE, VirtualGamepadButton_Capture},
+        {ControllerButton::HOME, VirtualGamepadButton_Home},
+    };
+
+    uint64_t buttons = 0;
+    for (const auto &entry : buttonList)
+    {
+        if (buttonData.buttons[entry.button])
+            buttons |= entry.npadButton;
+    }
+
+    return buttons;
+}
+
+void VirtualGamepadHandler::ConvertAxisToSwitchAxis(float x, float y, int32_t *x_out, int32_t *y_out)
+{
+    float floatRange = 2.0f;
+    float newRange = (VIRTUAL_GAMEPAD_JOYSTICK_MAX - VIRTUAL_GAMEPAD_JOYSTICK_MIN);
+
+    *x_out = (((x + 1.0f) * newRange) / floatRange) + VIRTUAL_GAMEPAD_JOYSTICK_MIN;
+    *y_out = -((((y + 1.0f) * newRange) / floatRange) + VIRTUAL_GAMEPAD_JOYSTICK_MIN);
+}
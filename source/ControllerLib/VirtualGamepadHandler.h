@@ -0,0 +1,99 @@
+#pragma once
+#include "IController.h"
+
+/*
+ * Input loop of a controller, shared by the console (SwitchVirtualGamepadHandler) and the simulator (SysConSim)
+ *
+ * Reads all the inputs of a transfer, tracks the connection of each input (Detached when disconnected, re-attached
+ * when connected again or on L+R) and converts the normalized state to the HID state of the console.
+ * The platform runs the loop in its thread and implements the attachment and the submission of the HID state.
+ */
+
+// HidNpadButton_xxx and HiddbgNpadButton_xxx bits of libnx
+enum VirtualGamepadButton : uint64_t
+{
+    VirtualGamepadButton_A = 1ULL << 0,
+    VirtualGamepadButton_B = 1ULL << 1,
+    VirtualGamepadButton_X = 1ULL << 2,
+    VirtualGamepadButton_Y = 1ULL << 3,
+    VirtualGamepadButton_StickL = 1ULL << 4,
+    VirtualGamepadButton_StickR = 1ULL << 5,
+    VirtualGamepadButton_L = 1ULL << 6,
+    VirtualGamepadButton_R = 1ULL << 7,
+    VirtualGamepadButton_ZL = 1ULL << 8,
+    VirtualGamepadButton_ZR = 1ULL << 9,
+    VirtualGamepadButton_Plus = 1ULL << 10,
+    VirtualGamepadButton_Minus = 1ULL << 11,
+    VirtualGamepadButton_Left = 1ULL << 12,
+    VirtualGamepadButton_Up = 1ULL << 13,
+    VirtualGamepadButton_Right = 1ULL << 14,
+    VirtualGamepadButton_Down = 1ULL << 15,
+    VirtualGamepadButton_Home = 1ULL << 18,
+    VirtualGamepadButton_Capture = 1ULL << 19,
+};
+
+// JOYSTICK_MIN and JOYSTICK_MAX of libnx
+#define VIRTUAL_GAMEPAD_JOYSTICK_MIN -32767
+#define VIRTUAL_GAMEPAD_JOYSTICK_MAX 32767
+
+#define VIRTUAL_GAMEPAD_SLOW_CYCLE_US 30000 // A cycle of the loop longer than this is logged
+
+// HidAnalogStickState of libnx
+struct VirtualGamepadStick
+{
+    int32_t x;
+    int32_t y;
+};
+
+class VirtualGamepadHandler
+{
+protected:
+    std::unique_ptr<IController> m_controller;
+    int32_t m_polling_timeout_ms;
+
+    bool m_is_connected[CONTROLLER_MAX_INPUTS] = {};
+    bool m_reattach_controller[CONTROLLER_MAX_INPUTS] = {};
+    ControllerInputBatch m_inputs; // Not on the stack: The input thread stack is small on the console
+
+    virtual bool IsControllerAttached(uint16_t input_idx) = 0;
+    virtual ControllerResult AttachController(uint16_t input_idx) = 0;
+    virtual ControllerResult DetachController(uint16_t input_idx) = 0;
+    // Submit the HID state of an attached input
+    virtual ControllerResult UpdateControllerState(uint64_t buttons, const VirtualGamepadStick &stick_l, const VirtualGamepadStick &stick_r, uint16_t input_idx) = 0;
+
+    /*
+     Read timeout depends on the polling frequency and number of interfaces
+      - On XBOX360 controllers, we have 4 interfaces, so the read timeout is divided by 4 to make sure we read all interfaces in time.
+      - On most of other controllers, we have 1 interface, so the read timeout is equal to the polling frequency but
+        it don't have a big impact on the performance - It's even better to set a bigger timeout to avoid the thread to be too busy.
+    */
+    uint32_t GetPollingTimeoutUs();
+
+    // One iteration of the input thread (UpdateInput then UpdateOutput), returns the result of UpdateInput
+    ControllerResult RunCycle(uint32_t timeout_us);
+
+    // The controller is likely disconnected: The thread must sleep before the next cycle
+    static bool NeedsBackOff(ControllerResult rc);
+
+    // Read all the inputs of the next transfer into m_inputs
+    ControllerResult ReadInputs(uint32_t timeout_us);
+    // Update the HID state of the inputs read by ReadInputs, returns the most relevant result (*submitted: A state was sent)
+    ControllerResult SubmitInputs(ControllerResult read_rc, bool *submitted);
+    // Update the HID state of one input from the result of its read, *submitted is set if the state was sent
+    ControllerResult UpdateInputState(uint16_t input_idx, ControllerResult read_rc, const NormalizedButtonData &buttonData, bool *submitted);
+
+public:
+    VirtualGamepadHandler(std::unique_ptr<IController> &&controller, int32_t polling_timeout_ms);
+    virtual ~VirtualGamepadHandler() = default;
+
+    // The function to call indefinitely by the input thread
+    virtual ControllerResult UpdateInput(uint32_t timeout_us);
+    // The function to call indefinitely by the output thread
+    virtual ControllerResult UpdateOutput();
+
+    static uint64_t ConvertButtons(const NormalizedButtonData &buttonData);
+    static void ConvertAxisToSwitchAxis(float x, float y, int32_t *x_out, int32_t *y_out);
+
+    // Get the raw controller pointer
+    inline IController *GetController() { return m_controller.get(); }
+};
@@ -0,0 +1,816 @@
+#include "ReplayCapture.h"
+#include "ReportRecorder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+
+#define PCAP_MAGIC_US      0xA1B2C3D4
+#define PCAP_MAGIC_NS      0xA1B23C4D
+#define PCAPNG_MAGIC       0x0A0D0D0A
+#define PCAPNG_BYTE_ORDER  0x1A2B3C4D
+#define PCAPNG_BLOCK_IDB   0x00000001
+#define PCAPNG_BLOCK_EPB   0x00000006
+#define PCAPNG_OPTION_TSRESOL 9
+
+#define LINKTYPE_USB_LINUX         189 // usbmon, 48 bytes header
+#define LINKTYPE_USB_LINUX_MMAPPED 220 // usbmon, 64 bytes header
+#define LINKTYPE_USBPCAP           249
+
+#define USB_TRANSFER_ISOCHRONOUS 0
+#define USB_TRANSFER_INTERRUPT   1
+#define USB_TRANSFER_CONTROL     2
+#define USB_TRANSFER_BULK        3
+
+#define USB_DESCRIPTOR_DEVICE        0x01
+#define USB_DESCRIPTOR_CONFIGURATION 0x02
+#define USB_DESCRIPTOR_INTERFACE     0x04
+#define USB_DESCRIPTOR_ENDPOINT      0x05
+#define USB_REQUEST_GET_DESCRIPTOR   0x06
+
+namespace
+{
+    class PcapReader
+    {
+    public:
+        PcapReader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+        bool Has(size_t offset, size_t length) const { return offset <= m_size && length <= m_size - offset; }
+
+        uint16_t U16(size_t offset) const
+        {
+            uint16_t value;
+            memcpy(&value, m_data + offset, sizeof(value));
+            return m_swap ? __builtin_bswap16(value) : value;
+        }
+
+        uint32_t U32(size_t offset) const
+        {
+            uint32_t value;
+            memcpy(&value, m_data + offset, sizeof(value));
+            return m_swap ? __builtin_bswap32(value) : value;
+        }
+
+        const uint8_t *Data(size_t offset) const { return m_data + offset; }
+        void SetSwap(bool swap) { m_swap = swap; }
+
+    private:
+        const uint8_t *m_data;
+        size_t m_size;
+        bool m_swap = false;
+    };
+
+    // USB headers are always little endian
+    uint16_t ReadLE16(const uint8_t *data) { return data[0] | (data[1] << 8); }
+    uint32_t ReadLE32(const uint8_t *data) { return ReadLE16(data) | (ReadLE16(data + 2) << 16); }
+
+    class CapturedTransfer
+    {
+    public:
+        uint32_t device = 0; // (bus << 16) | device address
+        ReplayTransfer transfer;
+    };
+
+    /*
+     * Rebuild complete transfers from the USB events of a capture
+     * Control transfers are split in several events (setup, data, completion), they are matched with the request id.
+     */
+    class TransferDecoder
+    {
+    public:
+        std::vector<CapturedTransfer> transfers;
+
+        void Decode(uint32_t linkType, uint64_t timestamp_us, const uint8_t *data, size_t size)
+        {
+            if (linkType == LINKTYPE_USBPCAP)
+                DecodeUSBPcap(timestamp_us, data, size);
+            else if (linkType == LINKTYPE_USB_LINUX || linkType == LINKTYPE_USB_LINUX_MMAPPED)
+                DecodeUsbmon(timestamp_us, data, size, (linkType == LINKTYPE_USB_LINUX_MMAPPED) ? 64 : 48);
+        }
+
+    private:
+        std::map<uint64_t, CapturedTransfer> m_pendingControl;
+        std::set<uint64_t> m_submittedOut; // usbmon: OUT transfers submitted with their data
+
+        void AddTransfer(uint32_t device, uint64_t timestamp_us, uint8_t endpoint, const uint8_t *data, size_t size)
+        {
+            CapturedTransfer captured;
+            captured.device = device;
+            captured.transfer.timestamp_us = timestamp_us;
+            captured.transfer.type = ReplayTransferType_Interrupt;
+            captured.transfer.endpoint = endpoint;
+            captured.transfer.data.assign(data, data + size);
+            transfers.push_back(std::move(captured));
+        }
+
+        void StartControl(uint64_t id, uint32_t device, uint64_t timestamp_us, const uint8_t *setup, const uint8_t *data, size_t size)
+        {
+            CapturedTransfer &captured = m_pendingControl[id];
+            captured.device = device;
+            captured.transfer = ReplayTransfer();
+            captured.transfer.timestamp_us = timestamp_us;
+            captured.transfer.type = ReplayTransferType_Control;
+            captured.transfer.bmRequestType = setup[0];
+            captured.transfer.bRequest = setup[1];
+            captured.transfer.wValue = ReadLE16(setup + 2);
+            captured.transfer.wIndex = ReadLE16(setup + 4);
+            captured.transfer.endpoint = setup[0] & IUSBEndpoint::USB_ENDPOINT_IN;
+            captured.transfer.data.assign(data, data + size);
+        }
+
+        void CompleteControl(uint64_t id, bool success, const uint8_t *data, size_t size)
+        {
+            auto it = m_pendingControl.find(id);
+            if (it == m_pendingControl.end())
+                return;
+
+            if (success)
+            {
+                if (it->second.transfer.IsInput())
+                    it->second.transfer.data.insert(it->second.transfer.data.end(), data, data + size);
+                transfers.push_back(std::move(it->second));
+            }
+
+            m_pendingControl.erase(it);
+        }
+
+        void DecodeUSBPcap(uint64_t timestamp_us, const uint8_t *data, size_t size)
+        {
+            if (size < 27)
+                return;
+
+            uint16_t headerLength = ReadLE16(data);
+            uint64_t irpId = (uint64_t)ReadLE32(data + 2) | ((uint64_t)ReadLE32(data + 6) << 32);
+            uint32_t status = ReadLE32(data + 10);
+            bool fromDevice = (data[16] & 0x01) != 0;
+            uint32_t device = (ReadLE16(data + 17) << 16) | ReadLE16(data + 19);
+            uint8_t endpoint = data[21];
+            uint8_t transferType = data[22];
+
+            if (headerLength > size)
+                return;
+
+            const uint8_t *payload = data + headerLength;
+            size_t payloadSize = size - headerLength;
+
+            if (transferType == USB_TRANSFER_CONTROL)
+            {
+                if (headerLength < 28)
+                    return;
+
+                uint8_t stage = data[27];
+                if (stage == 0 && payloadSize >= 8) // Setup
+                    StartControl(irpId, device, timestamp_us, payload, payload + 8, payloadSize - 8);
+                else if (stage == 1 && !fromDevice) // Data (OUT)
+                    CompleteControlData(irpId, payload, payloadSize);
+                else if (stage == 3 && fromDevice) // Complete
+                    CompleteControl(irpId, status == 0, payload, payloadSize);
+            }
+            else if (transferType == USB_TRANSFER_INTERRUPT || transferType == USB_TRANSFER_BULK)
+            {
+                // IN: data comes with the completion. OUT: data comes with the request
+                bool isInput = (endpoint & IUSBEndpoint::USB_ENDPOINT_IN) != 0;
+                if (payloadSize > 0 && status == 0 && isInput == fromDevice)
+                    AddTransfer(device, timestamp_us, endpoint, payload, payloadSize);
+            }
+        }
+
+        void CompleteControlData(uint64_t id, const uint8_t *data, size_t size)
+        {
+            auto it = m_pendingControl.find(id);
+            if (it != m_pendingControl.end())
+                it->second.transfer.data.insert(it->second.transfer.data.end(), data, data + size);
+        }
+
+        void DecodeUsbmon(uint64_t timestamp_us, const uint8_t *data, size_t size, size_t headerLength)
+        {
+            if (size < headerLength)
+                return;
+
+            uint64_t urbId;
+            memcpy(&urbId, data, sizeof(urbId));
+            char eventType = (char)data[8];
+            uint8_t transferType = data[9];
+            uint8_t endpoint = data[10];
+            uint32_t device = (ReadLE16(data + 12) << 16) | data[11];
+            bool hasSetup = data[14] == 0;
+            int32_t status = (int32_t)ReadLE32(data + 28);
+            const uint8_t *setup = data + 40;
+
+            const uint8_t *payload = data + headerLength;
+            size_t payloadSize = std::min<size_t>(ReadLE32(data + 36), size - headerLength);
+
+            if (transferType == USB_TRANSFER_CONTROL)
+            {
+                if (eventType == 'S' && hasSetup)
+                    StartControl(urbId, device, timestamp_us, setup, payload, payloadSize);
+                else if (eventType == 'C' || eventType == 'E')
+                    CompleteControl(urbId, eventType == 'C' && status == 0, payload, payloadSize);
+            }
+            else if (transferType == USB_TRANSFER_INTERRUPT || transferType == USB_TRANSFER_BULK)
+            {
+                // IN: data comes with the completion. OUT: data comes with the submission,
+                // or with the completion if the submission is not in the capture
+                bool isInput = (endpoint & IUSBEndpoint::USB_ENDPOINT_IN) != 0;
+                bool submitted = m_submittedOut.erase(urbId) != 0;
+
+                if (!isInput && eventType == 'S' && payloadSize > 0)
+                    m_submittedOut.insert(urbId);
+
+                bool hasData = isInput ? (eventType == 'C') : (eventType == 'S' || (eventType == 'C' && !submitted));
+                if (payloadSize > 0 && status == 0 && hasData)
+                    AddTransfer(device, timestamp_us, endpoint, payload, payloadSize);
+            }
+        }
+    };
+
+    bool ReadPcap(PcapReader &reader, TransferDecoder *decoder)
+    {
+        if (!reader.Has(0, 24))
+            return false;
+
+        uint32_t magic = reader.U32(0);
+        if (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS)
+        {
+            reader.SetSwap(true);
+            magic = reader.U32(0);
+        }
+
+        bool nanoseconds = magic == PCAP_MAGIC_NS;
+        uint32_t linkType = reader.U32(20) & 0x0FFFFFFF;
+
+        for (size_t offset = 24; reader.Has(offset, 16);)
+        {
+            uint64_t seconds = reader.U32(offset);
+            uint64_t fraction = reader.U32(offset + 4);
+            uint32_t capturedLength = reader.U32(offset + 8);
+
+            if (!reader.Has(offset + 16, capturedLength))
+                break; // Truncated capture
+
+            uint64_t timestamp_us = seconds * 1000000 + (nanoseconds ? fraction / 1000 : fraction);
+            decoder->Decode(linkType, timestamp_us, reader.Data(offset + 16), capturedLength);
+            offset += 16 + capturedLength;
+        }
+
+        return true;
+    }
+
+    bool ReadPcapng(PcapReader &reader, TransferDecoder *decoder)
+    {
+        class PcapngInterface
+        {
+        public:
+            uint32_t linkType;
+            uint64_t unitsPerSecond;
+        };
+        std::vector<PcapngInterface> interfaces;
+
+        for (size_t offset = 0; reader.Has(offset, 12);)
+        {
+            uint32_t blockType = reader.U32(offset);
+
+            // Section header: Endianness of the section
+            if (blockType == PCAPNG_MAGIC)
+            {
+                reader.SetSwap(false);
+                if (reader.U32(offset + 8) != PCAPNG_BYTE_ORDER)
+                    reader.SetSwap(true);
+                interfaces.clear();
+            }
+
+            uint32_t blockLength = reader.U32(offset + 4);
+            if (blockLength < 12 || !reader.Has(offset, blockLength))
+                break;
+
+            if (blockType == PCAPNG_BLOCK_IDB && blockLength >= 20)
+            {
+                PcapngInterface interface{reader.U16(offset + 8), 1000000};
+
+                // Options: timestamp resolution
+                for (size_t option = offset + 16; option + 4 <= offset + blockLength - 4;)
+                {
+                    uint16_t code = reader.U16(option);
+                    uint16_t length = reader.U16(option + 2);
+                    if (code == 0)
+                        break;
+
+                    if (code == PCAPNG_OPTION_TSRESOL && length >= 1)
+                    {
+                        uint8_t resolution = *reader.Data(option + 4);
+                        bool base2 = (resolution & 0x80) != 0;
+                        int exponent = resolution & 0x7F;
+                        if (exponent > (base2 ? 63 : 19))
+                            return false; // More units per second than a 64-bit counter
+
+                        uint64_t units = 1;
+                        for (int i = 0; i < exponent; i++)
+                            units *= base2 ? 2 : 10;
+                        interface.unitsPerSecond = units;
+                    }
+
+                    option += 4 + ((length + 3) & ~3);
+                }
+
+                interfaces.push_back(interface);
+            }
+            else if (blockType == PCAPNG_BLOCK_EPB && blockLength >= 32)
+            {
+                uint32_t interfaceId = reader.U32(offset + 8);
+                uint64_t timestamp = ((uint64_t)reader.U32(offset + 12) << 32) | reader.U32(offset + 16);
+                uint32_t capturedLength = reader.U32(offset + 20);
+
+                if (interfaceId < interfaces.size() && capturedLength <= blockLength - 32)
+                {
+                    uint64_t units = interfaces[interfaceId].unitsPerSecond;
+                    uint64_t remainder = timestamp % units;
+                    uint64_t timestamp_us = (timestamp / units) * 1000000;
+                    if (units <= UINT64_MAX / 1000000)
+                        timestamp_us += remainder * 1000000 / units;
+                    else
+                        timestamp_us += (uint64_t)((double)remainder * 1000000.0 / (double)units); // The exact product would overflow
+                    decoder->Decode(interfaces[interfaceId].linkType, timestamp_us, reader.Data(offset + 28), capturedLength);
+                }
+            }
+
+            offset += blockLength;
+        }
+
+        return true;
+    }
+
+    bool ParseHex(const std::string &token, uint32_t max, uint32_t *value)
+    {
+        char *end;
+        unsigned long parsed = strtoul(token.c_str(), &end, 16);
+        if (token.empty() || *end != '\0' || parsed > max)
+            return false;
+
+        *value = (uint32_t)parsed;
+        return true;
+    }
+
+    void AppendHex(std::string *out, const char *format, uint32_t value)
+    {
+        char text[16];
+        snprintf(text, sizeof(text), format, value);
+        out->append(text);
+    }
+} // namespace
+
+ControllerResult ReplayCapture::SetError(ControllerResult result, const std::string &error)
+{
+    m_error = error;
+    return result;
+}
+
+size_t ReplayCapture::GetReportCount() const
+{
+    return std::count_if(m_transfers.begin(), m_transfers.end(), [](const ReplayTransfer &transfer) {
+        return transfer.type == ReplayTransferType_Interrupt && transfer.IsInput();
+    });
+}
+
+ControllerResult ReplayCapture::LoadFile(const std::string &path, uint16_t deviceAddress)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return SetError(CONTROLLER_STATUS_OPEN_FAILED, "Unable to open " + path);
+
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uint32_t magic = 0;
+    if (content.size() >= sizeof(magic))
+        memcpy(&magic, content.data(), sizeof(magic));
+
+    if (magic == PCAPNG_MAGIC || magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS ||
+        magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS))
+        return LoadPcap(content.data(), content.size(), deviceAddress);
+
+    if (magic == REPORT_RECORD_MAGIC)
+        return LoadRecord(content.data(), content.size());
+
+    return LoadText(std::string(content.begin(), content.end()));
+}
+
+ControllerResult ReplayCapture::LoadPcap(const uint8_t *data, size_t size, uint16_t deviceAddress)
+{
+    *this = ReplayCapture();
+
+    PcapReader reader(data, size);
+    TransferDecoder decoder;
+
+    if (size < 4)
+        return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, "Not a pcap file");
+
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    bool valid = (magic == PCAPNG_MAGIC) ? ReadPcapng(reader, &decoder) : ReadPcap(reader, &decoder);
+    if (!valid)
+        return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, "Invalid pcap file");
+
+    // Select the device: The one with the most reports if not specified
+    std::map<uint32_t, size_t> reportCount;
+    for (const CapturedTransfer &captured : decoder.transfers)
+    {
+        bool isReport = captured.transfer.type == ReplayTransferType_Interrupt && captured.transfer.IsInput();
+        if (deviceAddress == 0 || (captured.device & 0xFFFF) == deviceAddress)
+            reportCount[captured.device] += isReport ? 1 : 0;
+    }
+
+    if (reportCount.empty())
+        return SetError(CONTROLLER_STATUS_NO_DATA_AVAILABLE, "No USB transfer found for this device in the capture");
+
+    uint32_t device = std::max_element(reportCount.begin(), reportCount.end(), [](const auto &a, const auto &b) { return a.second < b.second; })->first;
+
+    for (CapturedTransfer &captured : decoder.transfers)
+    {
+        if (captured.device == device)
+            m_transfers.push_back(std::move(captured.transfer));
+    }
+
+    // Control transfers are added at completion: Keep the capture order
+    std::stable_sort(m_transfers.begin(), m_transfers.end(), [](const ReplayTransfer &a, const ReplayTransfer &b) { return a.timestamp_us < b.timestamp_us; });
+
+    uint64_t start_us = m_transfers.front().timestamp_us;
+    for (ReplayTransfer &transfer : m_transfers)
+        transfer.timestamp_us -= start_us;
+
+    ParseDescriptors();
+    if (m_interfaces.empty())
+        InferInterfaces();
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult ReplayCapture::LoadRecord(const uint8_t *data, size_t size)
+{
+    *this = ReplayCapture();
+
+    ReportRecordFileHeader header;
+    if (size < sizeof(header))
+        return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, "Not a report record");
+
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != REPORT_RECORD_MAGIC || header.version != REPORT_RECORD_VERSION)
+        return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, "Unsupported report record (Version " + std::to_string(header.version) + ")");
+
+    m_vendorID = header.vendor_id;
+    m_productID = header.product_id;
+
+    size_t offset = sizeof(header);
+    std::vector<uint8_t> inEndpoints; // bEndpointAddress by index, all interfaces included
+
+    for (uint16_t i = 0; i < header.interface_count; i++)
+    {
+        ReportRecordInterface recordInterface;
+        if (offset + sizeof(recordInterface) > size)
+            return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, "Truncated report record header");
+
+        memcpy(&recordInterface, data + offset, sizeof(recordInterface));
+        offset += sizeof(recordInterface);
+
+        ReplayInterface interface;
+        interface.descriptor.bLength = 9;
+        interface.descriptor.bDescriptorType = USB_DESCRIPTOR_INTERFACE;
+        interface.descriptor.bInterfaceNumber = recordInterface.number;
+        interface.descriptor.bNumEndpoints = recordInterface.endpoint_count;
+        interface.descriptor.bInterfaceClass = recordInterface.interface_class;
+        interface.descriptor.bInterfaceSubClass = recordInterface.interface_subclass;
+        interface.descriptor.bInterfaceProtocol = recordInterface.interface_protocol;
+
+        for (uint8_t e = 0; e < recordInterface.endpoint_count; e++)
+        {
+            ReportRecordEndpoint recordEndpoint;
+            if (offset + sizeof(recordEndpoint) > size)
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, "Truncated report record header");
+
+            memcpy(&recordEndpoint, data + offset, sizeof(recordEndpoint));
+            offset += sizeof(recordEndpoint);
+
+            IUSBEndpoint::EndpointDescriptor endpoint = {};
+            endpoint.bLength = 7;
+            endpoint.bDescriptorType = USB_DESCRIPTOR_ENDPOINT;
+            endpoint.bEndpointAddress = recordEndpoint.address;
+            endpoint.bmAttributes = USB_TRANSFER_INTERRUPT;
+            endpoint.wMaxPacketSize = recordEndpoint.max_packet_size;
+            endpoint.bInterval = recordEndpoint.interval;
+            interface.endpoints.push_back(endpoint);
+
+            if (recordEndpoint.address & IUSBEndpoint::USB_ENDPOINT_IN)
+                inEndpoints.push_back(recordEndpoint.address);
+        }
+
+        m_interfaces.push_back(interface);
+    }
+
+    // Reports: Failed reads are only meaningful for the statistics of the recording, they are not replayed
+    uint64_t timestamp_us = 0;
+    while (offset + sizeof(ReportRecordHeader) <= size)
+    {
+        ReportRecordHeader record;
+        memcpy(&record, data + offset, sizeof(record));
+        offset += sizeof(record);
+
+        if (offset + record.size > size)
+            break; // Last record truncated (e.g. Console turned off while recording)
+
+        timestamp_us += record.delta_us;
+
+        if (record.size > 0 && record.endpoint < inEndpoints.size())
+        {
+            ReplayTransfer transfer;
+            transfer.timestamp_us = timestamp_us;
+            transfer.type = ReplayTransferType_Interrupt;
+            transfer.endpoint = inEndpoints[record.endpoint];
+            transfer.data.assign(data + offset, data + offset + record.size);
+            m_transfers.push_back(std::move(transfer));
+        }
+
+        offset += record.size;
+    }
+
+    if (m_interfaces.empty())
+        InferInterfaces();
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+void ReplayCapture::ParseDescriptors()
+{
+    const std::vector<uint8_t> *configuration = nullptr;
+
+    for (const ReplayTransfer &transfer : m_transfers)
+    {
+        if (transfer.type != ReplayTransferType_Control || transfer.bmRequestType != 0x80 || transfer.bRequest != USB_REQUEST_GET_DESCRIPTOR)
+            continue;
+
+        uint8_t descriptorType = transfer.wValue >> 8;
+        if (descriptorType == USB_DESCRIPTOR_DEVICE && transfer.data.size() >= 12)
+        {
+            m_vendorID = ReadLE16(&transfer.data[8]);
+            m_productID = ReadLE16(&transfer.data[10]);
+        }
+        else if (descriptorType == USB_DESCRIPTOR_CONFIGURATION && (configuration == nullptr || transfer.data.size() > configuration->size()))
+        {
+            configuration = &transfer.data;
+        }
+    }
+
+    if (configuration == nullptr)
+        return;
+
+    ReplayInterface *current = nullptr;
+    for (size_t offset = 0; offset + 2 <= configuration->size();)
+    {
+        const uint8_t *descriptor = &(*configuration)[offset];
+        uint8_t length = descriptor[0];
+        if (length < 2 || offset + length > configuration->size())
+            break;
+
+        if (descriptor[1] == USB_DESCRIPTOR_INTERFACE && length >= 9)
+        {
+            current = nullptr;
+            if (descriptor[3] == 0) // Alternate settings are not supported by IUSBInterface
+            {
+                ReplayInterface interface;
+                memcpy(&interface.descriptor, descriptor, sizeof(interface.descriptor));
+                m_interfaces.push_back(interface);
+                current = &m_interfaces.back();
+            }
+        }
+        else if (descriptor[1] == USB_DESCRIPTOR_ENDPOINT && length >= 7 && current != nullptr)
+        {
+            IUSBEndpoint::EndpointDescriptor endpoint = {};
+            endpoint.bLength = descriptor[0];
+            endpoint.bDescriptorType = descriptor[1];
+            endpoint.bEndpointAddress = descriptor[2];
+            endpoint.bmAttributes = descriptor[3];
+            endpoint.wMaxPacketSize = ReadLE16(descriptor + 4);
+            endpoint.bInterval = descriptor[6];
+            current->endpoints.push_back(endpoint);
+        }
+
+        offset += length;
+    }
+
+    for (ReplayInterface &interface : m_interfaces)
+        interface.descriptor.bNumEndpoints = interface.endpoints.size();
+}
+
+void ReplayCapture::InferInterfaces()
+{
+    // Enumeration not captured: A single vendor specific interface with all the endpoints used
+    ReplayInterface interface;
+    interface.descriptor.bLength = 9;
+    interface.descriptor.bDescriptorType = USB_DESCRIPTOR_INTERFACE;
+    interface.descriptor.bInterfaceClass = 0xFF;
+
+    for (const ReplayTransfer &transfer : m_transfers)
+    {
+        if (transfer.type != ReplayTransferType_Interrupt)
+            continue;
+
+        auto it = std::find_if(interface.endpoints.begin(), interface.endpoints.end(), [&transfer](const IUSBEndpoint::EndpointDescriptor &endpoint) {
+            return endpoint.bEndpointAddress == transfer.endpoint;
+        });
+
+        if (it == interface.endpoints.end())
+        {
+            IUSBEndpoint::EndpointDescriptor endpoint = {};
+            endpoint.bLength = 7;
+            endpoint.bDescriptorType = USB_DESCRIPTOR_ENDPOINT;
+            endpoint.bEndpointAddress = transfer.endpoint;
+            endpoint.bmAttributes = USB_TRANSFER_INTERRUPT;
+            endpoint.wMaxPacketSize = 64;
+            endpoint.bInterval = 1;
+            interface.endpoints.push_back(endpoint);
+            it = interface.endpoints.end() - 1;
+        }
+
+        it->wMaxPacketSize = std::max<uint16_t>(it->wMaxPacketSize, transfer.data.size());
+    }
+
+    interface.descriptor.bNumEndpoints = interface.endpoints.size();
+    m_interfaces.push_back(interface);
+}
+
+ControllerResult ReplayCapture::LoadText(const std::string &text)
+{
+    *this = ReplayCapture();
+
+    std::istringstream stream(text);
+    std::string line;
+    int lineNumber = 0;
+    uint64_t previousTimestamp = 0;
+
+    while (std::getline(stream, line))
+    {
+        lineNumber++;
+        std::string error = "Line " + std::to_string(lineNumber) + ": ";
+
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream tokens(line);
+        std::vector<std::string> words((std::istream_iterator<std::string>(tokens)), std::istream_iterator<std::string>());
+        if (words.empty())
+            continue;
+
+        uint32_t values[4] = {};
+
+        if (words[0] == "device")
+        {
+            if (words.size() != 3 || !ParseHex(words[1], 0xFFFF, &values[0]) || !ParseHex(words[2], 0xFFFF, &values[1]))
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Expected 'device VID PID'");
+
+            m_vendorID = values[0];
+            m_productID = values[1];
+            continue;
+        }
+
+        if (words[0] == "interface")
+        {
+            if (words.size() != 5 || !ParseHex(words[1], 0xFF, &values[0]) || !ParseHex(words[2], 0xFF, &values[1]) ||
+                !ParseHex(words[3], 0xFF, &values[2]) || !ParseHex(words[4], 0xFF, &values[3]))
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Expected 'interface number class subclass protocol'");
+
+            ReplayInterface interface;
+            interface.descriptor.bLength = 9;
+            interface.descriptor.bDescriptorType = USB_DESCRIPTOR_INTERFACE;
+            interface.descriptor.bInterfaceNumber = values[0];
+            interface.descriptor.bInterfaceClass = values[1];
+            interface.descriptor.bInterfaceSubClass = values[2];
+            interface.descriptor.bInterfaceProtocol = values[3];
+            m_interfaces.push_back(interface);
+            continue;
+        }
+
+        if (words[0] == "endpoint")
+        {
+            if (m_interfaces.empty())
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Endpoint declared before any interface");
+
+            if (words.size() != 4 || !ParseHex(words[1], 0xFF, &values[0]))
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Expected 'endpoint address wMaxPacketSize bInterval'");
+
+            IUSBEndpoint::EndpointDescriptor endpoint = {};
+            endpoint.bLength = 7;
+            endpoint.bDescriptorType = USB_DESCRIPTOR_ENDPOINT;
+            endpoint.bEndpointAddress = values[0];
+            endpoint.bmAttributes = USB_TRANSFER_INTERRUPT;
+            endpoint.wMaxPacketSize = atoi(words[2].c_str());
+            endpoint.bInterval = atoi(words[3].c_str());
+            m_interfaces.back().endpoints.push_back(endpoint);
+            m_interfaces.back().descriptor.bNumEndpoints = m_interfaces.back().endpoints.size();
+            continue;
+        }
+
+        // Transfer: timestamp type ...
+        char *end;
+        ReplayTransfer transfer;
+        transfer.timestamp_us = strtoull(words[0].c_str(), &end, 10);
+        if (*end != '\0' || words.size() < 3)
+            return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Unknown line");
+
+        if (transfer.timestamp_us < previousTimestamp)
+            return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Timestamps must be in ascending order");
+        previousTimestamp = transfer.timestamp_us;
+
+        size_t dataStart;
+        if (words[1] == "ctrl")
+        {
+            if (words.size() < 6 || !ParseHex(words[2], 0xFF, &values[0]) || !ParseHex(words[3], 0xFF, &values[1]) ||
+                !ParseHex(words[4], 0xFFFF, &values[2]) || !ParseHex(words[5], 0xFFFF, &values[3]))
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Expected 'timestamp ctrl bmRequestType bRequest wValue wIndex [data]'");
+
+            transfer.type = ReplayTransferType_Control;
+            transfer.bmRequestType = values[0];
+            transfer.bRequest = values[1];
+            transfer.wValue = values[2];
+            transfer.wIndex = values[3];
+            transfer.endpoint = values[0] & IUSBEndpoint::USB_ENDPOINT_IN;
+            dataStart = 6;
+        }
+        else if (words[1] == "in" || words[1] == "out")
+        {
+            if (!ParseHex(words[2], 0xFF, &values[0]) || ((values[0] & IUSBEndpoint::USB_ENDPOINT_IN) != 0) != (words[1] == "in"))
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Invalid endpoint address for '" + words[1] + "'");
+
+            transfer.type = ReplayTransferType_Interrupt;
+            transfer.endpoint = values[0];
+            dataStart = 3;
+        }
+        else
+        {
+            return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Unknown transfer type '" + words[1] + "'");
+        }
+
+        for (size_t i = dataStart; i < words.size(); i++)
+        {
+            if (!ParseHex(words[i], 0xFF, &values[0]))
+                return SetError(CONTROLLER_STATUS_UNEXPECTED_DATA, error + "Invalid byte '" + words[i] + "'");
+            transfer.data.push_back(values[0]);
+        }
+
+        m_transfers.push_back(std::move(transfer));
+    }
+
+    if (m_interfaces.empty())
+        InferInterfaces();
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+std::string ReplayCapture::SaveText() const
+{
+    std::string out;
+
+    AppendHex(&out, "device %04x", m_vendorID);
+    AppendHex(&out, " %04x\n", m_productID);
+
+    for (const ReplayInterface &interface : m_interfaces)
+    {
+        AppendHex(&out, "interface %x", interface.descriptor.bInterfaceNumber);
+        AppendHex(&out, " %02x", interface.descriptor.bInterfaceClass);
+        AppendHex(&out, " %02x", interface.descriptor.bInterfaceSubClass);
+        AppendHex(&out, " %02x\n", interface.descriptor.bInterfaceProtocol);
+
+        for (const IUSBEndpoint::EndpointDescriptor &endpoint : interface.endpoints)
+        {
+            AppendHex(&out, "endpoint %02x", endpoint.bEndpointAddress);
+            out.append(" " + std::to_string(endpoint.wMaxPacketSize) + " " + std::to_string(endpoint.bInterval) + "\n");
+        }
+    }
+
+    for (const ReplayTransfer &transfer : m_transfers)
+    {
+        out.append(std::to_string(transfer.timestamp_us));
+
+        if (transfer.type == ReplayTransferType_Control)
+        {
+            AppendHex(&out, " ctrl %02x", transfer.bmRequestType);
+            AppendHex(&out, " %02x", transfer.bRequest);
+            AppendHex(&out, " %04x", transfer.wValue);
+            AppendHex(&out, " %04x", transfer.wIndex);
+        }
+        else
+        {
+            out.append(transfer.IsInput() ? " in" : " out");
+            AppendHex(&out, " %02x", transfer.endpoint);
+        }
+
+        for (uint8_t byte : transfer.data)
+            AppendHex(&out, " %02x", byte);
+
+        out.append("\n");
+    }
+
+    return out;
+}
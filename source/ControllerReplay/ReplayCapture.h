@@ -0,0 +1,99 @@
+#pragma once
+#include "IUSBInterface.h"
+#include <string>
+#include <vector>
+
+/*
+ * USB traffic of a single device, loaded from a capture and replayed by ReplayUSBDevice
+ *
+ * Supported captures:
+ *  - Wireshark captures (.pcap or .pcapng) done with USBPcap (Windows, see doc/WiresharkCapture.md) or usbmon (Linux)
+ *    If the capture contains several devices, the one with the most IN reports is selected (or 'deviceAddress')
+ *    Interfaces and endpoints are read from the configuration descriptor when the enumeration was captured.
+ *  - Replay scripts (.txt), written by hand or with SaveText():
+ *
+ *      # Comment
+ *      device 045e 028e                   <- VID PID
+ *      interface 0 ff 5d 01               <- bInterfaceNumber bInterfaceClass bInterfaceSubClass bInterfaceProtocol
+ *      endpoint 81 32 4                   <- bEndpointAddress wMaxPacketSize bInterval (Belongs to the last interface)
+ *      0     ctrl 80 06 0100 0000 12 01   <- timestamp_us ctrl bmRequestType bRequest wValue wIndex [data]
+ *      1000  out 01 01 03 02              <- timestamp_us out bEndpointAddress data (Expected write)
+ *      2000  in 81 00 14 00 00            <- timestamp_us in bEndpointAddress data (Report to replay)
+ *
+ *    All numbers are hexadecimal, except timestamps, wMaxPacketSize and bInterval.
+ *  - Report records (.rec) written by the sysmodule with record_reports=1 (See ReportRecorder.h)
+ *    Only the reports successfully read are replayed, the device answers no control transfer.
+ */
+
+enum ReplayTransferType : uint8_t
+{
+    ReplayTransferType_Control = 0,
+    ReplayTransferType_Interrupt,
+};
+
+class ReplayTransfer
+{
+public:
+    uint64_t timestamp_us = 0;
+    ReplayTransferType type = ReplayTransferType_Interrupt;
+    uint8_t endpoint = 0; // bEndpointAddress (0x80 bit set for IN), 0x00 or 0x80 for control transfers
+
+    // Setup packet of control transfers
+    uint8_t bmRequestType = 0;
+    uint8_t bRequest = 0;
+    uint16_t wValue = 0;
+    uint16_t wIndex = 0;
+
+    std::vector<uint8_t> data;
+
+    bool IsInput() const { return (endpoint & IUSBEndpoint::USB_ENDPOINT_IN) != 0; }
+};
+
+class ReplayInterface
+{
+public:
+    IUSBInterface::InterfaceDescriptor descriptor = {};
+    std::vector<IUSBEndpoint::EndpointDescriptor> endpoints;
+};
+
+class ReplayCapture
+{
+public:
+    // Load a pcap/pcapng capture, a report record or a replay script (Detected from the content). deviceAddress: 0 to auto select
+    ControllerResult LoadFile(const std::string &path, uint16_t deviceAddress = 0);
+    ControllerResult LoadPcap(const uint8_t *data, size_t size, uint16_t deviceAddress = 0);
+    ControllerResult LoadRecord(const uint8_t *data, size_t size);
+    ControllerResult LoadText(const std::string &text);
+
+    // Needed when the enumeration is not in the capture (The device is then unknown)
+    void SetDevice(uint16_t vendorID, uint16_t productID)
+    {
+        m_vendorID = vendorID;
+        m_productID = productID;
+    }
+
+    // Write the capture as a replay script
+    std::string SaveText() const;
+
+    // Reason of the last load failure
+    const std::string &GetError() const { return m_error; }
+
+    uint16_t GetVendor() const { return m_vendorID; }
+    uint16_t GetProduct() const { return m_productID; }
+    const std::vector<ReplayInterface> &GetInterfaces() const { return m_interfaces; }
+    const std::vector<ReplayTransfer> &GetTransfers() const { return m_transfers; }
+
+    // Number of IN reports (interrupt transfers) in the capture
+    size_t GetReportCount() const;
+
+private:
+    ControllerResult SetError(ControllerResult result, const std::string &error);
+    void ParseDescriptors();
+    void InferInterfaces();
+
+    uint16_t m_vendorID = 0;
+    uint16_t m_productID = 0;
+    std::vector<ReplayInterface> m_interfaces;
+    std::vector<ReplayTransfer> m_transfers;
+    std::string m_error;
+};
@@ -0,0 +1,218 @@
+#include "ReplaySession.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+ReplaySession::ReplaySession(std::shared_ptr<const ReplayCapture> capture, const ReplayOptions &options)
+    : m_capture(capture),
+      m_options(options),
+      m_controlUsed(capture->GetTransfers().size(), false)
+{
+    for (const ReplayTransfer &transfer : m_capture->GetTransfers())
+    {
+        if (transfer.type == ReplayTransferType_Interrupt)
+            m_queues[transfer.endpoint].transfers.push_back(&transfer);
+    }
+}
+
+void ReplaySession::Wait(uint64_t aTimeoutUs)
+{
+    // As fast as possible: Never wait for a report that will not come
+    if (m_options.speed <= 0 || aTimeoutUs == 0 || aTimeoutUs == UINT64_MAX)
+        return;
+
+    std::this_thread::sleep_for(std::chrono::microseconds(aTimeoutUs));
+}
+
+ControllerResult ReplaySession::Read(uint8_t endpoint, uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto it = m_queues.find(endpoint);
+    if (it == m_queues.end() || it->second.transfers.empty())
+    {
+        lock.unlock();
+        Wait(aTimeoutUs);
+        return CONTROLLER_STATUS_TIMEOUT;
+    }
+
+    EndpointQueue &queue = it->second;
+    if (queue.next >= queue.transfers.size())
+    {
+        if (!m_options.loop)
+        {
+            lock.unlock();
+            Wait(aTimeoutUs);
+            return CONTROLLER_STATUS_TIMEOUT;
+        }
+
+        // Restart: The first report comes one (average) interval after the last one
+        uint64_t span_us = queue.transfers.back()->timestamp_us - queue.transfers.front()->timestamp_us;
+        uint64_t interval_us = (queue.transfers.size() > 1) ? span_us / (queue.transfers.size() - 1) : 1000;
+        queue.loop_offset_us += span_us + interval_us;
+        queue.next = 0;
+    }
+
+    const ReplayTransfer *transfer = queue.transfers[queue.next];
+
+    // As fast as possible: A report is never already queued, it comes with the next blocking read.
+    // Otherwise the keep-latest drain of the drivers would skip the whole capture at once
+    if (m_options.speed <= 0 && aTimeoutUs == 0)
+        return CONTROLLER_STATUS_TIMEOUT;
+
+    if (m_options.speed > 0)
+    {
+        auto now = std::chrono::steady_clock::now();
+        uint64_t capture_us = transfer->timestamp_us + queue.loop_offset_us;
+
+        if (!m_started)
+        {
+            m_started = true;
+            m_start = now;
+            m_start_us = capture_us;
+        }
+
+        int64_t delta_us = (int64_t)(capture_us - m_start_us);
+        auto due = m_start + std::chrono::microseconds((int64_t)(delta_us / m_options.speed));
+
+        if (due > now)
+        {
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(due - now);
+            if (aTimeoutUs != UINT64_MAX && (uint64_t)wait.count() > aTimeoutUs)
+            {
+                lock.unlock();
+                Wait(aTimeoutUs);
+                return CONTROLLER_STATUS_TIMEOUT;
+            }
+
+            // Only one reader per endpoint: The queue can't change while waiting
+            lock.unlock();
+            std::this_thread::sleep_until(due);
+            lock.lock();
+            now = std::chrono::steady_clock::now();
+        }
+
+        uint64_t late_us = std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+        m_stats.max_late_us = std::max(m_stats.max_late_us, late_us);
+    }
+
+    size_t size = std::min(*bufferSizeInOut, transfer->data.size());
+    memcpy(outBuffer, transfer->data.data(), size);
+    *bufferSizeInOut = size;
+
+    queue.next++;
+    m_stats.reports_replayed++;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult ReplaySession::Write(uint8_t endpoint, const uint8_t *inBuffer, size_t bufferSize)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_queues.find(endpoint);
+    if (it != m_queues.end())
+    {
+        // The next matching write: Writes not done by the driver (e.g. different rumble) are skipped
+        EndpointQueue &queue = it->second;
+        for (size_t i = queue.next; i < queue.transfers.size(); i++)
+        {
+            const std::vector<uint8_t> &data = queue.transfers[i]->data;
+            if (data.size() == bufferSize && memcmp(data.data(), inBuffer, bufferSize) == 0)
+            {
+                queue.next = i + 1;
+                m_stats.writes_matched++;
+                return CONTROLLER_STATUS_SUCCESS;
+            }
+        }
+    }
+
+    m_stats.writes_unexpected++;
+    return m_options.strict ? CONTROLLER_STATUS_WRITE_FAILED : CONTROLLER_STATUS_SUCCESS;
+}
+
+template <typename Match>
+const ReplayTransfer *ReplaySession::FindControl(Match match)
+{
+    const std::vector<ReplayTransfer> &transfers = m_capture->GetTransfers();
+    const ReplayTransfer *found = nullptr;
+
+    for (size_t i = 0; i < transfers.size(); i++)
+    {
+        if (transfers[i].type != ReplayTransferType_Control || !match(transfers[i]))
+            continue;
+
+        if (!m_controlUsed[i])
+        {
+            m_controlUsed[i] = true;
+            return &transfers[i];
+        }
+
+        // Already used: The device is expected to answer the same way again (e.g. descriptors)
+        found = &transfers[i];
+    }
+
+    return found;
+}
+
+ControllerResult ReplaySession::ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const ReplayTransfer *transfer = FindControl([=](const ReplayTransfer &t) {
+        return t.bmRequestType == bmRequestType && t.bRequest == bmRequest && t.wValue == wValue && t.wIndex == wIndex;
+    });
+
+    if (transfer == nullptr)
+    {
+        m_stats.control_unanswered++;
+        return CONTROLLER_STATUS_READ_FAILED;
+    }
+
+    uint16_t size = std::min<size_t>(*wLength, transfer->data.size());
+    memcpy(buffer, transfer->data.data(), size);
+    *wLength = size;
+
+    m_stats.control_answered++;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult ReplaySession::ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const ReplayTransfer *transfer = FindControl([=](const ReplayTransfer &t) {
+        return t.bmRequestType == bmRequestType && t.bRequest == bmRequest && t.wValue == wValue && t.wIndex == wIndex &&
+               t.data.size() == wLength && (wLength == 0 || memcmp(t.data.data(), buffer, wLength) == 0);
+    });
+
+    if (transfer == nullptr)
+    {
+        m_stats.writes_unexpected++;
+        return m_options.strict ? CONTROLLER_STATUS_WRITE_FAILED : CONTROLLER_STATUS_SUCCESS;
+    }
+
+    m_stats.writes_matched++;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+bool ReplaySession::IsFinished()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_options.loop)
+        return false;
+
+    for (const auto &[endpoint, queue] : m_queues)
+    {
+        if ((endpoint & IUSBEndpoint::USB_ENDPOINT_IN) && queue.next < queue.transfers.size())
+            return false;
+    }
+
+    return true;
+}
+
+ReplayStats ReplaySession::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "ReplayCapture.h"
+#include "USBSession.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+
+class ReplayOptions
+{
+public:
+    float speed = 1.0f;  // 1.0: Original timing, 2.0: Twice faster, 0: As fast as possible
+    bool loop = false;   // Restart from the first report at the end of the capture
+    bool strict = false; // Writes and control transfers not found in the capture fail (Otherwise they are only counted)
+};
+
+class ReplayStats
+{
+public:
+    uint64_t reports_replayed = 0;
+    uint64_t writes_matched = 0;     // Interrupt and control writes found in the capture
+    uint64_t writes_unexpected = 0;  // Interrupt and control writes not found in the capture
+    uint64_t control_answered = 0;   // Control reads answered from the capture
+    uint64_t control_unanswered = 0; // Control reads not found in the capture
+    uint64_t max_late_us = 0;        // Worst delay between the capture timing and the report returned
+};
+
+/*
+ * Replay state shared by a ReplayUSBDevice and all its interfaces and endpoints
+ *
+ * Reports of each IN endpoint are returned in order. With a speed != 0, the timing of the capture is kept:
+ * The first report read is returned immediately, the next ones when they are due (Relative to the first one).
+ * With a speed of 0, each blocking read (timeout != 0) returns the next report immediately.
+ * Writes and control transfers are searched in the capture: A control read is answered with the data captured
+ * for the same setup packet, a write is validated against the data captured on the same endpoint.
+ */
+class ReplaySession : public USBSession
+{
+public:
+    ReplaySession(std::shared_ptr<const ReplayCapture> capture, const ReplayOptions &options);
+
+    ControllerResult Read(uint8_t endpoint, uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) override;
+    ControllerResult Write(uint8_t endpoint, const uint8_t *inBuffer, size_t bufferSize) override;
+
+    ControllerResult ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength) override;
+    ControllerResult ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength) override;
+
+    // All the reports of the capture were read (Never true in loop mode)
+    bool IsFinished();
+    ReplayStats GetStats();
+
+private:
+    class EndpointQueue
+    {
+    public:
+        std::vector<const ReplayTransfer *> transfers;
+        size_t next = 0;
+        uint64_t loop_offset_us = 0; // Added to the timestamps each time the capture is restarted
+    };
+
+    // Search a transfer matching 'match', the ones not yet used first. Return nullptr if not found
+    template <typename Match>
+    const ReplayTransfer *FindControl(Match match);
+    void Wait(uint64_t aTimeoutUs);
+
+    std::shared_ptr<const ReplayCapture> m_capture;
+    ReplayOptions m_options;
+    std::mutex m_mutex;
+    ReplayStats m_stats;
+
+    std::map<uint8_t, EndpointQueue> m_queues; // By bEndpointAddress
+    std::vector<bool> m_controlUsed;           // By transfer index
+
+    bool m_started = false;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_start_us = 0; // Capture time of the first report read
+};
@@ -0,0 +1,29 @@
+#include "ReplayUSBDevice.h"
+
+ReplayUSBDevice::ReplayUSBDevice(std::shared_ptr<const ReplayCapture> capture, const ReplayOptions &options)
+    : m_session(std::make_shared<ReplaySession>(capture, options))
+{
+    m_vendorID = capture->GetVendor();
+    m_productID = capture->GetProduct();
+
+    for (const ReplayInterface &interface : capture->GetInterfaces())
+        m_interfaces.push_back(std::make_unique<ReplayUSBInterface>(m_session, interface));
+}
+
+ControllerResult ReplayUSBDevice::Open()
+{
+    if (m_interfaces.size() == 0)
+        return CONTROLLER_STATUS_NO_INTERFACES;
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+void ReplayUSBDevice::Close()
+{
+    for (auto &&interface : m_interfaces)
+        interface->Close();
+}
+
+void ReplayUSBDevice::Reset()
+{
+}
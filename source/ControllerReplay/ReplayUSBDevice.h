@@ -0,0 +1,30 @@
+#pragma once
+#include "IUSBDevice.h"
+#include "ReplaySession.h"
+#include "ReplayUSBInterface.h"
+
+/*
+ * IUSBDevice replaying a capture (See ReplayCapture.h), any driver can run unmodified on a computer:
+ *
+ *   auto capture = std::make_shared<ReplayCapture>();
+ *   capture->LoadFile("doc/wireshark/XBOX360 - Official.pcapng");
+ *   Xbox360Controller controller(std::make_unique<ReplayUSBDevice>(capture), config, std::move(logger));
+ *
+ * Several devices can replay the same capture, each one has its own replay state.
+ */
+class ReplayUSBDevice : public IUSBDevice
+{
+private:
+    std::shared_ptr<ReplaySession> m_session;
+
+public:
+    ReplayUSBDevice(std::shared_ptr<const ReplayCapture> capture, const ReplayOptions &options = ReplayOptions());
+
+    virtual ControllerResult Open() override;
+    virtual void Close() override;
+    virtual void Reset() override;
+
+    // All the reports of the capture were read
+    bool IsFinished() { return m_session->IsFinished(); }
+    ReplayStats GetStats() { return m_session->GetStats(); }
+};
@@ -0,0 +1,43 @@
+#include "ReplayUSBEndpoint.h"
+
+ReplayUSBEndpoint::ReplayUSBEndpoint(std::shared_ptr<USBSession> session, const EndpointDescriptor &descriptor)
+    : m_session(session),
+      m_descriptor(descriptor)
+{
+}
+
+ControllerResult ReplayUSBEndpoint::Open(int maxPacketSize)
+{
+    (void)maxPacketSize;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+void ReplayUSBEndpoint::Close()
+{
+}
+
+ControllerResult ReplayUSBEndpoint::Write(const uint8_t *inBuffer, size_t bufferSize)
+{
+    if (GetDirection() == USB_ENDPOINT_IN)
+        return CONTROLLER_STATUS_INVALID_ENDPOINT;
+
+    return m_session->Write(m_descriptor.bEndpointAddress, inBuffer, bufferSize);
+}
+
+ControllerResult ReplayUSBEndpoint::Read(uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs)
+{
+    if (GetDirection() == USB_ENDPOINT_OUT)
+        return CONTROLLER_STATUS_INVALID_ENDPOINT;
+
+    return m_session->Read(m_descriptor.bEndpointAddress, outBuffer, bufferSizeInOut, aTimeoutUs);
+}
+
+IUSBEndpoint::Direction ReplayUSBEndpoint::GetDirection()
+{
+    return ((m_descriptor.bEndpointAddress & USB_ENDPOINT_IN) ? USB_ENDPOINT_IN : USB_ENDPOINT_OUT);
+}
+
+IUSBEndpoint::EndpointDescriptor *ReplayUSBEndpoint::GetDescriptor()
+{
+    return &m_descriptor;
+}
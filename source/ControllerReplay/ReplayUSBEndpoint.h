@@ -0,0 +1,26 @@
+#pragma once
+#include "IUSBEndpoint.h"
+#include "USBSession.h"
+#include <memory>
+
+class ReplayUSBEndpoint : public IUSBEndpoint
+{
+private:
+    std::shared_ptr<USBSession> m_session;
+    EndpointDescriptor m_descriptor;
+
+public:
+    ReplayUSBEndpoint(std::shared_ptr<USBSession> session, const EndpointDescriptor &descriptor);
+
+    virtual ControllerResult Open(int maxPacketSize = 0) override;
+    virtual void Close() override;
+
+    // Given to the session (Validated against the writes of the capture when replayed)
+    virtual ControllerResult Write(const uint8_t *inBuffer, size_t bufferSize) override;
+
+    // Next report of this endpoint
+    virtual ControllerResult Read(uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) override;
+
+    virtual IUSBEndpoint::Direction GetDirection() override;
+    virtual IUSBEndpoint::EndpointDescriptor *GetDescriptor() override;
+};
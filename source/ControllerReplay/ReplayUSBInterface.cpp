@@ -0,0 +1,47 @@
+#include "ReplayUSBInterface.h"
+
+ReplayUSBInterface::ReplayUSBInterface(std::shared_ptr<USBSession> session, const ReplayInterface &interface)
+    : m_session(session),
+      m_descriptor(interface.descriptor)
+{
+    for (const IUSBEndpoint::EndpointDescriptor &descriptor : interface.endpoints)
+    {
+        if (descriptor.bEndpointAddress & IUSBEndpoint::USB_ENDPOINT_IN)
+            m_inEndpoints.push_back(std::make_unique<ReplayUSBEndpoint>(m_session, descriptor));
+        else
+            m_outEndpoints.push_back(std::make_unique<ReplayUSBEndpoint>(m_session, descriptor));
+    }
+}
+
+ControllerResult ReplayUSBInterface::Open()
+{
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+void ReplayUSBInterface::Close()
+{
+}
+
+ControllerResult ReplayUSBInterface::ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength)
+{
+    return m_session->ControlTransferInput(bmRequestType, bmRequest, wValue, wIndex, buffer, wLength);
+}
+
+ControllerResult ReplayUSBInterface::ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength)
+{
+    return m_session->ControlTransferOutput(bmRequestType, bmRequest, wValue, wIndex, buffer, wLength);
+}
+
+IUSBEndpoint *ReplayUSBInterface::GetEndpoint(IUSBEndpoint::Direction direction, uint8_t index)
+{
+    std::vector<std::unique_ptr<ReplayUSBEndpoint>> &endpoints = (direction == IUSBEndpoint::USB_ENDPOINT_IN) ? m_inEndpoints : m_outEndpoints;
+    if (index >= endpoints.size())
+        return nullptr;
+
+    return endpoints[index].get();
+}
+
+ControllerResult ReplayUSBInterface::Reset()
+{
+    return CONTROLLER_STATUS_SUCCESS;
+}
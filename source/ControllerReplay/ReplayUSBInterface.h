@@ -0,0 +1,33 @@
+#pragma once
+#include "IUSBInterface.h"
+#include "ReplayCapture.h"
+#include "ReplayUSBEndpoint.h"
+#include <memory>
+#include <vector>
+
+// Interface of a host device (ReplayUSBDevice or SyntheticUSBDevice), described by a ReplayInterface
+class ReplayUSBInterface : public IUSBInterface
+{
+private:
+    std::shared_ptr<USBSession> m_session;
+    InterfaceDescriptor m_descriptor;
+    std::vector<std::unique_ptr<ReplayUSBEndpoint>> m_inEndpoints;
+    std::vector<std::unique_ptr<ReplayUSBEndpoint>> m_outEndpoints;
+
+public:
+    ReplayUSBInterface(std::shared_ptr<USBSession> session, const ReplayInterface &interface);
+
+    virtual ControllerResult Open() override;
+    virtual void Close() override;
+
+    // Answered by the session (The control pipe is shared by all the interfaces)
+    virtual ControllerResult ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength) override;
+    virtual ControllerResult ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength) override;
+
+    // Endpoints are indexed per direction, in the order of the configuration descriptor
+    virtual IUSBEndpoint *GetEndpoint(IUSBEndpoint::Direction direction, uint8_t index) override;
+
+    virtual ControllerResult Reset() override;
+
+    virtual InterfaceDescriptor *GetDescriptor() override { return &m_descriptor; }
+};
@@ -0,0 +1,450 @@
+#include "SyntheticProtocol.h"
+#include "Controllers/Dualshock3Controller.h"
+#include "Controllers/SteamController2026.h"
+#include "Controllers/SwitchController.h"
+#include "Controllers/WiiController.h"
+#include "Controllers/Xbox360Controller.h"
+#include "Controllers/XboxOneController.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+#define USB_CLASS_HID         0x03
+#define USB_CLASS_VENDOR_SPEC 0xFF
+
+#define USB_ENDPOINT_INTERRUPT 0x03
+
+namespace
+{
+    class SyntheticEndpoint
+    {
+    public:
+        uint8_t address;
+        uint16_t max_packet_size;
+        uint8_t interval;
+    };
+
+    ReplayInterface MakeInterface(uint8_t number, uint8_t interfaceClass, uint8_t subClass, uint8_t protocol, std::initializer_list<SyntheticEndpoint> endpoints)
+    {
+        ReplayInterface interface;
+        interface.descriptor.bLength = sizeof(IUSBInterface::InterfaceDescriptor);
+        interface.descriptor.bDescriptorType = 0x04;
+        interface.descriptor.bInterfaceNumber = number;
+        interface.descriptor.bNumEndpoints = static_cast<uint8_t>(endpoints.size());
+        interface.descriptor.bInterfaceClass = interfaceClass;
+        interface.descriptor.bInterfaceSubClass = subClass;
+        interface.descriptor.bInterfaceProtocol = protocol;
+
+        for (const SyntheticEndpoint &endpoint : endpoints)
+        {
+            IUSBEndpoint::EndpointDescriptor descriptor = {};
+            descriptor.bLength = 7;
+            descriptor.bDescriptorType = 0x05;
+            descriptor.bEndpointAddress = endpoint.address;
+            descriptor.bmAttributes = USB_ENDPOINT_INTERRUPT;
+            descriptor.wMaxPacketSize = endpoint.max_packet_size;
+            descriptor.bInterval = endpoint.interval;
+            interface.endpoints.push_back(descriptor);
+        }
+
+        return interface;
+    }
+
+    SyntheticLayout MakeLayout(const char *name, const char *driver, uint16_t vendor_id, uint16_t product_id, uint16_t max_pads, bool shared_report, std::vector<ReplayInterface> &&interfaces)
+    {
+        SyntheticLayout layout;
+        layout.name = name;
+        layout.driver = driver;
+        layout.vendor_id = vendor_id;
+        layout.product_id = product_id;
+        layout.max_pads = max_pads;
+        layout.shared_report = shared_report;
+        layout.interfaces = std::move(interfaces);
+        return layout;
+    }
+
+    std::vector<SyntheticLayout> MakeLayouts()
+    {
+        std::vector<SyntheticLayout> layouts(SyntheticProtocol_Count);
+
+        layouts[SyntheticProtocol_Xbox360] = MakeLayout("xbox360", "xbox360", 0x045e, 0x028e, 1, false,
+                                                        {MakeInterface(0, USB_CLASS_VENDOR_SPEC, 0x5D, 0x01, {{0x81, 32, 4}, {0x01, 32, 8}})});
+
+        // The receiver has a second interface per pad (Headset, protocol 0x82) not used by the driver
+        layouts[SyntheticProtocol_Xbox360Wireless] = MakeLayout("xbox360w", "xbox360w", 0x045e, 0x0719, 4, false,
+                                                                {MakeInterface(0, USB_CLASS_VENDOR_SPEC, 0x5D, 0x81, {{0x81, 32, 1}, {0x01, 32, 8}}),
+                                                                 MakeInterface(2, USB_CLASS_VENDOR_SPEC, 0x5D, 0x81, {{0x83, 32, 1}, {0x03, 32, 8}}),
+                                                                 MakeInterface(4, USB_CLASS_VENDOR_SPEC, 0x5D, 0x81, {{0x85, 32, 1}, {0x05, 32, 8}}),
+                                                                 MakeInterface(6, USB_CLASS_VENDOR_SPEC, 0x5D, 0x81, {{0x87, 32, 1}, {0x07, 32, 8}})});
+
+        layouts[SyntheticProtocol_XboxOne] = MakeLayout("xboxone", "xboxone", 0x045e, 0x02ea, 1, false,
+                                                        {MakeInterface(0, USB_CLASS_VENDOR_SPEC, 0x47, 0xD0, {{0x81, 64, 4}, {0x01, 64, 4}})});
+
+        layouts[SyntheticProtocol_Dualshock3] = MakeLayout("dualshock3", "dualshock3", 0x054c, 0x0268, 1, false,
+                                                           {MakeInterface(0, USB_CLASS_HID, 0x00, 0x00, {{0x81, 64, 1}, {0x02, 64, 1}})});
+
+        layouts[SyntheticProtocol_Switch] = MakeLayout("switch", "switch", 0x057e, 0x2009, 1, false,
+                                                       {MakeInterface(0, USB_CLASS_HID, 0x00, 0x00, {{0x81, 64, 8}, {0x01, 64, 8}})});
+
+        layouts[SyntheticProtocol_WiiU] = MakeLayout("wiiu", "wii", 0x057e, 0x0337, 4, true,
+                                                     {MakeInterface(0, USB_CLASS_HID, 0x00, 0x00, {{0x81, 37, 8}, {0x02, 5, 8}})});
+
+        layouts[SyntheticProtocol_Steam2026] = MakeLayout("steam2026", "steam2026", 0x28de, 0x1302, 1, false,
+                                                          {MakeInterface(0, USB_CLASS_HID, 0x00, 0x00, {{0x81, 64, 1}})});
+
+        // The fifth interface is the dongle itself, it never sends input reports
+        layouts[SyntheticProtocol_Steam2026Puck] = MakeLayout("steam2026puck", "steam2026", 0x28de, 0x1304, 4, false,
+                                                              {MakeInterface(0, USB_CLASS_HID, 0x00, 0x00, {{0x81, 64, 1}}),
+                                                               MakeInterface(1, USB_CLASS_HID, 0x00, 0x00, {{0x82, 64, 1}}),
+                                                               MakeInterface(2, USB_CLASS_HID, 0x00, 0x00, {{0x83, 64, 1}}),
+                                                               MakeInterface(3, USB_CLASS_HID, 0x00, 0x00, {{0x84, 64, 1}}),
+                                                               MakeInterface(4, USB_CLASS_HID, 0x00, 0x00, {{0x85, 64, 1}})});
+
+        return layouts;
+    }
+
+    // Inverse of BaseController::Normalize
+    int32_t Denormalize(float value, int32_t min, int32_t max, int32_t center)
+    {
+        value = std::clamp(value, -1.0f, 1.0f);
+        float range = (value < 0) ? (float)(center - min) : (float)(max - center);
+        return center + static_cast<int32_t>(std::lround(value * range));
+    }
+
+    int32_t Denormalize(float value, int32_t min, int32_t max)
+    {
+        return Denormalize(value, min, max, (max + min) / 2);
+    }
+
+    // Axis decoded as Normalize(-raw): -32768 can't be negated in 16 bits
+    int16_t DenormalizeInverted16(float value)
+    {
+        return static_cast<int16_t>(std::max(-Denormalize(value, -32768, 32767), -32768));
+    }
+
+    void EncodeXbox360Data(const RawInputData &input, uint8_t *buffer)
+    {
+        Xbox360ButtonData *data = reinterpret_cast<Xbox360ButtonData *>(buffer);
+        data->type = XBOX360INPUT_BUTTON;
+
+        data->dpad_up = input.buttons[DPAD_UP_BUTTON_ID];
+        data->dpad_down = input.buttons[DPAD_DOWN_BUTTON_ID];
+        data->dpad_left = input.buttons[DPAD_LEFT_BUTTON_ID];
+        data->dpad_right = input.buttons[DPAD_RIGHT_BUTTON_ID];
+
+        data->button1 = input.buttons[1];
+        data->button2 = input.buttons[2];
+        data->button3 = input.buttons[3];
+        data->button4 = input.buttons[4];
+        data->button5 = input.buttons[5];
+        data->button6 = input.buttons[6];
+        data->button7 = input.buttons[7];
+        data->button8 = input.buttons[8];
+        data->button9 = input.buttons[9];
+        data->button10 = input.buttons[10];
+        data->button11 = input.buttons[11];
+
+        data->Rx = Denormalize(input.analog[ControllerAnalogType_Rx], 0, 255);
+        data->Ry = Denormalize(input.analog[ControllerAnalogType_Ry], 0, 255);
+        data->X = Denormalize(input.analog[ControllerAnalogType_X], -32768, 32767);
+        data->Y = DenormalizeInverted16(input.analog[ControllerAnalogType_Y]);
+        data->Z = Denormalize(input.analog[ControllerAnalogType_Z], -32768, 32767);
+        data->Rz = DenormalizeInverted16(input.analog[ControllerAnalogType_Rz]);
+    }
+
+    size_t EncodeXbox360(const SyntheticPadState &pad, uint8_t *buffer)
+    {
+        if (!pad.connected)
+            return 0;
+
+        memset(buffer, 0, 20);
+        EncodeXbox360Data(pad.input, buffer);
+        buffer[1] = 20;
+        return 20;
+    }
+
+    size_t EncodeXbox360Wireless(const SyntheticPadState &pad, uint8_t *buffer)
+    {
+        if (!pad.connected)
+            return 0;
+
+        memset(buffer, 0, 29);
+        buffer[1] = 0x01;
+        buffer[3] = 0xf0;
+        EncodeXbox360Data(pad.input, buffer + 4);
+        buffer[5] = 0x13;
+        return 29;
+    }
+
+    size_t EncodeXboxOne(const SyntheticPadState &pad, const SyntheticPadState &previous, uint8_t sequence, uint8_t *buffer)
+    {
+        if (!pad.connected)
+            return 0;
+
+        // Home button: GIP_CMD_VIRTUAL_KEY report, sent instead of the input report when it changes
+        if (pad.input.buttons[12] != previous.input.buttons[12])
+        {
+            const uint8_t virtualKey[] = {0x07, 0x20, sequence, 0x02, (uint8_t)(pad.input.buttons[12] ? 0x01 : 0x00), 0x5b};
+            memcpy(buffer, virtualKey, sizeof(virtualKey));
+            return sizeof(virtualKey);
+        }
+
+        memset(buffer, 0, sizeof(XboxOneButtonData));
+        XboxOneButtonData *data = reinterpret_cast<XboxOneButtonData *>(buffer);
+        data->type = 0x20;
+        data->id = sequence | (0x0e << 8); // Sequence and payload length
+
+        data->dpad_up = pad.input.buttons[DPAD_UP_BUTTON_ID];
+        data->dpad_down = pad.input.buttons[DPAD_DOWN_BUTTON_ID];
+        data->dpad_left = pad.input.buttons[DPAD_LEFT_BUTTON_ID];
+        data->dpad_right = pad.input.buttons[DPAD_RIGHT_BUTTON_ID];
+
+        data->button1 = pad.input.buttons[1];
+        data->button2 = pad.input.buttons[2];
+        data->button3 = pad.input.buttons[3];
+        data->button4 = pad.input.buttons[4];
+        data->button5 = pad.input.buttons[5];
+        data->button6 = pad.input.buttons[6];
+        data->button7 = pad.input.buttons[7];
+        data->button8 = pad.input.buttons[8];
+        data->button9 = pad.input.buttons[9];
+        data->button10 = pad.input.buttons[10];
+        data->button11 = pad.input.buttons[11];
+
+        data->trigger_left = Denormalize(pad.input.analog[ControllerAnalogType_Rx], 0, 1023);
+        data->trigger_right = Denormalize(pad.input.analog[ControllerAnalogType_Ry], 0, 1023);
+        data->stick_left_x = Denormalize(pad.input.analog[ControllerAnalogType_X], -32768, 32767);
+        data->stick_left_y = DenormalizeInverted16(pad.input.analog[ControllerAnalogType_Y]);
+        data->stick_right_x = Denormalize(pad.input.analog[ControllerAnalogType_Z], -32768, 32767);
+        data->stick_right_y = DenormalizeInverted16(pad.input.analog[ControllerAnalogType_Rz]);
+
+        return sizeof(XboxOneButtonData);
+    }
+
+    size_t EncodeDualshock3(const SyntheticPadState &pad, uint8_t *buffer)
+    {
+        if (!pad.connected)
+            return 0;
+
+        memset(buffer, 0, sizeof(Dualshock3ButtonData));
+        Dualshock3ButtonData *data = reinterpret_cast<Dualshock3ButtonData *>(buffer);
+        data->type = Ds3InputPacket_Button;
+
+        data->dpad_up = pad.input.buttons[DPAD_UP_BUTTON_ID];
+        data->dpad_right = pad.input.buttons[DPAD_RIGHT_BUTTON_ID];
+        data->dpad_down = pad.input.buttons[DPAD_DOWN_BUTTON_ID];
+        data->dpad_left = pad.input.buttons[DPAD_LEFT_BUTTON_ID];
+
+        data->button1 = pad.input.buttons[1];
+        data->button2 = pad.input.buttons[2];
+        data->button3 = pad.input.buttons[3];
+        data->button4 = pad.input.buttons[4];
+        data->button5 = pad.input.buttons[5];
+        data->button6 = pad.input.buttons[6];
+        data->button7 = pad.input.buttons[7];
+        data->button8 = pad.input.buttons[8];
+        data->button9 = pad.input.buttons[9];
+        data->button10 = pad.input.buttons[10];
+        data->button11 = pad.input.buttons[11];
+        data->button12 = pad.input.buttons[12];
+        data->button13 = pad.input.buttons[13];
+
+        data->X = Denormalize(pad.input.analog[ControllerAnalogType_X], 0, 255);
+        data->Y = Denormalize(pad.input.analog[ControllerAnalogType_Y], 0, 255);
+        data->Z = Denormalize(pad.input.analog[ControllerAnalogType_Z], 0, 255);
+        data->Rz = Denormalize(pad.input.analog[ControllerAnalogType_Rz], 0, 255);
+        data->Rx = Denormalize(pad.input.analog[ControllerAnalogType_Rx], 0, 255);
+        data->Ry = Denormalize(pad.input.analog[ControllerAnalogType_Ry], 0, 255);
+
+        return sizeof(Dualshock3ButtonData);
+    }
+
+    // 12 bits X and Y packed in 3 bytes (Centered on 2000, the default calibration of the driver is 600 to 3400)
+    void EncodeSwitchStick(float x, float y, uint8_t *out)
+    {
+        uint16_t raw_x = Denormalize(x, 600, 3400, 2000);
+        uint16_t raw_y = Denormalize(-y, 600, 3400, 2000);
+
+        out[0] = raw_x & 0xFF;
+        out[1] = ((raw_x >> 8) & 0x0F) | ((raw_y & 0x0F) << 4);
+        out[2] = (raw_y >> 4) & 0xFF;
+    }
+
+    size_t EncodeSwitch(const SyntheticPadState &pad, uint8_t sequence, uint8_t *buffer)
+    {
+        if (!pad.connected)
+            return 0;
+
+        memset(buffer, 0, 64);
+        SwitchButtonData *data = reinterpret_cast<SwitchButtonData *>(buffer);
+        data->report_id = 0x30;
+        data->timer = sequence;
+        data->bat_con = 0x91; // Full battery, USB powered
+
+        data->button1 = pad.input.buttons[1];
+        data->button2 = pad.input.buttons[2];
+        data->button3 = pad.input.buttons[3];
+        data->button4 = pad.input.buttons[4];
+        data->button5 = pad.input.buttons[5];
+        data->button6 = pad.input.buttons[6];
+        data->button7 = pad.input.buttons[7];
+        data->button8 = pad.input.buttons[8];
+        data->button9 = pad.input.buttons[9];
+        data->button10 = pad.input.buttons[10];
+        data->button11 = pad.input.buttons[11];
+        data->button12 = pad.input.buttons[12];
+        data->button13 = pad.input.buttons[13];
+        data->button14 = pad.input.buttons[14];
+        data->button15 = pad.input.buttons[15];
+        data->button16 = pad.input.buttons[16];
+        data->button17 = pad.input.buttons[17];
+        data->button18 = pad.input.buttons[18];
+        data->button19 = pad.input.buttons[19];
+
+        data->dpad_up = pad.input.buttons[DPAD_UP_BUTTON_ID];
+        data->dpad_down = pad.input.buttons[DPAD_DOWN_BUTTON_ID];
+        data->dpad_left = pad.input.buttons[DPAD_LEFT_BUTTON_ID];
+        data->dpad_right = pad.input.buttons[DPAD_RIGHT_BUTTON_ID];
+
+        EncodeSwitchStick(pad.input.analog[ControllerAnalogType_X], pad.input.analog[ControllerAnalogType_Y], data->stick_left);
+        EncodeSwitchStick(pad.input.analog[ControllerAnalogType_Z], pad.input.analog[ControllerAnalogType_Rz], data->stick_right);
+
+        return 64;
+    }
+
+    size_t EncodeWiiU(const SyntheticPadState *pads, uint16_t padCount, uint8_t *buffer)
+    {
+        memset(buffer, 0, WII_INPUT_BUFFER_SIZE);
+        buffer[0] = 0x21;
+
+        for (uint16_t i = 0; i < std::min<uint16_t>(padCount, WII_MAX_INPUTS); i++)
+        {
+            const SyntheticPadState &pad = pads[i];
+            uint8_t *port = &buffer[1 + i * 9];
+            if (!pad.connected)
+                continue;
+
+            uint16_t buttons = 0;
+            for (int j = 0; j < 16; j++)
+            {
+                if (pad.input.buttons[j + 1])
+                    buttons |= (1 << j);
+            }
+
+            port[0] = 0x14; // STATE_NORMAL | STATE_EXTRA_POWER
+            port[1] = buttons & 0xFF;
+            port[2] = buttons >> 8;
+            port[3] = Denormalize(pad.input.analog[ControllerAnalogType_X], 0, 255);
+            port[4] = Denormalize(pad.input.analog[ControllerAnalogType_Y], 0, 255);
+            port[5] = Denormalize(pad.input.analog[ControllerAnalogType_Rx], 0, 255);
+            port[6] = Denormalize(pad.input.analog[ControllerAnalogType_Ry], 0, 255);
+            port[7] = Denormalize(pad.input.analog[ControllerAnalogType_Z], 0, 255);
+            port[8] = Denormalize(pad.input.analog[ControllerAnalogType_Rz], 0, 255);
+        }
+
+        return WII_INPUT_BUFFER_SIZE;
+    }
+
+    size_t EncodeSteam2026(const SyntheticPadState &pad, uint8_t sequence, uint8_t *buffer)
+    {
+        if (!pad.connected)
+            return 0;
+
+        memset(buffer, 0, 64);
+        Steam2026InputReport *data = reinterpret_cast<Steam2026InputReport *>(buffer);
+        data->report_id = REPORT_INPUT;
+        data->seq_num = sequence;
+
+        data->buttons.a = pad.input.buttons[1];
+        data->buttons.b = pad.input.buttons[2];
+        data->buttons.y = pad.input.buttons[3];
+        data->buttons.x = pad.input.buttons[4];
+        data->buttons.l1 = pad.input.buttons[5];
+        data->buttons.r1 = pad.input.buttons[6];
+        data->buttons.l2 = pad.input.buttons[7];
+        data->buttons.r2 = pad.input.buttons[8];
+        data->buttons.view = pad.input.buttons[9];
+        data->buttons.menu = pad.input.buttons[10];
+        data->buttons.quickaccess = pad.input.buttons[11];
+        data->buttons.steam = pad.input.buttons[12];
+        data->buttons.lstick = pad.input.buttons[13];
+        data->buttons.rstick = pad.input.buttons[14];
+
+        data->buttons.dpad_up = pad.input.buttons[DPAD_UP_BUTTON_ID];
+        data->buttons.dpad_right = pad.input.buttons[DPAD_RIGHT_BUTTON_ID];
+        data->buttons.dpad_down = pad.input.buttons[DPAD_DOWN_BUTTON_ID];
+        data->buttons.dpad_left = pad.input.buttons[DPAD_LEFT_BUTTON_ID];
+
+        data->left_trigger = Denormalize(pad.input.analog[ControllerAnalogType_Rx], 0, 32767);
+        data->right_trigger = Denormalize(pad.input.analog[ControllerAnalogType_Ry], 0, 32767);
+        data->left_stick_x = Denormalize(pad.input.analog[ControllerAnalogType_X], -32768, 32767);
+        data->left_stick_y = DenormalizeInverted16(pad.input.analog[ControllerAnalogType_Y]);
+        data->right_stick_x = Denormalize(pad.input.analog[ControllerAnalogType_Z], -32768, 32767);
+        data->right_stick_y = DenormalizeInverted16(pad.input.analog[ControllerAnalogType_Rz]);
+
+        return 64;
+    }
+} // namespace
+
+const SyntheticLayout &GetSyntheticLayout(SyntheticProtocol protocol)
+{
+    static const std::vector<SyntheticLayout> layouts = MakeLayouts();
+    return layouts[protocol];
+}
+
+bool FindSyntheticProtocol(const std::string &name, SyntheticProtocol *protocol)
+{
+    for (int i = 0; i < SyntheticProtocol_Count; i++)
+    {
+        if (name == GetSyntheticLayout(static_cast<SyntheticProtocol>(i)).name)
+        {
+            *protocol = static_cast<SyntheticProtocol>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t EncodeSyntheticReport(SyntheticProtocol protocol, const SyntheticPadState *pads, const SyntheticPadState *previous, uint16_t padCount, uint8_t sequence, uint8_t *buffer)
+{
+    switch (protocol)
+    {
+        case SyntheticProtocol_Xbox360:
+            return EncodeXbox360(pads[0], buffer);
+        case SyntheticProtocol_Xbox360Wireless:
+            return EncodeXbox360Wireless(pads[0], buffer);
+        case SyntheticProtocol_XboxOne:
+            return EncodeXboxOne(pads[0], previous[0], sequence, buffer);
+        case SyntheticProtocol_Dualshock3:
+            return EncodeDualshock3(pads[0], buffer);
+        case SyntheticProtocol_Switch:
+            return EncodeSwitch(pads[0], sequence, buffer);
+        case SyntheticProtocol_WiiU:
+            return EncodeWiiU(pads, padCount, buffer);
+        case SyntheticProtocol_Steam2026:
+        case SyntheticProtocol_Steam2026Puck:
+            return EncodeSteam2026(pads[0], sequence, buffer);
+        default:
+            return 0;
+    }
+}
+
+size_t EncodeSyntheticStatus(SyntheticProtocol protocol, bool connected, uint8_t *buffer)
+{
+    if (protocol == SyntheticProtocol_Xbox360Wireless)
+    {
+        buffer[0] = 0x08;
+        buffer[1] = connected ? 0x80 : 0x00;
+        return 2;
+    }
+    else if (protocol == SyntheticProtocol_Steam2026Puck)
+    {
+        buffer[0] = REPORT_WIRELESS_STATUS;
+        buffer[1] = connected ? 0x02 : 0x01;
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "ReplayCapture.h"
+#include "Controllers/BaseController.h"
+#include <string>
+#include <vector>
+
+/*
+ * Devices and reports generated by SyntheticUSBDevice, one per built-in driver
+ *
+ * A pad state is given as the driver decodes it (RawInputData: buttons numbered as in config.ini, analogs from -1.0 to 1.0),
+ * the report is built so that ParseData returns the same state (Within the resolution of the protocol).
+ * Buttons and analogs not reported by a protocol are ignored.
+ */
+
+enum SyntheticProtocol : uint8_t
+{
+    SyntheticProtocol_Xbox360 = 0,     // Xbox 360 wired controller
+    SyntheticProtocol_Xbox360Wireless, // Xbox 360 wireless receiver (4 pads, one interface per pad)
+    SyntheticProtocol_XboxOne,         // Xbox One controller (GIP)
+    SyntheticProtocol_Dualshock3,      // Dualshock 3
+    SyntheticProtocol_Switch,          // Switch Pro controller (Report 0x30, after the USB handshake)
+    SyntheticProtocol_WiiU,            // Wii U GameCube adapter (Report 0x21, 4 ports in each report)
+    SyntheticProtocol_Steam2026,       // Steam Controller (2026) wired
+    SyntheticProtocol_Steam2026Puck,   // Steam Controller (2026) wireless dongle (4 pads, one interface per pad)
+
+    SyntheticProtocol_Count
+};
+
+#define SYNTHETIC_MAX_PADS        4
+#define SYNTHETIC_MAX_REPORT_SIZE 64
+
+class SyntheticPadState
+{
+public:
+    bool connected = true; // Disconnected: Wireless protocols report it, wired ones stop sending reports
+    RawInputData input;
+};
+
+class SyntheticLayout
+{
+public:
+    const char *name = "";   // Name of the protocol (Command lines)
+    const char *driver = ""; // config.driver of the matching driver
+    uint16_t vendor_id = 0;
+    uint16_t product_id = 0;
+    uint16_t max_pads = 1;
+    bool shared_report = false; // All the pads are in each report of the first IN endpoint, otherwise one IN endpoint per pad
+    std::vector<ReplayInterface> interfaces;
+};
+
+// Layout of the device emulated for 'protocol'
+const SyntheticLayout &GetSyntheticLayout(SyntheticProtocol protocol);
+
+// Protocol from its name, return false if unknown
+bool FindSyntheticProtocol(const std::string &name, SyntheticProtocol *protocol);
+
+/*
+ * Build the input report of 'pads' (padCount pads if the report is shared, 1 otherwise) in 'buffer'
+ * 'previous' is the state of the previous report (Some protocols send changes in their own report, e.g. XboxOne home button)
+ * 'sequence' is incremented by the caller for each report.
+ * Return the size of the report, 0 if nothing has to be sent (e.g. wired pad disconnected)
+ */
+size_t EncodeSyntheticReport(SyntheticProtocol protocol, const SyntheticPadState *pads, const SyntheticPadState *previous, uint16_t padCount, uint8_t sequence, uint8_t *buffer);
+
+// Build the connection status report of a pad, return 0 if the protocol has none
+size_t EncodeSyntheticStatus(SyntheticProtocol protocol, bool connected, uint8_t *buffer);
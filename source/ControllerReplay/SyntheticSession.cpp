@@ -0,0 +1,307 @@
+#include "SyntheticSession.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+void DefaultSyntheticScript(uint16_t pad, uint64_t report_idx, SyntheticPadState *state)
+{
+    double angle = (2.0 * M_PI * (report_idx % 1000)) / 1000.0 + pad * (M_PI / 2);
+    float trigger = (report_idx % 256) / 127.5f - 1.0f;
+
+    state->connected = true;
+    state->input.analog[ControllerAnalogType_X] = std::cos(angle);
+    state->input.analog[ControllerAnalogType_Y] = std::sin(angle);
+    state->input.analog[ControllerAnalogType_Z] = std::sin(angle);
+    state->input.analog[ControllerAnalogType_Rz] = std::cos(angle);
+    state->input.analog[ControllerAnalogType_Rx] = trigger;
+    state->input.analog[ControllerAnalogType_Ry] = -trigger;
+    state->input.buttons[1 + (report_idx / 64) % 12] = true;
+}
+
+SyntheticSession::SyntheticSession(const SyntheticOptions &options)
+    : m_options(options),
+      m_layout(GetSyntheticLayout(options.protocol)),
+      m_interval_us(1000000 / std::max<uint32_t>(options.rate_hz, 1)),
+      m_random(options.seed),
+      m_start(std::chrono::steady_clock::now())
+{
+    m_options.pads = std::clamp<uint16_t>(m_options.pads, 1, m_layout.max_pads);
+    m_options.burst = std::max<uint16_t>(m_options.burst, 1);
+    m_options.queue_depth = std::max<uint16_t>(m_options.queue_depth, 1);
+    if (!m_options.script)
+        m_options.script = DefaultSyntheticScript;
+
+    // One stream per IN endpoint sending reports: The first one for shared reports, the first of each interface otherwise
+    uint16_t streamCount = m_layout.shared_report ? 1 : m_options.pads;
+    for (uint16_t i = 0; i < streamCount && i < m_layout.interfaces.size(); i++)
+    {
+        for (const IUSBEndpoint::EndpointDescriptor &descriptor : m_layout.interfaces[i].endpoints)
+        {
+            if ((descriptor.bEndpointAddress & IUSBEndpoint::USB_ENDPOINT_IN) == 0)
+                continue;
+
+            Stream stream;
+            stream.endpoint = descriptor.bEndpointAddress;
+            stream.first_pad = m_layout.shared_report ? 0 : i;
+            stream.pad_count = m_layout.shared_report ? m_options.pads : 1;
+            stream.queue.resize(m_options.queue_depth);
+            m_streams.push_back(std::move(stream));
+            break;
+        }
+    }
+}
+
+uint64_t SyntheticSession::Now()
+{
+    if (!m_options.realtime)
+        return m_virtual_us;
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+uint64_t SyntheticSession::GetTimeUs()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Now();
+}
+
+void SyntheticSession::Start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // The Switch Pro controller waits for the handshake
+    if (m_options.protocol == SyntheticProtocol_Switch)
+        return;
+
+    uint64_t now_us = Now();
+    for (Stream &stream : m_streams)
+        Activate(stream, now_us);
+}
+
+void SyntheticSession::Activate(Stream &stream, uint64_t now_us)
+{
+    if (stream.active)
+        return;
+
+    stream.active = true;
+    stream.start_us = now_us;
+    stream.next_report = 0;
+    stream.next_due_us = now_us;
+}
+
+uint64_t SyntheticSession::DueTime(uint64_t report)
+{
+    uint64_t due_us = (report / m_options.burst) * m_options.burst * m_interval_us;
+    if (m_options.jitter_us != 0)
+        due_us += m_random() % (m_options.jitter_us + 1);
+
+    return due_us;
+}
+
+SyntheticSession::Stream *SyntheticSession::FindStream(uint8_t endpoint)
+{
+    for (Stream &stream : m_streams)
+    {
+        if (stream.endpoint == endpoint)
+            return &stream;
+    }
+
+    return nullptr;
+}
+
+void SyntheticSession::Push(Stream &stream, const uint8_t *data, size_t size)
+{
+    // Full: The oldest report is lost
+    if (stream.count == stream.queue.size())
+    {
+        stream.head = (stream.head + 1) % stream.queue.size();
+        stream.count--;
+        m_stats.reports_dropped++;
+    }
+
+    Report &report = stream.queue[(stream.head + stream.count) % stream.queue.size()];
+    memcpy(report.data, data, size);
+    report.size = static_cast<uint8_t>(size);
+    stream.count++;
+}
+
+bool SyntheticSession::Pop(Stream &stream, uint8_t *outBuffer, size_t *bufferSizeInOut)
+{
+    if (stream.count == 0)
+        return false;
+
+    const Report &report = stream.queue[stream.head];
+    size_t size = std::min<size_t>(*bufferSizeInOut, report.size);
+    memcpy(outBuffer, report.data, size);
+    *bufferSizeInOut = size;
+
+    stream.head = (stream.head + 1) % stream.queue.size();
+    stream.count--;
+    m_stats.reports_read++;
+    return true;
+}
+
+void SyntheticSession::Generate(Stream &stream, uint64_t now_us)
+{
+    if (!stream.active)
+        return;
+
+    uint8_t buffer[SYNTHETIC_MAX_REPORT_SIZE];
+
+    while (stream.next_due_us <= now_us && (m_options.report_limit == 0 || stream.next_report < m_options.report_limit))
+    {
+        for (uint16_t i = 0; i < stream.pad_count; i++)
+        {
+            stream.previous[i] = stream.state[i];
+            stream.state[i] = SyntheticPadState();
+            m_options.script(stream.first_pad + i, stream.next_report, &stream.state[i]);
+        }
+
+        // Wireless pads: Connection status queued right before the input report, for the first report and on each change
+        for (uint16_t i = 0; i < stream.pad_count; i++)
+        {
+            if (stream.status_sent[i] && stream.previous[i].connected == stream.state[i].connected)
+                continue;
+
+            size_t size = EncodeSyntheticStatus(m_options.protocol, stream.state[i].connected, buffer);
+            if (size != 0)
+                Push(stream, buffer, size);
+            stream.status_sent[i] = true;
+        }
+
+        size_t size = EncodeSyntheticReport(m_options.protocol, stream.state, stream.previous, stream.pad_count, stream.sequence++, buffer);
+        if (size != 0)
+        {
+            Push(stream, buffer, size);
+            m_stats.reports_generated++;
+        }
+
+        stream.next_report++;
+        stream.next_due_us = std::max(stream.next_due_us, stream.start_us + DueTime(stream.next_report));
+    }
+}
+
+ControllerResult SyntheticSession::Read(uint8_t endpoint, uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    Stream *stream = FindStream(endpoint);
+    uint64_t now_us = Now();
+    if (stream != nullptr)
+    {
+        Generate(*stream, now_us);
+        if (Pop(*stream, outBuffer, bufferSizeInOut))
+            return CONTROLLER_STATUS_SUCCESS;
+    }
+
+    if (aTimeoutUs == 0)
+        return CONTROLLER_STATUS_TIMEOUT;
+
+    // Nothing will come (Silent endpoint, handshake not done, or report_limit reached): An infinite wait never ends
+    bool pending = stream != nullptr && stream->active && (m_options.report_limit == 0 || stream->next_report < m_options.report_limit);
+    uint64_t wait_us = pending ? stream->next_due_us - now_us : UINT64_MAX;
+
+    if (!pending || wait_us > aTimeoutUs)
+    {
+        if (aTimeoutUs == UINT64_MAX)
+            return CONTROLLER_STATUS_TIMEOUT;
+
+        if (!m_options.realtime)
+        {
+            m_virtual_us += aTimeoutUs;
+            return CONTROLLER_STATUS_TIMEOUT;
+        }
+
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(aTimeoutUs));
+        return CONTROLLER_STATUS_TIMEOUT;
+    }
+
+    if (!m_options.realtime)
+    {
+        m_virtual_us += wait_us;
+        Generate(*stream, m_virtual_us);
+        return Pop(*stream, outBuffer, bufferSizeInOut) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+    }
+
+    lock.unlock();
+
+    // Only one reader per endpoint: The stream can't be read while waiting
+    std::this_thread::sleep_until(m_start + std::chrono::microseconds(now_us + wait_us));
+
+    lock.lock();
+    Generate(*stream, Now());
+    return Pop(*stream, outBuffer, bufferSizeInOut) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+}
+
+ControllerResult SyntheticSession::Write(uint8_t endpoint, const uint8_t *inBuffer, size_t bufferSize)
+{
+    (void)endpoint;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_stats.writes++;
+
+    if (m_options.protocol == SyntheticProtocol_Switch && bufferSize >= 2 && inBuffer[0] == 0x80 && !m_streams.empty())
+    {
+        if (inBuffer[1] == 0x02) // Handshake: Answered
+        {
+            const uint8_t answer[] = {0x81, 0x02};
+            Push(m_streams[0], answer, sizeof(answer));
+        }
+        else if (inBuffer[1] == 0x04) // USB only: Input reports start
+        {
+            Activate(m_streams[0], Now());
+        }
+    }
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult SyntheticSession::ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength)
+{
+    (void)bmRequestType;
+    (void)bmRequest;
+    (void)wValue;
+    (void)wIndex;
+    (void)buffer;
+    (void)wLength;
+
+    return CONTROLLER_STATUS_READ_FAILED;
+}
+
+ControllerResult SyntheticSession::ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength)
+{
+    (void)bmRequestType;
+    (void)bmRequest;
+    (void)wValue;
+    (void)wIndex;
+    (void)buffer;
+    (void)wLength;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.writes++;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+bool SyntheticSession::IsFinished()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_options.report_limit == 0)
+        return false;
+
+    for (const Stream &stream : m_streams)
+    {
+        if (!stream.active || stream.next_report < m_options.report_limit || stream.count != 0)
+            return false;
+    }
+
+    return true;
+}
+
+SyntheticStats SyntheticSession::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "SyntheticProtocol.h"
+#include "USBSession.h"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <random>
+
+// State of 'pad' for its report 'report_idx' (Counted per pad, from 0)
+using SyntheticScript = std::function<void(uint16_t pad, uint64_t report_idx, SyntheticPadState *state)>;
+
+class SyntheticOptions
+{
+public:
+    SyntheticProtocol protocol = SyntheticProtocol_Xbox360;
+    uint16_t pads = 1;         // Pads connected, up to the max of the protocol
+    uint32_t rate_hz = 1000;   // Reports per second and per IN endpoint (Per pad, or per adapter for shared reports)
+    uint32_t jitter_us = 0;    // Each report is delayed by a random 0 to jitter_us
+    uint16_t burst = 1;        // Reports sent back to back (Same time), the average rate is kept
+    uint16_t queue_depth = 8;  // Reports kept by the host until read, the oldest are dropped
+    uint64_t report_limit = 0; // Reports per IN endpoint, 0: Unlimited
+    bool realtime = true;      // false: Virtual clock, a blocking read returns the next report immediately
+    uint32_t seed = 1;         // Random generator of the jitter: Same seed, same timing
+    SyntheticScript script;    // nullptr: DefaultSyntheticScript
+};
+
+class SyntheticStats
+{
+public:
+    uint64_t reports_generated = 0; // Input reports (Connection status not counted)
+    uint64_t reports_read = 0;
+    uint64_t reports_dropped = 0; // Not read before queue_depth newer reports
+    uint64_t writes = 0;          // Interrupt and control writes
+};
+
+// Sticks turning, triggers ramping and one button pressed after the other (Every 64 reports)
+void DefaultSyntheticScript(uint16_t pad, uint64_t report_idx, SyntheticPadState *state);
+
+/*
+ * Generator shared by a SyntheticUSBDevice and all its interfaces and endpoints
+ *
+ * Each IN endpoint sends a report every 1/rate_hz (Grouped by 'burst', delayed by the jitter), starting when the device
+ * is opened. Reports are generated when due and queued until read, like the host controller does with posted transfers.
+ * With a virtual clock, the time only advances when a blocking read waits for the next report (Or times out):
+ * runs are reproducible and as fast as possible.
+ *
+ * Protocols handshakes: The Switch Pro controller only sends its input reports after the 0x80 0x04 command (USB only),
+ * the 0x80 0x02 command is answered. Control transfers are accepted and ignored.
+ * Wireless receivers send the connection status of a pad right before its first input report and on each change.
+ */
+class SyntheticSession : public USBSession
+{
+public:
+    SyntheticSession(const SyntheticOptions &options);
+
+    void Start();
+
+    ControllerResult Read(uint8_t endpoint, uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) override;
+    ControllerResult Write(uint8_t endpoint, const uint8_t *inBuffer, size_t bufferSize) override;
+
+    ControllerResult ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength) override;
+    ControllerResult ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength) override;
+
+    // All the reports were read (Only with a report_limit)
+    bool IsFinished();
+    SyntheticStats GetStats();
+
+    // Time of the session clock (Virtual or real), in us since the creation of the session
+    uint64_t GetTimeUs();
+
+private:
+    class Report
+    {
+    public:
+        uint8_t data[SYNTHETIC_MAX_REPORT_SIZE];
+        uint8_t size = 0;
+    };
+
+    class Stream
+    {
+    public:
+        uint8_t endpoint = 0;
+        uint16_t first_pad = 0;
+        uint16_t pad_count = 0; // Pads in each report
+        bool active = false;
+        uint64_t start_us = 0;
+        uint64_t next_report = 0; // Index of the next report to generate
+        uint64_t next_due_us = 0;
+        uint8_t sequence = 0;
+
+        SyntheticPadState state[SYNTHETIC_MAX_PADS];
+        SyntheticPadState previous[SYNTHETIC_MAX_PADS];
+        bool status_sent[SYNTHETIC_MAX_PADS] = {};
+
+        std::vector<Report> queue; // Ring buffer of queue_depth reports
+        size_t head = 0;
+        size_t count = 0;
+    };
+
+    uint64_t Now();
+    Stream *FindStream(uint8_t endpoint);
+    void Activate(Stream &stream, uint64_t now_us);
+    uint64_t DueTime(uint64_t report);
+    void Push(Stream &stream, const uint8_t *data, size_t size);
+    void Generate(Stream &stream, uint64_t now_us);
+    bool Pop(Stream &stream, uint8_t *outBuffer, size_t *bufferSizeInOut);
+
+    SyntheticOptions m_options;
+    const SyntheticLayout &m_layout;
+    uint64_t m_interval_us;
+
+    std::mutex m_mutex;
+    SyntheticStats m_stats;
+    std::vector<Stream> m_streams;
+    std::mt19937 m_random;
+
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_virtual_us = 0;
+};
@@ -0,0 +1,28 @@
+#include "SyntheticUSBDevice.h"
+
+SyntheticUSBDevice::SyntheticUSBDevice(const SyntheticOptions &options)
+    : m_session(std::make_shared<SyntheticSession>(options))
+{
+    const SyntheticLayout &layout = GetSyntheticLayout(options.protocol);
+    m_vendorID = layout.vendor_id;
+    m_productID = layout.product_id;
+
+    for (const ReplayInterface &interface : layout.interfaces)
+        m_interfaces.push_back(std::make_unique<ReplayUSBInterface>(m_session, interface));
+}
+
+ControllerResult SyntheticUSBDevice::Open()
+{
+    m_session->Start();
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+void SyntheticUSBDevice::Close()
+{
+    for (auto &&interface : m_interfaces)
+        interface->Close();
+}
+
+void SyntheticUSBDevice::Reset()
+{
+}
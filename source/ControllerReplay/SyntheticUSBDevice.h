@@ -0,0 +1,32 @@
+#pragma once
+#include "IUSBDevice.h"
+#include "ReplayUSBInterface.h"
+#include "SyntheticSession.h"
+
+/*
+ * IUSBDevice generating the reports of a built-in protocol (See SyntheticProtocol.h and SyntheticSession.h)
+ * Rates, pad counts and timings real hardware can't reach, for stress tests and benchmarks of the drivers and the polling:
+ *
+ *   SyntheticOptions options;
+ *   options.protocol = SyntheticProtocol_Xbox360Wireless;
+ *   options.pads = 4;
+ *   options.rate_hz = 8000;
+ *   options.jitter_us = 200;
+ *   Xbox360WirelessController controller(std::make_unique<SyntheticUSBDevice>(options), config, std::move(logger));
+ */
+class SyntheticUSBDevice : public IUSBDevice
+{
+private:
+    std::shared_ptr<SyntheticSession> m_session;
+
+public:
+    SyntheticUSBDevice(const SyntheticOptions &options);
+
+    virtual ControllerResult Open() override;
+    virtual void Close() override;
+    virtual void Reset() override;
+
+    bool IsFinished() { return m_session->IsFinished(); }
+    SyntheticStats GetStats() { return m_session->GetStats(); }
+    uint64_t GetTimeUs() { return m_session->GetTimeUs(); }
+};
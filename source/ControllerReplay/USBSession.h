@@ -0,0 +1,21 @@
+#pragma once
+#include "ControllerResult.h"
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Host USB device backend shared by a device and all its interfaces and endpoints (ReplayUSBInterface, ReplayUSBEndpoint)
+ * Implemented by ReplaySession (Capture replayed) and SyntheticSession (Reports generated).
+ * Endpoints are identified by their bEndpointAddress.
+ */
+class USBSession
+{
+public:
+    virtual ~USBSession() = default;
+
+    virtual ControllerResult Read(uint8_t endpoint, uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) = 0;
+    virtual ControllerResult Write(uint8_t endpoint, const uint8_t *inBuffer, size_t bufferSize) = 0;
+
+    virtual ControllerResult ControlTransferInput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength) = 0;
+    virtual ControllerResult ControlTransferOutput(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, const void *buffer, uint16_t wLength) = 0;
+};
@@ -62,10 +62,10 @@ bool SwitchHDLHandler::IsControllerAttached(uint16_t input_idx)
     return m_hdlsData[input_idx].m_hdlHandle.handle != 0;
 }
 
-Result SwitchHDLHandler::AttachController(uint16_t input_idx)
+ControllerResult SwitchHDLHandler::AttachController(uint16_t input_idx)
 {
     if (IsControllerAttached(input_idx))
-        return 0;
+        return CONTROLLER_STATUS_SUCCESS;
 
     syscon::logger::LogDebug("SwitchHDLHandler[%04x-%04x] Attaching device for input: %d ...", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
 
@@ -73,29 +73,29 @@ Result SwitchHDLHandler::AttachController(uint16_t input_idx)
     if (R_FAILED(rc))
     {
         syscon::logger::LogError("SwitchHDLHandler[%04x-%04x] Failed to attach device for input: %d (Error: 0x%08X)!", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx, rc);
-        return rc;
+        return CONTROLLER_STATUS_UNKNOWN_ERROR;
     }
 
     syscon::logger::LogDebug("SwitchHDLHandler[%04x-%04x] Attach - Idx: %d", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
 
-    return 0;
+    return CONTROLLER_STATUS_SUCCESS;
 }
 
-Result SwitchHDLHandler::DetachController(uint16_t input_idx)
+ControllerResult SwitchHDLHandler::DetachController(uint16_t input_idx)
 {
     if (!IsControllerAttached(input_idx))
-        return 0;
+        return CONTROLLER_STATUS_SUCCESS;
 
     syscon::logger::LogDebug("SwitchHDLHandler[%04x-%04x] Detaching device for input: %d ...", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
 
     hiddbgDetachHdlsVirtualDevice(m_hdlsData[input_idx].m_hdlHandle);
     m_hdlsData[input_idx].m_hdlHandle.handle = 0;
 
-    return 0;
+    return CONTROLLER_STATUS_SUCCESS;
 }
 
 // Sets the state of the class's HDL controller to the state stored in class's hdl.state
-Result SwitchHDLHandler::UpdateControllerState(u64 buttons, const HidAnalogStickState &analog_stick_l, const HidAnalogStickState &analog_stick_r, uint16_t input_idx)
+ControllerResult SwitchHDLHandler::UpdateControllerState(uint64_t buttons, const VirtualGamepadStick &analog_stick_l, const VirtualGamepadStick &analog_stick_r, uint16_t input_idx)
 {
     HiddbgHdlsState *hdlState = &m_hdlsData[input_idx].m_hdlState;
 
@@ -107,8 +107,9 @@ Result SwitchHDLHandler::UpdateControllerState(u64 buttons, const HidAnalogStick
 
     if (IsControllerAttached(input_idx))
     {
-        syscon::logger::LogDebug("SwitchHDLHandler[%04x-%04x] UpdateHdlState - Idx: %d [Button: 0x%016llX LeftX: %d LeftY: %d RightX: %d RightY: %d]", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx, (unsigned long long)hdlState->buttons, hdlState->analog_stick_l.x, hdlState->analog_stick_l.y, hdlState->analog_stick_r.x, hdlState->analog_stick_r.y);
+        SYSCON_LOG_DEBUG("SwitchHDLHandler[%04x-%04x] UpdateHdlState - Idx: %d [Button: 0x%016llX LeftX: %d LeftY: %d RightX: %d RightY: %d]", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx, (unsigned long long)hdlState->buttons, hdlState->analog_stick_l.x, hdlState->analog_stick_l.y, hdlState->analog_stick_r.x, hdlState->analog_stick_r.y);
         Result rc = hiddbgSetHdlsState(m_hdlsData[input_idx].m_hdlHandle, hdlState);
+        m_controller->GetMetrics().Increment(R_FAILED(rc) ? ControllerCounter_IpcFailed : ControllerCounter_IpcSubmitted);
         if (R_FAILED(rc))
         {
             /*
@@ -120,11 +121,11 @@ Result SwitchHDLHandler::UpdateControllerState(u64 buttons, const HidAnalogStick
             // syscon::logger::LogError("SwitchHDLHandler UpdateHdlState - Failed to set HDL state for idx: %d (Ret: 0x%X) - Detaching controller ...", input_idx, rc);
             DetachController(input_idx);
 
-            return rc;
+            return CONTROLLER_STATUS_WRITE_FAILED;
         }
     }
 
-    return 0;
+    return CONTROLLER_STATUS_SUCCESS;
 }
 
 HiddbgHdlsSessionId &SwitchHDLHandler::GetHdlsSessionId()
@@ -1,11 +1,49 @@
 #pragma once
+#include <atomic>
 
+// Same values as the sysmodule logger (logger.h)
 #define LOG_LEVEL_TRACE   0
 #define LOG_LEVEL_DEBUG   1
-#define LOG_LEVEL_INFO    2
-#define LOG_LEVEL_WARNING 3
-#define LOG_LEVEL_ERROR   4
-#define LOG_LEVEL_COUNT   5
+#define LOG_LEVEL_PERF    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_WARNING 4
+#define LOG_LEVEL_ERROR   5
+#define LOG_LEVEL_COUNT   6
+
+// See logger.h: Logs below SYSCON_LOG_MIN_LEVEL are removed at compile time, others are checked inline before evaluating the arguments
+#ifndef SYSCON_LOG_MIN_LEVEL
+    #define SYSCON_LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#endif
+
+#ifndef SYSCON_LOG_IF
+    #define SYSCON_LOG_IF(lvl, call)                     \
+        do                                               \
+        {                                                \
+            if constexpr ((lvl) >= SYSCON_LOG_MIN_LEVEL) \
+            {                                            \
+                if (::syscon::logger::IsEnabled(lvl))    \
+                    call;                                \
+            }                                            \
+        } while (0)
+
+    #define SYSCON_LOG_TRACE(...)                SYSCON_LOG_IF(LOG_LEVEL_TRACE, ::syscon::logger::LogTrace(__VA_ARGS__))
+    #define SYSCON_LOG_DEBUG(...)                SYSCON_LOG_IF(LOG_LEVEL_DEBUG, ::syscon::logger::LogDebug(__VA_ARGS__))
+    #define SYSCON_LOG_PERF(...)                 SYSCON_LOG_IF(LOG_LEVEL_PERF, ::syscon::logger::LogPerf(__VA_ARGS__))
+    #define SYSCON_LOG_INFO(...)                 SYSCON_LOG_IF(LOG_LEVEL_INFO, ::syscon::logger::LogInfo(__VA_ARGS__))
+    #define SYSCON_LOG_WARNING(...)              SYSCON_LOG_IF(LOG_LEVEL_WARNING, ::syscon::logger::LogWarning(__VA_ARGS__))
+    #define SYSCON_LOG_ERROR(...)                SYSCON_LOG_IF(LOG_LEVEL_ERROR, ::syscon::logger::LogError(__VA_ARGS__))
+    #define SYSCON_LOG_BUFFER(lvl, buffer, size) SYSCON_LOG_IF(lvl, ::syscon::logger::LogBuffer(lvl, buffer, size))
+
+namespace syscon::logger
+{
+    extern std::atomic<int> g_log_level;
+
+    inline bool IsEnabled(int lvl)
+    {
+        return lvl >= g_log_level.load(std::memory_order_relaxed);
+    }
+} // namespace syscon::logger
+#endif
 
 namespace syscon::logger
 {
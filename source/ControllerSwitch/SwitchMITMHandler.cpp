@@ -39,28 +39,33 @@ bool SwitchMITMHandler::IsControllerAttached(uint16_t input_idx)
     return m_controllerList[input_idx] != nullptr;
 }
 
-Result SwitchMITMHandler::DetachController(uint16_t input_idx)
+ControllerResult SwitchMITMHandler::DetachController(uint16_t input_idx)
 {
     if (!IsControllerAttached(input_idx))
-        return 0;
+        return CONTROLLER_STATUS_SUCCESS;
 
     HidSharedMemoryManager::GetHidSharedMemoryManager().DetachController(m_controllerList[input_idx]);
     m_controllerList[input_idx] = nullptr;
 
-    return 0;
+    return CONTROLLER_STATUS_SUCCESS;
 }
 
-Result SwitchMITMHandler::AttachController(uint16_t input_idx)
+ControllerResult SwitchMITMHandler::AttachController(uint16_t input_idx)
 {
     if (IsControllerAttached(input_idx))
-        return 0;
+        return CONTROLLER_STATUS_SUCCESS;
 
     m_controllerList[input_idx] = HidSharedMemoryManager::GetHidSharedMemoryManager().AttachController();
 
-    return 0;
+    return CONTROLLER_STATUS_SUCCESS;
 }
 
-Result SwitchMITMHandler::UpdateControllerState(u64 buttons, const HidAnalogStickState &analog_stick_l, const HidAnalogStickState &analog_stick_r, uint16_t input_idx)
+ControllerResult SwitchMITMHandler::UpdateControllerState(uint64_t buttons, const VirtualGamepadStick &analog_stick_l, const VirtualGamepadStick &analog_stick_r, uint16_t input_idx)
 {
-    return m_controllerList[input_idx]->Update(buttons, analog_stick_l, analog_stick_r);
+    HidAnalogStickState stick_l = {analog_stick_l.x, analog_stick_l.y};
+    HidAnalogStickState stick_r = {analog_stick_r.x, analog_stick_r.y};
+
+    Result rc = m_controllerList[input_idx]->Update(buttons, stick_l, stick_r);
+    m_controller->GetMetrics().Increment(R_FAILED(rc) ? ControllerCounter_IpcFailed : ControllerCounter_IpcSubmitted);
+    return R_FAILED(rc) ? CONTROLLER_STATUS_WRITE_FAILED : CONTROLLER_STATUS_SUCCESS;
 }
@@ -10,9 +10,9 @@ private:
 
 protected:
     bool IsControllerAttached(uint16_t input_idx) override;
-    Result DetachController(uint16_t input_idx) override;
-    Result AttachController(uint16_t input_idx) override;
-    Result UpdateControllerState(u64 buttons, const HidAnalogStickState &analog_stick_l, const HidAnalogStickState &analog_stick_r, uint16_t input_idx) override;
+    ControllerResult DetachController(uint16_t input_idx) override;
+    ControllerResult AttachController(uint16_t input_idx) override;
+    ControllerResult UpdateControllerState(uint64_t buttons, const VirtualGamepadStick &analog_stick_l, const VirtualGamepadStick &analog_stick_r, uint16_t input_idx) override;
 
 public:
     // Initialize the class with specified controller
@@ -1,5 +1,6 @@
 #include "SwitchMITMManager.h"
 #include "SwitchLogger.h"
+#include "SwitchSharedMemoryCopy.h"
 #include <string.h> // memcpy
 #include <cinttypes>
 #include <atomic>
@@ -17,26 +18,6 @@ static HidSharedMemoryManager g_HidSharedMemoryManager;
 
 static_assert(sizeof(HidSharedMemory) == HID_SHARED_MEMORY_SIZE, "HidSharedMemory size is not good!");
 
-static void memcpy_64(void *dest, const void *src, size_t n)
-{
-    if (n % 8 != 0 || reinterpret_cast<uintptr_t>(dest) % 8 != 0 || reinterpret_cast<uintptr_t>(src) % 8 != 0)
-    {
-        ::syscon::logger::LogWarning("memcpy_64: n is not a multiple of 8 (%zu) or address is not 8-byte aligned (dest: %p, src: %p)", n, dest, src);
-        const uint8_t *s = static_cast<const uint8_t *>(src);
-        uint8_t *d = static_cast<uint8_t *>(dest);
-        for (size_t i = 0; i < n; i++)
-            d[i] = s[i];
-    }
-    else
-    {
-        //::syscon::logger::LogTrace("memcpy_64: %zu bytes", n);
-        const volatile uint64_t *s = reinterpret_cast<const volatile uint64_t *>(src);
-        volatile uint64_t *d = reinterpret_cast<volatile uint64_t *>(dest);
-        for (size_t i = 0; i < (n / 8); i++)
-            d[i] = s[i];
-    }
-}
-
 /************************************************************
               HidSharedMemoryEntry
 ************************************************************/
@@ -98,7 +79,7 @@ HidSharedMemoryEntry::HidSharedMemoryEntry(::Service *hid_service, u64 processId
     //::syscon::logger::LogDebug("Real memory => Handle: %016" PRIx64 ", Size: %zu, Permissions: %u, MapAddr: %p", m_real_shared_memory.handle, m_real_shared_memory.size, m_real_shared_memory.perm, GetRealAddr());
 
     // Initialize the fake shared memory with the content of the real shared memory
-    memcpy_64(GetFakeAddr(), GetRealAddr(), HID_SHARED_MEMORY_SIZE);
+    SharedMemoryCopy(GetFakeAddr(), GetRealAddr(), HID_SHARED_MEMORY_SIZE);
     m_touchscreen_prev_tail = GetFakeAddr()->touchscreen.lifo.header.tail; // Initialize the previous tail with the current tail value
 }
 
@@ -383,16 +364,13 @@ void HidSharedMemoryManager::OnRun()
             if (tail == (*it)->m_touchscreen_prev_tail)
                 continue; // No new input, skip
 
-            // Read storage after tail to avoid reading the same input twice in case of new input during the copy
-            memcpy_64(&tmp_atomic_storage, &(*it)->GetRealAddr()->touchscreen.lifo.storage[tail], sizeof(tmp_atomic_storage));
-
-            //::syscon::logger::LogDebug("HidSharedMemoryManager::OnRun updating shared memory for process id: 0x%016" PRIx64 " (Count: %d)", (*it)->GetProcessId(), tmp_shmem_mem.touchscreen.lifo.header.count);
-            u64 current_tail = (*it)->GetFakeAddr()->touchscreen.lifo.header.tail + 1;
-            if (current_tail >= (*it)->GetFakeAddr()->touchscreen.lifo.header.buffer_count)
-                current_tail = 0;
+            // Read the latest entry, retried if the HID sysmodule rewrote it during the copy
+            HidTouchScreenLifo *real_lifo = &(*it)->GetRealAddr()->touchscreen.lifo;
+            if (!SharedMemoryReadLifoEntry(&tmp_atomic_storage, real_lifo->storage, &real_lifo->header.tail, real_lifo->header.buffer_count))
+                continue; // Entry still being written, we will catch it on the next tick
 
-            memcpy_64(&(*it)->GetFakeAddr()->touchscreen.lifo.storage[current_tail], &tmp_atomic_storage, sizeof(tmp_atomic_storage));
-            __atomic_store_n(&((*it)->GetFakeAddr()->touchscreen.lifo.header.tail), current_tail, __ATOMIC_RELEASE);
+            HidTouchScreenLifo *fake_lifo = &(*it)->GetFakeAddr()->touchscreen.lifo;
+            u64 current_tail = SharedMemoryWriteLifoEntry(fake_lifo->storage, &fake_lifo->header.tail, fake_lifo->header.buffer_count, tmp_atomic_storage);
 
             (*it)->m_touchscreen_prev_tail = current_tail;
         }
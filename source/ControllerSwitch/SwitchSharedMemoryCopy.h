@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+
+/*
+ * Copy helpers for the HID shared memory
+ *
+ * This file is intentionally free of any libnx dependency so it can be built and
+ * tested on the host (See tests/test_shared_memory_copy.cpp).
+ *
+ * SharedMemoryCopy:
+ *  Bulk copy using wide (64 bytes per iteration) loads and stores. It has no ordering
+ *  guarantee on its own, it must only be used on memory that is not written concurrently
+ *  or when the result is validated afterwards (See SharedMemoryReadLifoEntry).
+ *
+ * SharedMemoryReadLifoEntry:
+ *  Read the latest entry of a HID LIFO written concurrently by another process.
+ *  The writer (HID sysmodule) fills storage[tail + 1] and then publishes it by storing the new tail.
+ *  The copy is validated like a seqlock: the tail and the sampling number of the entry are read
+ *  before and after the copy, if any of them changed, the entry might have been overwritten while
+ *  we were copying it and the copy is retried.
+ */
+
+#define SHARED_MEMORY_COPY_BLOCK_SIZE  64
+#define SHARED_MEMORY_COPY_MAX_RETRIES 4
+
+inline void SharedMemoryCopy(void *dest, const void *src, size_t n)
+{
+    uint8_t *d = static_cast<uint8_t *>(dest);
+    const uint8_t *s = static_cast<const uint8_t *>(src);
+
+    /*
+        Fixed size memcpy are inlined by the compiler as wide load/store pairs (ldp/stp q registers on aarch64).
+        Alignment is not a concern here, the shared memory is a normal memory mapping.
+    */
+    while (n >= SHARED_MEMORY_COPY_BLOCK_SIZE)
+    {
+        __builtin_memcpy(d, s, SHARED_MEMORY_COPY_BLOCK_SIZE);
+        d += SHARED_MEMORY_COPY_BLOCK_SIZE;
+        s += SHARED_MEMORY_COPY_BLOCK_SIZE;
+        n -= SHARED_MEMORY_COPY_BLOCK_SIZE;
+    }
+
+    if (n > 0)
+        std::memcpy(d, s, n);
+}
+
+/*
+ * AtomicStorage must start with a "u64 sampling_number" (e.g. HidTouchScreenStateAtomicStorage, HidNpadCommonStateAtomicStorage)
+ * Return true if out contains a consistent copy of storage[tail], false if the entry kept changing during all the retries.
+ */
+template <typename AtomicStorage>
+bool SharedMemoryReadLifoEntry(AtomicStorage *out, const AtomicStorage *storage, const uint64_t *tail_ptr, uint64_t buffer_count)
+{
+    for (int retry = 0; retry < SHARED_MEMORY_COPY_MAX_RETRIES; retry++)
+    {
+        uint64_t tail = __atomic_load_n(tail_ptr, __ATOMIC_ACQUIRE);
+        if (tail >= buffer_count)
+            return false; // LIFO not initialized yet
+
+        const AtomicStorage *entry = &storage[tail];
+        uint64_t sampling_number = __atomic_load_n(&entry->sampling_number, __ATOMIC_ACQUIRE);
+
+        SharedMemoryCopy(out, entry, sizeof(AtomicStorage));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        /*
+            The writer only touches storage[tail + 1], storage[tail] can only be rewritten once the writer wrapped around the whole LIFO.
+            If the tail did not move and the sampling number is the same, the entry was not modified during the copy.
+        */
+        if (__atomic_load_n(&entry->sampling_number, __ATOMIC_RELAXED) == sampling_number &&
+            __atomic_load_n(tail_ptr, __ATOMIC_RELAXED) == tail &&
+            out->sampling_number == sampling_number)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Write an entry into a LIFO we own (fake shared memory) and publish it.
+ * Return the new tail.
+ */
+template <typename AtomicStorage>
+uint64_t SharedMemoryWriteLifoEntry(AtomicStorage *storage, uint64_t *tail_ptr, uint64_t buffer_count, const AtomicStorage &entry)
+{
+    uint64_t tail = __atomic_load_n(tail_ptr, __ATOMIC_RELAXED) + 1;
+    if (tail >= buffer_count)
+        tail = 0;
+
+    SharedMemoryCopy(&storage[tail], &entry, sizeof(AtomicStorage));
+    __atomic_store_n(tail_ptr, tail, __ATOMIC_RELEASE);
+
+    return tail;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * Pool of the USB transfer buffers
+ *
+ * This file is intentionally free of any libnx dependency so it can be built and
+ * tested on the host (See tests/test_usb_buffer_pool.cpp).
+ *
+ * The usbHs transfers need page aligned buffers. Instead of embedding an aligned array in every
+ * endpoint and interface (Whatever its direction and its packet size), each one borrows a slab
+ * sized to what it transfers (Rounded up to a page) when it is opened, and gives it back when
+ * it is destroyed. The released slabs are kept for the next devices (Reconnections, sleep/wake)
+ * up to USB_TRANSFER_BUFFER_POOL_MAX_FREE, so the heap is not fragmented by page aligned blocks.
+ */
+
+#define USB_TRANSFER_BUFFER_ALIGNMENT     0x1000
+#define USB_TRANSFER_BUFFER_POOL_MAX_FREE 16
+
+struct USBTransferBufferStats
+{
+    uint64_t acquires = 0;       // Slabs handed out
+    uint64_t reuses = 0;         // Slabs handed out from the free list
+    uint64_t failures = 0;       // Allocations failed
+    uint32_t slabs_in_use = 0;   // Slabs currently borrowed
+    uint32_t slabs_free = 0;     // Slabs kept for later
+    uint32_t peak_in_use = 0;    // Highest slabs_in_use
+    uint64_t bytes_reserved = 0; // Memory of all the slabs (In use and free)
+
+    // Human readable dump, one value per line, each line is prefixed by 'indent'
+    void Format(std::string *out, const char *indent) const
+    {
+        char line[128];
+
+        snprintf(line, sizeof(line), "%sacquires: %llu (reused: %llu, failed: %llu)\n", indent, (unsigned long long)acquires, (unsigned long long)reuses, (unsigned long long)failures);
+        out->append(line);
+        snprintf(line, sizeof(line), "%sslabs: %u in use (peak: %u), %u free\n", indent, slabs_in_use, peak_in_use, slabs_free);
+        out->append(line);
+        snprintf(line, sizeof(line), "%sbytes_reserved: %llu\n", indent, (unsigned long long)bytes_reserved);
+        out->append(line);
+    }
+};
+
+class USBTransferBufferPool;
+
+// Slab borrowed from the pool, given back when destroyed
+class USBTransferBuffer
+{
+public:
+    USBTransferBuffer() = default;
+    USBTransferBuffer(USBTransferBuffer &&other) noexcept { *this = std::move(other); }
+    ~USBTransferBuffer() { Reset(); }
+
+    USBTransferBuffer &operator=(USBTransferBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            std::swap(m_pool, other.m_pool);
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+        }
+        return *this;
+    }
+
+    USBTransferBuffer(const USBTransferBuffer &) = delete;
+    USBTransferBuffer &operator=(const USBTransferBuffer &) = delete;
+
+    inline void Reset();
+
+    uint8_t *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    explicit operator bool() const { return m_data != nullptr; }
+
+private:
+    friend class USBTransferBufferPool;
+
+    USBTransferBuffer(USBTransferBufferPool *pool, uint8_t *data, size_t size) : m_pool(pool), m_data(data), m_size(size) {}
+
+    USBTransferBufferPool *m_pool = nullptr;
+    uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+};
+
+class USBTransferBufferPool
+{
+public:
+    USBTransferBufferPool() = default;
+    ~USBTransferBufferPool() { Trim(); }
+
+    USBTransferBufferPool(const USBTransferBufferPool &) = delete;
+    USBTransferBufferPool &operator=(const USBTransferBufferPool &) = delete;
+
+    // Pool shared by all the USB devices of the process
+    static USBTransferBufferPool &Get()
+    {
+        static USBTransferBufferPool pool;
+        return pool;
+    }
+
+    // Page aligned slab of at least 'size' bytes, empty if the allocation failed
+    USBTransferBuffer Acquire(size_t size)
+    {
+        size_t slab_size = ((size > 0 ? size : 1) + USB_TRANSFER_BUFFER_ALIGNMENT - 1) & ~static_cast<size_t>(USB_TRANSFER_BUFFER_ALIGNMENT - 1);
+        uint8_t *data = nullptr;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<uint8_t *> &free_slabs = m_free[slab_size];
+        if (!free_slabs.empty())
+        {
+            data = free_slabs.back();
+            free_slabs.pop_back();
+            m_stats.slabs_free--;
+            m_stats.reuses++;
+        }
+        else
+        {
+            data = static_cast<uint8_t *>(::operator new(slab_size, std::align_val_t(USB_TRANSFER_BUFFER_ALIGNMENT), std::nothrow));
+            if (data == nullptr)
+            {
+                m_stats.failures++;
+                return USBTransferBuffer();
+            }
+            m_stats.bytes_reserved += slab_size;
+        }
+
+        m_stats.acquires++;
+        m_stats.slabs_in_use++;
+        if (m_stats.slabs_in_use > m_stats.peak_in_use)
+            m_stats.peak_in_use = m_stats.slabs_in_use;
+
+        return USBTransferBuffer(this, data, slab_size);
+    }
+
+    // Free the slabs kept for later
+    void Trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (auto &entry : m_free)
+        {
+            for (uint8_t *data : entry.second)
+                Free(data, entry.first);
+            entry.second.clear();
+        }
+        m_stats.slabs_free = 0;
+    }
+
+    USBTransferBufferStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    friend class USBTransferBuffer;
+
+    void Release(uint8_t *data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_stats.slabs_in_use--;
+
+        if (m_stats.slabs_free >= USB_TRANSFER_BUFFER_POOL_MAX_FREE)
+        {
+            Free(data, size);
+            return;
+        }
+
+        m_free[size].push_back(data);
+        m_stats.slabs_free++;
+    }
+
+    void Free(uint8_t *data, size_t size)
+    {
+        ::operator delete(data, std::align_val_t(USB_TRANSFER_BUFFER_ALIGNMENT));
+        m_stats.bytes_reserved -= size;
+    }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<size_t, std::vector<uint8_t *>> m_free; // By slab size
+    USBTransferBufferStats m_stats;
+};
+
+inline void USBTransferBuffer::Reset()
+{
+    if (m_pool != nullptr)
+        m_pool->Release(m_data, m_size);
+
+    m_pool = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+}
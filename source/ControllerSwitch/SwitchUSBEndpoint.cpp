@@ -1,12 +1,14 @@
 #include "SwitchUSBEndpoint.h"
-#include "SwitchUSBLock.h"
 #include "SwitchLogger.h"
+#include "ControllerTypes.h"
+#include <algorithm>
 #include <cstring>
 #include <malloc.h>
 
-SwitchUSBEndpoint::SwitchUSBEndpoint(UsbHsClientIfSession &if_session, usb_endpoint_descriptor &desc)
+SwitchUSBEndpoint::SwitchUSBEndpoint(UsbHsClientIfSession &if_session, usb_endpoint_descriptor &desc, USBLevelMutex &interfaceMutex)
     : m_ifSession(&if_session),
-      m_descriptor(&desc)
+      m_descriptor(&desc),
+      m_interfaceMutex(interfaceMutex)
 {
 }
 
@@ -16,12 +18,28 @@ SwitchUSBEndpoint::~SwitchUSBEndpoint()
 
 ControllerResult SwitchUSBEndpoint::Open(int maxPacketSize)
 {
-    SwitchUSBLock usbLock;
+    USBEndpointSetupLock lock(m_interfaceMutex, m_mutex);
 
     maxPacketSize = maxPacketSize != 0 ? maxPacketSize : m_descriptor->wMaxPacketSize;
 
     ::syscon::logger::LogDebug("SwitchUSBEndpoint[0x%02X] Opening (Pkt size: %d)...", m_descriptor->bEndpointAddress, maxPacketSize);
 
+    // One buffer to write, one per report lent to the controller to read (Latest and drained)
+    int bufferCount = GetDirection() == USB_ENDPOINT_IN ? USB_ENDPOINT_READ_BUFFERS : 1;
+    for (int i = 0; i < bufferCount; i++)
+    {
+        if (m_buffers[i])
+            continue;
+
+        // Large enough for any report read by the controllers, even if their packets are smaller
+        m_buffers[i] = USBTransferBufferPool::Get().Acquire(std::max<size_t>(maxPacketSize, CONTROLLER_INPUT_BUFFER_SIZE));
+        if (!m_buffers[i])
+        {
+            ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] Failed to allocate the transfer buffer !", m_descriptor->bEndpointAddress);
+            return CONTROLLER_STATUS_OUT_OF_MEMORY;
+        }
+    }
+
     Result rc = usbHsIfOpenUsbEp(m_ifSession, &m_epSession, 1, maxPacketSize, m_descriptor);
     if (R_FAILED(rc))
     {
@@ -36,7 +54,7 @@ ControllerResult SwitchUSBEndpoint::Open(int maxPacketSize)
 
 void SwitchUSBEndpoint::Close()
 {
-    SwitchUSBLock usbLock;
+    USBEndpointSetupLock lock(m_interfaceMutex, m_mutex);
 
     usbHsEpClose(&m_epSession);
 }
@@ -45,17 +63,23 @@ ControllerResult SwitchUSBEndpoint::Write(const uint8_t *inBuffer, size_t buffer
 {
     u32 transferredSize = 0;
 
-    SwitchUSBLock usbLock;
+    USBOutputTransferLock lock(m_mutex);
 
-    memcpy(m_usb_buffer_out, inBuffer, bufferSize);
+    if (bufferSize > m_buffers[0].size())
+    {
+        ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] Write: Invalid buffer size %d !", m_descriptor->bEndpointAddress, bufferSize);
+        return CONTROLLER_STATUS_INVALID_ARGUMENT;
+    }
+
+    memcpy(m_buffers[0].data(), inBuffer, bufferSize);
 
     if (GetDirection() == USB_ENDPOINT_IN)
         ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] Trying to write an INPUT endpoint!", m_descriptor->bEndpointAddress);
 
-    ::syscon::logger::LogTrace("SwitchUSBEndpoint[0x%02X] Write %d bytes", m_descriptor->bEndpointAddress, bufferSize);
-    ::syscon::logger::LogBuffer(LOG_LEVEL_TRACE, m_usb_buffer_out, bufferSize);
+    SYSCON_LOG_TRACE("SwitchUSBEndpoint[0x%02X] Write %d bytes", m_descriptor->bEndpointAddress, bufferSize);
+    SYSCON_LOG_BUFFER(LOG_LEVEL_TRACE, m_buffers[0].data(), bufferSize);
 
-    Result rc = usbHsEpPostBuffer(&m_epSession, m_usb_buffer_out, bufferSize, &transferredSize);
+    Result rc = usbHsEpPostBuffer(&m_epSession, m_buffers[0].data(), bufferSize, &transferredSize);
     if (R_FAILED(rc))
     {
         ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] Write failed: 0x%08X (Module: 0x%X, Desc: 0x%X)", m_descriptor->bEndpointAddress, rc, R_MODULE(rc), R_DESCRIPTION(rc));
@@ -68,29 +92,72 @@ ControllerResult SwitchUSBEndpoint::Write(const uint8_t *inBuffer, size_t buffer
 }
 
 ControllerResult SwitchUSBEndpoint::Read(uint8_t *outBuffer, size_t *bufferSizeInOut, u64 aTimeoutUs)
+{
+    ReadBuffer buffer;
+
+    ControllerResult result = AcquireRead(&buffer, *bufferSizeInOut, aTimeoutUs);
+    if (result != CONTROLLER_STATUS_SUCCESS)
+        return result;
+
+    memcpy(outBuffer, buffer.data, buffer.size);
+    *bufferSizeInOut = buffer.size;
+    ReleaseRead(buffer);
+
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult SwitchUSBEndpoint::AcquireRead(ReadBuffer *buffer, size_t maxSize, u64 aTimeoutUs)
 {
     if (GetDirection() == USB_ENDPOINT_OUT)
         ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] Trying to read an OUTPUT endpoint!", m_descriptor->bEndpointAddress);
 
-    if (aTimeoutUs == UINT64_MAX)
-        return ReadSync(outBuffer, bufferSizeInOut);
+    USBInputTransferLock lock(m_mutex);
+
+    // A transfer already posted completes in its own buffer, otherwise the next one goes to a buffer not lent
+    uint8_t slot = m_xferSlot;
+    if (m_xferIdRead == 0)
+    {
+        slot = 0;
+        while (slot < USB_ENDPOINT_READ_BUFFERS && (m_acquired[slot] || !m_buffers[slot]))
+            slot++;
+
+        if (slot == USB_ENDPOINT_READ_BUFFERS)
+        {
+            ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] No transfer buffer available !", m_descriptor->bEndpointAddress);
+            return CONTROLLER_STATUS_OUT_OF_MEMORY;
+        }
+    }
+
+    buffer->data = m_buffers[slot].data();
+    buffer->size = std::min(maxSize, m_buffers[slot].size());
+    buffer->slot = slot;
+
+    ControllerResult result = aTimeoutUs == UINT64_MAX ? ReadSync(slot, &buffer->size) : ReadAsync(slot, &buffer->size, aTimeoutUs);
+    if (result == CONTROLLER_STATUS_SUCCESS)
+        m_acquired[slot] = true;
+
+    return result;
+}
+
+void SwitchUSBEndpoint::ReleaseRead(const ReadBuffer &buffer)
+{
+    USBInputTransferLock lock(m_mutex);
 
-    return ReadAsync(outBuffer, bufferSizeInOut, aTimeoutUs);
+    if (buffer.slot < USB_ENDPOINT_READ_BUFFERS)
+        m_acquired[buffer.slot] = false;
 }
 
-ControllerResult SwitchUSBEndpoint::ReadSync(uint8_t *outBuffer, size_t *bufferSizeInOut)
+ControllerResult SwitchUSBEndpoint::ReadSync(uint8_t slot, size_t *bufferSizeInOut)
 {
-    SwitchUSBLock usbLock;
     u32 transferredSize;
 
-    Result rc = usbHsEpPostBuffer(&m_epSession, m_usb_buffer_in, *bufferSizeInOut, &transferredSize);
+    Result rc = usbHsEpPostBuffer(&m_epSession, m_buffers[slot].data(), *bufferSizeInOut, &transferredSize);
     if (R_FAILED(rc))
     {
         ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] ReadSync failed: 0x%08X", m_descriptor->bEndpointAddress, rc);
         return CONTROLLER_STATUS_READ_FAILED;
     }
 
-    memcpy(outBuffer, m_usb_buffer_in, transferredSize);
     *bufferSizeInOut = transferredSize;
 
     if (transferredSize == 0)
@@ -99,15 +166,14 @@ ControllerResult SwitchUSBEndpoint::ReadSync(uint8_t *outBuffer, size_t *bufferS
         return CONTROLLER_STATUS_NO_DATA_AVAILABLE;
     }
 
-    ::syscon::logger::LogTrace("SwitchUSBEndpoint[0x%02X] ReadSync %d bytes", m_descriptor->bEndpointAddress, *bufferSizeInOut);
-    ::syscon::logger::LogBuffer(LOG_LEVEL_TRACE, outBuffer, *bufferSizeInOut);
+    SYSCON_LOG_TRACE("SwitchUSBEndpoint[0x%02X] ReadSync %d bytes", m_descriptor->bEndpointAddress, *bufferSizeInOut);
+    SYSCON_LOG_BUFFER(LOG_LEVEL_TRACE, m_buffers[slot].data(), *bufferSizeInOut);
 
     return CONTROLLER_STATUS_SUCCESS;
 }
 
-ControllerResult SwitchUSBEndpoint::ReadAsync(uint8_t *outBuffer, size_t *bufferSizeInOut, u64 aTimeoutUs)
+ControllerResult SwitchUSBEndpoint::ReadAsync(uint8_t slot, size_t *bufferSizeInOut, u64 aTimeoutUs)
 {
-    SwitchUSBLock usbLock;
     u32 count = 0;
     UsbHsXferReport report;
     u32 tmpXcferId = 0;
@@ -115,12 +181,13 @@ ControllerResult SwitchUSBEndpoint::ReadAsync(uint8_t *outBuffer, size_t *buffer
 
     if (m_xferIdRead == 0)
     {
-        rc = usbHsEpPostBufferAsync(&m_epSession, m_usb_buffer_in, *bufferSizeInOut, 0, &m_xferIdRead);
+        rc = usbHsEpPostBufferAsync(&m_epSession, m_buffers[slot].data(), *bufferSizeInOut, 0, &m_xferIdRead);
         if (R_FAILED(rc))
         {
             ::syscon::logger::LogError("SwitchUSBEndpoint[0x%02X] ReadAsync failed: 0x%08X", m_descriptor->bEndpointAddress, rc);
             return CONTROLLER_STATUS_READ_FAILED;
         }
+        m_xferSlot = slot;
     }
 
     if (R_FAILED(eventWait(usbHsEpGetXferEvent(&m_epSession), aTimeoutUs * 1000)))
@@ -145,14 +212,13 @@ ControllerResult SwitchUSBEndpoint::ReadAsync(uint8_t *outBuffer, size_t *buffer
         return CONTROLLER_STATUS_NO_DATA_AVAILABLE;
     }
 
-    memcpy(outBuffer, m_usb_buffer_in, report.transferredSize);
     *bufferSizeInOut = report.transferredSize;
 
     if (report.transferredSize == 0)
         return CONTROLLER_STATUS_NO_DATA_AVAILABLE;
 
-    ::syscon::logger::LogTrace("SwitchUSBEndpoint[0x%02X] ReadAsync %d bytes", m_descriptor->bEndpointAddress, *bufferSizeInOut);
-    ::syscon::logger::LogBuffer(LOG_LEVEL_TRACE, outBuffer, *bufferSizeInOut);
+    SYSCON_LOG_TRACE("SwitchUSBEndpoint[0x%02X] ReadAsync %d bytes", m_descriptor->bEndpointAddress, *bufferSizeInOut);
+    SYSCON_LOG_BUFFER(LOG_LEVEL_TRACE, m_buffers[slot].data(), *bufferSizeInOut);
 
     if (R_FAILED(report.res))
     {
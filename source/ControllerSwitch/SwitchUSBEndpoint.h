@@ -1,6 +1,8 @@
 #pragma once
 #include <switch.h>
 #include "IUSBEndpoint.h"
+#include "SwitchUSBBufferPool.h"
+#include "SwitchUSBLockLevels.h"
 #include <memory>
 
 class SwitchUSBEndpoint : public IUSBEndpoint
@@ -10,12 +12,19 @@ private:
     UsbHsClientIfSession *m_ifSession;
     usb_endpoint_descriptor *m_descriptor;
     u32 m_xferIdRead = 0;
-    alignas(0x1000) u8 m_usb_buffer_in[512];
-    alignas(0x1000) u8 m_usb_buffer_out[512];
+    uint8_t m_xferSlot = 0; // Transfer buffer of m_xferIdRead
+    USBLevelMutex &m_interfaceMutex; // Open and close
+    USBLevelMutex m_mutex{USBLockLevel_Endpoint}; // Transfers
+    // Borrowed from the pool when opened, sized to the packets of this endpoint (Only the first one for an OUTPUT endpoint)
+    USBTransferBuffer m_buffers[USB_ENDPOINT_READ_BUFFERS];
+    bool m_acquired[USB_ENDPOINT_READ_BUFFERS] = {};
+
+    ControllerResult ReadSync(uint8_t slot, size_t *bufferSizeInOut);
+    ControllerResult ReadAsync(uint8_t slot, size_t *bufferSizeInOut, u64 aTimeoutUs);
 
 public:
     // Pass the necessary information to be able to open the endpoint
-    SwitchUSBEndpoint(UsbHsClientIfSession &if_session, usb_endpoint_descriptor &desc);
+    SwitchUSBEndpoint(UsbHsClientIfSession &if_session, usb_endpoint_descriptor &desc, USBLevelMutex &interfaceMutex);
     ~SwitchUSBEndpoint();
 
     // Open and close the endpoint
@@ -27,8 +36,10 @@ public:
 
     // The data received will be put in the outBuffer array for the length of the specified size.
     virtual ControllerResult Read(uint8_t *outBuffer, size_t *bufferSizeInOut, u64 aTimeoutUs) override;
-    virtual ControllerResult ReadSync(uint8_t *outBuffer, size_t *bufferSizeInOut);
-    virtual ControllerResult ReadAsync(uint8_t *outBuffer, size_t *bufferSizeInOut, u64 aTimeoutUs);
+
+    // Zero-copy read: The report is left in one of the transfer buffers until it is released
+    virtual ControllerResult AcquireRead(ReadBuffer *buffer, size_t maxSize, u64 aTimeoutUs) override;
+    virtual void ReleaseRead(const ReadBuffer &buffer) override;
 
     // Gets the direction of this endpoint (IN or OUT)
     virtual IUSBEndpoint::Direction GetDirection() override;
@@ -1,6 +1,5 @@
 #include "SwitchUSBInterface.h"
 #include "SwitchUSBEndpoint.h"
-#include "SwitchUSBLock.h"
 #include "SwitchLogger.h"
 #include <malloc.h>
 #include <cstring>
@@ -16,7 +15,7 @@ SwitchUSBInterface::~SwitchUSBInterface()
 
 ControllerResult SwitchUSBInterface::Open()
 {
-    SwitchUSBLock usbLock;
+    USBInterfaceSetupLock lock(m_mutex);
 
     ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] Openning ...", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
 
@@ -27,13 +26,24 @@ ControllerResult SwitchUSBInterface::Open()
         return CONTROLLER_STATUS_USB_INTERFACE_ACQUIRE;
     }
 
+    if (!m_controlBuffer)
+    {
+        m_controlBuffer = USBTransferBufferPool::Get().Acquire(SWITCH_USB_CONTROL_BUFFER_SIZE);
+        if (!m_controlBuffer)
+        {
+            ::syscon::logger::LogError("SwitchUSBInterface[%04x-%04x] Failed to allocate the control buffer !", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
+            usbHsIfClose(&m_session);
+            return CONTROLLER_STATUS_OUT_OF_MEMORY;
+        }
+    }
+
     for (int i = 0; i < SWITCH_USB_MAX_ENDPOINTS; i++)
     {
         usb_endpoint_descriptor &epdesc = m_session.inf.inf.input_endpoint_descs[i];
         if (epdesc.bLength != 0)
         {
             ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] Input endpoint found 0x%x (Idx: %d)", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct, epdesc.bEndpointAddress, i);
-            m_inEndpoints[i] = std::make_unique<SwitchUSBEndpoint>(m_session, epdesc);
+            m_inEndpoints[i] = std::make_unique<SwitchUSBEndpoint>(m_session, epdesc, m_mutex);
         }
         else
         {
@@ -47,7 +57,7 @@ ControllerResult SwitchUSBInterface::Open()
         if (epdesc.bLength != 0)
         {
             ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] Output endpoint found 0x%x (Idx: %d)", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct, epdesc.bEndpointAddress, i);
-            m_outEndpoints[i] = std::make_unique<SwitchUSBEndpoint>(m_session, epdesc);
+            m_outEndpoints[i] = std::make_unique<SwitchUSBEndpoint>(m_session, epdesc, m_mutex);
         }
         else
         {
@@ -62,7 +72,7 @@ void SwitchUSBInterface::Close()
 {
     ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] Closing...", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
 
-    SwitchUSBLock usbLock;
+    USBInterfaceSetupLock lock(m_mutex);
 
     for (int i = 0; i < SWITCH_USB_MAX_ENDPOINTS; i++)
     {
@@ -79,7 +89,7 @@ void SwitchUSBInterface::Close()
 
 ControllerResult SwitchUSBInterface::ControlTransferInput(u8 bmRequestType, u8 bmRequest, u16 wValue, u16 wIndex, void *buffer, u16 *wLength)
 {
-    SwitchUSBLock usbLock;
+    USBInputTransferLock lock(m_mutex);
 
     ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] ControlTransferInput (bmRequestType=0x%02X, bmRequest=0x%02X, wValue=0x%04X, wIndex=0x%04X, wLength=%d)...", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct, bmRequestType, bmRequest, wValue, wIndex, *wLength);
 
@@ -89,9 +99,15 @@ ControllerResult SwitchUSBInterface::ControlTransferInput(u8 bmRequestType, u8 b
         return CONTROLLER_STATUS_INVALID_ARGUMENT;
     }
 
+    if (*wLength > m_controlBuffer.size())
+    {
+        ::syscon::logger::LogError("SwitchUSBInterface[%04x-%04x] ControlTransferInput: Invalid buffer size !", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
+        return CONTROLLER_STATUS_INVALID_ARGUMENT;
+    }
+
     u32 transferredSize = 0;
 
-    if (R_FAILED(usbHsIfCtrlXfer(&m_session, bmRequestType, bmRequest, wValue, wIndex, *wLength, m_usb_buffer, &transferredSize)))
+    if (R_FAILED(usbHsIfCtrlXfer(&m_session, bmRequestType, bmRequest, wValue, wIndex, *wLength, m_controlBuffer.data(), &transferredSize)))
     {
         ::syscon::logger::LogError("SwitchUSBInterface[%04x-%04x] ControlTransferInput: Failed to read data !", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
         return CONTROLLER_STATUS_UNKNOWN_ERROR;
@@ -101,7 +117,7 @@ ControllerResult SwitchUSBInterface::ControlTransferInput(u8 bmRequestType, u8 b
     {
         if (buffer != NULL && *wLength >= transferredSize)
         {
-            memcpy(buffer, m_usb_buffer, transferredSize);
+            memcpy(buffer, m_controlBuffer.data(), transferredSize);
             *wLength = transferredSize;
         }
         else
@@ -116,7 +132,7 @@ ControllerResult SwitchUSBInterface::ControlTransferInput(u8 bmRequestType, u8 b
 
 ControllerResult SwitchUSBInterface::ControlTransferOutput(u8 bmRequestType, u8 bmRequest, u16 wValue, u16 wIndex, const void *buffer, u16 wLength)
 {
-    SwitchUSBLock usbLock;
+    USBOutputTransferLock lock(m_mutex);
 
     ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] ControlTransferOutput (bmRequestType=0x%02X, bmRequest=0x%02X, wValue=0x%04X, wIndex=0x%04X, wLength=%d)...", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct, bmRequestType, bmRequest, wValue, wIndex, wLength);
 
@@ -128,10 +144,16 @@ ControllerResult SwitchUSBInterface::ControlTransferOutput(u8 bmRequestType, u8
         return CONTROLLER_STATUS_INVALID_ARGUMENT;
     }
 
+    if (wLength > m_controlBuffer.size())
+    {
+        ::syscon::logger::LogError("SwitchUSBInterface[%04x-%04x] ControlTransferOutput: Invalid buffer size !", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
+        return CONTROLLER_STATUS_INVALID_ARGUMENT;
+    }
+
     if (buffer != NULL && wLength > 0)
-        memcpy(m_usb_buffer, buffer, wLength);
+        memcpy(m_controlBuffer.data(), buffer, wLength);
 
-    if (R_FAILED(usbHsIfCtrlXfer(&m_session, bmRequestType, bmRequest, wValue, wIndex, wLength, m_usb_buffer, &transferredSize)))
+    if (R_FAILED(usbHsIfCtrlXfer(&m_session, bmRequestType, bmRequest, wValue, wIndex, wLength, m_controlBuffer.data(), &transferredSize)))
     {
         ::syscon::logger::LogError("SwitchUSBInterface[%04x-%04x] ControlTransferOutput: Failed to send data !", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
         return CONTROLLER_STATUS_UNKNOWN_ERROR;
@@ -153,7 +175,7 @@ IUSBEndpoint *SwitchUSBInterface::GetEndpoint(IUSBEndpoint::Direction direction,
 
 ControllerResult SwitchUSBInterface::Reset()
 {
-    SwitchUSBLock usbLock;
+    USBOutputTransferLock lock(m_mutex);
 
     ::syscon::logger::LogDebug("SwitchUSBInterface[%04x-%04x] Reset...", m_interface.device_desc.idVendor, m_interface.device_desc.idProduct);
 
@@ -1,11 +1,14 @@
 #pragma once
 #include "SwitchUSBEndpoint.h"
+#include "SwitchUSBBufferPool.h"
+#include "SwitchUSBLockLevels.h"
 #include "IUSBInterface.h"
 #include <memory>
 
 class IUSBEndpoint;
 
-#define SWITCH_USB_MAX_ENDPOINTS 15
+#define SWITCH_USB_MAX_ENDPOINTS        15
+#define SWITCH_USB_CONTROL_BUFFER_SIZE 0x1000
 
 class SwitchUSBInterface : public IUSBInterface
 {
@@ -14,7 +17,8 @@ private:
     UsbHsInterface m_interface;
     std::unique_ptr<IUSBEndpoint> m_inEndpoints[SWITCH_USB_MAX_ENDPOINTS];
     std::unique_ptr<IUSBEndpoint> m_outEndpoints[SWITCH_USB_MAX_ENDPOINTS];
-    alignas(0x1000) u8 m_usb_buffer[0x1000];
+    USBTransferBuffer m_controlBuffer; // Borrowed from the pool when opened
+    USBLevelMutex m_mutex{USBLockLevel_Interface}; // Control transfers, reset, open and close of the endpoints
 
 public:
     // Pass the specified interface to allow for opening the session
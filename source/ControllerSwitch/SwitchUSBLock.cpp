@@ -1,7 +1,5 @@
 #include "SwitchUSBLock.h"
-#include <mutex>
-
-static std::recursive_mutex usbMutex;
+#include "SwitchUSBLockLevels.h"
 
 SwitchUSBLock::SwitchUSBLock(bool scoped) : m_scoped(scoped)
 {
@@ -17,10 +15,10 @@ SwitchUSBLock::~SwitchUSBLock()
 
 void SwitchUSBLock::lock()
 {
-    usbMutex.lock();
+    GetUSBDiscoveryMutex().lock();
 }
 
 void SwitchUSBLock::unlock()
 {
-    usbMutex.unlock();
+    GetUSBDiscoveryMutex().unlock();
 }
\ No newline at end of file
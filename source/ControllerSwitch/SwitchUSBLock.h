@@ -1,16 +1,18 @@
 #pragma once
 
 /*
- * Global Lock for USBHS API Calls
+ * Discovery Lock for USBHS API Calls
  *
- * This lock is required for the entire application when using any usbHsXXXX API.
+ * This lock is the first level of the lock hierarchy of the usbHsXXXX API (See SwitchUSBLockLevels.h).
  *
  * Reason:
- * The usbHsXXXX APIs cannot be called in parallel for an unknown reason. They must
- * be executed sequentially to avoid unexpected behavior (e.g. Initialization failure, ...).
+ * The usbHsXXXX APIs that change the set of interfaces cannot be called in parallel for an unknown reason.
+ * They must be executed sequentially to avoid unexpected behavior (e.g. Initialization failure, ...).
  *
  * Usage:
- * Always ensure you acquire this lock before calling any usbHsXXXX API.
+ * Acquire this lock before querying, acquiring an interface or changing the interface events, and around
+ * the initialization of a new controller. Transfers only take the lock of their interface or endpoint, the output
+ * transfers also wait for the end of an initialization (USBInitGate).
  */
 
 class SwitchUSBLock
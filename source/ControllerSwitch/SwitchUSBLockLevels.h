@@ -0,0 +1,286 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+/*
+ * Lock hierarchy of the usbHs API calls
+ *
+ * This file is intentionally free of any libnx dependency so it can be built and
+ * tested on the host (See tests/test_usb_locking.cpp).
+ *
+ * USBLockLevel_Discovery: One for the process (SwitchUSBLock). Queries of the interfaces, acquisition, events,
+ *   and the whole initialization of a new controller (Controllers connected at boot are initialized one by one).
+ * USBLockLevel_Init: One for the process (USBInitGate). Taken exclusively by the initialization of a new controller,
+ *   shared by the output transfers (writes, control transfers to the device, reset) of all the controllers.
+ * USBLockLevel_Interface: One per acquired interface (SwitchUSBInterface). Control transfers, reset, open and
+ *   close of its endpoints.
+ * USBLockLevel_Endpoint: One per endpoint (SwitchUSBEndpoint). Transfers, a read waits for its report with it.
+ *
+ * The locks are only taken in this order: a thread holding an endpoint lock never takes the lock of its interface,
+ * nor the discovery lock. An input read only takes the lock of its endpoint, it never waits for another controller,
+ * for a control transfer or for the initialization of a new controller. An output transfer waits for the end of an
+ * initialization (Except the ones of the initialization itself).
+ * All the locks are recursive (Taken again, a lock is not checked). A lock taken in the wrong order is counted and
+ * reported (USBLockOrder), it is not fatal.
+ */
+
+enum USBLockLevel : uint8_t
+{
+    USBLockLevel_Discovery = 0,
+    USBLockLevel_Init,
+    USBLockLevel_Interface,
+    USBLockLevel_Endpoint,
+
+    USBLockLevel_Count
+};
+
+// Locks held by each thread, checked against the hierarchy when a lock is taken
+class USBLockOrder
+{
+public:
+    // Called by the thread taking 'level' while it holds 'held' (The highest level held)
+    using ViolationHandler = void (*)(USBLockLevel level, USBLockLevel held);
+
+    // Count (and report) a lock of this level taken while a lock of a higher level is held
+    static void Check(USBLockLevel level)
+    {
+        for (int held = USBLockLevel_Count - 1; held > level; held--)
+        {
+            if (t_held[held] != 0)
+            {
+                s_violations.fetch_add(1, std::memory_order_relaxed);
+
+                ViolationHandler handler = s_handler.load(std::memory_order_acquire);
+                if (handler != nullptr)
+                    handler(level, static_cast<USBLockLevel>(held));
+                break;
+            }
+        }
+    }
+
+    static void Acquired(USBLockLevel level) { t_held[level]++; }
+    static void Released(USBLockLevel level) { t_held[level]--; }
+
+    // Locks of this level held by the calling thread
+    static uint32_t GetHeldCount(USBLockLevel level) { return t_held[level]; }
+    static uint64_t GetViolations() { return s_violations.load(std::memory_order_relaxed); }
+
+    // The sysmodule logs them (nullptr: Only counted)
+    static void SetViolationHandler(ViolationHandler handler) { s_handler.store(handler, std::memory_order_release); }
+
+private:
+    static inline thread_local uint32_t t_held[USBLockLevel_Count] = {};
+    static inline std::atomic<uint64_t> s_violations{0};
+    static inline std::atomic<ViolationHandler> s_handler{nullptr};
+};
+
+class USBLevelMutex
+{
+public:
+    explicit USBLevelMutex(USBLockLevel level) : m_level(level) {}
+
+    USBLevelMutex(const USBLevelMutex &) = delete;
+    USBLevelMutex &operator=(const USBLevelMutex &) = delete;
+
+    void lock()
+    {
+        if (!IsOwner()) // Taken again: It can't wait
+            USBLockOrder::Check(m_level);
+
+        m_mutex.lock();
+        Acquired();
+    }
+
+    bool try_lock()
+    {
+        if (!m_mutex.try_lock())
+            return false;
+
+        if (m_depth == 0) // Can't deadlock, but the same sequence with lock() could
+            USBLockOrder::Check(m_level);
+        Acquired();
+        return true;
+    }
+
+    void unlock()
+    {
+        USBLockOrder::Released(m_level);
+        if (--m_depth == 0)
+            m_owner.store(std::thread::id(), std::memory_order_relaxed);
+        m_mutex.unlock();
+    }
+
+    USBLockLevel GetLevel() const { return m_level; }
+
+private:
+    // Only the calling thread can have set its own ID
+    bool IsOwner() const { return m_owner.load(std::memory_order_relaxed) == std::this_thread::get_id(); }
+
+    // m_mutex held
+    void Acquired()
+    {
+        if (m_depth++ == 0)
+            m_owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        USBLockOrder::Acquired(m_level);
+    }
+
+    std::recursive_mutex m_mutex;
+    USBLockLevel m_level;
+    std::atomic<std::thread::id> m_owner{};
+    uint32_t m_depth = 0; // m_mutex held
+};
+
+// Lock of the discovery level, shared by the whole process
+inline USBLevelMutex &GetUSBDiscoveryMutex()
+{
+    static USBLevelMutex mutex(USBLockLevel_Discovery);
+    return mutex;
+}
+
+/*
+ * Exclusive during the initialization of a new controller, shared by the output transfers of the other controllers:
+ * The USB stack fails some requests of a device being initialized while other devices are written (e.g. Set LED of
+ * the XBOX 360 wired controllers connected at boot). The initializing thread doesn't wait for its own output transfers.
+ * Recursive for the exclusive owner only. A waiting initialization blocks the new output transfers.
+ */
+class USBInitGate
+{
+public:
+    USBInitGate() = default;
+
+    USBInitGate(const USBInitGate &) = delete;
+    USBInitGate &operator=(const USBInitGate &) = delete;
+
+    // Initialization: Waits for the output transfers in progress
+    void lock()
+    {
+        USBLockOrder::Check(USBLockLevel_Init);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!IsOwner())
+        {
+            m_cond.wait(lock, [this]() { return m_owner == std::thread::id(); });
+            m_owner = std::this_thread::get_id();
+            m_cond.wait(lock, [this]() { return m_transfers == 0; });
+        }
+        m_depth++;
+
+        USBLockOrder::Acquired(USBLockLevel_Init);
+    }
+
+    void unlock()
+    {
+        USBLockOrder::Released(USBLockLevel_Init);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_depth == 0)
+        {
+            m_owner = std::thread::id();
+            m_cond.notify_all();
+        }
+    }
+
+    // Output transfer: Waits for the end of an initialization of another thread
+    void lock_shared()
+    {
+        USBLockOrder::Check(USBLockLevel_Init);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!IsOwner())
+        {
+            m_cond.wait(lock, [this]() { return m_owner == std::thread::id(); });
+            m_transfers++;
+        }
+
+        USBLockOrder::Acquired(USBLockLevel_Init);
+    }
+
+    void unlock_shared()
+    {
+        USBLockOrder::Released(USBLockLevel_Init);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!IsOwner() && --m_transfers == 0)
+            m_cond.notify_all();
+    }
+
+private:
+    // m_mutex held
+    bool IsOwner() const { return m_owner == std::this_thread::get_id(); }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread::id m_owner; // Initializing thread (Default: None), set as soon as it waits for the transfers in progress
+    uint32_t m_depth = 0;
+    uint32_t m_transfers = 0;
+};
+
+// Gate of the initializations, shared by the whole process
+inline USBInitGate &GetUSBInitGate()
+{
+    static USBInitGate gate;
+    return gate;
+}
+
+/*
+ * Lock sequences of the usbHs calls: SwitchUSBInterface and SwitchUSBEndpoint only take their locks through them
+ * (The stress tests too). Released in the reverse order.
+ */
+
+// Open and close of an interface (and of all its endpoints): The discovery lock, then the interface
+class USBInterfaceSetupLock
+{
+public:
+    explicit USBInterfaceSetupLock(USBLevelMutex &interfaceMutex) : m_discoveryLock(GetUSBDiscoveryMutex()), m_interfaceLock(interfaceMutex) {}
+
+private:
+    std::lock_guard<USBLevelMutex> m_discoveryLock;
+    std::lock_guard<USBLevelMutex> m_interfaceLock;
+};
+
+// Open and close of an endpoint: Its interface, then the endpoint
+class USBEndpointSetupLock
+{
+public:
+    USBEndpointSetupLock(USBLevelMutex &interfaceMutex, USBLevelMutex &endpointMutex) : m_interfaceLock(interfaceMutex), m_endpointLock(endpointMutex) {}
+
+private:
+    std::lock_guard<USBLevelMutex> m_interfaceLock;
+    std::lock_guard<USBLevelMutex> m_endpointLock;
+};
+
+// Read of an endpoint or control transfer from the device: Only the lock of the endpoint or interface
+class USBInputTransferLock
+{
+public:
+    explicit USBInputTransferLock(USBLevelMutex &mutex) : m_lock(mutex) {}
+
+private:
+    std::lock_guard<USBLevelMutex> m_lock;
+};
+
+// Write of an endpoint, control transfer to the device or reset: The init gate (shared), then the endpoint or interface
+class USBOutputTransferLock
+{
+public:
+    explicit USBOutputTransferLock(USBLevelMutex &mutex) : m_gateLock(GetUSBInitGate()), m_lock(mutex) {}
+
+private:
+    std::shared_lock<USBInitGate> m_gateLock;
+    std::lock_guard<USBLevelMutex> m_lock;
+};
+
+// Initialization of a new controller (Discovery lock held): The init gate, exclusive
+class USBInitLock
+{
+public:
+    USBInitLock() : m_gateLock(GetUSBInitGate()) {}
+
+private:
+    std::lock_guard<USBInitGate> m_gateLock;
+};
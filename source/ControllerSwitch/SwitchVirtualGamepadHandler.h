@@ -1,37 +1,22 @@
 #pragma once
 #include <switch.h>
 #include "IController.h"
-
-class SwitchVirtualGamepadHandlerData
-{
-
-public:
-    bool m_reattach_controller = false;
-    bool m_is_connected = false;
-};
+#include "VirtualGamepadHandler.h"
 
 // This class is a base class for SwitchHDLHandler and SwitchAbstractedPaadHandler.
-class SwitchVirtualGamepadHandler
+// The input loop is VirtualGamepadHandler, this class runs it in a thread of the console.
+class SwitchVirtualGamepadHandler : public VirtualGamepadHandler
 {
     friend void SwitchVirtualGamepadHandlerThreadFunc(void *arg);
 
 protected:
-    SwitchVirtualGamepadHandlerData m_controllerData[CONTROLLER_MAX_INPUTS];
-
-protected:
-    std::unique_ptr<IController> m_controller;
     int32_t m_polling_thread_priority;
-    int32_t m_polling_timeout_ms;
 
     alignas(0x1000) u8 thread_stack[0x2000];
     Thread m_Thread;
     bool m_ThreadIsRunning = false;
 
-    // Fills out the HDL state with the specified button data and passes it to HID
-    virtual bool IsControllerAttached(uint16_t input_idx) = 0;
-    virtual Result UpdateControllerState(u64 buttons, const HidAnalogStickState &analog_stick_l, const HidAnalogStickState &analog_stick_r, uint16_t input_idx) = 0;
-    virtual Result AttachController(uint16_t input_idx) = 0;
-    virtual Result DetachController(uint16_t input_idx) = 0;
+    u64 m_wake_us = 0; // Console wake up of a resumed controller, until its first input
 
     void OnRun();
 
@@ -50,14 +35,10 @@ public:
     // Separately close the input-reading thread
     void ExitThread();
 
-    // The function to call indefinitely by the input thread
-    virtual Result UpdateInput(uint32_t timeout_us);
-    // The function to call indefinitely by the output thread
-    virtual Result UpdateOutput();
+    ControllerResult UpdateInput(uint32_t timeout_us) override;
 
-    static void ConvertAxisToSwitchAxis(float x, float y, int32_t *x_out, int32_t *y_out);
     static u8 ControllerTypeToDeviceType(ControllerType type);
 
-    // Get the raw controller pointer
-    inline IController *GetController() { return m_controller.get(); }
+    // Resumed after a sleep: The time from 'wake_us' to the first input is logged (Before Initialize)
+    inline void SetWakeTime(u64 wake_us) { m_wake_us = wake_us; }
 };
\ No newline at end of file
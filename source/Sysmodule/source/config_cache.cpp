@@ -0,0 +1,283 @@
+#include "config_cache.h"
+#include "logger.h"
+
+#include <cstring>
+
+namespace syscon::config
+{
+    namespace
+    {
+        bool SerializeEntry(uint16_t vid, uint16_t pid, const ControllerConfig &config, ConfigCacheEntry *entry)
+        {
+            if (config.driver.length() >= CONFIG_CACHE_STRING_SIZE || config.profile.length() >= CONFIG_CACHE_STRING_SIZE)
+                return false; // Can't be cached, will always be resolved from the INI
+
+            memset(entry, 0, sizeof(ConfigCacheEntry));
+
+            entry->vid = vid;
+            entry->pid = pid;
+            memcpy(entry->driver, config.driver.c_str(), config.driver.length());
+            memcpy(entry->profile, config.profile.c_str(), config.profile.length());
+            entry->inputMaxPacketSize = config.inputMaxPacketSize;
+            entry->outputMaxPacketSize = config.outputMaxPacketSize;
+            entry->controllerType = config.controllerType;
+            memcpy(entry->analogDeadzonePercent, config.analogDeadzonePercent, sizeof(entry->analogDeadzonePercent));
+            memcpy(entry->analogFactorPercent, config.analogFactorPercent, sizeof(entry->analogFactorPercent));
+            memcpy(entry->buttonsPin, config.buttonsPin, sizeof(entry->buttonsPin));
+            entry->buttonsAnalogUsed = config.buttonsAnalogUsed ? 1 : 0;
+
+            for (int i = 0; i < ControllerButton::COUNT; i++)
+            {
+                entry->buttonsAnalogBind[i] = config.buttonsAnalog[i].bind;
+                entry->buttonsAnalogSign[i] = config.buttonsAnalog[i].sign;
+            }
+
+            for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
+            {
+                entry->simulateCombos[i][0] = config.simulateCombos[i].buttonSimulated;
+                entry->simulateCombos[i][1] = config.simulateCombos[i].buttons[0];
+                entry->simulateCombos[i][2] = config.simulateCombos[i].buttons[1];
+            }
+
+            entry->colors[0] = config.bodyColor.rgbaValue;
+            entry->colors[1] = config.buttonsColor.rgbaValue;
+            entry->colors[2] = config.leftGripColor.rgbaValue;
+            entry->colors[3] = config.rightGripColor.rgbaValue;
+
+            return true;
+        }
+
+        // Every value used as an index by the mapping (BaseController::MapRawInputToNormalized) is in range
+        bool IsEntryValid(const ConfigCacheEntry &entry)
+        {
+            if (entry.controllerType > ControllerType_Famicom)
+                return false;
+
+            for (int i = 0; i < ControllerButton::COUNT; i++)
+            {
+                for (int j = 0; j < MAX_PIN_BY_BUTTONS; j++)
+                {
+                    if (entry.buttonsPin[i][j] >= MAX_CONTROLLER_BUTTONS)
+                        return false;
+                }
+
+                if (entry.buttonsAnalogBind[i] >= ControllerAnalogBinding_Count)
+                    return false;
+            }
+
+            for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    if (entry.simulateCombos[i][j] >= ControllerButton::COUNT)
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        void DeserializeEntry(const ConfigCacheEntry &entry, ControllerConfig *config)
+        {
+            config->driver = std::string(entry.driver, strnlen(entry.driver, CONFIG_CACHE_STRING_SIZE));
+            config->profile = std::string(entry.profile, strnlen(entry.profile, CONFIG_CACHE_STRING_SIZE));
+            config->inputMaxPacketSize = entry.inputMaxPacketSize;
+            config->outputMaxPacketSize = entry.outputMaxPacketSize;
+            config->controllerType = static_cast<ControllerType>(entry.controllerType);
+            memcpy(config->analogDeadzonePercent, entry.analogDeadzonePercent, sizeof(entry.analogDeadzonePercent));
+            memcpy(config->analogFactorPercent, entry.analogFactorPercent, sizeof(entry.analogFactorPercent));
+            memcpy(config->buttonsPin, entry.buttonsPin, sizeof(entry.buttonsPin));
+            config->buttonsAnalogUsed = entry.buttonsAnalogUsed != 0;
+
+            for (int i = 0; i < ControllerButton::COUNT; i++)
+            {
+                config->buttonsAnalog[i].bind = static_cast<ControllerAnalogBinding>(entry.buttonsAnalogBind[i]);
+                config->buttonsAnalog[i].sign = entry.buttonsAnalogSign[i];
+            }
+
+            for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
+            {
+                config->simulateCombos[i].buttonSimulated = static_cast<ControllerButton>(entry.simulateCombos[i][0]);
+                config->simulateCombos[i].buttons[0] = static_cast<ControllerButton>(entry.simulateCombos[i][1]);
+                config->simulateCombos[i].buttons[1] = static_cast<ControllerButton>(entry.simulateCombos[i][2]);
+            }
+
+            config->bodyColor.rgbaValue = entry.colors[0];
+            config->buttonsColor.rgbaValue = entry.colors[1];
+            config->leftGripColor.rgbaValue = entry.colors[2];
+            config->rightGripColor.rgbaValue = entry.colors[3];
+        }
+    } // namespace
+
+    uint32_t Crc32(const void *data, size_t size, uint32_t crc)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+        {
+            crc ^= bytes[i];
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+
+        return ~crc;
+    }
+
+    void ControllerConfigCache::SetPath(const std::string &cacheFullPath)
+    {
+        m_path = cacheFullPath;
+        m_loaded = false;
+        m_dirty = false;
+        m_entries.clear();
+    }
+
+    bool ControllerConfigCache::IsEnabled() const
+    {
+        return !m_path.empty();
+    }
+
+    void ControllerConfigCache::Load(IFileManager *fileManager, uint32_t iniHash)
+    {
+        if (m_loaded && m_iniHash == iniHash)
+            return; // Already up to date
+
+        m_loaded = true;
+        m_dirty = false;
+        m_iniHash = iniHash;
+        m_entries.clear();
+
+        std::uintmax_t size = fileManager->file_size(m_path);
+        if (size < sizeof(ConfigCacheHeader))
+            return; // No cache yet
+
+        std::unique_ptr<IFile> file = fileManager->open(m_path, OpenFlags_Read);
+        if (!file)
+            return;
+
+        std::vector<uint8_t> data(size);
+        if (file->read(data.data(), data.size()) != data.size())
+        {
+            syscon::logger::LogError("Unable to read config cache: '%s' !", m_path.c_str());
+            return;
+        }
+
+        ConfigCacheHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != CONFIG_CACHE_MAGIC || header.version != CONFIG_CACHE_VERSION || header.entry_size != sizeof(ConfigCacheEntry) ||
+            size != sizeof(ConfigCacheHeader) + (std::uintmax_t)header.entry_count * sizeof(ConfigCacheEntry))
+        {
+            syscon::logger::LogWarning("Config cache '%s' is invalid (Version: %d, Size: %ju), ignoring it !", m_path.c_str(), header.version, size);
+            return;
+        }
+
+        uint32_t crc = header.crc;
+        header.crc = 0;
+        if (Crc32(data.data() + sizeof(ConfigCacheHeader), size - sizeof(ConfigCacheHeader), Crc32(&header, sizeof(header))) != crc)
+        {
+            syscon::logger::LogWarning("Config cache '%s' is corrupted (CRC), ignoring it !", m_path.c_str());
+            return;
+        }
+
+        if (header.ini_hash != iniHash)
+        {
+            syscon::logger::LogDebug("Config cache '%s' is outdated, ignoring it", m_path.c_str());
+            return;
+        }
+
+        m_entries.resize(header.entry_count);
+        memcpy(m_entries.data(), data.data() + sizeof(ConfigCacheHeader), header.entry_count * sizeof(ConfigCacheEntry));
+
+        for (const ConfigCacheEntry &entry : m_entries)
+        {
+            if (!IsEntryValid(entry))
+            {
+                syscon::logger::LogWarning("Config cache '%s' has an invalid entry [%04x-%04x], ignoring it !", m_path.c_str(), entry.vid, entry.pid);
+                m_entries.clear();
+                return;
+            }
+        }
+
+        syscon::logger::LogDebug("Config cache '%s' loaded (%d entries)", m_path.c_str(), header.entry_count);
+    }
+
+    bool ControllerConfigCache::Find(uint16_t vid, uint16_t pid, ControllerConfig *config) const
+    {
+        for (const ConfigCacheEntry &entry : m_entries)
+        {
+            if (entry.vid == vid && entry.pid == pid)
+            {
+                DeserializeEntry(entry, config);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    int ControllerConfigCache::Store(uint32_t iniHash, uint16_t vid, uint16_t pid, const ControllerConfig &config)
+    {
+        ConfigCacheEntry newEntry;
+
+        if (!SerializeEntry(vid, pid, config, &newEntry))
+            return -1;
+
+        if (!m_loaded || m_iniHash != iniHash)
+        {
+            // Entries built from another version of the INI are dropped
+            m_loaded = true;
+            m_iniHash = iniHash;
+            m_entries.clear();
+        }
+
+        bool replaced = false;
+        for (ConfigCacheEntry &entry : m_entries)
+        {
+            if (entry.vid == vid && entry.pid == pid)
+            {
+                entry = newEntry;
+                replaced = true;
+            }
+        }
+
+        if (!replaced)
+            m_entries.push_back(newEntry);
+
+        m_dirty = true;
+        return 0;
+    }
+
+    int ControllerConfigCache::Flush(IFileManager *fileManager)
+    {
+        if (!m_dirty || m_path.empty())
+            return 0;
+
+        m_dirty = false;
+
+        ConfigCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = CONFIG_CACHE_MAGIC;
+        header.version = CONFIG_CACHE_VERSION;
+        header.ini_hash = m_iniHash;
+        header.entry_size = sizeof(ConfigCacheEntry);
+        header.entry_count = m_entries.size();
+        header.crc = Crc32(m_entries.data(), m_entries.size() * sizeof(ConfigCacheEntry), Crc32(&header, sizeof(header)));
+
+        std::vector<uint8_t> data(sizeof(ConfigCacheHeader) + m_entries.size() * sizeof(ConfigCacheEntry));
+        memcpy(data.data(), &header, sizeof(header));
+        memcpy(data.data() + sizeof(header), m_entries.data(), m_entries.size() * sizeof(ConfigCacheEntry));
+
+        fileManager->remove(m_path); // Make sure the file is truncated
+
+        std::unique_ptr<IFile> file = fileManager->open(m_path, OpenFlags_Write);
+        if (!file || file->write(data.data(), data.size()) != data.size())
+        {
+            syscon::logger::LogError("Unable to write config cache: '%s' !", m_path.c_str());
+            return -1;
+        }
+
+        syscon::logger::LogDebug("Config cache '%s' written (%d entries)", m_path.c_str(), (int)m_entries.size());
+        return 0;
+    }
+} // namespace syscon::config
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ifilemanager.h"
+#include "ControllerConfig.h"
+#include <string>
+#include <vector>
+
+/*
+ * Binary cache of the resolved ControllerConfig (default -> profile -> vid-pid)
+ *
+ * The file is made of a header followed by fixed size entries (one per VID/PID), covered by a CRC.
+ * It is only valid for the config.ini it was built from (Same content hash: the INI is read but not parsed on a hit).
+ * If the hash, the version, the entry size or the CRC do not match, or an entry holds an out of range value
+ * (button, analog binding, ...), the whole cache is discarded and the config is resolved from the text again.
+ * New entries are only written to the file by Flush (Deferred: one SD write for all the controllers connected meanwhile).
+ */
+
+#define CONFIG_CACHE_MAGIC       0x43435953 // "SYCC"
+#define CONFIG_CACHE_VERSION     3          // Increase it each time ConfigCacheEntry or the config parsing change
+#define CONFIG_CACHE_STRING_SIZE 32
+
+namespace syscon::config
+{
+    struct ConfigCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t ini_hash; // Crc32 of the content of config.ini
+        uint32_t crc;      // Crc32 of the header (With crc = 0) and of the entries
+        uint32_t entry_size;
+        uint32_t entry_count;
+    };
+
+    struct ConfigCacheEntry
+    {
+        uint16_t vid;
+        uint16_t pid;
+        char driver[CONFIG_CACHE_STRING_SIZE];
+        char profile[CONFIG_CACHE_STRING_SIZE];
+        uint32_t inputMaxPacketSize;
+        uint32_t outputMaxPacketSize;
+        uint32_t controllerType;
+        uint8_t analogDeadzonePercent[ControllerAnalogBinding_Count];
+        uint8_t analogFactorPercent[ControllerAnalogBinding_Count];
+        uint8_t buttonsPin[ControllerButton::COUNT][MAX_PIN_BY_BUTTONS];
+        uint8_t buttonsAnalogUsed;
+        uint8_t buttonsAnalogBind[ControllerButton::COUNT];
+        float buttonsAnalogSign[ControllerButton::COUNT];
+        uint8_t simulateCombos[MAX_CONTROLLER_COMBO][3]; // buttonSimulated, buttons[0], buttons[1]
+        uint32_t colors[4];                              // body, buttons, leftGrip, rightGrip
+    };
+
+    // CRC-32 (IEEE), 'crc' chains the result of a previous block
+    uint32_t Crc32(const void *data, size_t size, uint32_t crc = 0);
+
+    class ControllerConfigCache
+    {
+    public:
+        void SetPath(const std::string &cacheFullPath);
+        bool IsEnabled() const;
+
+        // Read the cache file (single read) unless it was already loaded for this INI content
+        void Load(IFileManager *fileManager, uint32_t iniHash);
+
+        bool Find(uint16_t vid, uint16_t pid, ControllerConfig *config) const;
+
+        // Add (or replace) an entry in memory, the file is written by Flush
+        int Store(uint32_t iniHash, uint16_t vid, uint16_t pid, const ControllerConfig &config);
+
+        // Rewrite the cache file if entries were stored since the last flush
+        int Flush(IFileManager *fileManager);
+
+    private:
+        std::string m_path;
+        bool m_loaded{false};
+        bool m_dirty{false};
+        uint32_t m_iniHash{0};
+        std::vector<ConfigCacheEntry> m_entries;
+    };
+} // namespace syscon::config
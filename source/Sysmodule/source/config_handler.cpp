@@ -1,4 +1,6 @@
 #include "config_handler.h"
+#include "config_cache.h"
+#include "config_keywords.h"
 
 #include "logger.h"
 #include "ini.h"
@@ -8,6 +10,9 @@
 #include <fstream>
 #include <filesystem>
 #include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include <mutex>
 
 #ifdef WIN32
     #define strtok_r                       strtok_s
@@ -20,96 +25,206 @@ namespace syscon::config
     {
         std::unique_ptr<IFileManager> file_manager;
 
-        // Utils function
-        std::string convertToLowercase(const std::string &str)
+        // Section names are case-insensitive
+        struct ConfigSectionHash
         {
-            std::string result = "";
-            for (char ch : str)
-                result += tolower(ch);
-            return result;
-        }
+            size_t operator()(const std::string &section) const
+            {
+                return ConfigKeywordHash(section, 0);
+            }
+        };
 
-        class ConfigINIData
+        struct ConfigSectionEqual
         {
-        public:
-            std::string ini_section;
-            ControllerConfig *controller_config;
-            GlobalConfig *global_config;
-            bool ini_section_found;
-
-            ConfigINIData(const std::string &ini_section_str, ControllerConfig *config) : ini_section(convertToLowercase(ini_section_str)),
-                                                                                          controller_config(config),
-                                                                                          global_config(NULL),
-                                                                                          ini_section_found(false)
+            bool operator()(const std::string &a, const std::string &b) const
             {
+                return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return ConfigKeywordToLower(x) == ConfigKeywordToLower(y); });
             }
+        };
+
+        class ConfigKeyValue
+        {
+        public:
+            ConfigKeyValue(const std::string &name, const std::string &value) : name(name), value(value) {}
+
+            std::string name;
+            std::string value;
+        };
 
-            ConfigINIData(const std::string &ini_section_str, GlobalConfig *config) : ini_section(convertToLowercase(ini_section_str)),
-                                                                                      controller_config(NULL),
-                                                                                      global_config(config),
-                                                                                      ini_section_found(false)
+        /*
+            In-memory copy of the configuration file: section name => list of key/values (in file order)
+            The file is parsed once and the index is reused as long as its content did not change (Same hash).
+            The size and mtime are only polled to detect a modification (ReloadIfModified).
+        */
+        class ConfigIndex
+        {
+        public:
+            std::string path;
+            std::uintmax_t size{0};
+            std::int64_t mtime{0};
+            uint32_t hash{0}; // Crc32 of the content
+            bool valid{false};
+            std::unordered_map<std::string, std::vector<ConfigKeyValue>, ConfigSectionHash, ConfigSectionEqual> sections;
+
+            const std::vector<ConfigKeyValue> *GetSection(const std::string &section) const
             {
+                auto it = sections.find(section);
+                if (it == sections.end())
+                    return nullptr;
+
+                return &it->second;
             }
         };
 
-        ControllerButton stringToButton(const char *name)
-        {
-            std::string nameStr = convertToLowercase(name);
-
-            if (nameStr == "b")
-                return ControllerButton::B;
-            else if (nameStr == "a")
-                return ControllerButton::A;
-            else if (nameStr == "x")
-                return ControllerButton::X;
-            else if (nameStr == "y")
-                return ControllerButton::Y;
-            else if (nameStr == "lstick_click")
-                return ControllerButton::LSTICK_CLICK;
-            else if (nameStr == "lstick_left")
-                return ControllerButton::LSTICK_LEFT;
-            else if (nameStr == "lstick_right")
-                return ControllerButton::LSTICK_RIGHT;
-            else if (nameStr == "lstick_up")
-                return ControllerButton::LSTICK_UP;
-            else if (nameStr == "lstick_down")
-                return ControllerButton::LSTICK_DOWN;
-            else if (nameStr == "rstick_click")
-                return ControllerButton::RSTICK_CLICK;
-            else if (nameStr == "rstick_left")
-                return ControllerButton::RSTICK_LEFT;
-            else if (nameStr == "rstick_right")
-                return ControllerButton::RSTICK_RIGHT;
-            else if (nameStr == "rstick_up")
-                return ControllerButton::RSTICK_UP;
-            else if (nameStr == "rstick_down")
-                return ControllerButton::RSTICK_DOWN;
-            else if (nameStr == "l")
-                return ControllerButton::L;
-            else if (nameStr == "r")
-                return ControllerButton::R;
-            else if (nameStr == "zl")
-                return ControllerButton::ZL;
-            else if (nameStr == "zr")
-                return ControllerButton::ZR;
-            else if (nameStr == "minus")
-                return ControllerButton::MINUS;
-            else if (nameStr == "plus")
-                return ControllerButton::PLUS;
-            else if (nameStr == "dpad_up")
-                return ControllerButton::DPAD_UP;
-            else if (nameStr == "dpad_right")
-                return ControllerButton::DPAD_RIGHT;
-            else if (nameStr == "dpad_down")
-                return ControllerButton::DPAD_DOWN;
-            else if (nameStr == "dpad_left")
-                return ControllerButton::DPAD_LEFT;
-            else if (nameStr == "capture")
-                return ControllerButton::CAPTURE;
-            else if (nameStr == "home")
-                return ControllerButton::HOME;
-
-            return ControllerButton::NONE;
+        ConfigIndex config_index;
+        std::mutex config_index_mutex;
+        ControllerConfigCache config_cache;
+
+        constexpr auto button_keywords = MakeConfigKeywordTable<ControllerButton>({
+            {"b", ControllerButton::B},
+            {"a", ControllerButton::A},
+            {"x", ControllerButton::X},
+            {"y", ControllerButton::Y},
+            {"lstick_click", ControllerButton::LSTICK_CLICK},
+            {"lstick_left", ControllerButton::LSTICK_LEFT},
+            {"lstick_right", ControllerButton::LSTICK_RIGHT},
+            {"lstick_up", ControllerButton::LSTICK_UP},
+            {"lstick_down", ControllerButton::LSTICK_DOWN},
+            {"rstick_click", ControllerButton::RSTICK_CLICK},
+            {"rstick_left", ControllerButton::RSTICK_LEFT},
+            {"rstick_right", ControllerButton::RSTICK_RIGHT},
+            {"rstick_up", ControllerButton::RSTICK_UP},
+            {"rstick_down", ControllerButton::RSTICK_DOWN},
+            {"l", ControllerButton::L},
+            {"r", ControllerButton::R},
+            {"zl", ControllerButton::ZL},
+            {"zr", ControllerButton::ZR},
+            {"minus", ControllerButton::MINUS},
+            {"plus", ControllerButton::PLUS},
+            {"dpad_up", ControllerButton::DPAD_UP},
+            {"dpad_right", ControllerButton::DPAD_RIGHT},
+            {"dpad_down", ControllerButton::DPAD_DOWN},
+            {"dpad_left", ControllerButton::DPAD_LEFT},
+            {"capture", ControllerButton::CAPTURE},
+            {"home", ControllerButton::HOME},
+        });
+
+        constexpr auto analog_keywords = MakeConfigKeywordTable<ControllerAnalogBinding>({
+            {"x", ControllerAnalogBinding::ControllerAnalogBinding_X},
+            {"y", ControllerAnalogBinding::ControllerAnalogBinding_Y},
+            {"z", ControllerAnalogBinding::ControllerAnalogBinding_Z},
+            {"rz", ControllerAnalogBinding::ControllerAnalogBinding_Rz},
+            {"rx", ControllerAnalogBinding::ControllerAnalogBinding_Rx},
+            {"ry", ControllerAnalogBinding::ControllerAnalogBinding_Ry},
+            {"slider", ControllerAnalogBinding::ControllerAnalogBinding_Slider},
+            {"dial", ControllerAnalogBinding::ControllerAnalogBinding_Dial},
+            {"brake", ControllerAnalogBinding::ControllerAnalogBinding_Brake},
+            {"accelerator", ControllerAnalogBinding::ControllerAnalogBinding_Accelerator},
+            {"none", ControllerAnalogBinding::ControllerAnalogBinding_Unknown},
+        });
+
+        constexpr auto controller_type_keywords = MakeConfigKeywordTable<ControllerType>({
+            {"prowithbattery", ControllerType_ProWithBattery},
+            {"tarragon", ControllerType_Tarragon},
+            {"snes", ControllerType_Snes},
+            {"pokeballplus", ControllerType_PokeballPlus},
+            {"gamecube", ControllerType_Gamecube},
+            {"pro", ControllerType_Pro},
+            {"3rdpartypro", ControllerType_3rdPartyPro},
+            {"n64", ControllerType_N64},
+            {"sega", ControllerType_Sega},
+            {"nes", ControllerType_Nes},
+            {"famicom", ControllerType_Famicom},
+        });
+
+        enum GlobalConfigKey
+        {
+            GlobalConfigKey_PollingTimeoutMs,
+            GlobalConfigKey_PollingThreadPriority,
+            GlobalConfigKey_LogLevel,
+            GlobalConfigKey_LogBinary,
+            GlobalConfigKey_LogSyncErrors,
+            GlobalConfigKey_StatsPeriodS,
+            GlobalConfigKey_RecordReports,
+            GlobalConfigKey_DiscoveryMode,
+            GlobalConfigKey_AutoAddController,
+            GlobalConfigKey_DiscoveryVidPid,
+        };
+
+        constexpr auto global_keywords = MakeConfigKeywordTable<GlobalConfigKey>({
+            {"polling_timeout_ms", GlobalConfigKey_PollingTimeoutMs},
+            {"polling_thread_priority", GlobalConfigKey_PollingThreadPriority},
+            {"log_level", GlobalConfigKey_LogLevel},
+            {"log_binary", GlobalConfigKey_LogBinary},
+            {"log_sync_errors", GlobalConfigKey_LogSyncErrors},
+            {"stats_period_s", GlobalConfigKey_StatsPeriodS},
+            {"record_reports", GlobalConfigKey_RecordReports},
+            {"discovery_mode", GlobalConfigKey_DiscoveryMode},
+            {"auto_add_controller", GlobalConfigKey_AutoAddController},
+            {"discovery_vidpid", GlobalConfigKey_DiscoveryVidPid},
+        });
+
+        enum ControllerConfigKeyType
+        {
+            ControllerConfigKeyType_Driver,
+            ControllerConfigKeyType_Profile,
+            ControllerConfigKeyType_InputMaxPacketSize,
+            ControllerConfigKeyType_OutputMaxPacketSize,
+            ControllerConfigKeyType_ControllerType,
+            ControllerConfigKeyType_Deadzone,
+            ControllerConfigKeyType_Factor,
+            ControllerConfigKeyType_ColorBody,
+            ControllerConfigKeyType_ColorButtons,
+            ControllerConfigKeyType_ColorLeftGrip,
+            ControllerConfigKeyType_ColorRightGrip,
+        };
+
+        struct ControllerConfigKey
+        {
+            ControllerConfigKeyType type{ControllerConfigKeyType_Driver};
+            ControllerAnalogBinding axis{ControllerAnalogBinding::ControllerAnalogBinding_Unknown}; // Deadzone and Factor only
+        };
+
+        // Buttons (b, a, x, ...) and simulate_xxx are handled separately
+        constexpr auto controller_keywords = MakeConfigKeywordTable<ControllerConfigKey>({
+            {"driver", {ControllerConfigKeyType_Driver}},
+            {"profile", {ControllerConfigKeyType_Profile}},
+            {"input_max_packet_size", {ControllerConfigKeyType_InputMaxPacketSize}},
+            {"output_max_packet_size", {ControllerConfigKeyType_OutputMaxPacketSize}},
+            {"controller_type", {ControllerConfigKeyType_ControllerType}},
+            {"deadzone_x", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_X}},
+            {"deadzone_y", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Y}},
+            {"deadzone_z", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Z}},
+            {"deadzone_rz", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Rz}},
+            {"deadzone_rx", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Rx}},
+            {"deadzone_ry", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Ry}},
+            {"deadzone_slider", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Slider}},
+            {"deadzone_dial", {ControllerConfigKeyType_Deadzone, ControllerAnalogBinding::ControllerAnalogBinding_Dial}},
+            {"factor_x", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_X}},
+            {"factor_y", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Y}},
+            {"factor_z", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Z}},
+            {"factor_rz", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Rz}},
+            {"factor_rx", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Rx}},
+            {"factor_ry", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Ry}},
+            {"factor_slider", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Slider}},
+            {"factor_dial", {ControllerConfigKeyType_Factor, ControllerAnalogBinding::ControllerAnalogBinding_Dial}},
+            {"color_body", {ControllerConfigKeyType_ColorBody}},
+            {"color_buttons", {ControllerConfigKeyType_ColorButtons}},
+            {"color_leftgrip", {ControllerConfigKeyType_ColorLeftGrip}},
+            {"color_rightgrip", {ControllerConfigKeyType_ColorRightGrip}},
+        });
+
+        ControllerButton stringToButton(std::string_view name)
+        {
+            return button_keywords.Find(name, ControllerButton::NONE);
+        }
+
+        std::string stringToLowercase(const char *str)
+        {
+            std::string result = str;
+            for (char &ch : result)
+                ch = ConfigKeywordToLower(ch);
+            return result;
         }
 
         RGBAColor hexStringColorToRGBA(const char *value)
@@ -137,41 +252,19 @@ namespace syscon::config
             return color;
         }
 
-        bool stringToAnalogConfig(const std::string &cfg, ControllerAnalogConfig *analogCfg)
+        bool stringToAnalogConfig(std::string_view cfg, ControllerAnalogConfig *analogCfg)
         {
-            std::string stickcfg = convertToLowercase(cfg);
-
             analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Unknown;
-            analogCfg->sign = stickcfg[0] == '-' ? -1.0f : 1.0f;
-
-            if (stickcfg[0] == '-' || stickcfg[0] == '+')
-                stickcfg = stickcfg.substr(1);
-
-            if (stickcfg == "x")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_X;
-            else if (stickcfg == "y")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Y;
-            else if (stickcfg == "z")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Z;
-            else if (stickcfg == "rz")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Rz;
-            else if (stickcfg == "rx")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Rx;
-            else if (stickcfg == "ry")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Ry;
-            else if (stickcfg == "slider")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Slider;
-            else if (stickcfg == "dial")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Dial;
-            else if (stickcfg == "brake")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Brake;
-            else if (stickcfg == "accelerator")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Accelerator;
-            else if (stickcfg == "none")
-                analogCfg->bind = ControllerAnalogBinding::ControllerAnalogBinding_Unknown;
-            else
+            analogCfg->sign = (!cfg.empty() && cfg[0] == '-') ? -1.0f : 1.0f;
+
+            if (!cfg.empty() && (cfg[0] == '-' || cfg[0] == '+'))
+                cfg.remove_prefix(1);
+
+            const ControllerAnalogBinding *bind = analog_keywords.Find(cfg);
+            if (bind == nullptr)
                 return false;
 
+            analogCfg->bind = *bind;
             return true;
         }
 
@@ -236,220 +329,290 @@ namespace syscon::config
             }
         }
 
-        ControllerType stringToControllerType(const char *value)
-        {
-            std::string type = convertToLowercase(value);
-
-            if (type == "prowithbattery")
-                return ControllerType_ProWithBattery;
-            else if (type == "tarragon")
-                return ControllerType_Tarragon;
-            else if (type == "snes")
-                return ControllerType_Snes;
-            else if (type == "pokeballplus")
-                return ControllerType_PokeballPlus;
-            else if (type == "gamecube")
-                return ControllerType_Gamecube;
-            else if (type == "pro")
-                return ControllerType_Pro;
-            else if (type == "3rdpartypro")
-                return ControllerType_3rdPartyPro;
-            else if (type == "n64")
-                return ControllerType_N64;
-            else if (type == "sega")
-                return ControllerType_Sega;
-            else if (type == "nes")
-                return ControllerType_Nes;
-            else if (type == "famicom")
-                return ControllerType_Famicom;
-
-            return ControllerType_Unknown;
-        }
-
-        int ParseGlobalConfigLine(void *data, const char *section, const char *name, const char *value)
-        {
-            ConfigINIData *ini_data = static_cast<ConfigINIData *>(data);
-            std::string sectionStr = convertToLowercase(section);
-            std::string nameStr = convertToLowercase(name);
-
-            // syscon::logger::LogTrace("Parsing global config line: %s, %s, %s (expect: %s)", section, name, value, ini_data->ini_section.c_str());
-            if (ini_data->ini_section != sectionStr)
-                return 1; // Not the section we are looking for (return success to continue parsing)
-
-            ini_data->ini_section_found = true;
-
-            if (nameStr == "polling_timeout_ms")
-                ini_data->global_config->polling_timeout_ms = atoi(value);
-            else if (nameStr == "polling_thread_priority")
-                ini_data->global_config->polling_thread_priority = atoi(value);
-            else if (nameStr == "log_level")
-                ini_data->global_config->log_level = atoi(value);
-            else if (nameStr == "discovery_mode")
-                ini_data->global_config->discovery_mode = static_cast<DiscoveryMode>(atoi(value));
-            else if (nameStr == "auto_add_controller")
-                ini_data->global_config->auto_add_controller = (atoi(value) == 0) ? false : true;
-            else if (nameStr == "discovery_vidpid")
+        void ParseGlobalConfigKey(GlobalConfig *config, const std::string &nameStr, char *value)
+        {
+            const GlobalConfigKey *key = global_keywords.Find(nameStr);
+            if (key == nullptr)
             {
-                char *context;
-                char *tok = strtok_r(const_cast<char *>(value), ",", &context);
+                syscon::logger::LogError("Unknown key: %s, continue anyway ...", nameStr.c_str());
+                return;
+            }
 
-                while (tok != NULL)
+            switch (*key)
+            {
+                case GlobalConfigKey_PollingTimeoutMs:
+                    config->polling_timeout_ms = atoi(value);
+                    break;
+                case GlobalConfigKey_PollingThreadPriority:
+                    config->polling_thread_priority = atoi(value);
+                    break;
+                case GlobalConfigKey_LogLevel:
+                    config->log_level = atoi(value);
+                    break;
+                case GlobalConfigKey_LogBinary:
+                    config->log_binary = (atoi(value) == 0) ? false : true;
+                    break;
+                case GlobalConfigKey_LogSyncErrors:
+                    config->log_sync_errors = (atoi(value) == 0) ? false : true;
+                    break;
+                case GlobalConfigKey_StatsPeriodS:
+                    config->stats_period_s = atoi(value);
+                    break;
+                case GlobalConfigKey_RecordReports:
+                    config->record_reports = (atoi(value) == 0) ? false : true;
+                    break;
+                case GlobalConfigKey_DiscoveryMode:
+                    config->discovery_mode = static_cast<DiscoveryMode>(atoi(value));
+                    break;
+                case GlobalConfigKey_AutoAddController:
+                    config->auto_add_controller = (atoi(value) == 0) ? false : true;
+                    break;
+                case GlobalConfigKey_DiscoveryVidPid:
                 {
-                    ini_data->global_config->discovery_vidpid.push_back(ControllerVidPid(tok));
-                    tok = strtok_r(NULL, ",", &context);
+                    char *context;
+                    char *tok = strtok_r(const_cast<char *>(value), ",", &context);
+
+                    while (tok != NULL)
+                    {
+                        config->discovery_vidpid.push_back(ControllerVidPid(tok));
+                        tok = strtok_r(NULL, ",", &context);
+                    }
+                    break;
                 }
             }
-            else
-            {
-                syscon::logger::LogError("Unknown key: %s, continue anyway ...", name);
-            }
-
-            return 1; // Success
         }
 
-        int ParseControllerConfigLine(void *data, const char *section, const char *name, const char *value)
+        void ParseSimulateConfigKey(ControllerConfig *config, const std::string &nameStr, char *value)
         {
-            ConfigINIData *ini_data = static_cast<ConfigINIData *>(data);
-            std::string sectionStr = convertToLowercase(section);
-            std::string nameStr = convertToLowercase(name);
+            ControllerButton btn = stringToButton(std::string_view(nameStr).substr(9));
+            if (btn == ControllerButton::NONE || btn >= ControllerButton::COUNT)
+            {
+                syscon::logger::LogError("Unknown key: %s, continue anyway ...", nameStr.c_str());
+                return;
+            }
 
-            // syscon::logger::LogTrace("Parsing controller config line: %s, %s, %s (expect: %s)", section, name, value, ini_data->ini_section.c_str());
-            if (ini_data->ini_section != sectionStr)
-                return 1; // Not the section we are looking for (return success to continue parsing)
+            for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
+            {
+                if (config->simulateCombos[i].buttonSimulated != ControllerButton::NONE)
+                    continue; // Search for a free slot
 
-            ini_data->ini_section_found = true;
+                config->simulateCombos[i].buttonSimulated = btn;
+                parseHotKey(value, config->simulateCombos[i].buttons);
+                break; // Found a free slot
+            }
+        }
 
-            ControllerButton buttonId = stringToButton(nameStr.c_str());
+        void ParseControllerConfigKey(ControllerConfig *config, const std::string &nameStr, char *value)
+        {
+            ControllerButton buttonId = stringToButton(nameStr);
             if (buttonId != ControllerButton::NONE)
             {
-                ini_data->controller_config->buttonsAnalogUsed = true;
-                parseBinding(value, ini_data->controller_config->buttonsPin[buttonId], &ini_data->controller_config->buttonsAnalog[buttonId]);
+                config->buttonsAnalogUsed = true;
+                parseBinding(value, config->buttonsPin[buttonId], &config->buttonsAnalog[buttonId]);
+                return;
             }
-            else if (nameStr == "driver")
-                ini_data->controller_config->driver = convertToLowercase(value);
-            else if (nameStr == "profile")
-                ini_data->controller_config->profile = convertToLowercase(value);
-            else if (nameStr == "input_max_packet_size")
-                ini_data->controller_config->inputMaxPacketSize = atoi(value);
-            else if (nameStr == "output_max_packet_size")
-                ini_data->controller_config->outputMaxPacketSize = atoi(value);
-            else if (nameStr == "controller_type")
-                ini_data->controller_config->controllerType = stringToControllerType(value);
-            else if (nameStr.starts_with("simulate_"))
-            {
-                ControllerButton btn = stringToButton(nameStr.substr(9).c_str());
-                if (btn != ControllerButton::NONE && btn < ControllerButton::COUNT)
-                {
-                    for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
-                    {
-                        if (ini_data->controller_config->simulateCombos[i].buttonSimulated != ControllerButton::NONE)
-                            continue; // Search for a free slot
 
-                        ini_data->controller_config->simulateCombos[i].buttonSimulated = btn;
-                        parseHotKey(value, ini_data->controller_config->simulateCombos[i].buttons);
-                        break; // Found a free slot
-                    }
-                }
+            const ControllerConfigKey *key = controller_keywords.Find(nameStr);
+            if (key == nullptr)
+            {
+                if (nameStr.size() > 9 && ConfigKeywordEquals("simulate_", std::string_view(nameStr).substr(0, 9)))
+                    ParseSimulateConfigKey(config, nameStr, value);
                 else
                     syscon::logger::LogError("Unknown key: %s, continue anyway ...", nameStr.c_str());
+                return;
             }
-            else if (nameStr == "deadzone_x")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_X] = atoi(value);
-            else if (nameStr == "deadzone_y")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Y] = atoi(value);
-            else if (nameStr == "deadzone_z")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Z] = atoi(value);
-            else if (nameStr == "deadzone_rz")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Rz] = atoi(value);
-            else if (nameStr == "deadzone_rx")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Rx] = atoi(value);
-            else if (nameStr == "deadzone_ry")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Ry] = atoi(value);
-            else if (nameStr == "deadzone_slider")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Slider] = atoi(value);
-            else if (nameStr == "deadzone_dial")
-                ini_data->controller_config->analogDeadzonePercent[ControllerAnalogBinding::ControllerAnalogBinding_Dial] = atoi(value);
-            else if (nameStr == "factor_x")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_X] = atoi(value);
-            else if (nameStr == "factor_y")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Y] = atoi(value);
-            else if (nameStr == "factor_z")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Z] = atoi(value);
-            else if (nameStr == "factor_rz")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Rz] = atoi(value);
-            else if (nameStr == "factor_rx")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Rx] = atoi(value);
-            else if (nameStr == "factor_ry")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Ry] = atoi(value);
-            else if (nameStr == "factor_slider")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Slider] = atoi(value);
-            else if (nameStr == "factor_dial")
-                ini_data->controller_config->analogFactorPercent[ControllerAnalogBinding::ControllerAnalogBinding_Dial] = atoi(value);
-            else if (nameStr == "color_body")
-                ini_data->controller_config->bodyColor = hexStringColorToRGBA(value);
-            else if (nameStr == "color_buttons")
-                ini_data->controller_config->buttonsColor = hexStringColorToRGBA(value);
-            else if (nameStr == "color_leftgrip")
-                ini_data->controller_config->leftGripColor = hexStringColorToRGBA(value);
-            else if (nameStr == "color_rightgrip")
-                ini_data->controller_config->rightGripColor = hexStringColorToRGBA(value);
-            else
+
+            switch (key->type)
             {
-                syscon::logger::LogError("Unknown key: %s, continue anyway ...", name);
+                case ControllerConfigKeyType_Driver:
+                    config->driver = stringToLowercase(value);
+                    break;
+                case ControllerConfigKeyType_Profile:
+                    config->profile = stringToLowercase(value);
+                    break;
+                case ControllerConfigKeyType_InputMaxPacketSize:
+                    config->inputMaxPacketSize = atoi(value);
+                    break;
+                case ControllerConfigKeyType_OutputMaxPacketSize:
+                    config->outputMaxPacketSize = atoi(value);
+                    break;
+                case ControllerConfigKeyType_ControllerType:
+                    config->controllerType = controller_type_keywords.Find(value, ControllerType_Unknown);
+                    break;
+                case ControllerConfigKeyType_Deadzone:
+                    config->analogDeadzonePercent[key->axis] = atoi(value);
+                    break;
+                case ControllerConfigKeyType_Factor:
+                    config->analogFactorPercent[key->axis] = atoi(value);
+                    break;
+                case ControllerConfigKeyType_ColorBody:
+                    config->bodyColor = hexStringColorToRGBA(value);
+                    break;
+                case ControllerConfigKeyType_ColorButtons:
+                    config->buttonsColor = hexStringColorToRGBA(value);
+                    break;
+                case ControllerConfigKeyType_ColorLeftGrip:
+                    config->leftGripColor = hexStringColorToRGBA(value);
+                    break;
+                case ControllerConfigKeyType_ColorRightGrip:
+                    config->rightGripColor = hexStringColorToRGBA(value);
+                    break;
             }
-            return 1; // Success
         }
 
-        char *IniReaderLineByLineCallback(char *str, int num, void *stream)
+        // Whole content of the configuration file, in a single read
+        int ReadConfigFile(const std::string &configFullPath, std::string *content)
         {
-            for (int i = 0; i < num; i++)
+            std::unique_ptr<IFile> file = file_manager->open(configFullPath, OpenFlags_Read);
+            if (!file)
             {
-                if (((IFile *)stream)->read(&str[i], 1) <= 0)
-                    return nullptr;
+                syscon::logger::LogError("Unable to open configuration file: '%s' !", configFullPath.c_str());
+                return -1;
+            }
 
-                if (str[i] == '\n')
-                {
-                    str[i] = '\0'; // Null-terminate the string
-                    return str;
-                }
+            content->resize(file_manager->file_size(configFullPath));
+            if (file->read(content->data(), content->size()) != content->size())
+            {
+                syscon::logger::LogError("Unable to read configuration file: '%s' !", configFullPath.c_str());
+                return -1;
             }
 
-            return nullptr;
+            return 0;
         }
 
-        int ReadFromConfig(const char *path, ini_handler handler, void *config)
+        int IndexConfigLine(void *data, const char *section, const char *name, const char *value)
         {
-            std::unique_ptr<IFile> file = file_manager->open(path, OpenFlags_Read);
-            if (!file)
+            ConfigIndex *index = static_cast<ConfigIndex *>(data);
+            index->sections[section].emplace_back(name, value);
+            return 1; // Success
+        }
+
+        // config_index_mutex must be locked by the caller, 'content' is the whole file (See ReadConfigFile)
+        int IndexConfig(const std::string &configFullPath, const std::string &content, uint32_t hash)
+        {
+            if (config_index.valid && config_index.path == configFullPath && config_index.hash == hash)
+                return 0; // Already indexed and not modified since
+
+            syscon::logger::LogDebug("Indexing config: '%s' (Size: %d) ...", configFullPath.c_str(), (int)content.size());
+
+            config_index = ConfigIndex();
+            config_index.path = configFullPath;
+            config_index.size = content.size();
+            config_index.mtime = file_manager->last_write_time(configFullPath);
+            config_index.hash = hash;
+
+            int rc = ini_parse_string(content.c_str(), IndexConfigLine, &config_index);
+            if (rc)
+                return rc;
+
+            config_index.valid = true;
+            return 0;
+        }
+
+        // config_index_mutex must be locked by the caller
+        int LoadConfigIndex(const std::string &configFullPath)
+        {
+            std::string content;
+            int rc = ReadConfigFile(configFullPath, &content);
+            if (rc)
+                return rc;
+
+            return IndexConfig(configFullPath, content, Crc32(content.data(), content.size()));
+        }
+
+        bool ApplyControllerSection(const std::string &section, ControllerConfig *config)
+        {
+            const std::vector<ConfigKeyValue> *keys = config_index.GetSection(section);
+            if (keys == nullptr)
+                return false;
+
+            for (const ConfigKeyValue &key : *keys)
             {
-                syscon::logger::LogError("Unable to open configuration file: '%s' !", path);
-                return -1;
+                std::string value = key.value; // Values are tokenized in place, work on a copy
+                ParseControllerConfigKey(config, key.name, value.data());
+            }
+
+            return true;
+        }
+
+        bool ApplyGlobalSection(const std::string &section, GlobalConfig *config)
+        {
+            const std::vector<ConfigKeyValue> *keys = config_index.GetSection(section);
+            if (keys == nullptr)
+                return false;
+
+            for (const ConfigKeyValue &key : *keys)
+            {
+                std::string value = key.value; // Values are tokenized in place, work on a copy
+                ParseGlobalConfigKey(config, key.name, value.data());
             }
 
-            return ini_parse_stream(IniReaderLineByLineCallback, file.get(), handler, config);
+            return true;
         }
 
     } // namespace
 
     int Initialize(std::unique_ptr<IFileManager> &&fileManager)
     {
+        std::lock_guard<std::mutex> lock(config_index_mutex);
+
         file_manager = std::move(fileManager);
+        config_index = ConfigIndex(); // Index was built with the previous file manager
+        config_cache.SetPath("");
         return 0;
     }
 
+    void SetCachePath(const std::string &cacheFullPath)
+    {
+        std::lock_guard<std::mutex> lock(config_index_mutex);
+
+        config_cache.SetPath(cacheFullPath);
+    }
+
+    void FlushCache()
+    {
+        std::lock_guard<std::mutex> lock(config_index_mutex);
+
+        if (file_manager)
+            config_cache.Flush(file_manager.get());
+    }
+
+    bool ReloadIfModified(const std::string &configFullPath)
+    {
+        std::lock_guard<std::mutex> lock(config_index_mutex);
+
+        if (config_index.valid && config_index.path == configFullPath &&
+            config_index.size == file_manager->file_size(configFullPath) &&
+            config_index.mtime == file_manager->last_write_time(configFullPath))
+            return false;
+
+        syscon::logger::LogInfo("Config '%s' modified, reloading it ...", configFullPath.c_str());
+
+        int rc = LoadConfigIndex(configFullPath);
+        if (rc)
+        {
+            syscon::logger::LogError("Failed to reload config: '%s' (Error: 0x%08X) !", configFullPath.c_str(), rc);
+            return false;
+        }
+
+        return true;
+    }
+
     int LoadGlobalConfig(const std::string &configFullPath, GlobalConfig *config)
     {
-        ConfigINIData cfg("global", config);
+        std::lock_guard<std::mutex> lock(config_index_mutex);
 
         syscon::logger::LogDebug("Loading global config: '%s' ...", configFullPath.c_str());
 
-        int rc = ReadFromConfig(configFullPath.c_str(), ParseGlobalConfigLine, &cfg);
+        int rc = LoadConfigIndex(configFullPath);
         if (rc)
         {
             syscon::logger::LogError("Failed to load global config: '%s' (Error: 0x%08X) !", configFullPath.c_str(), rc);
             return rc;
         }
 
+        ApplyGlobalSection("global", config);
+
         return 0;
     }
 
@@ -513,52 +676,85 @@ namespace syscon::config
         return 0;
     }
 
-    int LoadControllerConfig(const std::string &configFullPath, ControllerConfig *config, uint16_t vendor_id, uint16_t product_id, bool auto_add_controller, const std::string &default_profile)
+    // config_index_mutex must be locked and the index loaded by the caller
+    int ResolveControllerConfig(const std::string &configFullPath, ControllerConfig *config, uint16_t vendor_id, uint16_t product_id, bool auto_add_controller, const std::string &default_profile, bool *controllerFound)
     {
-        ControllerVidPid controllerVidPid(vendor_id, product_id);
-        ConfigINIData cfg_default("default", config);
-        ConfigINIData cfg_controller(controllerVidPid, config);
+        std::string controllerSection = ControllerVidPid(vendor_id, product_id);
 
         syscon::logger::LogDebug("Loading controller config: '%s' [default] ...", configFullPath.c_str());
-
-        int rc = ReadFromConfig(configFullPath.c_str(), ParseControllerConfigLine, &cfg_default);
-        if (rc)
-            return rc;
+        ApplyControllerSection("default", config);
 
         // Override with vendor specific config
-        syscon::logger::LogDebug("Loading controller config: '%s' [%s] ...", configFullPath.c_str(), std::string(controllerVidPid).c_str());
-        rc = ReadFromConfig(configFullPath.c_str(), ParseControllerConfigLine, &cfg_controller);
-        if (rc)
-            return rc;
+        syscon::logger::LogDebug("Loading controller config: '%s' [%s] ...", configFullPath.c_str(), controllerSection.c_str());
+        *controllerFound = ApplyControllerSection(controllerSection, config);
 
-        if (!cfg_controller.ini_section_found && auto_add_controller)
+        if (!*controllerFound && auto_add_controller)
         {
             syscon::logger::LogDebug("Controller not found in config file, adding it as '%s'...", default_profile.c_str());
-            rc = AddControllerToConfig(configFullPath.c_str(), std::string(controllerVidPid), default_profile);
+            int rc = AddControllerToConfig(configFullPath.c_str(), controllerSection, default_profile);
             if (rc)
                 return rc;
 
-            syscon::logger::LogDebug("Reloading controller config: '%s' [%s] ...", configFullPath.c_str(), std::string(controllerVidPid).c_str());
-            rc = ReadFromConfig(configFullPath.c_str(), ParseControllerConfigLine, &cfg_controller);
+            // The file changed, the index is rebuilt
+            rc = LoadConfigIndex(configFullPath);
             if (rc)
                 return rc;
+
+            syscon::logger::LogDebug("Reloading controller config: '%s' [%s] ...", configFullPath.c_str(), controllerSection.c_str());
+            *controllerFound = ApplyControllerSection(controllerSection, config);
         }
 
         // Check if have a "profile"
         if (config->profile.length() > 0)
         {
             syscon::logger::LogDebug("Loading controller config: '%s' (Profile: [%s]) ... ", configFullPath.c_str(), config->profile.c_str());
-            ConfigINIData cfg_profile(config->profile, config);
-            rc = ReadFromConfig(configFullPath.c_str(), ParseControllerConfigLine, &cfg_profile);
-            if (rc)
-                return rc;
+            ApplyControllerSection(config->profile, config);
 
             // Re-Override with vendor specific config
             // We are doing this to allow the profile to be overrided by the vendor specific config
             // In other words we would like to have [default] overrided by [profile] overrided by [vid-pid]
-            rc = ReadFromConfig(configFullPath.c_str(), ParseControllerConfigLine, &cfg_controller);
+            ApplyControllerSection(controllerSection, config);
+        }
+
+        return 0;
+    }
+
+    int LoadControllerConfig(const std::string &configFullPath, ControllerConfig *config, uint16_t vendor_id, uint16_t product_id, bool auto_add_controller, const std::string &default_profile)
+    {
+        std::lock_guard<std::mutex> lock(config_index_mutex);
+
+        // Single read of config.ini, its hash validates the cache: On a hit, the INI is neither parsed nor indexed
+        std::string content;
+        int rc = ReadConfigFile(configFullPath, &content);
+        if (rc)
+            return rc;
+
+        uint32_t hash = Crc32(content.data(), content.size());
+        bool fromCache = false;
+        if (config_cache.IsEnabled())
+        {
+            config_cache.Load(file_manager.get(), hash);
+            fromCache = config_cache.Find(vendor_id, product_id, config);
+        }
+
+        if (fromCache)
+        {
+            syscon::logger::LogDebug("Controller config [%04x-%04x] loaded from cache", vendor_id, product_id);
+        }
+        else
+        {
+            rc = IndexConfig(configFullPath, content, hash);
             if (rc)
                 return rc;
+
+            bool controllerFound = false;
+            rc = ResolveControllerConfig(configFullPath, config, vendor_id, product_id, auto_add_controller, default_profile, &controllerFound);
+            if (rc)
+                return rc;
+
+            // Only controllers having their own section are cached, others depend on auto_add_controller and default_profile
+            if (controllerFound && config_cache.IsEnabled())
+                config_cache.Store(config_index.hash, vendor_id, product_id, *config);
         }
 
         if (config->buttonsPin[ControllerButton::B][0] == 0 && config->buttonsPin[ControllerButton::A][0] == 0 && config->buttonsPin[ControllerButton::Y][0] == 0 && config->buttonsPin[ControllerButton::X][0] == 0)
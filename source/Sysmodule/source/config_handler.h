@@ -9,8 +9,12 @@
 #include <vector>
 #include <stdlib.h>
 
-#define CONFIG_PATH     "/config/sys-con/"
-#define CONFIG_FULLPATH CONFIG_PATH "config.ini"
+#define CONFIG_PATH           "/config/sys-con/"
+#define CONFIG_FULLPATH       CONFIG_PATH "config.ini"
+#define CONFIG_CACHE_FULLPATH CONFIG_PATH "config.cache"
+#define STATS_FULLPATH         CONFIG_PATH "stats.txt"
+#define STATS_REQUEST_FULLPATH CONFIG_PATH "stats.request" // Created by the user to get stats.txt on demand
+#define RECORDS_PATH           CONFIG_PATH "records/"
 
 namespace syscon::config
 {
@@ -63,6 +67,10 @@ namespace syscon::config
         uint16_t polling_timeout_ms{10};
         int8_t polling_thread_priority{30};
         int log_level{LOG_LEVEL_INFO};
+        bool log_binary{false};
+        bool log_sync_errors{true};
+        uint16_t stats_period_s{0}; // 0: stats.txt written on demand only
+        bool record_reports{false};
         DiscoveryMode discovery_mode{DiscoveryMode::HID_AND_XBOX};
         std::vector<ControllerVidPid> discovery_vidpid;
         bool auto_add_controller{true};
@@ -70,8 +78,17 @@ namespace syscon::config
 
     int Initialize(std::unique_ptr<IFileManager> &&fileManager);
 
+    // Enable the binary cache of the resolved controllers config (Disabled by default)
+    void SetCachePath(const std::string &cacheFullPath);
+
+    // Write the controllers config resolved since the last call to the cache file (Deferred, one write for all of them)
+    void FlushCache();
+
     int LoadGlobalConfig(const std::string &configFullPath, GlobalConfig *config);
 
     int LoadControllerConfig(const std::string &configFullPath, ControllerConfig *config, uint16_t vendor_id, uint16_t product_id, bool auto_add_controller, const std::string &default_profile);
 
+    // Check config.ini metadata (size, mtime), return true if it changed and was successfully re-indexed
+    bool ReloadIfModified(const std::string &configFullPath);
+
 }; // namespace syscon::config
\ No newline at end of file
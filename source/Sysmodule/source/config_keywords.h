@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+/*
+ * Compile time perfect hash tables for the config.ini keywords
+ *
+ * Each table is built by the compiler: it searches for a seed for which every keyword gets its own slot.
+ * A lookup is then one hash of the token and one (case-insensitive) comparison with the keyword stored in the slot,
+ * no lowercase copy and no heap allocation.
+ *
+ * Keywords must be written in lowercase in the tables.
+ * Duplicated keywords (or a table for which no seed is found) are reported as a compilation error.
+ */
+
+#define CONFIG_KEYWORD_MAX_SEED 0x10000
+
+namespace syscon::config
+{
+    template <typename T>
+    struct ConfigKeyword
+    {
+        std::string_view name;
+        T value;
+    };
+
+    constexpr char ConfigKeywordToLower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // FNV-1a (32 bits) of the lowercase string
+    constexpr uint32_t ConfigKeywordHash(std::string_view str, uint32_t seed)
+    {
+        uint32_t hash = 0x811c9dc5 ^ (seed * 0x9e3779b9);
+
+        for (char c : str)
+        {
+            hash ^= static_cast<uint8_t>(ConfigKeywordToLower(c));
+            hash *= 0x01000193;
+        }
+
+        return hash ^ (hash >> 15);
+    }
+
+    // keyword must be lowercase
+    constexpr bool ConfigKeywordEquals(std::string_view keyword, std::string_view str)
+    {
+        if (keyword.size() != str.size())
+            return false;
+
+        for (size_t i = 0; i < str.size(); i++)
+        {
+            if (keyword[i] != ConfigKeywordToLower(str[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    // 4 slots per keyword (rounded to a power of 2): A seed is found after a few tries
+    constexpr size_t ConfigKeywordTableSize(size_t count)
+    {
+        size_t size = 1;
+        while (size < count * 4)
+            size <<= 1;
+        return size;
+    }
+
+    // Not constexpr: Reaching it during the table construction stops the compilation
+    inline void ConfigKeywordTableNoPerfectHashFound() {}
+
+    template <typename T, size_t Count>
+    class ConfigKeywordTable
+    {
+    public:
+        static constexpr size_t TableSize = ConfigKeywordTableSize(Count);
+
+        static_assert(Count < 0xFF, "Slots are stored on 8 bits");
+
+        constexpr ConfigKeywordTable(const ConfigKeyword<T> (&keywords)[Count]) : m_keywords{}, m_slots{}, m_seed(0)
+        {
+            for (size_t i = 0; i < Count; i++)
+                m_keywords[i] = keywords[i];
+
+            while (!TrySeed(m_seed))
+            {
+                if (++m_seed >= CONFIG_KEYWORD_MAX_SEED)
+                {
+                    ConfigKeywordTableNoPerfectHashFound();
+                    break;
+                }
+            }
+        }
+
+        // Case-insensitive lookup, return nullptr if str is not a keyword of the table
+        constexpr const T *Find(std::string_view str) const
+        {
+            uint8_t slot = m_slots[ConfigKeywordHash(str, m_seed) & (TableSize - 1)];
+            if (slot == 0 || !ConfigKeywordEquals(m_keywords[slot - 1].name, str))
+                return nullptr;
+
+            return &m_keywords[slot - 1].value;
+        }
+
+        constexpr T Find(std::string_view str, T defaultValue) const
+        {
+            const T *value = Find(str);
+            return (value != nullptr) ? *value : defaultValue;
+        }
+
+    private:
+        constexpr bool TrySeed(uint32_t seed)
+        {
+            for (size_t i = 0; i < TableSize; i++)
+                m_slots[i] = 0;
+
+            for (size_t i = 0; i < Count; i++)
+            {
+                uint8_t &slot = m_slots[ConfigKeywordHash(m_keywords[i].name, seed) & (TableSize - 1)];
+                if (slot != 0)
+                    return false; // Collision
+
+                slot = static_cast<uint8_t>(i + 1); // 0 is an empty slot
+            }
+
+            return true;
+        }
+
+        ConfigKeyword<T> m_keywords[Count];
+        uint8_t m_slots[TableSize];
+        uint32_t m_seed;
+    };
+
+    template <typename T, size_t Count>
+    constexpr ConfigKeywordTable<T, Count> MakeConfigKeywordTable(const ConfigKeyword<T> (&keywords)[Count])
+    {
+        return ConfigKeywordTable<T, Count>(keywords);
+    }
+
+} // namespace syscon::config
@@ -8,11 +8,17 @@
 #endif
 
 #include "SwitchUSBInterface.h"
+#include "SwitchUSBBufferPool.h"
+#include "SwitchUSBLockLevels.h"
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <mutex>
+#include <unordered_map>
 
 #include "logger.h"
+#include "config_handler.h"
+#include "report_recorder.h"
 
 namespace syscon::controllers
 {
@@ -20,9 +26,16 @@ namespace syscon::controllers
     {
         constexpr size_t MaxControllerHandlersSize = 10;
         std::vector<std::unique_ptr<SwitchVirtualGamepadHandler>> controllerHandlers;
+        std::unordered_map<s32, SwitchVirtualGamepadHandler *> handlerByInterface; // Interface ID -> Handler of its controller
         std::mutex controllerMutex;
         int32_t polling_timeout_ms = 0;
         int8_t polling_thread_priority = 0x30;
+        ResumeTable resumeTable; // Protected by controllerMutex
+
+        u64 GetTimeUs()
+        {
+            return armTicksToNs(armGetSystemTick()) / 1000;
+        }
 
     } // namespace
 
@@ -32,20 +45,37 @@ namespace syscon::controllers
         return controllerHandlers.size() >= MaxControllerHandlersSize;
     }
 
-    Result Insert(std::unique_ptr<IController> &&controllerPtr)
+    Result Insert(std::unique_ptr<IController> &&controllerPtr, u64 wake_us)
     {
+        // Before the initialization: The input thread is started by the switch handler
+        if (syscon::recorder::IsEnabled())
+            controllerPtr->SetReportRecorder(syscon::recorder::Create(controllerPtr->GetDevice()->GetVendor(), controllerPtr->GetDevice()->GetProduct()));
+
 #if ATMOSPHERE
         std::unique_ptr<SwitchVirtualGamepadHandler> switchHandler = std::make_unique<SwitchMITMHandler>(std::move(controllerPtr), polling_timeout_ms, polling_thread_priority);
 #else
         std::unique_ptr<SwitchVirtualGamepadHandler> switchHandler = std::make_unique<SwitchHDLHandler>(std::move(controllerPtr), polling_timeout_ms, polling_thread_priority);
 #endif
+        switchHandler->SetWakeTime(wake_us);
 
-        Result rc = switchHandler->Initialize();
+        u64 start_us = GetTimeUs();
+        Result rc;
+        {
+            // The other controllers don't write until the end of the initialization (Not while waiting for controllerMutex:
+            // a controller being removed waits for its input thread)
+            USBInitLock initLock;
+            rc = switchHandler->Initialize();
+        }
         if (R_SUCCEEDED(rc))
         {
-            syscon::logger::LogInfo("Controller[%04x-%04x] plugged !", switchHandler->GetController()->GetDevice()->GetVendor(), switchHandler->GetController()->GetDevice()->GetProduct());
+            if (wake_us != 0)
+                syscon::logger::LogInfo("Controller[%04x-%04x] resumed in %d ms (%d ms after the wake up) !", switchHandler->GetController()->GetDevice()->GetVendor(), switchHandler->GetController()->GetDevice()->GetProduct(), (int)((GetTimeUs() - start_us) / 1000), (int)((GetTimeUs() - wake_us) / 1000));
+            else
+                syscon::logger::LogInfo("Controller[%04x-%04x] plugged !", switchHandler->GetController()->GetDevice()->GetVendor(), switchHandler->GetController()->GetDevice()->GetProduct());
 
             std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+            for (auto &&ptr : switchHandler->GetController()->GetDevice()->GetInterfaces())
+                handlerByInterface[static_cast<SwitchUSBInterface *>(ptr.get())->GetID()] = switchHandler.get();
             controllerHandlers.push_back(std::move(switchHandler));
         }
         else
@@ -56,33 +86,90 @@ namespace syscon::controllers
         return rc;
     }
 
-    void RemoveAllNonPlugged(std::vector<s32> interfaceIDsPlugged)
+    void RemoveUnplugged(const std::vector<s32> &interfaceIDsRemoved)
+    {
+        std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+        for (s32 interfaceID : interfaceIDsRemoved)
+        {
+            auto found = handlerByInterface.find(interfaceID);
+            if (found == handlerByInterface.end())
+                continue;
+
+            SwitchVirtualGamepadHandler *handler = found->second;
+            handlerByInterface.erase(found);
+
+            // A controller is removed with its last interface
+            bool plugged = false;
+            for (auto &&ptr : handler->GetController()->GetDevice()->GetInterfaces())
+                plugged |= handlerByInterface.find(static_cast<SwitchUSBInterface *>(ptr.get())->GetID()) != handlerByInterface.end();
+
+            if (plugged)
+                continue;
+
+            syscon::logger::LogInfo("Controller[%04x-%04x] unplugged !", handler->GetController()->GetDevice()->GetVendor(), handler->GetController()->GetDevice()->GetProduct());
+            controllerHandlers.erase(std::find_if(controllerHandlers.begin(), controllerHandlers.end(), [handler](const std::unique_ptr<SwitchVirtualGamepadHandler> &ptr) { return ptr.get() == handler; }));
+        }
+    }
+
+    void ReloadConfig(const std::string &configFullPath)
     {
         std::lock_guard<std::mutex> scoped_lock(controllerMutex);
-        for (auto it = controllerHandlers.begin(); it != controllerHandlers.end(); it++)
+        resumeTable.Clear(); // Kept configs are outdated
+        for (auto &&handler : controllerHandlers)
         {
-            bool found = false;
+            IController *controller = handler->GetController();
+            ControllerConfig config;
 
-            for (auto &&ptr : (*it)->GetController()->GetDevice()->GetInterfaces())
+            int rc = syscon::config::LoadControllerConfig(configFullPath, &config, controller->GetDevice()->GetVendor(), controller->GetDevice()->GetProduct(), false, "");
+            if (rc)
             {
-                for (auto &&interfaceID : interfaceIDsPlugged)
-                {
-                    if (static_cast<SwitchUSBInterface *>(ptr.get())->GetID() == interfaceID)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
+                syscon::logger::LogError("Controller[%04x-%04x] Failed to reload config (Error: %d), keep the current one !", controller->GetDevice()->GetVendor(), controller->GetDevice()->GetProduct(), rc);
+                continue;
             }
 
-            // We check if a device was removed by comparing the controller's interfaces and the currently acquired interfaces
-            // If we didn't find a single matching interface ID, we consider a controller removed
-            if (!found)
+            controller->SetConfig(config);
+            syscon::logger::LogInfo("Controller[%04x-%04x] config reloaded !", controller->GetDevice()->GetVendor(), controller->GetDevice()->GetProduct());
+        }
+    }
+
+    void DumpStats(IFileManager *fileManager, const std::string &statsFullPath)
+    {
+        std::string stats;
+        char title[64];
+
+        {
+            std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+            for (auto &&handler : controllerHandlers)
             {
-                syscon::logger::LogInfo("Controller[%04x-%04x] unplugged !", (*it)->GetController()->GetDevice()->GetVendor(), (*it)->GetController()->GetDevice()->GetProduct());
-                controllerHandlers.erase(it--);
+                IController *controller = handler->GetController();
+                ControllerMetricsSnapshot snapshot;
+                controller->GetMetrics().Snapshot(&snapshot);
+
+                snprintf(title, sizeof(title), "Controller[%04x-%04x]\n", controller->GetDevice()->GetVendor(), controller->GetDevice()->GetProduct());
+                stats += title;
+                snapshot.Format(&stats, "  ");
             }
         }
+
+        if (stats.empty())
+            stats = "No controller\n";
+
+        stats += "USB transfer buffers\n";
+        USBTransferBufferPool::Get().GetStats().Format(&stats, "  ");
+
+        snprintf(title, sizeof(title), "USB lock order violations: %llu\n", (unsigned long long)USBLockOrder::GetViolations());
+        stats += title;
+
+        fileManager->remove(statsFullPath); // Make sure the file is truncated
+
+        std::unique_ptr<IFile> file = fileManager->open(statsFullPath, OpenFlags_Write);
+        if (!file || file->write(stats.data(), stats.size()) != stats.size())
+        {
+            syscon::logger::LogError("Unable to write stats: '%s' !", statsFullPath.c_str());
+            return;
+        }
+
+        syscon::logger::LogDebug("Stats written in '%s'", statsFullPath.c_str());
     }
 
     void SetPollingParameters(int32_t _polling_timeout_ms, s8 _polling_thread_priority)
@@ -91,6 +178,53 @@ namespace syscon::controllers
         polling_thread_priority = _polling_thread_priority;
     }
 
+    void Suspend()
+    {
+        std::vector<ResumeEntry> entries;
+
+        std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+        for (auto &&handler : controllerHandlers)
+        {
+            IController *controller = handler->GetController();
+            ResumeEntry entry;
+
+            entry.vendor_id = controller->GetDevice()->GetVendor();
+            entry.product_id = controller->GetDevice()->GetProduct();
+            if (!controller->GetDevice()->GetInterfaces().empty())
+            {
+                const UsbHsInterface &interface = static_cast<SwitchUSBInterface *>(controller->GetDevice()->GetInterfaces()[0].get())->GetInterface();
+                entry.path.assign(interface.pathstr, strnlen(interface.pathstr, sizeof(interface.pathstr)));
+            }
+            entry.config = controller->GetConfig();
+            entry.data = controller->GetResumeData();
+            entries.push_back(std::move(entry));
+        }
+
+        syscon::logger::LogDebug("Controllers suspend (Release all controllers, %d kept for the wake up) !", (int)entries.size());
+        resumeTable.Suspend(std::move(entries));
+        handlerByInterface.clear();
+        controllerHandlers.clear();
+    }
+
+    void Resume()
+    {
+        std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+        resumeTable.Wake(GetTimeUs());
+        syscon::logger::LogDebug("Controllers resume (%d to resume) !", (int)resumeTable.Size());
+    }
+
+    bool TakeResumeEntry(u16 vendor_id, u16 product_id, const std::string &path, ResumeEntry *entry)
+    {
+        std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+        return resumeTable.Take(vendor_id, product_id, path, GetTimeUs(), entry);
+    }
+
+    u64 GetWakeTime()
+    {
+        std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+        return resumeTable.GetWakeTime();
+    }
+
     void Initialize()
     {
         controllerHandlers.reserve(MaxControllerHandlersSize);
@@ -100,6 +234,8 @@ namespace syscon::controllers
     {
         syscon::logger::LogDebug("Controllers clear (Release all controllers) !");
         std::lock_guard<std::mutex> scoped_lock(controllerMutex);
+        resumeTable.Clear();
+        handlerByInterface.clear();
         controllerHandlers.clear();
     }
 
@@ -1,16 +1,36 @@
 #pragma once
 
 #include "IController.h"
+#include "resume_table.h"
+#include "ifilemanager.h"
 #include <switch.h>
+#include <string>
 namespace syscon::controllers
 {
     bool IsAtControllerLimit();
 
-    Result Insert(std::unique_ptr<IController> &&controllerPtr);
-    void RemoveAllNonPlugged(std::vector<s32> interfaceIDsPlugged);
+    // wake_us: Controller resumed after a sleep (See TakeResumeEntry), the time to its first input is logged
+    Result Insert(std::unique_ptr<IController> &&controllerPtr, u64 wake_us = 0);
+    // Interfaces no longer acquired (Unplugged): Their controllers are removed with their last interface
+    void RemoveUnplugged(const std::vector<s32> &interfaceIDsRemoved);
+
+    // Re-resolve the config of every live controller and swap it in (Mapping, deadzones, ... are applied immediately)
+    void ReloadConfig(const std::string &configFullPath);
+
+    // Write the metrics of every live controller (reports, IPC, latency histograms, ...) to statsFullPath
+    void DumpStats(IFileManager *fileManager, const std::string &statsFullPath);
 
     void SetPollingParameters(int32_t _polling_timeout_ms, s8 _thread_priority);
 
+    // Console going to sleep: Release all the controllers, what was resolved for each one is kept for the wake up
+    void Suspend();
+    // Console woken up: The controllers plugged again are resumed from what was kept by Suspend
+    void Resume();
+    // Kept by Suspend for the device, if any (Removed from the table)
+    bool TakeResumeEntry(u16 vendor_id, u16 product_id, const std::string &path, ResumeEntry *entry);
+    // Time of the wake up, 0 if not resumed
+    u64 GetWakeTime();
+
     void Initialize();
     void Clear();
     void Exit();
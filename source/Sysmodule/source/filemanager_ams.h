@@ -40,12 +40,14 @@ namespace syscon
             if (!m_file.handle != INVALID_HANDLE || !buffer || bytes == 0)
                 return 0;
 
-            ams::Result err = ams::fs::ReadFile(m_file, m_fileoffset, buffer, bytes);
+            // Use the variant returning the number of bytes read: A chunked read reaching the end of the file is a short read, not an error
+            size_t bytesRead = 0;
+            ams::Result err = ams::fs::ReadFile(&bytesRead, m_file, m_fileoffset, buffer, bytes);
             if (R_FAILED(err))
                 return 0;
 
-            m_fileoffset += bytes;
-            return static_cast<std::size_t>(bytes);
+            m_fileoffset += bytesRead;
+            return static_cast<std::size_t>(bytesRead);
         }
 
         std::size_t write(const void *buffer, std::size_t bytes) noexcept override
@@ -61,6 +63,11 @@ namespace syscon
             return static_cast<std::size_t>(bytes);
         }
 
+        void flush() noexcept override
+        {
+            // Nothing to do, every write is done with WriteOption::Flush
+        }
+
     private:
         ams::fs::FileHandle m_file;
         std::filesystem::path m_path;
@@ -122,6 +129,16 @@ namespace syscon
 
             return fileOffset;
         }
+
+        std::int64_t last_write_time(const std::filesystem::path &path) const override
+        {
+            ams::fs::FileTimeStampRaw timestamp;
+
+            if (R_FAILED(ams::fs::GetFileTimeStampRawForDebug(&timestamp, to_ams_path(path).c_str())))
+                return 0;
+
+            return timestamp.modify;
+        }
     };
 
 } // namespace syscon
\ No newline at end of file
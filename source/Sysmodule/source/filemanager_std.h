@@ -48,6 +48,12 @@ namespace syscon
             return bytes;
         }
 
+        void flush() noexcept override
+        {
+            if (m_file.is_open())
+                m_file.flush();
+        }
+
     private:
         std::fstream m_file;
         std::filesystem::path m_path;
@@ -95,5 +101,15 @@ namespace syscon
 
             return std::filesystem::file_size(p);
         }
+
+        std::int64_t last_write_time(const std::filesystem::path &p) const override
+        {
+            std::error_code ec;
+            auto time = std::filesystem::last_write_time(p, ec);
+            if (ec)
+                return 0;
+
+            return static_cast<std::int64_t>(time.time_since_epoch().count());
+        }
     };
 } // namespace syscon
\ No newline at end of file
@@ -24,6 +24,7 @@ namespace syscon
 
         virtual std::size_t read(void *buffer, std::size_t bytes) noexcept = 0;
         virtual std::size_t write(const void *buffer, std::size_t bytes) noexcept = 0;
+        virtual void flush() noexcept = 0;
     };
 
     class IFileManager
@@ -37,6 +38,7 @@ namespace syscon
         virtual bool remove(const std::filesystem::path &p) = 0;
 
         virtual std::uintmax_t file_size(const std::filesystem::path &p) const = 0;
+        virtual std::int64_t last_write_time(const std::filesystem::path &p) const = 0; // Opaque value, only meant to be compared (0 if unknown)
     };
 
 } // namespace syscon
\ No newline at end of file
@@ -1,110 +1,724 @@
 #include "logger.h"
+#include "logger_binary.h"
 #include <string.h>
 #include <algorithm>
 #include <sys/stat.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 #include <fstream>
 #include <filesystem>
 #include <iostream>
 #include <inttypes.h>
-
-#define LOG_FILE_SIZE_MAX (128 * 1024)
+#include <unordered_set>
+
+#ifdef __SWITCH__
+    #include <switch.h>
+#endif
+
+#define LOG_FILE_SIZE_MAX     (128 * 1024)
+#define LOG_RING_SIZE         128  // Number of slots, must be a power of 2
+#define LOG_SLOT_SIZE         256  // A record uses one slot, or several consecutive slots when it doesn't fit
+#define LOG_RECORD_SIZE       1024 // Max size of a formatted record (Including the '\n'), longer records are truncated
+#define LOG_RING_ERROR_SLOTS  16   // Slots only usable by error records
+#define LOG_WRITE_BUFFER_SIZE 4096
+#define LOG_FLUSH_PERIOD_MS   20
+#define LOG_BINARY_CHUNK_SIZE 224 // Max payload of a binary Buffer record (Multiple of 16 to keep the hex dump aligned)
+#define LOG_BINARY_ARGS_SIZE  96  // Room for the arguments of a binary Log record, after its format string
 
 namespace syscon::logger
 {
     namespace
     {
-        // Mutex to protect log writing
-        static std::mutex sLogMutex;
-
-        static char sLogBuffer[1024];
-        static std::filesystem::path sLogPath;
-        static int slogLevel = LOG_LEVEL_TRACE;
+        /*
+            Records are formatted by the caller into a lock-free ring buffer (Bounded MPMC queue from D. Vyukov, used with a single consumer).
+            A low priority thread drains the ring and writes the records by batch into the log file that is kept open.
+            The caller never waits on the file system: error records only wake up the flusher thread.
+
+            A record longer than a slot reserves consecutive slots, its text is contiguous in sLogData (The area after the
+            last slot receives the end of the records that wrap around the ring).
+            The last LOG_RING_ERROR_SLOTS free slots are kept for error records, so a burst of debug logs doesn't drop them.
+
+            In binary mode, Trace and Perf records are not formatted: they are stored as binary records (See logger_binary.h) and
+            written in a separate file (log.bin). The record holds a copy of the format string (The caller's one may be gone when
+            the flusher runs), the flusher only writes it to the file the first time it sees it.
+        */
+        struct LogRecord
+        {
+            std::atomic<uint32_t> sequence;
+            uint16_t length;
+            uint8_t slotCount;
+            bool binary;
+        };
+
+        static_assert(LOG_RECORD_SIZE % LOG_SLOT_SIZE == 0, "A record must use whole slots");
+        static_assert(LOG_RECORD_SIZE / LOG_SLOT_SIZE + LOG_RING_ERROR_SLOTS < LOG_RING_SIZE, "Ring too small for the longest record");
+        static_assert(sizeof(BinaryLogRecordHeader) + LOG_BINARY_CHUNK_SIZE <= LOG_SLOT_SIZE, "Binary chunk doesn't fit in a slot");
+
+        // Log file kept open by the consumer, with its write buffer
+        struct LogOutput
+        {
+            std::filesystem::path path;
+            std::unique_ptr<IFile> file;
+            size_t offset;
+            char buffer[LOG_WRITE_BUFFER_SIZE];
+        };
+
+        LogRecord sLogRing[LOG_RING_SIZE];
+        char sLogData[LOG_RING_SIZE * LOG_SLOT_SIZE + LOG_RECORD_SIZE - LOG_SLOT_SIZE];
+        std::atomic<uint32_t> sLogEnqueuePos{0};
+        uint32_t sLogDequeuePos = 0; // Protected by sFlushMutex
+        std::atomic<uint32_t> sDroppedRecords{0};
+
+        // Mutex to protect the consumer side (Ring dequeue and log file), never locked by the producers
+        static std::mutex sFlushMutex;
+
+        // Wake up the flusher before its period (Error records)
+        static std::mutex sFlusherWakeupMutex;
+        static std::condition_variable sFlusherWakeup;
+        static std::atomic<bool> sFlushRequested{false};
+
+        static LogOutput sTextOutput;
+        static LogOutput sBinaryOutput;
+        static std::unordered_set<uint64_t> sBinaryKnownFormats; // Format strings already written in the current session
         static std::unique_ptr<IFileManager> sFileManager;
+        static std::atomic<bool> sInitialized{false};
+        static std::atomic<bool> sBinaryEnabled{false};
+        static std::atomic<bool> sSyncErrors{true};
+        static std::atomic<bool> sFlusherRunning{false};
+
+#ifdef __SWITCH__
+        alignas(0x1000) u8 sFlusherThreadStack[0x4000];
+        Thread sFlusherThread;
+#else
+        std::thread sFlusherThread;
+#endif
 
         const char klogLevelStr[LOG_LEVEL_COUNT] = {'T', 'D', 'P', 'I', 'W', 'E'};
+
+        void ResetRing()
+        {
+            for (uint32_t i = 0; i < LOG_RING_SIZE; i++)
+                sLogRing[i].sequence.store(i, std::memory_order_relaxed);
+
+            sLogEnqueuePos.store(0, std::memory_order_relaxed);
+            sLogDequeuePos = 0;
+            sDroppedRecords.store(0, std::memory_order_relaxed);
+        }
+
+        char *GetRecordData(uint32_t pos)
+        {
+            return &sLogData[(pos & (LOG_RING_SIZE - 1)) * LOG_SLOT_SIZE];
+        }
+
+        // Reserve slotCount consecutive slots, return nullptr if the ring is full
+        LogRecord *AcquireRecord(int lvl, size_t slotCount, uint32_t *pos)
+        {
+            // The consumer frees the slots in order: If the last needed slot (Plus the error reserve) is free, the ones before are too
+            uint32_t reserve = (lvl >= LOG_LEVEL_ERROR) ? 0 : LOG_RING_ERROR_SLOTS;
+            uint32_t enqueuePos = sLogEnqueuePos.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                uint32_t lastPos = enqueuePos + static_cast<uint32_t>(slotCount) - 1 + reserve;
+                int32_t diff = (int32_t)(sLogRing[lastPos & (LOG_RING_SIZE - 1)].sequence.load(std::memory_order_acquire) - lastPos);
+
+                if (diff == 0)
+                {
+                    if (sLogEnqueuePos.compare_exchange_weak(enqueuePos, enqueuePos + static_cast<uint32_t>(slotCount), std::memory_order_relaxed))
+                    {
+                        LogRecord *record = &sLogRing[enqueuePos & (LOG_RING_SIZE - 1)];
+                        record->slotCount = static_cast<uint8_t>(slotCount);
+                        *pos = enqueuePos;
+                        return record;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return nullptr; // Full
+                }
+                else
+                {
+                    enqueuePos = sLogEnqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void PublishRecord(LogRecord *record, uint32_t pos)
+        {
+            record->sequence.store(pos + 1, std::memory_order_release);
+        }
+
+        void WakeUpFlusher()
+        {
+            sFlushRequested.store(true, std::memory_order_release);
+            sFlusherWakeup.notify_one();
+        }
+
+        size_t FormatHeader(char *buffer, size_t size, int lvl)
+        {
+            uint64_t current_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            int len = std::snprintf(buffer, size, "|%c|%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64 ".%03" PRIu64 "|%08X| ", klogLevelStr[lvl], (current_time_ms / 3600000) % 24, (current_time_ms / 60000) % 60, (current_time_ms / 1000) % 60, current_time_ms % 1000, (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            return std::min<size_t>(std::max(len, 0), size - 1);
+        }
+
+        // Terminate the record with a '\n', return the final length
+        uint16_t EndRecord(char *text, size_t length, size_t size)
+        {
+            length = std::min<size_t>(length, size - 1);
+            text[length] = '\n';
+            return static_cast<uint16_t>(length + 1);
+        }
+
+        uint32_t GetThreadId()
+        {
+            return (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id());
+        }
+
+        uint64_t GetTimestampUs()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // sFlushMutex must be locked by the caller
+        void WriteOutput(LogOutput *output)
+        {
+            if (output->offset == 0 || sFileManager == nullptr)
+                return;
+
+            if (output->file == nullptr)
+                output->file = sFileManager->open(output->path, (OpenFlags)(OpenFlags_Write | OpenFlags_Append));
+
+            if (output->file && output->file->is_open())
+            {
+                output->file->write(output->buffer, output->offset);
+                output->file->flush();
+            }
+
+            output->offset = 0;
+        }
+
+        // sFlushMutex must be locked by the caller
+        void AppendOutput(LogOutput *output, const void *data, size_t size)
+        {
+            if (output->offset + size > sizeof(output->buffer))
+                WriteOutput(output);
+
+            size = std::min(size, sizeof(output->buffer));
+            memcpy(&output->buffer[output->offset], data, size);
+            output->offset += size;
+        }
+
+        // sFlushMutex must be locked by the caller
+        void AppendBinaryRecord(BinaryLogRecordType type, uint64_t id, const void *payload, size_t size)
+        {
+            BinaryLogRecordHeader header = {};
+            header.type = type;
+            header.size = static_cast<uint16_t>(size);
+            header.thread = GetThreadId();
+            header.timestamp_us = GetTimestampUs();
+            header.id = id;
+
+            AppendOutput(&sBinaryOutput, &header, sizeof(header));
+            AppendOutput(&sBinaryOutput, payload, size);
+        }
+
+        // sFlushMutex must be locked by the caller
+        void AppendBinaryLogRecord(const LogRecord *record, const char *data)
+        {
+            BinaryLogRecordHeader header;
+            memcpy(&header, data, sizeof(header));
+
+            if (header.type != BinaryLogRecordType_Log)
+            {
+                AppendOutput(&sBinaryOutput, data, record->length);
+                return;
+            }
+
+            // The ring record is header + format length + format + arguments, the file only gets the format the first time it is used
+            uint16_t formatLength;
+            memcpy(&formatLength, data + sizeof(header), sizeof(formatLength));
+            const char *format = data + sizeof(header) + sizeof(formatLength);
+
+            if (sBinaryKnownFormats.insert(header.id).second)
+                AppendBinaryRecord(BinaryLogRecordType_Format, header.id, format, formatLength);
+
+            size_t argsOffset = sizeof(header) + sizeof(formatLength) + formatLength;
+            header.size = static_cast<uint16_t>(record->length - argsOffset);
+            AppendOutput(&sBinaryOutput, &header, sizeof(header));
+            AppendOutput(&sBinaryOutput, data + argsOffset, header.size);
+        }
+
+        // sFlushMutex must be locked by the caller, return false if the next record is not available (Empty or still being written)
+        bool DrainRecord()
+        {
+            LogRecord *record = &sLogRing[sLogDequeuePos & (LOG_RING_SIZE - 1)];
+            if (record->sequence.load(std::memory_order_acquire) != sLogDequeuePos + 1)
+                return false;
+
+            const char *data = GetRecordData(sLogDequeuePos);
+            if (record->binary)
+                AppendBinaryLogRecord(record, data);
+            else
+                AppendOutput(&sTextOutput, data, record->length);
+
+            // Free the slots in order (See AcquireRecord)
+            uint32_t slotCount = record->slotCount;
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                sLogRing[(sLogDequeuePos + i) & (LOG_RING_SIZE - 1)].sequence.store(sLogDequeuePos + i + LOG_RING_SIZE, std::memory_order_release);
+            }
+
+            sLogDequeuePos += slotCount;
+            return true;
+        }
+
+        // sFlushMutex must be locked by the caller, drain records until untilPos (excluded) is reached or until the ring is empty
+        void DrainRing(uint32_t untilPos, bool waitUntilPos)
+        {
+            uint32_t dropped = sDroppedRecords.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+            {
+                char text[LOG_SLOT_SIZE];
+                size_t len = FormatHeader(text, sizeof(text), LOG_LEVEL_WARNING);
+                len += std::snprintf(&text[len], sizeof(text) - len, "%" PRIu32 " log records dropped (Log ring buffer full)", dropped);
+                AppendOutput(&sTextOutput, text, EndRecord(text, len, sizeof(text)));
+            }
+
+            while ((int32_t)(untilPos - sLogDequeuePos) > 0)
+            {
+                if (!DrainRecord())
+                {
+                    if (!waitUntilPos)
+                        break;
+
+                    std::this_thread::yield(); // A previous record is still being formatted by another thread
+                }
+            }
+
+            WriteOutput(&sTextOutput);
+            WriteOutput(&sBinaryOutput);
+        }
+
+        // Consumer side (Flusher thread, Flush, Exit and error records in sync mode)
+        void FlushUntil(uint32_t untilPos, bool waitUntilPos)
+        {
+            std::lock_guard<std::mutex> flushLock(sFlushMutex);
+            DrainRing(untilPos, waitUntilPos);
+        }
+
+        // Error records published before untilPos: Written by the caller in sync mode (e.g. Crash right after), flusher woken up otherwise
+        void FlushErrorRecords(uint32_t untilPos)
+        {
+            if (sSyncErrors.load(std::memory_order_relaxed))
+                FlushUntil(untilPos, true);
+            else
+                WakeUpFlusher();
+        }
+
+        // Reserve a record, count it as dropped if the ring is full
+        LogRecord *AcquireRecordOrDrop(int lvl, size_t slotCount, uint32_t *pos)
+        {
+            LogRecord *record = AcquireRecord(lvl, slotCount, pos);
+            if (record == nullptr)
+            {
+                sDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+                WakeUpFlusher();
+            }
+
+            return record;
+        }
+
+        bool IsBinaryLevel(int lvl)
+        {
+            return (lvl == LOG_LEVEL_TRACE || lvl == LOG_LEVEL_PERF) && sBinaryEnabled.load(std::memory_order_relaxed);
+        }
+
+        // Return the record size with the binary header
+        size_t BeginBinaryRecord(LogRecord *record, char *data, BinaryLogRecordType type, int lvl, uint64_t id)
+        {
+            BinaryLogRecordHeader header = {};
+            header.type = type;
+            header.level = static_cast<uint8_t>(lvl);
+            header.thread = GetThreadId();
+            header.timestamp_us = GetTimestampUs();
+            header.id = id;
+
+            memcpy(data, &header, sizeof(header));
+            record->binary = true;
+            return sizeof(header);
+        }
+
+        void EndBinaryRecord(LogRecord *record, char *data, size_t length)
+        {
+            uint16_t payloadSize = static_cast<uint16_t>(length - sizeof(BinaryLogRecordHeader));
+            memcpy(data + offsetof(BinaryLogRecordHeader, size), &payloadSize, sizeof(payloadSize));
+            record->length = static_cast<uint16_t>(length);
+        }
+
+        bool PutBinaryArg(char *data, size_t capacity, size_t *offset, BinaryLogArgType type, const void *value, size_t size)
+        {
+            if (*offset + 1 + size > capacity)
+                return false; // No more room, remaining arguments are not recorded
+
+            data[*offset] = type;
+            memcpy(&data[*offset + 1], value, size);
+            *offset += 1 + size;
+            return true;
+        }
+
+        bool PutBinaryIntArg(char *data, size_t capacity, size_t *offset, int64_t value)
+        {
+            return PutBinaryArg(data, capacity, offset, BinaryLogArgType_Int, &value, sizeof(value));
+        }
+
+        int64_t ReadIntArg(const BinaryLogFormatSpec &spec, ::std::va_list *vl)
+        {
+            bool isSigned = (spec.conversion == 'd' || spec.conversion == 'i');
+            const char *length = spec.length;
+
+            if (strcmp(length, "ll") == 0)
+                return isSigned ? (int64_t)va_arg(*vl, long long) : (int64_t)va_arg(*vl, unsigned long long);
+            else if (strcmp(length, "l") == 0)
+                return isSigned ? (int64_t)va_arg(*vl, long) : (int64_t)va_arg(*vl, unsigned long);
+            else if (strcmp(length, "z") == 0)
+                return (int64_t)va_arg(*vl, size_t);
+            else if (strcmp(length, "j") == 0)
+                return (int64_t)va_arg(*vl, intmax_t);
+            else if (strcmp(length, "t") == 0)
+                return (int64_t)va_arg(*vl, ptrdiff_t);
+
+            // hh, h and no modifier are promoted to int
+            return isSigned ? (int64_t)va_arg(*vl, int) : (int64_t)va_arg(*vl, unsigned int);
+        }
+
+        // Store the raw arguments, no formatting
+        size_t EncodeBinaryArgs(char *data, size_t capacity, size_t offset, const char *fmt, ::std::va_list vl)
+        {
+            BinaryLogFormatSpec spec;
+            size_t textLength;
+            ::std::va_list args;
+            va_copy(args, vl);
+
+            while ((fmt = BinaryLogNextFormatSpec(fmt, &textLength, &spec)) != nullptr)
+            {
+                bool stored = true;
+
+                for (int i = 0; i < spec.starCount; i++)
+                    stored = stored && PutBinaryIntArg(data, capacity, &offset, va_arg(args, int));
+
+                if (BinaryLogIsIntConversion(spec.conversion))
+                {
+                    stored = stored && PutBinaryIntArg(data, capacity, &offset, ReadIntArg(spec, &args));
+                }
+                else if (BinaryLogIsDoubleConversion(spec.conversion))
+                {
+                    double value = (spec.length[0] == 'L') ? (double)va_arg(args, long double) : va_arg(args, double);
+                    stored = stored && PutBinaryArg(data, capacity, &offset, BinaryLogArgType_Double, &value, sizeof(value));
+                }
+                else if (spec.conversion == 's')
+                {
+                    const char *str = va_arg(args, const char *);
+                    if (str == nullptr)
+                        str = "(null)";
+
+                    uint16_t len = static_cast<uint16_t>(strnlen(str, BINARY_LOG_STRING_MAX));
+                    if (stored && offset + 1 + sizeof(len) + len <= capacity)
+                    {
+                        data[offset] = BinaryLogArgType_String;
+                        memcpy(&data[offset + 1], &len, sizeof(len));
+                        memcpy(&data[offset + 1 + sizeof(len)], str, len);
+                        offset += 1 + sizeof(len) + len;
+                    }
+                    else
+                        stored = false;
+                }
+                else if (spec.conversion == 'p')
+                {
+                    stored = stored && PutBinaryIntArg(data, capacity, &offset, (int64_t)(uintptr_t)va_arg(args, void *));
+                }
+                else if (spec.conversion == 'n')
+                {
+                    (void)va_arg(args, void *);
+                }
+
+                if (!stored)
+                    break;
+            }
+
+            va_end(args);
+            return offset;
+        }
+
+        void FlusherThreadFunc(void *arg)
+        {
+            (void)arg;
+
+            while (sFlusherRunning.load(std::memory_order_acquire))
+            {
+                FlushUntil(sLogEnqueuePos.load(std::memory_order_relaxed), false);
+
+                // A missed wake up only delays the records until the next period
+                std::unique_lock<std::mutex> wakeupLock(sFlusherWakeupMutex);
+                sFlusherWakeup.wait_for(wakeupLock, std::chrono::milliseconds(LOG_FLUSH_PERIOD_MS), []() {
+                    return sFlushRequested.load(std::memory_order_acquire) || !sFlusherRunning.load(std::memory_order_acquire);
+                });
+                sFlushRequested.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        void StartFlusher()
+        {
+            sFlusherRunning.store(true, std::memory_order_release);
+
+#ifdef __SWITCH__
+            // Lowest priority: Logging must not compete with the input threads
+            Result rc = threadCreate(&sFlusherThread, &FlusherThreadFunc, nullptr, sFlusherThreadStack, sizeof(sFlusherThreadStack), 0x3F, -2);
+            if (R_SUCCEEDED(rc))
+                rc = threadStart(&sFlusherThread);
+
+            if (R_FAILED(rc))
+                sFlusherRunning.store(false, std::memory_order_release); // Records will be written by Exit (Or dropped when the ring is full)
+#else
+            sFlusherThread = std::thread(FlusherThreadFunc, nullptr);
+#endif
+        }
+
+        void StopFlusher()
+        {
+            if (!sFlusherRunning.exchange(false, std::memory_order_acq_rel))
+                return;
+
+            sFlusherWakeup.notify_one();
+
+#ifdef __SWITCH__
+            threadWaitForExit(&sFlusherThread);
+            threadClose(&sFlusherThread);
+#else
+            sFlusherThread.join();
+#endif
+        }
     } // namespace
 
     void Initialize(const std::string &log, std::unique_ptr<IFileManager> &&file)
     {
-        sLogPath = std::filesystem::path(log);
-        sFileManager = std::move(file);
+        Exit(); // In case of re-initialization
+
+        {
+            std::lock_guard<std::mutex> flushLock(sFlushMutex);
 
-        std::lock_guard<std::mutex> printLock(sLogMutex);
-        std::filesystem::path basePath = sLogPath.parent_path();
+            sTextOutput.path = std::filesystem::path(log);
+            sBinaryOutput.path = std::filesystem::path(log).replace_extension(".bin");
+            sFileManager = std::move(file);
 
-        sFileManager->create_directories(basePath);
+            std::filesystem::path basePath = sTextOutput.path.parent_path();
+
+            sFileManager->create_directories(basePath);
+
+            if (sFileManager->file_size(sTextOutput.path) >= LOG_FILE_SIZE_MAX)
+                sFileManager->remove(sTextOutput.path);
+
+            ResetRing();
+        }
 
-        if (sFileManager->file_size(sLogPath) >= LOG_FILE_SIZE_MAX)
-            sFileManager->remove(sLogPath);
+        sInitialized.store(true, std::memory_order_release);
+        StartFlusher();
     }
 
     void Exit()
     {
-        std::lock_guard<std::mutex> printLock(sLogMutex);
+        if (!sInitialized.exchange(false, std::memory_order_acq_rel))
+            return;
+
+        StopFlusher();
+
+        std::lock_guard<std::mutex> flushLock(sFlushMutex);
+        DrainRing(sLogEnqueuePos.load(std::memory_order_relaxed), true);
+
+        sTextOutput.file.reset();
+        sBinaryOutput.file.reset();
         sFileManager.reset();
+        sBinaryEnabled.store(false, std::memory_order_relaxed);
     }
 
-    void LogWriteToFile(const char *logBuffer)
+    void Flush()
     {
-        if (sFileManager == nullptr)
+        if (!sInitialized.load(std::memory_order_acquire))
             return;
 
-        auto file = sFileManager->open(sLogPath, (OpenFlags)(OpenFlags_Write | OpenFlags_Append));
-        if (file && file->is_open())
+        FlushUntil(sLogEnqueuePos.load(std::memory_order_relaxed), true);
+    }
+
+    std::atomic<int> g_log_level{LOG_LEVEL_TRACE};
+
+    void SetBinaryLogging(bool enabled)
+    {
+        if (!sInitialized.load(std::memory_order_acquire))
+            return;
+
+        std::lock_guard<std::mutex> flushLock(sFlushMutex);
+
+        if (enabled && !sBinaryEnabled.load(std::memory_order_relaxed))
         {
-            file->write(logBuffer, strlen(logBuffer));
-            file->write("\n", 1);
+            if (sFileManager->file_size(sBinaryOutput.path) >= LOG_FILE_SIZE_MAX)
+                sFileManager->remove(sBinaryOutput.path);
+
+            // New session: The decoder forgets the format strings, they are written again the first time they are used
+            BinaryLogSession session = {BINARY_LOG_MAGIC, BINARY_LOG_VERSION};
+            sBinaryKnownFormats.clear();
+            AppendBinaryRecord(BinaryLogRecordType_Session, 0, &session, sizeof(session));
+            WriteOutput(&sBinaryOutput);
         }
+
+        sBinaryEnabled.store(enabled, std::memory_order_release);
+    }
+
+    void SetSyncErrors(bool enabled)
+    {
+        sSyncErrors.store(enabled, std::memory_order_relaxed);
     }
 
     void SetLogLevel(int level)
     {
-        // This function is not thread safe, should be called only once at the start of the program
-        slogLevel = level;
+        // Relaxed: A thread can log a few more records with the previous level, nothing else depends on it
+        g_log_level.store(level, std::memory_order_relaxed);
     }
 
     void Log(int lvl, const char *fmt, ::std::va_list vl)
     {
-        if (lvl < slogLevel)
+        if (!IsEnabled(lvl))
             return; // Don't log if the level is lower than the current log level.
 
-        std::lock_guard<std::mutex> printLock(sLogMutex);
+        if (!sInitialized.load(std::memory_order_acquire))
+            return;
 
-        uint64_t current_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        std::snprintf(sLogBuffer, sizeof(sLogBuffer), "|%c|%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64 ".%03" PRIu64 "|%08X| ", klogLevelStr[lvl], (current_time_ms / 3600000) % 24, (current_time_ms / 60000) % 60, (current_time_ms / 1000) % 60, current_time_ms % 1000, (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id()));
-        std::vsnprintf(&sLogBuffer[strlen(sLogBuffer)], sizeof(sLogBuffer) - strlen(sLogBuffer), fmt, vl);
+        bool binary = IsBinaryLevel(lvl);
+        size_t formatLength = binary ? strlen(fmt) : 0;
+        size_t binaryLength = sizeof(BinaryLogRecordHeader) + sizeof(uint16_t) + formatLength + LOG_BINARY_ARGS_SIZE;
+        if (binaryLength > LOG_RECORD_SIZE)
+            binary = false; // Format string too long for a binary record, format it
 
-        /* Write in the file. */
-        LogWriteToFile(sLogBuffer);
+        uint32_t pos;
+        LogRecord *record = AcquireRecordOrDrop(lvl, binary ? (binaryLength + LOG_SLOT_SIZE - 1) / LOG_SLOT_SIZE : 1, &pos);
+        if (record == nullptr)
+            return;
+
+        char *data = GetRecordData(pos);
+
+        if (binary)
+        {
+            size_t len = BeginBinaryRecord(record, data, BinaryLogRecordType_Log, lvl, BinaryLogFormatId(fmt, formatLength));
+
+            uint16_t formatLength16 = static_cast<uint16_t>(formatLength);
+            memcpy(&data[len], &formatLength16, sizeof(formatLength16));
+            memcpy(&data[len + sizeof(formatLength16)], fmt, formatLength);
+            len += sizeof(formatLength16) + formatLength;
+
+            EndBinaryRecord(record, data, EncodeBinaryArgs(data, record->slotCount * LOG_SLOT_SIZE, len, fmt, vl));
+        }
+        else
+        {
+            record->binary = false;
+            size_t headerLen = FormatHeader(data, LOG_SLOT_SIZE, lvl);
+
+            ::std::va_list args;
+            va_copy(args, vl);
+            int msgLen = std::vsnprintf(&data[headerLen], LOG_SLOT_SIZE - headerLen, fmt, args);
+            va_end(args);
+
+            size_t recordLen = std::min<size_t>(headerLen + std::max(msgLen, 0) + 1, LOG_RECORD_SIZE);
+            uint32_t longPos;
+            LogRecord *longRecord = (recordLen > LOG_SLOT_SIZE) ? AcquireRecord(lvl, (recordLen + LOG_SLOT_SIZE - 1) / LOG_SLOT_SIZE, &longPos) : nullptr;
+
+            if (longRecord != nullptr)
+            {
+                // Format it again in consecutive slots, the first slot becomes an empty record
+                char *longData = GetRecordData(longPos);
+                memcpy(longData, data, headerLen);
+                record->length = 0;
+                PublishRecord(record, pos);
+
+                record = longRecord;
+                pos = longPos;
+                data = longData;
+
+                record->binary = false;
+                msgLen = std::vsnprintf(&data[headerLen], recordLen - headerLen, fmt, vl);
+            }
+
+            // Truncated to the slot if the ring has no room for a longer record
+            record->length = EndRecord(data, headerLen + std::max(msgLen, 0), record->slotCount * LOG_SLOT_SIZE);
+        }
+
+        PublishRecord(record, pos);
+
+        if (lvl >= LOG_LEVEL_ERROR)
+            FlushErrorRecords(pos + record->slotCount); // Get errors on the SD card as soon as possible (e.g. Crash)
     }
 
     void LogBuffer(int lvl, const uint8_t *buffer, size_t size)
     {
-        if (lvl < slogLevel)
+        if (!IsEnabled(lvl))
             return; // Don't log if the level is lower than the current log level.
 
-        std::lock_guard<std::mutex> printLock(sLogMutex);
+        if (!sInitialized.load(std::memory_order_acquire))
+            return;
 
-        uint64_t current_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        std::snprintf(sLogBuffer, sizeof(sLogBuffer), "|%c|%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64 ".%03" PRIu64 "|%08X| ", klogLevelStr[lvl], (current_time_ms / 3600000) % 24, (current_time_ms / 60000) % 60, (current_time_ms / 1000) % 60, current_time_ms % 1000, (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        uint32_t pos = 0;
 
-        size_t start_offset = strlen(sLogBuffer);
+        if (IsBinaryLevel(lvl))
+        {
+            // Raw bytes, split by chunk
+            for (size_t offset = 0; offset == 0 || offset < size; offset += LOG_BINARY_CHUNK_SIZE)
+            {
+                LogRecord *record = AcquireRecordOrDrop(lvl, 1, &pos);
+                if (record == nullptr)
+                    return;
+
+                char *data = GetRecordData(pos);
+                size_t chunkSize = std::min<size_t>(LOG_BINARY_CHUNK_SIZE, size - offset);
+                size_t len = BeginBinaryRecord(record, data, BinaryLogRecordType_Buffer, lvl, ((uint64_t)offset << 32) | (uint32_t)size);
+                memcpy(&data[len], &buffer[offset], chunkSize);
+                EndBinaryRecord(record, data, len + chunkSize);
+                PublishRecord(record, pos);
+            }
 
-        std::snprintf(&sLogBuffer[strlen(sLogBuffer)], sizeof(sLogBuffer) - strlen(sLogBuffer), "Buffer (%zu): ", size);
+            return;
+        }
 
-        LogWriteToFile(sLogBuffer);
+        char header[LOG_SLOT_SIZE];
+        size_t header_len = FormatHeader(header, sizeof(header), lvl);
 
-        /* Format log */
-        for (size_t i = 0; i < size; i += 16)
+        /* Format log: One record for the size, then one record per 16 bytes */
+        for (size_t i = 0; i < size + 16; i += 16)
         {
-            for (size_t k = 0; k < std::min((size_t)16, size - i); k++)
-                snprintf(&sLogBuffer[start_offset + (k * 3)], sizeof(sLogBuffer) - (start_offset + (k * 3)), "%02X ", buffer[i + k]);
-
-            /* Write in the file. */
-            LogWriteToFile(sLogBuffer);
+            LogRecord *record = AcquireRecordOrDrop(lvl, 1, &pos);
+            if (record == nullptr)
+                return;
+
+            char *data = GetRecordData(pos);
+            record->binary = false;
+            memcpy(data, header, header_len);
+            size_t len = header_len;
+
+            if (i == 0)
+            {
+                len += std::snprintf(&data[len], LOG_SLOT_SIZE - len, "Buffer (%zu): ", size);
+            }
+            else
+            {
+                for (size_t k = i - 16; k < std::min(i, size); k++)
+                    len += std::snprintf(&data[len], LOG_SLOT_SIZE - len, "%02X ", buffer[k]);
+            }
+
+            record->length = EndRecord(data, len, LOG_SLOT_SIZE);
+            PublishRecord(record, pos);
         }
+
+        if (lvl >= LOG_LEVEL_ERROR)
+            FlushErrorRecords(pos + 1);
     }
 
     void LogTrace(const char *fmt, ...)
@@ -170,7 +784,7 @@ namespace syscon::logger
 
     bool Logger::IsEnabled(LogLevel lvl)
     {
-        return lvl >= slogLevel;
+        return ::syscon::logger::IsEnabled(lvl);
     }
 
 } // namespace syscon::logger
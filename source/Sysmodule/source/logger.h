@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <cstdarg>
 #include <string>
 #include "ifilemanager.h"
@@ -12,13 +13,56 @@
 #define LOG_LEVEL_ERROR   5
 #define LOG_LEVEL_COUNT   6
 
+/*
+    Logs below SYSCON_LOG_MIN_LEVEL are removed at compile time when using the SYSCON_LOG_xxx macros (e.g. make LOG_MIN_LEVEL=3).
+    Above it, the runtime level is checked inline before evaluating the arguments.
+    Use the macros on hot paths (Called for every input report), LogXXX functions are fine everywhere else.
+*/
+#ifndef SYSCON_LOG_MIN_LEVEL
+    #define SYSCON_LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#endif
+
+#define SYSCON_LOG_IF(lvl, call)                     \
+    do                                               \
+    {                                                \
+        if constexpr ((lvl) >= SYSCON_LOG_MIN_LEVEL) \
+        {                                            \
+            if (::syscon::logger::IsEnabled(lvl))    \
+                call;                                \
+        }                                            \
+    } while (0)
+
+#define SYSCON_LOG_TRACE(...)                SYSCON_LOG_IF(LOG_LEVEL_TRACE, ::syscon::logger::LogTrace(__VA_ARGS__))
+#define SYSCON_LOG_DEBUG(...)                SYSCON_LOG_IF(LOG_LEVEL_DEBUG, ::syscon::logger::LogDebug(__VA_ARGS__))
+#define SYSCON_LOG_PERF(...)                 SYSCON_LOG_IF(LOG_LEVEL_PERF, ::syscon::logger::LogPerf(__VA_ARGS__))
+#define SYSCON_LOG_INFO(...)                 SYSCON_LOG_IF(LOG_LEVEL_INFO, ::syscon::logger::LogInfo(__VA_ARGS__))
+#define SYSCON_LOG_WARNING(...)              SYSCON_LOG_IF(LOG_LEVEL_WARNING, ::syscon::logger::LogWarning(__VA_ARGS__))
+#define SYSCON_LOG_ERROR(...)                SYSCON_LOG_IF(LOG_LEVEL_ERROR, ::syscon::logger::LogError(__VA_ARGS__))
+#define SYSCON_LOG_BUFFER(lvl, buffer, size) SYSCON_LOG_IF(lvl, ::syscon::logger::LogBuffer(lvl, buffer, size))
+
 namespace syscon::logger
 {
     void Initialize(const std::string &logPath, std::unique_ptr<IFileManager> &&file);
     void Exit();
 
+    // Wait until all the pending records are written in the log file
+    void Flush();
+
+    // Sync errors: The thread logging an error waits until it is written in the log file (Enabled by default), otherwise it only wakes up the flusher thread
+    void SetSyncErrors(bool enabled);
+
     void SetLogLevel(int level);
 
+    extern std::atomic<int> g_log_level; // Use SetLogLevel/IsEnabled
+
+    inline bool IsEnabled(int lvl)
+    {
+        return lvl >= g_log_level.load(std::memory_order_relaxed);
+    }
+
+    // Binary mode: Trace and Perf records are stored unformatted in <log>.bin (See logger_binary.h and tools/LogDecoder)
+    void SetBinaryLogging(bool enabled);
+
     void LogTrace(const char *format, ...);
     void LogDebug(const char *format, ...);
     void LogPerf(const char *format, ...);
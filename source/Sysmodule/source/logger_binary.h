@@ -0,0 +1,369 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Binary log format (log.bin)
+ *
+ * In binary mode, Trace and Perf records are not formatted by sys-con: the caller only stores the format string,
+ * a timestamp, the thread and the raw arguments (or the raw bytes for LogBuffer).
+ * The format string itself is written once per session (first time it is used), the log is then rendered
+ * on a computer with tools/LogDecoder.
+ *
+ * The file is a sequence of records: BinaryLogRecordHeader followed by 'size' bytes of payload.
+ *  - Session: Written each time sys-con starts, payload is BinaryLogSession. All format ids are reset.
+ *  - Format:  id = format id (BinaryLogFormatId of the format string), payload = format string (Not null terminated)
+ *  - Log:     id = format id, payload = arguments, each one is a BinaryLogArgType (1 byte) followed by:
+ *                  Int: int64_t, Double: double, String: uint16_t length + characters
+ *  - Buffer:  id = (offset << 32) | total size, payload = raw bytes (Buffers are split in several records if needed)
+ *
+ * This header has no dependency on the sysmodule, it is shared with tools/LogDecoder and the tests.
+ */
+
+#define BINARY_LOG_MAGIC      0x424C5953 // "SYLB"
+#define BINARY_LOG_VERSION    1
+#define BINARY_LOG_STRING_MAX 64 // String arguments are truncated
+
+namespace syscon::logger
+{
+    enum BinaryLogRecordType : uint8_t
+    {
+        BinaryLogRecordType_Session = 0,
+        BinaryLogRecordType_Format,
+        BinaryLogRecordType_Log,
+        BinaryLogRecordType_Buffer,
+    };
+
+    enum BinaryLogArgType : uint8_t
+    {
+        BinaryLogArgType_Int = 0,
+        BinaryLogArgType_Double,
+        BinaryLogArgType_String,
+    };
+
+    struct BinaryLogRecordHeader
+    {
+        uint8_t type;
+        uint8_t level;
+        uint16_t size; // Payload size
+        uint32_t thread;
+        uint64_t timestamp_us;
+        uint64_t id;
+    };
+
+    struct BinaryLogSession
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    /*
+     * One conversion of a printf format string (e.g. "%-08.3lf")
+     * The length modifier is not kept in 'spec': integers are always stored and rendered as 64 bits.
+     */
+    struct BinaryLogFormatSpec
+    {
+        char spec[16];     // Flags, width and precision, including the '%' (e.g. "%-08.3")
+        char conversion;   // d, i, u, x, X, o, c, s, p, f, e, g, a, ... (0 for "%%")
+        char length[3];    // hh, h, l, ll, z, j, t, L or empty
+        int starCount;     // Number of '*' in width/precision: Each one consumes an int argument
+    };
+
+    // FNV-1a hash of the format string: The same text always gets the same id, whatever its address
+    inline uint64_t BinaryLogFormatId(const char *fmt, size_t length)
+    {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < length; i++)
+            hash = (hash ^ static_cast<uint8_t>(fmt[i])) * 0x100000001B3ULL;
+
+        return hash;
+    }
+
+    // Search the next conversion in fmt, text before it is returned in *textLength. Return nullptr at the end of the string
+    inline const char *BinaryLogNextFormatSpec(const char *fmt, size_t *textLength, BinaryLogFormatSpec *spec)
+    {
+        const char *percent = strchr(fmt, '%');
+        if (percent == nullptr)
+        {
+            *textLength = strlen(fmt);
+            return nullptr;
+        }
+
+        *textLength = percent - fmt;
+
+        const char *p = percent + 1;
+        size_t specLen = 1;
+        memset(spec, 0, sizeof(BinaryLogFormatSpec));
+        spec->spec[0] = '%';
+
+        // Flags, width, precision
+        while (*p != '\0' && strchr("-+ #0123456789.*", *p) != nullptr)
+        {
+            if (*p == '*')
+                spec->starCount++;
+
+            if (specLen < sizeof(spec->spec) - 1)
+                spec->spec[specLen++] = *p;
+            p++;
+        }
+
+        // Length modifier
+        size_t lengthLen = 0;
+        while (*p != '\0' && strchr("hlzjtL", *p) != nullptr)
+        {
+            if (lengthLen < sizeof(spec->length) - 1)
+                spec->length[lengthLen++] = *p;
+            p++;
+        }
+
+        if (*p == '\0')
+            return p; // Truncated conversion, ignored
+
+        spec->conversion = (*p == '%') ? 0 : *p;
+        return p + 1;
+    }
+
+    inline bool BinaryLogIsIntConversion(char conversion)
+    {
+        return conversion != 0 && strchr("diuxXoc", conversion) != nullptr;
+    }
+
+    inline bool BinaryLogIsDoubleConversion(char conversion)
+    {
+        return conversion != 0 && strchr("fFeEgGaA", conversion) != nullptr;
+    }
+
+    /*
+     * Render binary log records as the text log would do
+     * Records can be fed in any chunk size, incomplete records are kept until the next call.
+     */
+    class BinaryLogDecoder
+    {
+    public:
+        // Return false if the data is not a valid binary log
+        bool Decode(const uint8_t *data, size_t size, std::string *out)
+        {
+            m_pending.append(reinterpret_cast<const char *>(data), size);
+
+            size_t offset = 0;
+            while (m_pending.size() - offset >= sizeof(BinaryLogRecordHeader))
+            {
+                BinaryLogRecordHeader header;
+                memcpy(&header, &m_pending[offset], sizeof(header));
+
+                if (m_pending.size() - offset - sizeof(header) < header.size)
+                    break; // Incomplete record
+
+                const uint8_t *payload = reinterpret_cast<const uint8_t *>(&m_pending[offset + sizeof(header)]);
+                if (!DecodeRecord(header, payload, out))
+                    return false;
+
+                offset += sizeof(header) + header.size;
+            }
+
+            m_pending.erase(0, offset);
+            return true;
+        }
+
+    private:
+        bool DecodeRecord(const BinaryLogRecordHeader &header, const uint8_t *payload, std::string *out)
+        {
+            switch (header.type)
+            {
+                case BinaryLogRecordType_Session:
+                {
+                    BinaryLogSession session;
+                    if (header.size != sizeof(session))
+                        return false;
+
+                    memcpy(&session, payload, sizeof(session));
+                    if (session.magic != BINARY_LOG_MAGIC || session.version != BINARY_LOG_VERSION)
+                        return false;
+
+                    m_formats.clear();
+                    return true;
+                }
+                case BinaryLogRecordType_Format:
+                    m_formats[header.id] = std::string(reinterpret_cast<const char *>(payload), header.size);
+                    return true;
+                case BinaryLogRecordType_Log:
+                {
+                    auto it = m_formats.find(header.id);
+                    AppendHeader(header, out);
+                    if (it == m_formats.end())
+                        out->append("<Unknown format>");
+                    else
+                        AppendFormatted(it->second.c_str(), payload, header.size, out);
+                    out->append("\n");
+                    return true;
+                }
+                case BinaryLogRecordType_Buffer:
+                {
+                    uint32_t bufferOffset = static_cast<uint32_t>(header.id >> 32);
+                    uint32_t bufferSize = static_cast<uint32_t>(header.id);
+                    char hex[4];
+
+                    if (bufferOffset == 0)
+                    {
+                        AppendHeader(header, out);
+                        out->append("Buffer (" + std::to_string(bufferSize) + "): \n");
+                    }
+
+                    for (size_t i = 0; i < header.size; i += 16)
+                    {
+                        AppendHeader(header, out);
+                        for (size_t k = i; k < header.size && k < i + 16; k++)
+                        {
+                            snprintf(hex, sizeof(hex), "%02X ", payload[k]);
+                            out->append(hex);
+                        }
+                        out->append("\n");
+                    }
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        void AppendHeader(const BinaryLogRecordHeader &header, std::string *out)
+        {
+            static const char levels[] = {'T', 'D', 'P', 'I', 'W', 'E'};
+            uint64_t ms = header.timestamp_us / 1000;
+            char text[64];
+
+            snprintf(text, sizeof(text), "|%c|%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64 ".%03" PRIu64 "|%08X| ", header.level < sizeof(levels) ? levels[header.level] : '?',
+                     (ms / 3600000) % 24, (ms / 60000) % 60, (ms / 1000) % 60, ms % 1000, header.thread);
+            out->append(text);
+        }
+
+        // Read the next argument, return false if there is no more argument of the expected type
+        bool ReadArg(const uint8_t *payload, size_t size, size_t *offset, BinaryLogArgType expected, int64_t *intValue, double *doubleValue, std::string *stringValue)
+        {
+            if (*offset >= size || payload[*offset] != expected)
+                return false;
+
+            size_t pos = *offset + 1;
+            if (expected == BinaryLogArgType_String)
+            {
+                uint16_t len;
+                if (pos + sizeof(len) > size)
+                    return false;
+                memcpy(&len, &payload[pos], sizeof(len));
+                pos += sizeof(len);
+                if (pos + len > size)
+                    return false;
+                stringValue->assign(reinterpret_cast<const char *>(&payload[pos]), len);
+                *offset = pos + len;
+                return true;
+            }
+
+            if (pos + 8 > size)
+                return false;
+
+            if (expected == BinaryLogArgType_Int)
+                memcpy(intValue, &payload[pos], 8);
+            else
+                memcpy(doubleValue, &payload[pos], 8);
+
+            *offset = pos + 8;
+            return true;
+        }
+
+        void AppendFormatted(const char *fmt, const uint8_t *payload, size_t size, std::string *out)
+        {
+            BinaryLogFormatSpec spec;
+            size_t offset = 0;
+            size_t textLength;
+            char text[256];
+
+            while (true)
+            {
+                const char *next = BinaryLogNextFormatSpec(fmt, &textLength, &spec);
+                out->append(fmt, textLength);
+                if (next == nullptr)
+                    break;
+
+                fmt = next;
+
+                int64_t stars[2] = {0, 0};
+                int64_t intValue = 0;
+                double doubleValue = 0;
+                std::string stringValue;
+                bool valid = true;
+
+                for (int i = 0; i < spec.starCount && i < 2; i++)
+                    valid = valid && ReadArg(payload, size, &offset, BinaryLogArgType_Int, &stars[i], &doubleValue, &stringValue);
+
+                // Width and precision given as arguments are written in the conversion
+                std::string conversion;
+                int star = 0;
+                for (const char *c = spec.spec; *c != '\0'; c++)
+                {
+                    if (*c == '*')
+                        conversion += std::to_string(stars[star++ % 2]);
+                    else
+                        conversion += *c;
+                }
+
+                if (spec.conversion == 0)
+                {
+                    out->append("%");
+                    continue;
+                }
+                else if (BinaryLogIsIntConversion(spec.conversion))
+                {
+                    valid = valid && ReadArg(payload, size, &offset, BinaryLogArgType_Int, &intValue, &doubleValue, &stringValue);
+                    conversion += (spec.conversion == 'c') ? "c" : std::string("ll") + spec.conversion;
+                }
+                else if (BinaryLogIsDoubleConversion(spec.conversion))
+                {
+                    valid = valid && ReadArg(payload, size, &offset, BinaryLogArgType_Double, &intValue, &doubleValue, &stringValue);
+                    conversion += spec.conversion;
+                }
+                else if (spec.conversion == 's')
+                {
+                    valid = valid && ReadArg(payload, size, &offset, BinaryLogArgType_String, &intValue, &doubleValue, &stringValue);
+                    conversion += 's';
+                }
+                else if (spec.conversion == 'p')
+                {
+                    valid = valid && ReadArg(payload, size, &offset, BinaryLogArgType_Int, &intValue, &doubleValue, &stringValue);
+                    conversion = "0x%llx";
+                }
+                else
+                {
+                    continue; // %n and unknown conversions are not rendered
+                }
+
+                if (!valid)
+                {
+                    out->append("<Missing argument>");
+                    continue;
+                }
+
+                const char *format = conversion.c_str();
+                if (BinaryLogIsDoubleConversion(spec.conversion))
+                    snprintf(text, sizeof(text), format, doubleValue);
+                else if (spec.conversion == 's')
+                    snprintf(text, sizeof(text), format, stringValue.c_str());
+                else if (spec.conversion == 'c')
+                    snprintf(text, sizeof(text), format, (int)intValue);
+                else
+                    snprintf(text, sizeof(text), format, (long long)intValue);
+
+                out->append(text);
+            }
+        }
+
+        std::string m_pending;
+        std::unordered_map<uint64_t, std::string> m_formats;
+    };
+
+} // namespace syscon::logger
@@ -5,6 +5,7 @@
 #include "usb_module.h"
 #include "controller_handler.h"
 #include "config_handler.h"
+#include "report_recorder.h"
 #include "psc_module.h"
 #include "version.h"
 #include "SwitchMITMHandler.h"
@@ -14,6 +15,7 @@
 
 // Size of the inner heap (adjust as necessary).
 #define INNER_HEAP_SIZE 0x80000 // 512 KiB
+#define CONFIG_WATCH_PERIOD 10   // Main loop ticks every 100ms, check config.ini every second
 
 namespace ams
 {
@@ -81,9 +83,15 @@ namespace ams
 
         ::syscon::config::GlobalConfig globalConfig;
         ::syscon::config::Initialize(std::make_unique<::syscon::AMSFileManager>());
+        ::syscon::config::SetCachePath(CONFIG_CACHE_FULLPATH);
         ::syscon::config::LoadGlobalConfig(CONFIG_FULLPATH, &globalConfig);
 
         ::syscon::logger::SetLogLevel(globalConfig.log_level);
+        ::syscon::logger::SetBinaryLogging(globalConfig.log_binary);
+        ::syscon::logger::SetSyncErrors(globalConfig.log_sync_errors);
+
+        if (globalConfig.record_reports)
+            ::syscon::recorder::Initialize(RECORDS_PATH, std::make_unique<::syscon::AMSFileManager>());
 
         ::syscon::logger::LogDebug("Initializing controllers ...");
         ::syscon::controllers::Initialize();
@@ -101,17 +109,34 @@ namespace ams
         HidSharedMemoryManager::GetHidSharedMemoryManager().Start();
         ams::syscon::hid::mitm::InitializeHidMitm();
 
+        std::unique_ptr<::syscon::IFileManager> statsFileManager = std::make_unique<::syscon::AMSFileManager>();
+        int loopCount = 0;
         while ((::syscon::psc::IsRunning()))
         {
             svcSleepThread(1e+8L);
+
+            // Config hot reload: config.ini metadata are checked every CONFIG_WATCH_PERIOD loops
+            if (++loopCount % CONFIG_WATCH_PERIOD == 0 && ::syscon::config::ReloadIfModified(CONFIG_FULLPATH))
+                ::syscon::controllers::ReloadConfig(CONFIG_FULLPATH);
+
+            // Config cache: Controllers connected meanwhile are written at once
+            if (loopCount % CONFIG_WATCH_PERIOD == 0)
+                ::syscon::config::FlushCache();
+
+            // Stats: stats.txt is written every stats_period_s seconds, or on demand when stats.request exists (Checked every second)
+            if (loopCount % CONFIG_WATCH_PERIOD == 0 && (statsFileManager->remove(STATS_REQUEST_FULLPATH) ||
+                                                         (globalConfig.stats_period_s != 0 && loopCount % (globalConfig.stats_period_s * CONFIG_WATCH_PERIOD) == 0)))
+                ::syscon::controllers::DumpStats(statsFileManager.get(), STATS_FULLPATH);
         }
 
         ::syscon::logger::LogDebug("Shutting down sys-con ...");
+        ::syscon::config::FlushCache();
         HidSharedMemoryManager::GetHidSharedMemoryManager().Stop();
         ams::syscon::hid::mitm::FinalizeHidMitm();
         ::syscon::psc::Exit();
         ::syscon::usb::Exit();
         ::syscon::controllers::Exit();
+        ::syscon::recorder::Exit();
         ::syscon::logger::Exit();
     }
 
@@ -15,7 +15,7 @@ namespace syscon::psc
         // Thread to check for psc:pm state change (console waking up/going to sleep)
         void PscThreadFunc(void *arg);
 
-        // Must be large enough for controllers::Clear()'s teardown on sleep/shutdown: destructor
+        // Must be large enough for controllers::Clear()/Suspend()'s teardown on sleep/shutdown: destructor
         // chains through every connected controller plus several Log*() calls, each driving
         // newlib's stack-heavy vsnprintf internals. 0x1000 was observed to overflow (crash report
         // showed SP sitting exactly at the stack region's floor) - sized to match the USB threads.
@@ -40,14 +40,16 @@ namespace syscon::psc
                             case PscPmState_Awake:
                             case PscPmState_ReadyAwaken:
                                 ::syscon::logger::LogDebug("Power management: Awake");
+                                controllers::Resume();
                                 break;
                             case PscPmState_ReadyShutdown:
                                 ::syscon::logger::LogDebug("Power management: Shutdown");
                                 is_psc_thread_running = false; // Exit thread
-                                [[fallthrough]];
+                                controllers::Clear();
+                                break;
                             case PscPmState_ReadySleep:
                                 ::syscon::logger::LogDebug("Power management: Sleep");
-                                controllers::Clear();
+                                controllers::Suspend(); // The USB bus is powered off, only what was resolved for each controller is kept
                                 break;
                             default:
                                 break;
@@ -0,0 +1,353 @@
+#include "report_recorder.h"
+#include "logger.h"
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <inttypes.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __SWITCH__
+    #include <switch.h>
+#endif
+
+#define REPORT_RECORDER_BUFFER_SIZE     4096 // Size of each of the 2 buffers of a recorder
+#define REPORT_RECORDER_FLUSH_PERIOD_MS 50
+
+namespace syscon::recorder
+{
+    namespace
+    {
+        /*
+            Each recorder has 2 preallocated buffers: The input thread appends the records to the active one, and hands it over
+            to the writer thread when it is full (Or when the writer asks for it, to keep the file up to date).
+            The input thread never waits: If the writer has not yet written the other buffer, the record is dropped (And counted).
+            The writer thread is shared by all the recorders, it has the lowest priority.
+        */
+        class ReportRecorder final : public IReportRecorder
+        {
+        public:
+            ReportRecorder(const std::filesystem::path &path);
+            ~ReportRecorder() override;
+
+            void Begin(uint16_t vendor_id, uint16_t product_id, IUSBInterface *const *interfaces, size_t interfaceCount) override;
+            void Record(uint8_t endpoint, ControllerResult result, const uint8_t *buffer, size_t size) override;
+
+            // Writer thread, sRecorderMutex must be locked by the caller
+            void WritePending();
+
+        private:
+            bool Append(const void *header, size_t headerSize, const void *data, size_t dataSize);
+            bool Swap();
+
+            // sRecorderMutex must be locked by the caller
+            void WriteBuffer(uint8_t idx);
+
+            std::filesystem::path m_path;
+            std::unique_ptr<IFile> m_file;
+
+            std::unique_ptr<uint8_t[]> m_buffers[2];
+            size_t m_used[2] = {};
+            std::atomic<bool> m_full[2] = {}; // Handed over to the writer thread
+            uint8_t m_active = 0;             // Buffer used by the input thread
+            std::atomic<bool> m_swapRequested{false};
+            std::atomic<uint32_t> m_dropped{0};
+
+            bool m_started = false;
+            std::chrono::steady_clock::time_point m_lastRecordTime;
+        };
+
+        std::vector<ReportRecorder *> sRecorders;
+        std::mutex sRecorderMutex; // Protect sRecorders, sFileManager and the files
+        std::unique_ptr<IFileManager> sFileManager;
+        std::filesystem::path sDirectory;
+        uint32_t sNextFileIndex = 0;
+        std::atomic<bool> sInitialized{false};
+        std::atomic<bool> sWriterRunning{false};
+
+#ifdef __SWITCH__
+        alignas(0x1000) u8 sWriterThreadStack[0x4000];
+        Thread sWriterThread;
+#else
+        std::thread sWriterThread;
+#endif
+
+        ReportRecorder::ReportRecorder(const std::filesystem::path &path)
+            : m_path(path)
+        {
+            m_buffers[0] = std::make_unique<uint8_t[]>(REPORT_RECORDER_BUFFER_SIZE);
+            m_buffers[1] = std::make_unique<uint8_t[]>(REPORT_RECORDER_BUFFER_SIZE);
+
+            std::lock_guard<std::mutex> lock(sRecorderMutex);
+            sRecorders.push_back(this);
+        }
+
+        ReportRecorder::~ReportRecorder()
+        {
+            // The input thread is stopped: Write what remains, in order
+            std::lock_guard<std::mutex> lock(sRecorderMutex);
+            sRecorders.erase(std::remove(sRecorders.begin(), sRecorders.end(), this), sRecorders.end());
+
+            WritePending();
+            WriteBuffer(m_active);
+        }
+
+        void ReportRecorder::Begin(uint16_t vendor_id, uint16_t product_id, IUSBInterface *const *interfaces, size_t interfaceCount)
+        {
+            ReportRecordFileHeader header = {};
+            header.magic = REPORT_RECORD_MAGIC;
+            header.version = REPORT_RECORD_VERSION;
+            header.interface_count = static_cast<uint16_t>(interfaceCount);
+            header.vendor_id = vendor_id;
+            header.product_id = product_id;
+
+            if (!Append(&header, sizeof(header), nullptr, 0))
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+
+            for (size_t i = 0; i < interfaceCount; i++)
+            {
+                ReportRecordInterface interface = {};
+                ReportRecordEndpoint endpoints[30] = {};
+
+                IUSBInterface::InterfaceDescriptor *interfaceDescriptor = interfaces[i]->GetDescriptor();
+                if (interfaceDescriptor != nullptr)
+                {
+                    interface.number = interfaceDescriptor->bInterfaceNumber;
+                    interface.interface_class = interfaceDescriptor->bInterfaceClass;
+                    interface.interface_subclass = interfaceDescriptor->bInterfaceSubClass;
+                    interface.interface_protocol = interfaceDescriptor->bInterfaceProtocol;
+                }
+
+                // Same enumeration as BaseController::OpenInterfaces
+                for (IUSBEndpoint::Direction direction : {IUSBEndpoint::USB_ENDPOINT_IN, IUSBEndpoint::USB_ENDPOINT_OUT})
+                {
+                    for (uint8_t idx = 0; idx < 15; idx++)
+                    {
+                        IUSBEndpoint *endpoint = interfaces[i]->GetEndpoint(direction, idx);
+                        if (endpoint == nullptr)
+                            continue;
+
+                        ReportRecordEndpoint *recordEndpoint = &endpoints[interface.endpoint_count++];
+                        recordEndpoint->address = direction | (idx + 1); // Descriptor not available (e.g. mocks): Best guess
+
+                        IUSBEndpoint::EndpointDescriptor *descriptor = endpoint->GetDescriptor();
+                        if (descriptor != nullptr)
+                        {
+                            recordEndpoint->address = descriptor->bEndpointAddress;
+                            recordEndpoint->interval = descriptor->bInterval;
+                            recordEndpoint->max_packet_size = descriptor->wMaxPacketSize;
+                        }
+                    }
+                }
+
+                if (!Append(&interface, sizeof(interface), endpoints, interface.endpoint_count * sizeof(ReportRecordEndpoint)))
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void ReportRecorder::Record(uint8_t endpoint, ControllerResult result, const uint8_t *buffer, size_t size)
+        {
+            auto now = std::chrono::steady_clock::now();
+
+            ReportRecordHeader header = {};
+            header.size = static_cast<uint16_t>(size);
+            header.endpoint = endpoint;
+            header.result = static_cast<uint8_t>(result);
+            if (m_started)
+                header.delta_us = static_cast<uint32_t>(std::min<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastRecordTime).count(), UINT32_MAX));
+
+            // The writer thread is waiting for the records already there
+            if (m_swapRequested.load(std::memory_order_relaxed) && m_used[m_active] > 0)
+                Swap();
+
+            if (!Append(&header, sizeof(header), buffer, size))
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return; // Not recorded: The delta of the next record includes this one
+            }
+
+            m_started = true;
+            m_lastRecordTime = now;
+        }
+
+        bool ReportRecorder::Append(const void *header, size_t headerSize, const void *data, size_t dataSize)
+        {
+            if (headerSize + dataSize > REPORT_RECORDER_BUFFER_SIZE)
+                return false;
+
+            if (m_used[m_active] + headerSize + dataSize > REPORT_RECORDER_BUFFER_SIZE && !Swap())
+                return false;
+
+            uint8_t *buffer = m_buffers[m_active].get();
+            memcpy(&buffer[m_used[m_active]], header, headerSize);
+            if (dataSize > 0)
+                memcpy(&buffer[m_used[m_active] + headerSize], data, dataSize);
+            m_used[m_active] += headerSize + dataSize;
+            return true;
+        }
+
+        bool ReportRecorder::Swap()
+        {
+            uint8_t next = m_active ^ 1;
+            if (m_full[next].load(std::memory_order_acquire))
+                return false; // Still being written
+
+            m_full[m_active].store(true, std::memory_order_release);
+            m_active = next;
+            m_swapRequested.store(false, std::memory_order_relaxed);
+            return true;
+        }
+
+        void ReportRecorder::WriteBuffer(uint8_t idx)
+        {
+            // Without file manager (Recorder stopped), the records are discarded
+            if (m_used[idx] > 0 && sFileManager != nullptr)
+            {
+                if (m_file == nullptr)
+                    m_file = sFileManager->open(m_path, (OpenFlags)(OpenFlags_Write | OpenFlags_Append));
+
+                if (m_file && m_file->is_open())
+                {
+                    m_file->write(m_buffers[idx].get(), m_used[idx]);
+                    m_file->flush();
+                }
+            }
+
+            m_used[idx] = 0;
+        }
+
+        void ReportRecorder::WritePending()
+        {
+            // Only one buffer can be handed over at a time: It is always older than the active one
+            for (uint8_t idx = 0; idx < 2; idx++)
+            {
+                if (!m_full[idx].load(std::memory_order_acquire))
+                    continue;
+
+                WriteBuffer(idx);
+                m_full[idx].store(false, std::memory_order_release);
+            }
+
+            m_swapRequested.store(true, std::memory_order_relaxed);
+
+            uint32_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+                ::syscon::logger::LogWarning("Recorder: %" PRIu32 " reports dropped in '%s' (SD card too slow)", dropped, m_path.c_str());
+        }
+
+        void WriterThreadFunc(void *arg)
+        {
+            (void)arg;
+
+            while (sWriterRunning.load(std::memory_order_acquire))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(sRecorderMutex);
+                    for (ReportRecorder *recorder : sRecorders)
+                        recorder->WritePending();
+                }
+
+#ifdef __SWITCH__
+                svcSleepThread(REPORT_RECORDER_FLUSH_PERIOD_MS * 1000000ULL);
+#else
+                std::this_thread::sleep_for(std::chrono::milliseconds(REPORT_RECORDER_FLUSH_PERIOD_MS));
+#endif
+            }
+        }
+
+        void StartWriter()
+        {
+            sWriterRunning.store(true, std::memory_order_release);
+
+#ifdef __SWITCH__
+            // Lowest priority: Recording must not compete with the input threads
+            Result rc = threadCreate(&sWriterThread, &WriterThreadFunc, nullptr, sWriterThreadStack, sizeof(sWriterThreadStack), 0x3F, -2);
+            if (R_SUCCEEDED(rc))
+                rc = threadStart(&sWriterThread);
+
+            if (R_FAILED(rc))
+            {
+                sWriterRunning.store(false, std::memory_order_release);
+                ::syscon::logger::LogError("Recorder: Unable to start the writer thread (Error: 0x%X)", rc);
+            }
+#else
+            sWriterThread = std::thread(WriterThreadFunc, nullptr);
+#endif
+        }
+
+        void StopWriter()
+        {
+            if (!sWriterRunning.exchange(false, std::memory_order_acq_rel))
+                return;
+
+#ifdef __SWITCH__
+            threadWaitForExit(&sWriterThread);
+            threadClose(&sWriterThread);
+#else
+            sWriterThread.join();
+#endif
+        }
+    } // namespace
+
+    void Initialize(const std::string &directory, std::unique_ptr<IFileManager> &&fileManager)
+    {
+        Exit(); // In case of re-initialization
+
+        {
+            std::lock_guard<std::mutex> lock(sRecorderMutex);
+            sDirectory = std::filesystem::path(directory);
+            sFileManager = std::move(fileManager);
+            sFileManager->create_directories(sDirectory);
+        }
+
+        sInitialized.store(true, std::memory_order_release);
+        StartWriter();
+
+        ::syscon::logger::LogInfo("Recorder: Reports are recorded in '%s'", directory.c_str());
+    }
+
+    void Exit()
+    {
+        if (!sInitialized.exchange(false, std::memory_order_acq_rel))
+            return;
+
+        StopWriter();
+
+        // Recorders still alive keep recording, but nothing more is written
+        std::lock_guard<std::mutex> lock(sRecorderMutex);
+        for (ReportRecorder *recorder : sRecorders)
+            recorder->WritePending();
+
+        sFileManager.reset();
+    }
+
+    bool IsEnabled()
+    {
+        return sInitialized.load(std::memory_order_acquire);
+    }
+
+    std::unique_ptr<IReportRecorder> Create(uint16_t vendor_id, uint16_t product_id)
+    {
+        if (!IsEnabled())
+            return nullptr;
+
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> lock(sRecorderMutex);
+
+            // Never overwrite a previous record (Another session or another controller of the same model)
+            char name[32];
+            do
+            {
+                snprintf(name, sizeof(name), "%04x-%04x_%" PRIu32 ".rec", vendor_id, product_id, sNextFileIndex++);
+                path = sDirectory / name;
+            } while (sFileManager->file_size(path) != 0);
+        }
+
+        ::syscon::logger::LogInfo("Controller[%04x-%04x] Recording reports in '%s'", vendor_id, product_id, path.c_str());
+        return std::make_unique<ReportRecorder>(path);
+    }
+} // namespace syscon::recorder
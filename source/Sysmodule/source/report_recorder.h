@@ -0,0 +1,23 @@
+#pragma once
+#include "ifilemanager.h"
+#include "ReportRecorder.h"
+#include <memory>
+#include <string>
+
+/*
+    Report recorder (record_reports=1): Every report read by the controllers is written in <directory>/<vid>-<pid>_<n>.rec
+    Replay the files on a computer with source/ControllerReplay (See doc/WiresharkCapture.md).
+*/
+namespace syscon::recorder
+{
+    // Start the writer thread, records are written in 'directory' (Created if needed)
+    void Initialize(const std::string &directory, std::unique_ptr<IFileManager> &&fileManager);
+
+    // Write what remains of the live recorders and stop the writer thread
+    void Exit();
+
+    bool IsEnabled();
+
+    // Recorder of a new controller (A new file), nullptr if the recorder is not initialized
+    std::unique_ptr<IReportRecorder> Create(uint16_t vendor_id, uint16_t product_id);
+} // namespace syscon::recorder
@@ -0,0 +1,51 @@
+#include "resume_table.h"
+#include <utility>
+
+namespace syscon::controllers
+{
+    void ResumeTable::Suspend(std::vector<ResumeEntry> &&entries)
+    {
+        m_entries = std::move(entries);
+        m_wake_us = 0;
+    }
+
+    void ResumeTable::Wake(uint64_t now_us)
+    {
+        m_wake_us = now_us;
+    }
+
+    bool ResumeTable::Take(uint16_t vendor_id, uint16_t product_id, const std::string &path, uint64_t now_us, ResumeEntry *entry)
+    {
+        if (m_wake_us != 0 && now_us >= m_wake_us + CONTROLLER_RESUME_WINDOW_US)
+            Clear();
+
+        auto found = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->vendor_id != vendor_id || it->product_id != product_id)
+                continue;
+
+            if (it->path == path)
+            {
+                found = it;
+                break;
+            }
+
+            // Same device on another port: Only if there is no better match
+            if (found == m_entries.end())
+                found = it;
+        }
+
+        if (found == m_entries.end())
+            return false;
+
+        *entry = std::move(*found);
+        m_entries.erase(found);
+        return true;
+    }
+
+    void ResumeTable::Clear()
+    {
+        m_entries.clear();
+    }
+} // namespace syscon::controllers
@@ -0,0 +1,57 @@
+#pragma once
+#include "IController.h"
+#include "ControllerConfig.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define CONTROLLER_RESUME_WINDOW_US (60 * 1000 * 1000) // Entries kept after the wake up, then the controllers are initialized from scratch
+
+/*
+    Controllers kept across a sleep (Shared with the tests)
+
+    The USB bus is powered off during the sleep: The interfaces, the endpoints and the input threads cannot be kept,
+    but what was resolved for each device does not change. On sleep, controller_handler.cpp saves it here:
+    - The resolved config, with the driver found for the device (No INI parsing nor probe on wake up),
+    - The data of the initialization returned by IController::GetResumeData() (e.g. the parsed HID report descriptor).
+
+    On wake up, usb_module.cpp takes the entry of each device plugged again: The entries are matched by VID/PID and
+    USB port (pathstr), then by VID/PID only (The device moved to another port). An entry is taken only once.
+*/
+namespace syscon::controllers
+{
+    struct ResumeEntry
+    {
+        uint16_t vendor_id = 0;
+        uint16_t product_id = 0;
+        std::string path; // UsbHsInterface.pathstr
+        ControllerConfig config;
+        std::shared_ptr<const ControllerResumeData> data;
+    };
+
+    class ResumeTable
+    {
+    public:
+        // Console going to sleep: Replace the content of the table with 'entries'
+        void Suspend(std::vector<ResumeEntry> &&entries);
+
+        // Console woken up: The entries are kept up to CONTROLLER_RESUME_WINDOW_US
+        void Wake(uint64_t now_us);
+
+        // Entry of the device, removed from the table. Return false if there is none (Or the resume window is over)
+        bool Take(uint16_t vendor_id, uint16_t product_id, const std::string &path, uint64_t now_us, ResumeEntry *entry);
+
+        void Clear();
+
+        size_t Size() const { return m_entries.size(); }
+
+        // Time of the last wake up, 0 if the console is still sleeping (Or was never)
+        uint64_t GetWakeTime() const { return m_wake_us; }
+
+    private:
+        std::vector<ResumeEntry> m_entries;
+        uint64_t m_wake_us = 0;
+    };
+} // namespace syscon::controllers
@@ -0,0 +1,88 @@
+#include "usb_discovery.h"
+#include <utility>
+
+#define USB_CLASS_HID 0x03
+
+namespace syscon::usb
+{
+    namespace
+    {
+        size_t SelectMatching(const ControllerRegistry &registry, const UsbDiscoveryFilter &filter, const UsbInterfaceInfo *interfaces, size_t count, uint64_t now_us, size_t *selected, const ControllerMatchRule *rule)
+        {
+            bool allowAll = rule != nullptr ? filter.interface_rules : filter.any_hid;
+            size_t total = 0;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const IUSBInterface::InterfaceDescriptor &descriptor = interfaces[i].descriptor;
+
+                if (descriptor.bInterfaceClass != (rule != nullptr ? rule->interface_class : USB_CLASS_HID))
+                    continue;
+
+                if (rule != nullptr && (descriptor.bInterfaceSubClass != rule->interface_subclass || descriptor.bInterfaceProtocol != rule->interface_protocol))
+                    continue;
+
+                if (!allowAll && !filter.IsAllowed(interfaces[i].vendor_id, interfaces[i].product_id))
+                    continue;
+
+                if (registry.IsProbeBlocked(interfaces[i].vendor_id, interfaces[i].product_id, interfaces[i].id, now_us))
+                    continue;
+
+                selected[total++] = i;
+            }
+
+            return total;
+        }
+    } // namespace
+
+    void UsbDiscoveryFilter::Allow(uint16_t vendor_id, uint16_t product_id)
+    {
+        m_allowlist.insert((static_cast<uint32_t>(vendor_id) << 16) | product_id);
+    }
+
+    bool UsbDiscoveryFilter::IsAllowed(uint16_t vendor_id, uint16_t product_id) const
+    {
+        if (m_allowlist.empty())
+            return false;
+
+        uint32_t key = static_cast<uint32_t>(vendor_id) << 16;
+        return m_allowlist.find(key | product_id) != m_allowlist.end() || m_allowlist.find(key) != m_allowlist.end();
+    }
+
+    size_t SelectInterfaces(const ControllerRegistry &registry, const UsbDiscoveryFilter &filter, const UsbInterfaceInfo *interfaces, size_t count, uint64_t now_us, size_t *selected)
+    {
+        for (const ControllerMatchRule &rule : registry.GetInterfaceRules())
+        {
+            size_t total = SelectMatching(registry, filter, interfaces, count, now_us, selected, &rule);
+            if (total > 0)
+                return total;
+        }
+
+        return SelectMatching(registry, filter, interfaces, count, now_us, selected, nullptr);
+    }
+
+    void UsbInterfaceTable::Update(const UsbInterfaceInfo *interfaces, size_t count, std::vector<int32_t> *added, std::vector<int32_t> *removed)
+    {
+        std::unordered_map<int32_t, UsbInterfaceInfo> previous;
+        std::swap(m_interfaces, previous);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            m_interfaces[interfaces[i].id] = interfaces[i];
+
+            if (previous.erase(interfaces[i].id) == 0 && added != nullptr)
+                added->push_back(interfaces[i].id);
+        }
+
+        if (removed != nullptr)
+        {
+            for (const auto &entry : previous)
+                removed->push_back(entry.first);
+        }
+    }
+
+    void UsbInterfaceTable::Add(const UsbInterfaceInfo &interface)
+    {
+        m_interfaces[interface.id] = interface;
+    }
+} // namespace syscon::usb
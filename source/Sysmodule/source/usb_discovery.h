@@ -0,0 +1,69 @@
+#pragma once
+#include "ControllerRegistry.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+    USB discovery without the USB stack (Shared with the tests)
+
+    usb_module.cpp queries all the interfaces at once and converts them in UsbInterfaceInfo:
+    - SelectInterfaces picks the interfaces to initialize among the available ones, in memory,
+      with the same priority as one query per class (Interface rules of the registry, then HID).
+    - UsbInterfaceTable keeps the acquired interfaces and gives what changed since the previous query.
+*/
+namespace syscon::usb
+{
+    struct UsbInterfaceInfo
+    {
+        int32_t id; // UsbHsInterface.inf.ID
+        uint16_t vendor_id;
+        uint16_t product_id;
+        IUSBInterface::InterfaceDescriptor descriptor;
+    };
+
+    /*
+        Devices that can be initialized (discovery_mode and discovery_vidpid)
+        The kernel only wakes up the event thread through a few broad filters (Limited to 3 events), the VID/PID of
+        the devices are checked here: The allowlist has no size limit.
+    */
+    class UsbDiscoveryFilter
+    {
+    public:
+        bool interface_rules = true; // Devices detected by an interface rule of the registry (e.g. XBOX controllers)
+        bool any_hid = true;         // Any HID device (Official Switch controllers too), otherwise only the allowlist
+
+        // product_id 0: All the products of the vendor
+        void Allow(uint16_t vendor_id, uint16_t product_id);
+        bool IsAllowed(uint16_t vendor_id, uint16_t product_id) const;
+        size_t AllowlistSize() const { return m_allowlist.size(); }
+
+    private:
+        std::unordered_set<uint32_t> m_allowlist; // VID << 16 | PID
+    };
+
+    /*
+        Interfaces of the first class found (In the order of the interface rules of the registry, then any HID interface),
+        skipping the devices not allowed by 'filter' and the interfaces whose probe failed recently. 'selected' receives the indices
+        of the interfaces, in their order in 'interfaces' (Up to 'count'), return the number of interfaces selected.
+    */
+    size_t SelectInterfaces(const ControllerRegistry &registry, const UsbDiscoveryFilter &filter, const UsbInterfaceInfo *interfaces, size_t count, uint64_t now_us, size_t *selected);
+
+    class UsbInterfaceTable
+    {
+    public:
+        // Replace the content of the table with 'interfaces', 'added' and 'removed' receive the IDs that changed (Can be nullptr)
+        void Update(const UsbInterfaceInfo *interfaces, size_t count, std::vector<int32_t> *added, std::vector<int32_t> *removed);
+
+        // Interfaces known before the next query (e.g. acquired by a new controller)
+        void Add(const UsbInterfaceInfo &interface);
+
+        bool Contains(int32_t id) const { return m_interfaces.find(id) != m_interfaces.end(); }
+        size_t Size() const { return m_interfaces.size(); }
+
+    private:
+        std::unordered_map<int32_t, UsbInterfaceInfo> m_interfaces;
+    };
+} // namespace syscon::usb
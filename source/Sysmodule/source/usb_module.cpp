@@ -1,12 +1,14 @@
 #include <switch.h>
 #include "usb_module.h"
 #include "controller_handler.h"
-#include "Controllers.h"
+#include "usb_discovery.h"
 
 #include "SwitchUSBDevice.h"
 #include "SwitchUSBLock.h"
+#include "SwitchUSBLockLevels.h"
 #include "logger.h"
 #include <string.h>
+#include <mutex>
 
 #define MS_TO_NS(x) (x * 1000000ul)
 
@@ -14,7 +16,7 @@ namespace syscon::usb
 {
     namespace
     {
-        constexpr size_t MaxUsbHsInterfacesSize = 8;
+        constexpr size_t MaxUsbHsInterfacesSize = 64; // All the interfaces of all the devices in one query (e.g. 8 for an Xbox 360 wireless receiver)
         constexpr size_t MaxUsbEvents = 3; // MaxUsbEvents is limited by usbHsCreateInterfaceAvailableEvent, we can have only up to 3 events
 
         // Thread that waits on generic usb event
@@ -32,19 +34,37 @@ namespace syscon::usb
         bool is_usb_interface_change_thread_running = false;
         bool g_auto_add_controller = false;
 
+        ControllerRegistry g_registry;
+        UsbDiscoveryFilter g_discoveryFilter;
+
+        // Interfaces acquired by the controllers: Unplugged ones are found by difference with the previous query
+        UsbInterfaceTable g_acquiredInterfaces;
+        std::mutex g_acquiredInterfacesMutex;
+
+        // Static storage: A query of all the interfaces doesn't fit in the stacks of the threads
+        UsbHsInterface g_availableInterfaces[MaxUsbHsInterfacesSize]; // The selected ones are then moved to the front
+        UsbHsInterface g_acquiredQuery[MaxUsbHsInterfacesSize];
+        UsbInterfaceInfo g_interfacesInfo[MaxUsbHsInterfacesSize];
+        UsbInterfaceInfo g_acquiredInfo[MaxUsbHsInterfacesSize];
+
         Event g_usbEvent[MaxUsbEvents] = {};
         Waiter g_usbWaiters[MaxUsbEvents] = {};
         size_t g_usbEventCount = 0;
 
         s32 QueryAcquiredInterfaces(UsbHsInterface *interfaces, size_t interfaces_maxsize);
-        s32 QueryAvailableInterfacesByClass(UsbHsInterface *interfaces, size_t interfaces_maxsize, u8 iclass);
-        s32 QueryAvailableInterfacesByClassSubClassProtocol(UsbHsInterface *interfaces, size_t interfaces_maxsize, u8 iclass, u8 isubclass, u8 iprotocol);
+        s32 QueryAvailableInterfaces(UsbHsInterface *interfaces, size_t interfaces_maxsize);
+        void ToInterfacesInfo(const UsbHsInterface *interfaces, s32 total_entries, UsbInterfaceInfo *info);
 
         Result AddEvent(UsbHsInterfaceFilter *filter, const std::string &name);
 
+        // Not fatal, but the same sequence can deadlock with another thread taking the locks in the right order
+        void LogLockOrderViolation(USBLockLevel level, USBLockLevel held)
+        {
+            syscon::logger::LogError("USB lock of level %d taken while holding a lock of level %d !", level, held);
+        }
+
         void UsbEventThreadFunc(void *arg)
         {
-            UsbHsInterface interfaces[MaxUsbHsInterfacesSize] = {};
             u64 timeoutNs = MS_TO_NS(1);
             (void)arg;
 
@@ -65,22 +85,27 @@ namespace syscon::usb
                         For unknown reason we have to keep this lock in order to lock the usb stacks during the controller initialization
                         If we don't do that, we will have some issue with the USB stack when we have multiple controllers connected at boot time
                         (Example: Not being able to setLed to the device - On XBOX360 wired controller)
+                        This is only the discovery lock: The input reads of the controllers already running are not blocked (See SwitchUSBLockLevels.h),
+                        their output transfers are blocked by controllers::Insert during the initialization itself
                     */
 
                     SwitchUSBLock usbLock;
-                    s32 total_interfaces_hid = 0, total_interfaces_xbox360 = 0, total_interfaces_xboxone = 0, total_interfaces_xbox360w = 0, total_interfaces_xbox = 0;
-
-                    if (
-                        (total_interfaces_xbox360 = QueryAvailableInterfacesByClassSubClassProtocol(interfaces, sizeof(interfaces), USB_CLASS_VENDOR_SPEC, 0x5D, 0x01)) > 0 ||  // XBOX360 Wired
-                        (total_interfaces_xbox360w = QueryAvailableInterfacesByClassSubClassProtocol(interfaces, sizeof(interfaces), USB_CLASS_VENDOR_SPEC, 0x5D, 0x81)) > 0 || // XBOX360 Wireless
-                        (total_interfaces_xboxone = QueryAvailableInterfacesByClassSubClassProtocol(interfaces, sizeof(interfaces), USB_CLASS_VENDOR_SPEC, 0x47, 0xD0)) > 0 ||  // XBOX ONE
-                        (total_interfaces_xbox = QueryAvailableInterfacesByClassSubClassProtocol(interfaces, sizeof(interfaces), 0x58, 0x42, 0x00)) > 0 ||                      // XBOX Original
-                        (total_interfaces_hid = QueryAvailableInterfacesByClass(interfaces, sizeof(interfaces), USB_CLASS_HID)) > 0                                             // Generic HID
-                    )
+                    u64 now_us = armTicksToNs(armGetSystemTick()) / 1000;
+
+                    // One query for all the classes, the interfaces to initialize are selected in memory
+                    s32 total_available = QueryAvailableInterfaces(g_availableInterfaces, sizeof(g_availableInterfaces));
+                    ToInterfacesInfo(g_availableInterfaces, total_available, g_interfacesInfo);
+
+                    size_t selected[MaxUsbHsInterfacesSize];
+                    s32 total_entries = SelectInterfaces(g_registry, g_discoveryFilter, g_interfacesInfo, total_available, now_us, selected);
+                    for (s32 i = 0; i < total_entries; i++)
+                        g_availableInterfaces[i] = g_availableInterfaces[selected[i]]; // In place: selected[i] >= i
+                    UsbHsInterface *interfaces = g_availableInterfaces;
+
+                    if (total_entries > 0)
                     {
                         timeoutNs = MS_TO_NS(1); // Everytime we find a controller we reset the timeout to loop again on next controllers
 
-                        s32 total_entries = total_interfaces_hid + total_interfaces_xbox360 + total_interfaces_xboxone + total_interfaces_xbox360w + total_interfaces_xbox;
                         if (controllers::IsAtControllerLimit())
                         {
                             syscon::logger::LogError("Reach controller limit - Can't add anymore controller !");
@@ -88,75 +113,57 @@ namespace syscon::usb
                         }
 
                         UsbHsInterface *interface = &interfaces[0];
+                        u16 vendor_id = interface->device_desc.idVendor;
+                        u16 product_id = interface->device_desc.idProduct;
 
                         syscon::logger::LogInfo("Trying to initialize USB device: [%04x-%04x] (Class: 0x%02X, SubClass: 0x%02X, Protocol: 0x%02X, bcd: 0x%04X)...",
-                                                interface->device_desc.idVendor,
-                                                interface->device_desc.idProduct,
+                                                vendor_id,
+                                                product_id,
                                                 interface->device_desc.bDeviceClass,
                                                 interface->device_desc.bDeviceSubClass,
                                                 interface->device_desc.bDeviceProtocol,
                                                 interface->device_desc.bcdDevice);
 
-                        std::string default_profile = "";
-                        if (total_interfaces_xbox360 > 0)
-                            default_profile = "xbox360";
-                        else if (total_interfaces_xbox360w > 0)
-                            default_profile = "xbox360w";
-                        else if (total_interfaces_xboxone > 0)
-                            default_profile = "xboxone";
-                        else if (total_interfaces_xbox > 0)
-                            default_profile = "xbox";
-
+                        // Plugged before the sleep: Same config and driver, the driver only repeats the handshakes it needs
+                        controllers::ResumeEntry resumed;
+                        bool is_resumed = controllers::TakeResumeEntry(vendor_id, product_id, std::string(interface->pathstr, strnlen(interface->pathstr, sizeof(interface->pathstr))), &resumed);
                         ControllerConfig config;
-                        ::syscon::config::LoadControllerConfig(CONFIG_FULLPATH, &config, interface->device_desc.idVendor, interface->device_desc.idProduct, g_auto_add_controller, default_profile);
 
-                        if (config.driver == "dualshock3")
-                        {
-                            syscon::logger::LogInfo("Initializing Dualshock 3 controller (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<Dualshock3Controller>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
-                        }
-                        else if (config.driver == "xbox360w")
-                        {
-                            syscon::logger::LogInfo("Initializing Xbox 360 Wireless controller (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<Xbox360WirelessController>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
-                        }
-                        else if (config.driver == "xbox360")
-                        {
-                            syscon::logger::LogInfo("Initializing Xbox 360 controller (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<Xbox360Controller>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
-                        }
-                        else if (config.driver == "xboxone")
+                        if (is_resumed)
                         {
-                            /* One XboxOne controller will expose 2 interfaces, thus we have to take all of them */
-                            syscon::logger::LogInfo("Initializing Xbox One controller (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<XboxOneController>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
+                            config = resumed.config;
                         }
-                        else if (config.driver == "xbox")
-                        {
-                            syscon::logger::LogInfo("Initializing Xbox 1st gen (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<XboxController>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
-                        }
-                        else if (config.driver == "switch")
-                        {
-                            syscon::logger::LogInfo("Initializing Switch (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<SwitchController>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
-                        }
-                        else if (config.driver == "wii")
-                        {
-                            syscon::logger::LogInfo("Initializing Wii (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<WiiController>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
-                        }
-                        else if (config.driver == "steam2026")
+                        else
                         {
-                            syscon::logger::LogInfo("Initializing Steam Controller 2026 (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<SteamController2026>(std::make_unique<SwitchUSBDevice>(interfaces, total_entries), config, std::make_unique<syscon::logger::Logger>()));
+                            const ControllerDriver *detected = g_registry.FindByDevice(vendor_id, product_id, g_interfacesInfo[selected[0]].descriptor);
+                            std::string default_profile = detected != nullptr ? detected->name : "";
+
+                            ::syscon::config::LoadControllerConfig(CONFIG_FULLPATH, &config, vendor_id, product_id, g_auto_add_controller, default_profile);
                         }
-                        else
+
+                        const ControllerDriver *driver = g_registry.FindByName(config.driver);
+                        s32 driver_entries = driver->single_interface ? 1 : total_entries;
+
+                        syscon::logger::LogInfo("%s %s (Interface count: %d) ...", is_resumed ? "Resuming" : "Initializing", driver->description.c_str(), driver_entries);
+                        std::unique_ptr<IController> controller = driver->factory(std::make_unique<SwitchUSBDevice>(interfaces, driver_entries), config, std::make_unique<syscon::logger::Logger>());
+                        if (is_resumed)
+                            controller->SetResumeData(resumed.data);
+
+                        Result rc = controllers::Insert(std::move(controller), is_resumed ? controllers::GetWakeTime() : 0);
+
+                        // Not retried on each USB event: The device would be initialized again and again (Until it's plugged again)
+                        if (R_FAILED(rc))
                         {
-                            /* For now if Generic controller expose more than 1 interface, we will create as many GenericHIDController as we have interfaces */
-                            syscon::logger::LogInfo("Initializing Generic controller (Interface count: %d) ...", total_entries);
-                            controllers::Insert(std::make_unique<GenericHIDController>(std::make_unique<SwitchUSBDevice>(interfaces, 1), config, std::make_unique<syscon::logger::Logger>()));
+                            g_registry.SetProbeFailed(vendor_id, product_id, interface->inf.ID, now_us);
+                            continue;
                         }
+
+                        g_registry.ClearProbeFailed(vendor_id, product_id);
+
+                        // Known before the next query of the acquired interfaces: Removed if unplugged in the meantime
+                        std::lock_guard<std::mutex> lock(g_acquiredInterfacesMutex);
+                        for (s32 i = 0; i < driver_entries; i++)
+                            g_acquiredInterfaces.Add(g_interfacesInfo[selected[i]]);
                     }
                     else
                     {
@@ -170,7 +177,7 @@ namespace syscon::usb
         void UsbInterfaceChangeThreadFunc(void *arg)
         {
             (void)arg;
-            UsbHsInterface interfaces[MaxUsbHsInterfacesSize] = {};
+            std::vector<s32> interfaceIDsRemoved;
 
             do
             {
@@ -180,15 +187,19 @@ namespace syscon::usb
 
                     syscon::logger::LogDebug("USBInterface state was changed !");
 
-                    s32 total_entries = QueryAcquiredInterfaces(interfaces, sizeof(interfaces));
+                    s32 total_entries = QueryAcquiredInterfaces(g_acquiredQuery, sizeof(g_acquiredQuery));
+                    ToInterfacesInfo(g_acquiredQuery, total_entries, g_acquiredInfo);
 
-                    syscon::logger::LogDebug("USBInterface %d interfaces acquired !", total_entries);
+                    interfaceIDsRemoved.clear();
+                    {
+                        std::lock_guard<std::mutex> lock(g_acquiredInterfacesMutex);
+                        g_acquiredInterfaces.Update(g_acquiredInfo, total_entries, nullptr, &interfaceIDsRemoved);
+                    }
 
-                    std::vector<s32> interfaceIDsPlugged;
-                    for (int i = 0; i < total_entries; i++)
-                        interfaceIDsPlugged.push_back(interfaces[i].inf.ID);
+                    syscon::logger::LogDebug("USBInterface %d interfaces acquired, %d removed !", total_entries, interfaceIDsRemoved.size());
 
-                    controllers::RemoveAllNonPlugged(interfaceIDsPlugged);
+                    if (!interfaceIDsRemoved.empty())
+                        controllers::RemoveUnplugged(interfaceIDsRemoved);
                 }
 
             } while (is_usb_interface_change_thread_running);
@@ -199,47 +210,44 @@ namespace syscon::usb
             SwitchUSBLock usbLock;
             s32 out_entries = 0;
 
-            if (R_SUCCEEDED(usbHsQueryAcquiredInterfaces(interfaces, interfaces_maxsize, &out_entries)))
-                return out_entries;
+            if (R_FAILED(usbHsQueryAcquiredInterfaces(interfaces, interfaces_maxsize, &out_entries)))
+                return 0;
+
+            // The interfaces missing from a full query would be seen as unplugged
+            if ((size_t)out_entries >= interfaces_maxsize / sizeof(UsbHsInterface))
+                syscon::logger::LogWarning("USB query full: %d acquired interfaces, some might be missing !", out_entries);
 
-            return 0;
+            return out_entries;
         }
 
-        s32 QueryAvailableInterfacesByClassSubClassProtocol(UsbHsInterface *interfaces, size_t interfaces_maxsize, u8 iclass, u8 isubclass, u8 iprotocol)
+        s32 QueryAvailableInterfaces(UsbHsInterface *interfaces, size_t interfaces_maxsize)
         {
             SwitchUSBLock usbLock;
 
             UsbHsInterfaceFilter filter{
-                .Flags = UsbHsInterfaceFilterFlags_bInterfaceClass | UsbHsInterfaceFilterFlags_bInterfaceSubClass | UsbHsInterfaceFilterFlags_bInterfaceProtocol,
-                .bInterfaceClass = iclass,
-                .bInterfaceSubClass = isubclass,
-                .bInterfaceProtocol = iprotocol,
+                .Flags = UsbHsInterfaceFilterFlags_bcdDevice_Min,
+                .bcdDevice_Min = 0x0000,
             };
 
             s32 out_entries = 0;
-            memset(interfaces, 0, interfaces_maxsize);
+            if (R_FAILED(usbHsQueryAvailableInterfaces(&filter, interfaces, interfaces_maxsize, &out_entries)))
+                return 0;
 
-            if (R_SUCCEEDED(usbHsQueryAvailableInterfaces(&filter, interfaces, interfaces_maxsize, &out_entries)))
-                return out_entries;
+            if ((size_t)out_entries >= interfaces_maxsize / sizeof(UsbHsInterface))
+                syscon::logger::LogWarning("USB query full: %d available interfaces, some might be missing !", out_entries);
 
-            return 0;
+            return out_entries;
         }
 
-        s32 QueryAvailableInterfacesByClass(UsbHsInterface *interfaces, size_t interfaces_maxsize, u8 iclass)
+        void ToInterfacesInfo(const UsbHsInterface *interfaces, s32 total_entries, UsbInterfaceInfo *info)
         {
-            SwitchUSBLock usbLock;
-
-            UsbHsInterfaceFilter filter{
-                .Flags = UsbHsInterfaceFilterFlags_bInterfaceClass,
-                .bInterfaceClass = iclass};
-
-            s32 out_entries = 0;
-            memset(interfaces, 0, interfaces_maxsize);
-
-            if (R_SUCCEEDED(usbHsQueryAvailableInterfaces(&filter, interfaces, interfaces_maxsize, &out_entries)))
-                return out_entries;
-
-            return 0;
+            for (s32 i = 0; i < total_entries; i++)
+            {
+                info[i].id = interfaces[i].inf.ID;
+                info[i].vendor_id = interfaces[i].device_desc.idVendor;
+                info[i].product_id = interfaces[i].device_desc.idProduct;
+                memcpy(&info[i].descriptor, &interfaces[i].inf.interface_desc, sizeof(info[i].descriptor));
+            }
         }
 
         inline Result AddEvent(UsbHsInterfaceFilter *filter, const std::string &name)
@@ -271,18 +279,35 @@ namespace syscon::usb
     {
         g_auto_add_controller = auto_add_controller;
 
+        USBLockOrder::SetViolationHandler(&LogLockOrderViolation);
+
+        g_registry.RegisterBuiltIn();
+        g_registry.BuildIndex();
+
         syscon::logger::LogInfo("USB configuration: Discovery mode(%d), Auto add controller(%s)", discovery_mode, auto_add_controller ? "true" : "false");
 
-        if (discovery_mode == syscon::config::DiscoveryMode::HID_AND_XBOX || discovery_mode == syscon::config::DiscoveryMode::VIDPID_AND_XBOX)
+        /*
+            The kernel filters only wake up the event thread, the devices to initialize are selected by g_discoveryFilter:
+            XBOX controllers and known VID/PID (As many as needed) don't need an event of their own.
+        */
+        g_discoveryFilter.interface_rules = discovery_mode != syscon::config::DiscoveryMode::VIDPID;
+        g_discoveryFilter.any_hid = discovery_mode == syscon::config::DiscoveryMode::HID_AND_XBOX;
+
+        if (discovery_mode != syscon::config::DiscoveryMode::HID_AND_XBOX)
         {
-            // Filter use to detect XBOX controllers
-            UsbHsInterfaceFilter filterAllDevices1{
-                .Flags = UsbHsInterfaceFilterFlags_bcdDevice_Min,
-                .bcdDevice_Min = 0x0000,
-            };
-            AddEvent(&filterAllDevices1, "XBOX");
+            for (syscon::config::ControllerVidPid &vidpid : discovery_vidpid)
+                g_discoveryFilter.Allow(vidpid.vid, vidpid.pid);
+
+            syscon::logger::LogInfo("USB configuration: %d known VID/PID", g_discoveryFilter.AllowlistSize());
         }
 
+        // Filter used to detect all the devices (XBOX controllers and known VID/PID)
+        UsbHsInterfaceFilter filterAllDevices1{
+            .Flags = UsbHsInterfaceFilterFlags_bcdDevice_Min,
+            .bcdDevice_Min = 0x0000,
+        };
+        AddEvent(&filterAllDevices1, "ALL");
+
         if (discovery_mode == syscon::config::DiscoveryMode::HID_AND_XBOX)
         {
             // Filter used to detect Generic HID controllers
@@ -295,26 +320,6 @@ namespace syscon::usb
             AddEvent(&filterAllDevices2, "USB_CLASS_HID");
         }
 
-        if (discovery_mode == syscon::config::DiscoveryMode::VIDPID || discovery_mode == syscon::config::DiscoveryMode::VIDPID_AND_XBOX)
-        {
-            // Filter known VID/PID
-            for (syscon::config::ControllerVidPid &vidpid : discovery_vidpid)
-            {
-                UsbHsInterfaceFilter filterKnownDevice{
-                    .Flags = UsbHsInterfaceFilterFlags_idVendor,
-                    .idVendor = vidpid.vid,
-                };
-
-                if (vidpid.pid != 0)
-                {
-                    filterKnownDevice.Flags |= UsbHsInterfaceFilterFlags_idProduct;
-                    filterKnownDevice.idProduct = vidpid.pid;
-                }
-
-                AddEvent(&filterKnownDevice, std::string(vidpid));
-            }
-        }
-
         is_usb_event_thread_running = true;
         Result rc = threadCreate(&g_usb_event_thread, &UsbEventThreadFunc, nullptr, usb_event_thread_stack, sizeof(usb_event_thread_stack), 0x3A, -2);
         if (R_FAILED(rc))
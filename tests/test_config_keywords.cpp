@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "config_keywords.h"
+
+using namespace syscon::config;
+
+namespace
+{
+    enum TestKeyword
+    {
+        TestKeyword_None,
+        TestKeyword_Alpha,
+        TestKeyword_Beta,
+        TestKeyword_Gamma,
+        TestKeyword_GammaRay,
+    };
+
+    constexpr auto test_keywords = MakeConfigKeywordTable<TestKeyword>({
+        {"alpha", TestKeyword_Alpha},
+        {"beta", TestKeyword_Beta},
+        {"gamma", TestKeyword_Gamma},
+        {"gamma_ray", TestKeyword_GammaRay},
+    });
+
+    // Lookups are resolved at compile time as well
+    static_assert(test_keywords.Find("beta", TestKeyword_None) == TestKeyword_Beta);
+    static_assert(test_keywords.Find("BETA", TestKeyword_None) == TestKeyword_Beta);
+    static_assert(test_keywords.Find("delta") == nullptr);
+} // namespace
+
+TEST(ConfigKeywords, test_find_all_keywords)
+{
+    EXPECT_EQ(test_keywords.Find("alpha", TestKeyword_None), TestKeyword_Alpha);
+    EXPECT_EQ(test_keywords.Find("beta", TestKeyword_None), TestKeyword_Beta);
+    EXPECT_EQ(test_keywords.Find("gamma", TestKeyword_None), TestKeyword_Gamma);
+    EXPECT_EQ(test_keywords.Find("gamma_ray", TestKeyword_None), TestKeyword_GammaRay);
+}
+
+TEST(ConfigKeywords, test_find_case_insensitive)
+{
+    EXPECT_EQ(test_keywords.Find("Alpha", TestKeyword_None), TestKeyword_Alpha);
+    EXPECT_EQ(test_keywords.Find("GAMMA_RAY", TestKeyword_None), TestKeyword_GammaRay);
+    EXPECT_EQ(test_keywords.Find("gAmMa", TestKeyword_None), TestKeyword_Gamma);
+}
+
+TEST(ConfigKeywords, test_find_unknown)
+{
+    EXPECT_EQ(test_keywords.Find(""), nullptr);
+    EXPECT_EQ(test_keywords.Find("alph"), nullptr);
+    EXPECT_EQ(test_keywords.Find("alphaa"), nullptr);
+    EXPECT_EQ(test_keywords.Find("gamma ray"), nullptr);
+    EXPECT_EQ(test_keywords.Find("delta", TestKeyword_None), TestKeyword_None);
+}
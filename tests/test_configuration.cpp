@@ -2,6 +2,13 @@
 #include "Controllers/BaseController.h"
 #include "config_handler.h"
 #include "filemanager_std.h"
+#include "config_cache.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <map>
+#include <vector>
 
 #define CONFIG_FULLPATH_PROJECT "../../dist/config/sys-con/config.ini"
 
@@ -70,4 +77,472 @@ TEST(Configuration, test_load_config_with_profile_wii)
     EXPECT_EQ(config.driver, "wii");
     EXPECT_EQ(config.profile, "wii");
     EXPECT_EQ(config.buttonsPin[ControllerButton::ZL][0], 0);
-}
\ No newline at end of file
+}
+
+TEST(Configuration, test_load_global_config)
+{
+    ::syscon::config::GlobalConfig config;
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    int rc = ::syscon::config::LoadGlobalConfig(CONFIG_FULLPATH_PROJECT, &config);
+    EXPECT_EQ(rc, 0);
+
+    EXPECT_EQ(config.polling_timeout_ms, 10);
+    EXPECT_EQ(config.polling_thread_priority, 41);
+    EXPECT_EQ(config.log_level, 3);
+    EXPECT_FALSE(config.log_binary);
+    EXPECT_EQ(config.discovery_mode, ::syscon::config::DiscoveryMode::HID_AND_XBOX);
+    ASSERT_EQ(config.discovery_vidpid.size(), 2);
+    EXPECT_EQ(config.discovery_vidpid[0].vid, 0x054c);
+    EXPECT_EQ(config.discovery_vidpid[0].pid, 0x0000);
+    EXPECT_EQ(config.discovery_vidpid[1].vid, 0x0f0d);
+    EXPECT_EQ(config.discovery_vidpid[1].pid, 0x0088);
+    EXPECT_TRUE(config.auto_add_controller);
+}
+
+static void ExpectSameConfig(const ControllerConfig &a, const ControllerConfig &b)
+{
+    EXPECT_EQ(a.driver, b.driver);
+    EXPECT_EQ(a.profile, b.profile);
+    EXPECT_EQ(a.inputMaxPacketSize, b.inputMaxPacketSize);
+    EXPECT_EQ(a.outputMaxPacketSize, b.outputMaxPacketSize);
+    EXPECT_EQ(a.controllerType, b.controllerType);
+    EXPECT_EQ(memcmp(a.analogDeadzonePercent, b.analogDeadzonePercent, sizeof(a.analogDeadzonePercent)), 0);
+    EXPECT_EQ(memcmp(a.analogFactorPercent, b.analogFactorPercent, sizeof(a.analogFactorPercent)), 0);
+    EXPECT_EQ(memcmp(a.buttonsPin, b.buttonsPin, sizeof(a.buttonsPin)), 0);
+    EXPECT_EQ(a.buttonsAnalogUsed, b.buttonsAnalogUsed);
+    for (int i = 0; i < ControllerButton::COUNT; i++)
+    {
+        EXPECT_EQ(a.buttonsAnalog[i].sign, b.buttonsAnalog[i].sign);
+        EXPECT_EQ(a.buttonsAnalog[i].bind, b.buttonsAnalog[i].bind);
+    }
+    for (int i = 0; i < MAX_CONTROLLER_COMBO; i++)
+    {
+        EXPECT_EQ(a.simulateCombos[i].buttonSimulated, b.simulateCombos[i].buttonSimulated);
+        EXPECT_EQ(a.simulateCombos[i].buttons[0], b.simulateCombos[i].buttons[0]);
+        EXPECT_EQ(a.simulateCombos[i].buttons[1], b.simulateCombos[i].buttons[1]);
+    }
+    EXPECT_EQ(a.bodyColor.rgbaValue, b.bodyColor.rgbaValue);
+    EXPECT_EQ(a.buttonsColor.rgbaValue, b.buttonsColor.rgbaValue);
+    EXPECT_EQ(a.leftGripColor.rgbaValue, b.leftGripColor.rgbaValue);
+    EXPECT_EQ(a.rightGripColor.rgbaValue, b.rightGripColor.rgbaValue);
+}
+
+TEST(Configuration, test_load_config_indexed_identical)
+{
+    // Values of the shipped config.ini: [default], then the profile, then the vid-pid section
+    struct ExpectedConfig
+    {
+        uint16_t vendor_id;
+        uint16_t product_id;
+        const char *driver;
+        const char *profile;
+        uint8_t pins[5]; // B, A, Y, X, L
+        uint8_t zl_pin;
+        uint8_t dpad_up_pin;
+        uint8_t factor_x;
+        uint32_t body_color;
+    };
+    const ExpectedConfig expectedConfigs[] = {
+        {0x0000, 0x0000, "", "", {0, 0, 0, 0, 0}, 0, 32, 100, 0x304769FF},
+        {0x054c, 0x0cda, "", "", {3, 2, 4, 1, 7}, 5, 32, 100, 0x304769FF},
+        {0x045e, 0x02dd, "xboxone", "xboxone", {1, 2, 3, 4, 8}, 0, 32, 100, 0xF1F1F1FF},
+        {0x057e, 0x0337, "wii", "wii", {2, 1, 4, 3, 12}, 0, 8, 125, 0x1C1C1CFF},
+        {0x054c, 0x0268, "dualshock3", "dualshock3", {3, 2, 4, 1, 7}, 5, 32, 100, 0x1C1C1CFF},
+    };
+    const ControllerButton pinButtons[] = {ControllerButton::B, ControllerButton::A, ControllerButton::Y, ControllerButton::X, ControllerButton::L};
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>()); // Reset the index
+
+    // First pass builds the index, the second one only reads it
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (const ExpectedConfig &expected : expectedConfigs)
+        {
+            SCOPED_TRACE(testing::Message() << "pass " << pass << ", " << std::hex << expected.vendor_id << "-" << expected.product_id);
+
+            ControllerConfig config;
+            EXPECT_EQ(::syscon::config::LoadControllerConfig(CONFIG_FULLPATH_PROJECT, &config, expected.vendor_id, expected.product_id, false, ""), 0);
+
+            EXPECT_EQ(config.driver, expected.driver);
+            EXPECT_EQ(config.profile, expected.profile);
+            EXPECT_EQ(config.controllerType, ControllerType_Pro);
+            for (size_t i = 0; i < sizeof(pinButtons) / sizeof(pinButtons[0]); i++)
+                EXPECT_EQ(config.buttonsPin[pinButtons[i]][0], expected.pins[i]);
+            EXPECT_EQ(config.buttonsPin[ControllerButton::ZL][0], expected.zl_pin);
+            EXPECT_EQ(config.buttonsPin[ControllerButton::DPAD_UP][0], expected.dpad_up_pin);
+            EXPECT_EQ(config.analogDeadzonePercent[ControllerAnalogBinding_X], 20);
+            EXPECT_EQ(config.analogDeadzonePercent[ControllerAnalogBinding_Rx], 5);
+            EXPECT_EQ(config.analogFactorPercent[ControllerAnalogBinding_X], expected.factor_x);
+            EXPECT_EQ(config.bodyColor.rgbaValue, expected.body_color);
+            EXPECT_EQ(config.simulateCombos[0].buttonSimulated, ControllerButton::CAPTURE);
+            EXPECT_EQ(config.simulateCombos[1].buttonSimulated, ControllerButton::HOME);
+        }
+    }
+}
+
+TEST(Configuration, test_load_config_layering)
+{
+    const char *path = "test_load_config_layering.ini";
+    std::ofstream(path) << "[default]\n"
+                           "b=1\na=2\nx=3\n"
+                           "[MyProfile]\n"
+                           "a=20\nx=30\ndeadzone_x=15\n"
+                           "[1234-ABCD]\n"
+                           "profile=MyProfile\n"
+                           "x=31\n";
+
+    ControllerConfig config;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+
+    EXPECT_EQ(config.profile, "myprofile");
+    EXPECT_EQ(config.buttonsPin[ControllerButton::B][0], 1);  // [default]
+    EXPECT_EQ(config.buttonsPin[ControllerButton::A][0], 20); // [profile] overrides [default]
+    EXPECT_EQ(config.buttonsPin[ControllerButton::X][0], 31); // [vid-pid] overrides [profile]
+    EXPECT_EQ(config.analogDeadzonePercent[ControllerAnalogBinding_X], 15);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Configuration, test_load_config_index_invalidated_on_change)
+{
+    const char *path = "test_load_config_index_invalidated.ini";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n";
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+
+    ControllerConfig config;
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config.buttonsPin[ControllerButton::B][0], 1);
+
+    // Size changed => Index must be rebuilt
+    std::ofstream(path) << "[1234-abcd]\nb=12\n";
+
+    ControllerConfig config_updated;
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_updated, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config_updated.buttonsPin[ControllerButton::B][0], 12);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Configuration, test_load_config_keywords_case_insensitive)
+{
+    const char *path = "test_load_config_keywords_case.ini";
+    std::ofstream(path) << "[1234-ABCD]\n"
+                           "Driver=XboxOne\n"
+                           "B=1\nDPAD_UP=5,-Rz\n"
+                           "Controller_Type=GameCube\n"
+                           "DeadZone_Slider=12\nfactor_DIAL=50\n"
+                           "Color_Body=#FF0000\n"
+                           "Simulate_Home=MINUS+Plus\n"
+                           "simulate_unknown=minus+plus\n"
+                           "unknown_key=1\n";
+
+    ControllerConfig config;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+
+    EXPECT_EQ(config.driver, "xboxone");
+    EXPECT_EQ(config.buttonsPin[ControllerButton::B][0], 1);
+    EXPECT_EQ(config.buttonsPin[ControllerButton::DPAD_UP][0], 5);
+    EXPECT_EQ(config.buttonsAnalog[ControllerButton::DPAD_UP].bind, ControllerAnalogBinding_Rz);
+    EXPECT_EQ(config.buttonsAnalog[ControllerButton::DPAD_UP].sign, -1.0f);
+    EXPECT_EQ(config.controllerType, ControllerType_Gamecube);
+    EXPECT_EQ(config.analogDeadzonePercent[ControllerAnalogBinding_Slider], 12);
+    EXPECT_EQ(config.analogFactorPercent[ControllerAnalogBinding_Dial], 50);
+    EXPECT_EQ(config.bodyColor.rgbaValue, 0xFF0000FF);
+    EXPECT_EQ(config.simulateCombos[0].buttonSimulated, ControllerButton::HOME);
+    EXPECT_EQ(config.simulateCombos[0].buttons[0], ControllerButton::MINUS);
+    EXPECT_EQ(config.simulateCombos[0].buttons[1], ControllerButton::PLUS);
+    EXPECT_EQ(config.simulateCombos[1].buttonSimulated, ControllerButton::NONE);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Configuration, test_load_config_auto_add)
+{
+    const char *path = "test_load_config_auto_add.ini";
+    std::ofstream(path) << "[default]\nb=1\n"
+                           "[xbox360]\nb=2\na=3\n";
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+
+    ControllerConfig config;
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, true, "xbox360"), 0);
+    EXPECT_EQ(config.profile, "xbox360");
+    EXPECT_EQ(config.buttonsPin[ControllerButton::B][0], 2);
+    EXPECT_EQ(config.buttonsPin[ControllerButton::A][0], 3);
+
+    std::filesystem::remove(path);
+}
+
+namespace
+{
+    // Overwrite a byte of the first cached entry, the CRC is updated unless 'keepCrc'
+    void PatchConfigCache(const char *cache_path, size_t entryOffset, uint8_t value, bool keepCrc = false)
+    {
+        std::vector<uint8_t> data(std::filesystem::file_size(cache_path));
+        std::ifstream(cache_path, std::ios::binary).read(reinterpret_cast<char *>(data.data()), data.size());
+
+        data[sizeof(syscon::config::ConfigCacheHeader) + entryOffset] = value;
+
+        if (!keepCrc)
+        {
+            syscon::config::ConfigCacheHeader header;
+            memcpy(&header, data.data(), sizeof(header));
+            header.crc = 0;
+            header.crc = syscon::config::Crc32(data.data() + sizeof(header), data.size() - sizeof(header), syscon::config::Crc32(&header, sizeof(header)));
+            memcpy(data.data(), &header, sizeof(header));
+        }
+
+        std::ofstream(cache_path, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+} // namespace
+
+TEST(Configuration, test_load_config_cache_identical)
+{
+    const char *cache_path = "test_load_config_cache_identical.cache";
+    const uint16_t vidpids[][2] = {{0x054c, 0x0cda}, {0x045e, 0x02dd}, {0x057e, 0x0337}, {0x054c, 0x0268}};
+
+    std::filesystem::remove(cache_path);
+
+    for (const auto &vidpid : vidpids)
+    {
+        ControllerConfig config_text;
+        ControllerConfig config_cached;
+
+        ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+        ::syscon::config::SetCachePath(cache_path);
+        EXPECT_EQ(::syscon::config::LoadControllerConfig(CONFIG_FULLPATH_PROJECT, &config_text, vidpid[0], vidpid[1], false, ""), 0);
+        ::syscon::config::FlushCache();
+
+        // Fresh start (e.g. reboot): The entry is read back from the cache file
+        ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+        ::syscon::config::SetCachePath(cache_path);
+        EXPECT_EQ(::syscon::config::LoadControllerConfig(CONFIG_FULLPATH_PROJECT, &config_cached, vidpid[0], vidpid[1], false, ""), 0);
+
+        ExpectSameConfig(config_text, config_cached);
+    }
+
+    EXPECT_EQ(std::filesystem::file_size(cache_path), sizeof(syscon::config::ConfigCacheHeader) + 4 * sizeof(syscon::config::ConfigCacheEntry));
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    std::filesystem::remove(cache_path);
+}
+
+TEST(Configuration, test_load_config_cache_used)
+{
+    const char *path = "test_load_config_cache_used.ini";
+    const char *cache_path = "test_load_config_cache_used.cache";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n";
+    std::filesystem::remove(cache_path);
+
+    ControllerConfig config;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config.buttonsPin[ControllerButton::B][0], 1);
+    ::syscon::config::FlushCache();
+
+    // Patch the cached entry: If the cache is used, the patched value is returned
+    PatchConfigCache(cache_path, offsetof(syscon::config::ConfigCacheEntry, buttonsPin) + ControllerButton::B * MAX_PIN_BY_BUTTONS, 5);
+
+    ControllerConfig config_cached;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_cached, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config_cached.buttonsPin[ControllerButton::B][0], 5);
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    std::filesystem::remove(path);
+    std::filesystem::remove(cache_path);
+}
+
+namespace
+{
+    // Count the files opened for read
+    class CountingFileManager : public syscon::IFileManager
+    {
+    public:
+        std::unique_ptr<syscon::IFile> open(const std::filesystem::path &path, syscon::OpenFlags flags) override
+        {
+            if (flags & syscon::OpenFlags_Read)
+                (*reads)[path.string()]++;
+            return m_fileManager.open(path, flags);
+        }
+
+        bool create_directories(const std::filesystem::path &dir) override { return m_fileManager.create_directories(dir); }
+        bool remove(const std::filesystem::path &p) override { return m_fileManager.remove(p); }
+        std::uintmax_t file_size(const std::filesystem::path &p) const override { return m_fileManager.file_size(p); }
+        std::int64_t last_write_time(const std::filesystem::path &p) const override { return m_fileManager.last_write_time(p); }
+
+        std::shared_ptr<std::map<std::string, int>> reads = std::make_shared<std::map<std::string, int>>();
+
+    private:
+        syscon::StdFileManager m_fileManager;
+    };
+} // namespace
+
+TEST(Configuration, test_load_config_cache_invalid_entries)
+{
+    const char *path = "test_load_config_cache_invalid.ini";
+    const char *cache_path = "test_load_config_cache_invalid.cache";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n";
+
+    struct
+    {
+        size_t offset;
+        uint8_t value;
+        bool keepCrc;
+    } patches[] = {
+        {offsetof(syscon::config::ConfigCacheEntry, buttonsPin) + ControllerButton::B * MAX_PIN_BY_BUTTONS, 5, true}, // CRC mismatch
+        {offsetof(syscon::config::ConfigCacheEntry, buttonsPin) + ControllerButton::B * MAX_PIN_BY_BUTTONS, MAX_CONTROLLER_BUTTONS, false},
+        {offsetof(syscon::config::ConfigCacheEntry, buttonsAnalogBind) + ControllerButton::ZL, ControllerAnalogBinding_Count, false},
+        {offsetof(syscon::config::ConfigCacheEntry, simulateCombos) + 1, ControllerButton::COUNT, false},
+        {offsetof(syscon::config::ConfigCacheEntry, controllerType), 0xFF, false},
+    };
+
+    for (const auto &patch : patches)
+    {
+        std::filesystem::remove(cache_path);
+
+        ControllerConfig config;
+        ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+        ::syscon::config::SetCachePath(cache_path);
+        EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+        ::syscon::config::FlushCache();
+
+        PatchConfigCache(cache_path, patch.offset, patch.value, patch.keepCrc);
+
+        // The whole cache is discarded: Resolved from the INI
+        ControllerConfig config_cached;
+        ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+        ::syscon::config::SetCachePath(cache_path);
+        EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_cached, 0x1234, 0xabcd, false, ""), 0);
+        EXPECT_EQ(config_cached.buttonsPin[ControllerButton::B][0], 1) << "Patch at offset " << patch.offset;
+    }
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    std::filesystem::remove(path);
+    std::filesystem::remove(cache_path);
+}
+
+TEST(Configuration, test_load_config_cache_same_size_and_mtime)
+{
+    const char *path = "test_load_config_cache_same_mtime.ini";
+    const char *cache_path = "test_load_config_cache_same_mtime.cache";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n";
+    std::filesystem::remove(cache_path);
+    std::filesystem::file_time_type mtime = std::filesystem::last_write_time(path);
+
+    ControllerConfig config;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+    ::syscon::config::FlushCache();
+
+    // Edited within the same mtime tick (Or mtime unknown): Same metadata, different content
+    std::ofstream(path) << "[1234-abcd]\nb=2\n";
+    std::filesystem::last_write_time(path, mtime);
+
+    ControllerConfig config_edited;
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_edited, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config_edited.buttonsPin[ControllerButton::B][0], 2);
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    std::filesystem::remove(path);
+    std::filesystem::remove(cache_path);
+}
+
+TEST(Configuration, test_load_config_cache_deferred_and_ini_not_parsed)
+{
+    const char *path = "test_load_config_cache_deferred.ini";
+    const char *cache_path = "test_load_config_cache_deferred.cache";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n[1234-abce]\nb=2\n";
+    std::filesystem::remove(cache_path);
+
+    ControllerConfig config;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabce, false, ""), 0);
+
+    // Nothing written until the flush, then both entries at once
+    EXPECT_FALSE(std::filesystem::exists(cache_path));
+    ::syscon::config::FlushCache();
+    EXPECT_EQ(std::filesystem::file_size(cache_path), sizeof(syscon::config::ConfigCacheHeader) + 2 * sizeof(syscon::config::ConfigCacheEntry));
+
+    // Fresh start: Both configs from the cache, config.ini is only read to check its hash
+    std::unique_ptr<CountingFileManager> fileManager = std::make_unique<CountingFileManager>();
+    std::shared_ptr<std::map<std::string, int>> reads = fileManager->reads;
+    ::syscon::config::Initialize(std::move(fileManager));
+    ::syscon::config::SetCachePath(cache_path);
+
+    ControllerConfig config_cached;
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_cached, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config_cached.buttonsPin[ControllerButton::B][0], 1);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_cached, 0x1234, 0xabce, false, ""), 0);
+    EXPECT_EQ(config_cached.buttonsPin[ControllerButton::B][0], 2);
+
+    EXPECT_EQ((*reads)[path], 2); // One read per controller, not parsed
+    EXPECT_EQ((*reads)[cache_path], 1);
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    std::filesystem::remove(path);
+    std::filesystem::remove(cache_path);
+}
+
+TEST(Configuration, test_load_config_cache_outdated_or_corrupted)
+{
+    const char *path = "test_load_config_cache_outdated.ini";
+    const char *cache_path = "test_load_config_cache_outdated.cache";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n";
+    std::filesystem::remove(cache_path);
+
+    ControllerConfig config;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+    ::syscon::config::FlushCache();
+
+    // INI modified => Cache is outdated
+    std::ofstream(path) << "[1234-abcd]\nb=12\n";
+
+    ControllerConfig config_outdated;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_outdated, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config_outdated.buttonsPin[ControllerButton::B][0], 12);
+
+    // Corrupted cache => Fallback to the INI
+    std::ofstream(cache_path, std::ios::binary) << "corrupted";
+
+    ControllerConfig config_corrupted;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::SetCachePath(cache_path);
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config_corrupted, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_EQ(config_corrupted.buttonsPin[ControllerButton::B][0], 12);
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    std::filesystem::remove(path);
+    std::filesystem::remove(cache_path);
+}
+
+TEST(Configuration, test_reload_if_modified)
+{
+    const char *path = "test_reload_if_modified.ini";
+    std::ofstream(path) << "[1234-abcd]\nb=1\n";
+
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+
+    ControllerConfig config;
+    EXPECT_EQ(::syscon::config::LoadControllerConfig(path, &config, 0x1234, 0xabcd, false, ""), 0);
+    EXPECT_FALSE(::syscon::config::ReloadIfModified(path));
+
+    std::ofstream(path) << "[1234-abcd]\nb=12\n";
+    EXPECT_TRUE(::syscon::config::ReloadIfModified(path));
+    EXPECT_FALSE(::syscon::config::ReloadIfModified(path));
+
+    std::filesystem::remove(path);
+}
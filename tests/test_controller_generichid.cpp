@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "Controllers/GenericHIDController.h"
+#include "mocks/Logger.h"
+#include "mocks/Device.h"
+#include "mocks/USBInterface.h"
+#include "mocks/USBEndpoint.h"
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#define USB_REQUEST_GET_DESCRIPTOR 0x06
+#define USB_REQUEST_SET_IDLE       0x0A
+
+namespace
+{
+    // Gamepad: 8 buttons, X and Y (8 bits)
+    const uint8_t GamepadReportDescriptor[] = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,                         // Usage Page (Generic Desktop), Usage (Game Pad), Collection (Application)
+        0x05, 0x09, 0x19, 0x01, 0x29, 0x08, 0x15, 0x00, 0x25, 0x01, // Usage Page (Button), Usage (1 to 8), Logical (0 to 1)
+        0x75, 0x01, 0x95, 0x08, 0x81, 0x02,                         // Report Size (1), Report Count (8), Input (Data, Var, Abs)
+        0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, // Usage Page (Generic Desktop), Usage (X, Y), Logical (-127 to 127)
+        0x75, 0x08, 0x95, 0x02, 0x81, 0x02,                         // Report Size (8), Report Count (2), Input (Data, Var, Abs)
+        0xC0,                                                       // End Collection
+    };
+
+    struct GenericHIDTestDevice
+    {
+        IUSBEndpoint::EndpointDescriptor endpointDescriptor = {};
+        IUSBInterface::InterfaceDescriptor interfaceDescriptor = {};
+        std::deque<std::vector<uint8_t>> reports;
+        testing::NiceMock<MockUSBInterface> *interface = nullptr;
+
+        std::unique_ptr<GenericHIDController> Create(const ControllerConfig &config)
+        {
+            endpointDescriptor.wMaxPacketSize = 64;
+
+            auto mockUSBEndpointIn = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_IN);
+            auto mockUSBEndpointOut = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_OUT);
+            ON_CALL(*mockUSBEndpointIn, GetDescriptor).WillByDefault(testing::Return(&endpointDescriptor));
+            ON_CALL(*mockUSBEndpointIn, Read).WillByDefault([this](uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) {
+                if (reports.empty())
+                {
+                    *bufferSizeInOut = 0;
+                    return (aTimeoutUs == 0) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+                }
+
+                memcpy(outBuffer, reports.front().data(), reports.front().size());
+                *bufferSizeInOut = reports.front().size();
+                reports.pop_front();
+                return CONTROLLER_STATUS_SUCCESS;
+            });
+
+            auto mockUSBInterface = std::make_unique<testing::NiceMock<MockUSBInterface>>(std::move(mockUSBEndpointIn), std::move(mockUSBEndpointOut));
+            ON_CALL(*mockUSBInterface, GetDescriptor).WillByDefault(testing::Return(&interfaceDescriptor));
+            interface = mockUSBInterface.get();
+
+            return std::make_unique<GenericHIDController>(std::make_unique<MockDevice>(0x1234, 0x5678, std::move(mockUSBInterface)), config, std::make_unique<MockLogger>());
+        }
+    };
+
+    ControllerResult ReturnReportDescriptor(uint8_t bmRequestType, uint8_t bmRequest, uint16_t wValue, uint16_t wIndex, void *buffer, uint16_t *wLength)
+    {
+        (void)bmRequestType;
+        (void)bmRequest;
+        (void)wValue;
+        (void)wIndex;
+
+        memcpy(buffer, GamepadReportDescriptor, sizeof(GamepadReportDescriptor));
+        *wLength = sizeof(GamepadReportDescriptor);
+        return CONTROLLER_STATUS_SUCCESS;
+    }
+} // namespace
+
+TEST(Controller, test_generichid_resumed_skips_descriptor)
+{
+    ControllerConfig config;
+    config.buttonsPin[ControllerButton::A][0] = 1;
+
+    // Plugged before the sleep: The report descriptor is read and parsed
+    GenericHIDTestDevice before;
+    std::unique_ptr<GenericHIDController> controller = before.Create(config);
+    EXPECT_CALL(*before.interface, ControlTransferInput(testing::_, USB_REQUEST_GET_DESCRIPTOR, testing::_, testing::_, testing::_, testing::_))
+        .WillOnce(&ReturnReportDescriptor);
+    ASSERT_EQ(controller->Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    std::shared_ptr<const ControllerResumeData> resumeData = controller->GetResumeData();
+    ASSERT_NE(resumeData, nullptr);
+    uint16_t inputCount = controller->GetInputCount();
+    controller->Exit();
+    controller.reset();
+
+    // Plugged again after the wake up: SET_IDLE is sent again (Forgotten by the device), not GET_DESCRIPTOR
+    GenericHIDTestDevice after;
+    controller = after.Create(config);
+    EXPECT_CALL(*after.interface, ControlTransferInput).Times(0);
+    EXPECT_CALL(*after.interface, ControlTransferOutput(testing::_, USB_REQUEST_SET_IDLE, testing::_, testing::_, testing::_, testing::_))
+        .WillOnce(testing::Return(CONTROLLER_STATUS_SUCCESS));
+
+    controller->SetResumeData(resumeData);
+    ASSERT_EQ(controller->Initialize(), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(controller->GetInputCount(), inputCount);
+
+    // The reports are parsed with the descriptor parsed before the sleep
+    after.reports = {{0xFF, 0x00, 0x00}};
+    NormalizedButtonData normalData = {};
+    uint16_t input_idx = 0;
+    ASSERT_EQ(controller->ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(input_idx, 0);
+    EXPECT_TRUE(normalData.buttons[ControllerButton::A]);
+
+    after.reports = {{0x00, 0x00, 0x00}};
+    ASSERT_EQ(controller->ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_FALSE(normalData.buttons[ControllerButton::A]);
+}
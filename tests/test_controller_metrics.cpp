@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "Controllers/BaseController.h"
+#include "Controllers/WiiController.h"
+#include "ControllerMetrics.h"
+#include "mocks/Logger.h"
+#include "mocks/Device.h"
+#include "mocks/USBInterface.h"
+#include "mocks/USBEndpoint.h"
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#define REPORT_PARSE_ERROR 0xFF
+#define REPORT_IGNORED     0xFE
+
+namespace
+{
+    // Minimal driver: first byte of the report tells if it's valid
+    class MetricsTestController : public BaseController
+    {
+    public:
+        using BaseController::BaseController;
+
+        ControllerResult ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx) override
+        {
+            (void)size;
+            (void)rawData;
+            (void)input_idx;
+
+            if (buffer[0] == REPORT_PARSE_ERROR)
+                return CONTROLLER_STATUS_UNEXPECTED_DATA;
+            if (buffer[0] == REPORT_IGNORED)
+                return CONTROLLER_STATUS_NOTHING_TODO;
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+
+        ControllerResult SetRumble(uint16_t input_idx, float amp_high, float amp_low) override
+        {
+            uint8_t rumbleData[]{0x00, 0x08, (uint8_t)(amp_high * 255), (uint8_t)(amp_low * 255)};
+            return WriteRumble(m_outPipe[input_idx], rumbleData, sizeof(rumbleData));
+        }
+    };
+} // namespace
+
+TEST(ControllerMetrics, test_histogram_bucket_precision)
+{
+    for (uint32_t value = 0; value < 20000000; value = value * 1.01 + 1)
+    {
+        uint32_t index = ControllerLatencyHistogram::BucketIndex(value);
+        ASSERT_LT(index, CONTROLLER_HISTOGRAM_BUCKETS);
+
+        if (value >= (1u << CONTROLLER_HISTOGRAM_MAX_EXPONENT))
+        {
+            EXPECT_EQ(index, CONTROLLER_HISTOGRAM_BUCKETS - 1);
+            continue;
+        }
+
+        uint32_t upperBound = ControllerLatencyHistogram::BucketUpperBound(index);
+        EXPECT_GE(upperBound, value);
+        EXPECT_LE(upperBound - value, value / CONTROLLER_HISTOGRAM_SUB_BUCKETS) << value;
+    }
+}
+
+TEST(ControllerMetrics, test_histogram_percentiles)
+{
+    ControllerLatencyHistogram histogram;
+    ControllerHistogramSnapshot snapshot;
+
+    for (uint32_t value = 1; value <= 1000; value++)
+        histogram.Record(value);
+
+    histogram.Snapshot(&snapshot);
+
+    EXPECT_EQ(snapshot.count, 1000);
+    EXPECT_EQ(snapshot.max, 1000);
+    EXPECT_EQ(snapshot.Mean(), 500);
+    EXPECT_NEAR(snapshot.Percentile(50.0), 500, 500 / CONTROLLER_HISTOGRAM_SUB_BUCKETS);
+    EXPECT_NEAR(snapshot.Percentile(99.0), 990, 990 / CONTROLLER_HISTOGRAM_SUB_BUCKETS);
+    EXPECT_EQ(snapshot.Percentile(100.0), 1000); // Never above the max
+}
+
+TEST(ControllerMetrics, test_concurrent_updates)
+{
+    const int threadCount = 4;
+    const int updatesPerThread = 100000;
+
+    ControllerMetrics metrics;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&metrics]() {
+            for (int i = 0; i < updatesPerThread; i++)
+            {
+                metrics.Increment(ControllerCounter_ReportsRead);
+                metrics.Record(ControllerHistogram_InterReportUs, i % 2000);
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    ControllerMetricsSnapshot snapshot;
+    metrics.Snapshot(&snapshot);
+
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsRead], threadCount * updatesPerThread);
+    EXPECT_EQ(snapshot.histograms[ControllerHistogram_InterReportUs].count, threadCount * updatesPerThread);
+    EXPECT_EQ(snapshot.histograms[ControllerHistogram_InterReportUs].max, 1999);
+}
+
+TEST(ControllerMetrics, test_read_input_counters)
+{
+    ControllerConfig config;
+    IUSBEndpoint::EndpointDescriptor descriptor = {};
+    descriptor.wMaxPacketSize = 64;
+
+    std::deque<std::vector<uint8_t>> reports = {
+        {0x01, 0x02},
+        {0x01, 0x02}, // Duplicated
+        {0x01, 0x03},
+        {REPORT_PARSE_ERROR},
+        {REPORT_IGNORED},
+    };
+
+    auto mockUSBEndpointIn = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_IN);
+    auto mockUSBEndpointOut = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_OUT);
+    ON_CALL(*mockUSBEndpointIn, GetDescriptor).WillByDefault(testing::Return(&descriptor));
+    ON_CALL(*mockUSBEndpointIn, Read).WillByDefault([&reports](uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) {
+        // One report per blocking read: the drain loop of ReadEndpointLatest must not merge them
+        if (reports.empty() || aTimeoutUs == 0)
+        {
+            *bufferSizeInOut = 0;
+            return (aTimeoutUs == 0) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+        }
+
+        memcpy(outBuffer, reports.front().data(), reports.front().size());
+        *bufferSizeInOut = reports.front().size();
+        reports.pop_front();
+        return CONTROLLER_STATUS_SUCCESS;
+    });
+
+    MetricsTestController controller(std::make_unique<MockDevice>(0x1234, 0x5678, std::make_unique<testing::NiceMock<MockUSBInterface>>(std::move(mockUSBEndpointIn), std::move(mockUSBEndpointOut))), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    NormalizedButtonData normalData = {};
+    uint16_t input_idx = 0;
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_UNEXPECTED_DATA);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_NOTHING_TODO);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_TIMEOUT);
+    controller.SetRumble(0, 1.0f, 0.5f);
+
+    ControllerMetricsSnapshot snapshot;
+    controller.GetMetrics().Snapshot(&snapshot);
+
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsRead], 5);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsParsed], 3);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsDuplicated], 1);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ParseErrors], 1);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReadTimeouts], 1);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReadErrors], 0);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_RumbleWrites], 1);
+    EXPECT_EQ(snapshot.histograms[ControllerHistogram_InterReportUs].count, 4);
+
+    std::string stats;
+    snapshot.Format(&stats, "  ");
+    EXPECT_NE(stats.find("  reports_read: 5 ("), std::string::npos) << stats;
+    EXPECT_NE(stats.find("  inter_report_us: count=4 "), std::string::npos) << stats;
+}
+
+TEST(ControllerMetrics, test_read_metrics_per_transfer)
+{
+    ControllerConfig config;
+    IUSBEndpoint::EndpointDescriptor descriptor = {};
+    descriptor.wMaxPacketSize = 64;
+
+    // Wii U adapter: The 4 ports in each transfer, ports 1 and 2 connected. The same transfer is received twice.
+    std::vector<uint8_t> transfer = {0x21,
+                                     0x10, 0x10, 0x00, 0x82, 0x82, 0x7B, 0x81, 0x17, 0x1A,
+                                     0x10, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00,
+                                     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    std::deque<std::vector<uint8_t>> reports = {transfer, transfer};
+
+    auto mockUSBEndpointIn = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_IN);
+    auto mockUSBEndpointOut = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_OUT);
+    ON_CALL(*mockUSBEndpointIn, GetDescriptor).WillByDefault(testing::Return(&descriptor));
+    ON_CALL(*mockUSBEndpointIn, Read).WillByDefault([&reports](uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) {
+        if (reports.empty() || aTimeoutUs == 0)
+        {
+            *bufferSizeInOut = 0;
+            return (aTimeoutUs == 0) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+        }
+
+        memcpy(outBuffer, reports.front().data(), reports.front().size());
+        *bufferSizeInOut = reports.front().size();
+        reports.pop_front();
+        return CONTROLLER_STATUS_SUCCESS;
+    });
+
+    WiiController controller(std::make_unique<MockDevice>(0x057e, 0x0337, std::make_unique<testing::NiceMock<MockUSBInterface>>(std::move(mockUSBEndpointIn), std::move(mockUSBEndpointOut))), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    ControllerInputBatch inputs;
+    for (int i = 0; i < 2; i++)
+    {
+        auto before = std::chrono::steady_clock::now();
+        ASSERT_EQ(controller.ReadInputs(&inputs, 1000), CONTROLLER_STATUS_SUCCESS);
+        ASSERT_EQ(inputs.count, 4);
+
+        // Timestamp of the USB read, not of the decoding of the last port
+        EXPECT_GE(inputs.read_time, before);
+        EXPECT_LE(inputs.read_time, std::chrono::steady_clock::now());
+    }
+
+    ControllerMetricsSnapshot snapshot;
+    controller.GetMetrics().Snapshot(&snapshot);
+
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsRead], 2);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsDuplicated], 1);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsParsed], 4);
+    EXPECT_EQ(snapshot.histograms[ControllerHistogram_InterReportUs].count, 1);
+}
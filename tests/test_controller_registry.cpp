@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "ControllerRegistry.h"
+#include "Controllers/GenericHIDController.h"
+#include "Controllers/XboxOneController.h"
+#include "SyntheticUSBDevice.h"
+#include "mocks/Logger.h"
+
+namespace
+{
+    std::unique_ptr<IController> CreateNothing(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger)
+    {
+        (void)device;
+        (void)config;
+        (void)logger;
+        return nullptr;
+    }
+
+    IUSBInterface::InterfaceDescriptor MakeDescriptor(uint8_t iclass, uint8_t isubclass, uint8_t iprotocol)
+    {
+        IUSBInterface::InterfaceDescriptor descriptor = {};
+        descriptor.bInterfaceClass = iclass;
+        descriptor.bInterfaceSubClass = isubclass;
+        descriptor.bInterfaceProtocol = iprotocol;
+        return descriptor;
+    }
+} // namespace
+
+TEST(ControllerRegistry, test_find_by_name)
+{
+    ControllerRegistry registry;
+    registry.RegisterBuiltIn();
+    registry.BuildIndex();
+
+    for (const char *name : {"xbox360", "xbox360w", "xboxone", "xbox", "dualshock3", "switch", "wii", "steam2026"})
+    {
+        const ControllerDriver *driver = registry.FindByName(name);
+        ASSERT_NE(driver, nullptr) << name;
+        EXPECT_EQ(driver->name, name);
+        EXPECT_FALSE(driver->single_interface);
+    }
+
+    // Unknown or empty: Generic HID, on its first interface only
+    for (const char *name : {"", "unknown"})
+    {
+        const ControllerDriver *driver = registry.FindByName(name);
+        ASSERT_NE(driver, nullptr) << name;
+        EXPECT_TRUE(driver->name.empty());
+        EXPECT_TRUE(driver->single_interface);
+    }
+
+    std::unique_ptr<IController> controller = registry.FindByName("xboxone")->factory(std::make_unique<SyntheticUSBDevice>(SyntheticOptions()), ControllerConfig(), std::make_unique<MockLogger>());
+    EXPECT_NE(dynamic_cast<XboxOneController *>(controller.get()), nullptr);
+
+    controller = registry.FindByName("")->factory(std::make_unique<SyntheticUSBDevice>(SyntheticOptions()), ControllerConfig(), std::make_unique<MockLogger>());
+    EXPECT_NE(dynamic_cast<GenericHIDController *>(controller.get()), nullptr);
+}
+
+TEST(ControllerRegistry, test_find_by_device)
+{
+    ControllerRegistry registry;
+    registry.RegisterBuiltIn();
+    registry.BuildIndex();
+
+    // Every synthetic device is detected as its driver, from its VID/PID or its interface
+    for (int i = 0; i < SyntheticProtocol_Count; i++)
+    {
+        const SyntheticLayout &layout = GetSyntheticLayout(static_cast<SyntheticProtocol>(i));
+        SCOPED_TRACE(layout.name);
+
+        const ControllerDriver *driver = registry.FindByDevice(layout.vendor_id, layout.product_id, layout.interfaces[0].descriptor);
+        ASSERT_NE(driver, nullptr);
+        EXPECT_EQ(driver->name, layout.driver);
+    }
+
+    // Xbox 360 compatible pad of another vendor: Detected from its interface
+    const ControllerDriver *driver = registry.FindByDevice(0x1234, 0x5678, MakeDescriptor(0xFF, 0x5D, 0x01));
+    ASSERT_NE(driver, nullptr);
+    EXPECT_EQ(driver->name, "xbox360");
+
+    // HID device unknown: No driver detected (config.ini or Generic HID)
+    EXPECT_EQ(registry.FindByDevice(0x1234, 0x5678, MakeDescriptor(0x03, 0x00, 0x00)), nullptr);
+
+    // The interface rules are queried in the order of registration
+    const std::vector<ControllerMatchRule> &rules = registry.GetInterfaceRules();
+    ASSERT_EQ(rules.size(), 4);
+    EXPECT_EQ(rules[0].interface_protocol, 0x01);
+    EXPECT_EQ(rules[1].interface_protocol, 0x81);
+    EXPECT_EQ(rules[2].interface_subclass, 0x47);
+    EXPECT_EQ(rules[3].interface_class, 0x58);
+}
+
+TEST(ControllerRegistry, test_custom_rules)
+{
+    ControllerRegistry registry;
+    registry.Register({"vendor", "Whole vendor", CreateNothing, false, {{ControllerMatchType_VidPid, 0x1234, 0x0000, 0, 0, 0}}});
+    registry.Register({"product", "One product", CreateNothing, false, {{ControllerMatchType_VidPid, 0x1234, 0x0001, 0, 0, 0}}});
+    registry.Register({"first", "First", CreateNothing, false, {{ControllerMatchType_Interface, 0, 0, 0xFF, 0x01, 0x02}}});
+    registry.Register({"second", "Second", CreateNothing, false, {{ControllerMatchType_Interface, 0, 0, 0xFF, 0x01, 0x02}}});
+    registry.BuildIndex();
+
+    IUSBInterface::InterfaceDescriptor descriptor = MakeDescriptor(0xFF, 0x01, 0x02);
+
+    // Product before vendor, VID/PID before interface
+    EXPECT_EQ(registry.FindByDevice(0x1234, 0x0001, descriptor)->name, "product");
+    EXPECT_EQ(registry.FindByDevice(0x1234, 0x0002, descriptor)->name, "vendor");
+
+    // Same rule registered twice: The first driver keeps it
+    EXPECT_EQ(registry.FindByDevice(0x4321, 0x0001, descriptor)->name, "first");
+    EXPECT_EQ(registry.GetInterfaceRules().size(), 1);
+
+    // No fallback registered
+    EXPECT_EQ(registry.FindByName("unknown"), nullptr);
+}
+
+TEST(ControllerRegistry, test_failed_probes)
+{
+    ControllerRegistry registry;
+
+    EXPECT_FALSE(registry.IsProbeBlocked(0x1234, 0x0001, 7, 1000));
+
+    registry.SetProbeFailed(0x1234, 0x0001, 7, 1000);
+    EXPECT_TRUE(registry.IsProbeBlocked(0x1234, 0x0001, 7, 1000));
+    EXPECT_TRUE(registry.IsProbeBlocked(0x1234, 0x0001, 7, 1000 + CONTROLLER_PROBE_RETRY_US - 1));
+    EXPECT_FALSE(registry.IsProbeBlocked(0x1234, 0x0002, 7, 1000));
+
+    // Plugged again: New interface ID, probed right away
+    EXPECT_FALSE(registry.IsProbeBlocked(0x1234, 0x0001, 8, 1000));
+
+    // Retried once the delay is elapsed
+    EXPECT_FALSE(registry.IsProbeBlocked(0x1234, 0x0001, 7, 1000 + CONTROLLER_PROBE_RETRY_US));
+
+    registry.SetProbeFailed(0x1234, 0x0001, 7, 5000);
+    registry.ClearProbeFailed(0x1234, 0x0001);
+    EXPECT_FALSE(registry.IsProbeBlocked(0x1234, 0x0001, 7, 5000));
+}
@@ -54,3 +54,35 @@ TEST(Controller, test_steam2026_wireless_disconnected)
     EXPECT_EQ(controller.ParseData(buffer, sizeof(buffer), &rawData, &input_idx), CONTROLLER_STATUS_NOTHING_TODO);
     EXPECT_FALSE(controller.IsControllerConnected(input_idx));
 }
+
+TEST(Controller, test_steam2026_state_by_pad)
+{
+    ControllerConfig config;
+    RawInputData rawData;
+
+    SteamController2026 controller(std::make_unique<MockDevice>(), config, std::make_unique<MockLogger>());
+
+    uint8_t pressed[54] = {0x42};
+    uint8_t released[54] = {0x42};
+    reinterpret_cast<Steam2026InputReport *>(pressed)->buttons.a = 1;
+
+    // Pad 0 presses A, pad 1 does not: No cross-talk
+    uint16_t input_idx = 0;
+    EXPECT_EQ(controller.ParseData(pressed, sizeof(pressed), &rawData, &input_idx), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(rawData.buttons[1]);
+
+    input_idx = 1;
+    rawData = RawInputData();
+    EXPECT_EQ(controller.ParseData(released, sizeof(released), &rawData, &input_idx), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_FALSE(rawData.buttons[1]);
+
+    // Unchanged state (Only the IMU moved): Not handed off
+    reinterpret_cast<Steam2026InputReport *>(pressed)->imu.timestamp = 1234;
+    input_idx = 0;
+    EXPECT_EQ(controller.ParseData(pressed, sizeof(pressed), &rawData, &input_idx), CONTROLLER_STATUS_NOTHING_TODO);
+
+    input_idx = 0;
+    rawData = RawInputData();
+    EXPECT_EQ(controller.ParseData(released, sizeof(released), &rawData, &input_idx), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_FALSE(rawData.buttons[1]);
+}
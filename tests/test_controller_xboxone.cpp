@@ -7,6 +7,8 @@
 #include "mocks/USBEndpoint.h"
 #include <array>
 #include <cstring>
+#include <deque>
+#include <vector>
 
 MATCHER_P2(BufferMatches, expected, size, "Matches buffer content")
 {
@@ -77,4 +79,84 @@ TEST(Controller, test_xboxone_s_init)
 
     XboxOneController controller(std::make_unique<MockDevice>(0x045e, 0x0b00, std::make_unique<MockUSBInterface>(std::move(mockUSBEndpointIn), std::move(mockUSBEndpointOut))), config, std::make_unique<MockLogger>());
     controller.Initialize();
-}
\ No newline at end of file
+}
+
+TEST(Controller, test_xboxone_partial_reports)
+{
+    ControllerConfig config;
+    RawInputData rawData;
+    uint16_t input_idx = 0;
+
+    XboxOneController controller(std::make_unique<MockDevice>(), config, std::make_unique<MockLogger>());
+
+    uint8_t input[18] = {0x20, 0x00, 0x01, 0x0e, 0x10}; // A pressed
+    uint8_t home[6] = {0x07, 0x20, 0x02, 0x02, 0x01, 0x5b};
+
+    EXPECT_EQ(controller.ParseData(input, sizeof(input), &rawData, &input_idx), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(rawData.buttons[1]);
+    EXPECT_FALSE(rawData.buttons[12]);
+
+    // The home button report keeps the state of the last input report
+    rawData = RawInputData();
+    EXPECT_EQ(controller.ParseData(home, sizeof(home), &rawData, &input_idx), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(rawData.buttons[1]);
+    EXPECT_TRUE(rawData.buttons[12]);
+
+    // Nothing changed
+    EXPECT_EQ(controller.ParseData(input, sizeof(input), &rawData, &input_idx), CONTROLLER_STATUS_NOTHING_TODO);
+    EXPECT_EQ(controller.ParseData(home, sizeof(home), &rawData, &input_idx), CONTROLLER_STATUS_NOTHING_TODO);
+}
+
+TEST(Controller, test_xboxone_unchanged_state_after_config_reload)
+{
+    ControllerConfig config;
+    NormalizedButtonData normalData;
+    uint16_t input_idx = 0;
+
+    IUSBEndpoint::EndpointDescriptor descriptor = {};
+    descriptor.bEndpointAddress = 0x81;
+    descriptor.wMaxPacketSize = 64;
+
+    std::deque<std::vector<uint8_t>> reports;
+    auto mockUSBEndpointIn = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_IN);
+    auto mockUSBEndpointOut = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_OUT);
+    ON_CALL(*mockUSBEndpointIn, GetDescriptor).WillByDefault(testing::Return(&descriptor));
+    ON_CALL(*mockUSBEndpointIn, Read).WillByDefault([&reports](uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) {
+        if (reports.empty())
+        {
+            *bufferSizeInOut = 0;
+            return (aTimeoutUs == 0) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+        }
+
+        memcpy(outBuffer, reports.front().data(), reports.front().size());
+        *bufferSizeInOut = reports.front().size();
+        reports.pop_front();
+        return CONTROLLER_STATUS_SUCCESS;
+    });
+
+    XboxOneController controller(std::make_unique<MockDevice>(0x045e, 0x02ea, std::make_unique<testing::NiceMock<MockUSBInterface>>(std::move(mockUSBEndpointIn), std::move(mockUSBEndpointOut))), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    const std::vector<uint8_t> input = {0x20, 0x00, 0x01, 0x0e, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // A pressed
+
+    reports.push_back(input);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    reports.push_back(input);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_NOTHING_TODO);
+
+    // The new mapping is applied to the unchanged state
+    config.buttonsPin[ControllerButton::B][0] = 1;
+    controller.SetConfig(config);
+    reports.push_back(input);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(normalData.buttons[ControllerButton::B]);
+
+    reports.push_back(input);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_NOTHING_TODO);
+
+    // Initialized again (e.g. resumed): Its first report is submitted
+    controller.Exit();
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+    reports.push_back(input);
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+}
@@ -11,6 +11,7 @@ public:
     MockBaseController(std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<ILogger> &&logger) : BaseController(std::move(device), config, std::move(logger)) {}
     ControllerResult ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx) override { return CONTROLLER_STATUS_SUCCESS; }
     using BaseController::MapRawInputToNormalized; // Move protected method to public for testing
+    using BaseController::EnterConfigQuiescentState;
 };
 
 /* --------------------------- Tests --------------------------- */
@@ -255,3 +256,65 @@ TEST(BaseController, test_input_complex_combination)
     EXPECT_TRUE(normalizedData.buttons[ControllerButton::DPAD_RIGHT]);
     EXPECT_FLOAT_EQ(normalizedData.sticks[0].axis_x, -0.5f);
 }
+
+TEST(BaseController, test_input_config_reload)
+{
+    NormalizedButtonData normalizedData = {0};
+
+    ControllerConfig config;
+    config.buttonsPin[ControllerButton::X][0] = 1;
+
+    RawInputData inputData;
+    inputData.buttons[1] = true;
+
+    MockBaseController controller(std::make_unique<MockDevice>(), config, std::make_unique<MockLogger>());
+    const ControllerConfig *previousConfig = &controller.GetConfig();
+
+    controller.MapRawInputToNormalized(inputData, &normalizedData);
+    EXPECT_TRUE(normalizedData.buttons[ControllerButton::X]);
+    EXPECT_FALSE(normalizedData.buttons[ControllerButton::Y]);
+
+    // New snapshot: pin 1 is now Y
+    ControllerConfig newConfig;
+    newConfig.buttonsPin[ControllerButton::Y][0] = 1;
+    controller.SetConfig(newConfig);
+
+    normalizedData = {0};
+    controller.MapRawInputToNormalized(inputData, &normalizedData);
+    EXPECT_FALSE(normalizedData.buttons[ControllerButton::X]);
+    EXPECT_TRUE(normalizedData.buttons[ControllerButton::Y]);
+
+    // Previous snapshot is still valid for readers which loaded it before the swap
+    EXPECT_EQ(previousConfig->buttonsPin[ControllerButton::X][0], 1);
+    EXPECT_NE(previousConfig, &controller.GetConfig());
+}
+
+TEST(BaseController, test_input_config_reload_snapshots_freed)
+{
+    ControllerConfig config;
+    MockBaseController controller(std::make_unique<MockDevice>(), config, std::make_unique<MockLogger>());
+    EXPECT_EQ(controller.GetRetiredConfigCount(), 0);
+
+    // Input thread busy in a cycle: The replaced snapshots are kept
+    for (int i = 0; i < 3; i++)
+    {
+        config.buttonsPin[ControllerButton::A][0] = i + 1;
+        controller.SetConfig(config);
+    }
+    EXPECT_EQ(controller.GetRetiredConfigCount(), 3);
+
+    // Next cycle: Only the snapshot replaced after it is kept
+    controller.EnterConfigQuiescentState();
+    config.buttonsPin[ControllerButton::A][0] = 10;
+    controller.SetConfig(config);
+    EXPECT_EQ(controller.GetRetiredConfigCount(), 1);
+    EXPECT_EQ(controller.GetConfig().buttonsPin[ControllerButton::A][0], 10);
+
+    // Many reloads, one input cycle between each: Memory stays bounded
+    for (int i = 0; i < 100; i++)
+    {
+        controller.EnterConfigQuiescentState();
+        controller.SetConfig(config);
+    }
+    EXPECT_EQ(controller.GetRetiredConfigCount(), 1);
+}
@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+#include "logger.h"
+#include "filemanager_std.h"
+#include "logger_binary.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TEST_LOG_PATH        "test_logger/log.txt"
+#define TEST_BINARY_LOG_PATH "test_logger/log.bin"
+
+namespace
+{
+    std::vector<std::string> ReadLogLines()
+    {
+        std::vector<std::string> lines;
+        std::ifstream file(TEST_LOG_PATH);
+        std::string line;
+
+        while (std::getline(file, line))
+            lines.push_back(line);
+
+        return lines;
+    }
+
+    // Decode log.bin and remove the "|T|time|thread| " header of each line
+    std::vector<std::string> ReadBinaryLogMessages()
+    {
+        std::ifstream file(TEST_BINARY_LOG_PATH, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        syscon::logger::BinaryLogDecoder decoder;
+        std::string text;
+        EXPECT_TRUE(decoder.Decode(reinterpret_cast<const uint8_t *>(data.data()), data.size(), &text));
+
+        std::vector<std::string> messages;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line))
+            messages.push_back(line.substr(line.find("| ") + 2));
+
+        return messages;
+    }
+
+    void StartLogger()
+    {
+        std::filesystem::remove(TEST_LOG_PATH);
+        std::filesystem::remove(TEST_BINARY_LOG_PATH);
+        ::syscon::logger::Initialize(TEST_LOG_PATH, std::make_unique<syscon::StdFileManager>());
+        ::syscon::logger::SetLogLevel(LOG_LEVEL_TRACE);
+    }
+
+    void StopLogger()
+    {
+        ::syscon::logger::Exit();
+        ::syscon::logger::SetLogLevel(LOG_LEVEL_TRACE);
+        ::syscon::logger::SetSyncErrors(true);
+        std::filesystem::remove_all("test_logger");
+    }
+} // namespace
+
+TEST(Logger, test_records_written_in_order)
+{
+    StartLogger();
+
+    for (int i = 0; i < 10; i++)
+        ::syscon::logger::LogInfo("Record %d", i);
+
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 10);
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(lines[i].substr(0, 3), "|I|");
+        EXPECT_NE(lines[i].find("| Record " + std::to_string(i)), std::string::npos) << lines[i];
+    }
+
+    StopLogger();
+}
+
+TEST(Logger, test_error_written_before_return)
+{
+    StartLogger();
+
+    ::syscon::logger::LogDebug("Before error");
+    ::syscon::logger::LogError("Error %s", "message");
+
+    // Sync errors (Default): The error and the records before it are in the file when LogError returns
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_NE(lines[0].find("Before error"), std::string::npos);
+    EXPECT_EQ(lines[1].substr(0, 3), "|E|");
+    EXPECT_NE(lines[1].find("Error message"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_error_written_without_flush)
+{
+    StartLogger();
+    ::syscon::logger::SetSyncErrors(false);
+
+    ::syscon::logger::LogDebug("Before error");
+    ::syscon::logger::LogError("Error %s", "message");
+
+    // No Flush(): The error wakes up the flusher thread that writes it with the records before it
+    std::vector<std::string> lines;
+    for (int i = 0; i < 100 && lines.size() < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        lines = ReadLogLines();
+    }
+
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_NE(lines[0].find("Before error"), std::string::npos);
+    EXPECT_EQ(lines[1].substr(0, 3), "|E|");
+    EXPECT_NE(lines[1].find("Error message"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_level_filtered)
+{
+    StartLogger();
+    ::syscon::logger::SetLogLevel(LOG_LEVEL_WARNING);
+
+    ::syscon::logger::LogDebug("Debug");
+    ::syscon::logger::LogInfo("Info");
+    ::syscon::logger::LogWarning("Warning");
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_NE(lines[0].find("Warning"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_log_buffer)
+{
+    StartLogger();
+
+    uint8_t buffer[20];
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (uint8_t)i;
+
+    ::syscon::logger::LogBuffer(LOG_LEVEL_TRACE, buffer, sizeof(buffer));
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_NE(lines[0].find("Buffer (20): "), std::string::npos);
+    EXPECT_NE(lines[1].find("00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F "), std::string::npos);
+    EXPECT_NE(lines[2].find("| 10 11 12 13 "), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_long_record_truncated)
+{
+    StartLogger();
+
+    std::string longMessage(2000, 'x');
+    ::syscon::logger::LogInfo("%s", longMessage.c_str());
+    ::syscon::logger::LogInfo("Next");
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0].size(), 1023); // 1024 bytes with the '\n'
+    EXPECT_NE(lines[1].find("Next"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_long_records_kept)
+{
+    StartLogger();
+
+    // Records longer than a ring slot, enough of them to wrap around the ring
+    for (int i = 0; i < 60; i++)
+    {
+        ::syscon::logger::LogInfo("%d %s", i, std::string(500 + i * 7, 'a' + (i % 26)).c_str());
+        if (i % 10 == 0)
+            ::syscon::logger::Flush();
+    }
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 60);
+    for (int i = 0; i < 60; i++)
+    {
+        std::string expected = "| " + std::to_string(i) + " " + std::string(500 + i * 7, 'a' + (i % 26));
+        EXPECT_EQ(lines[i].substr(lines[i].size() - expected.size()), expected) << i;
+    }
+
+    StopLogger();
+}
+
+TEST(Logger, test_concurrent_producers_no_lost_records)
+{
+    const int threadCount = 4;
+    const int recordsPerThread = 5000;
+
+    StartLogger();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < recordsPerThread; i++)
+                ::syscon::logger::LogDebug("Thread %d record %d", t, i);
+        });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    ::syscon::logger::LogError("Done"); // Report the last dropped records (if any)
+    ::syscon::logger::Flush();
+
+    // Every record is either in the file or counted as dropped
+    int written = 0;
+    int dropped = 0;
+    for (const std::string &line : ReadLogLines())
+    {
+        if (line.find(" record ") != std::string::npos)
+            written++;
+        else if (line.find("log records dropped") != std::string::npos)
+            dropped += std::stoi(line.substr(line.find("| ") + 2));
+    }
+
+    EXPECT_EQ(written + dropped, threadCount * recordsPerThread);
+
+    StopLogger();
+}
+
+TEST(Logger, test_macro_arguments_not_evaluated_when_disabled)
+{
+    StartLogger();
+    ::syscon::logger::SetLogLevel(LOG_LEVEL_INFO);
+
+    int evaluated = 0;
+    SYSCON_LOG_DEBUG("Debug %d", ++evaluated);
+    SYSCON_LOG_INFO("Info %d", ++evaluated);
+    ::syscon::logger::Flush();
+
+    EXPECT_EQ(evaluated, 1);
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_NE(lines[0].find("Info 1"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_controller_macro_arguments_not_evaluated_when_disabled)
+{
+    StartLogger();
+    ::syscon::logger::SetLogLevel(LOG_LEVEL_PERF);
+
+    ::syscon::logger::Logger logger;
+    ILogger *controllerLogger = &logger;
+
+    int evaluated = 0;
+    CONTROLLER_LOG_DEBUG(controllerLogger, "Debug %d", ++evaluated);
+    CONTROLLER_LOG_PERF(controllerLogger, "Perf %d", ++evaluated);
+    ::syscon::logger::Flush();
+
+    EXPECT_EQ(evaluated, 1);
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_NE(lines[0].find("Perf 1"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_binary_log_round_trip)
+{
+    StartLogger();
+    ::syscon::logger::SetBinaryLogging(true);
+
+    uint8_t buffer[300];
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (uint8_t)i;
+
+    ::syscon::logger::LogPerf("Controller[%04x-%04x] Reading: %dus, Parsing: %dus", 0x045e, 0x02dd, 125, -3);
+    ::syscon::logger::LogTrace("%s=%-6.2f%% (%c) %zu %lld %llu %*d|", "ratio", 12.345, 'x', (size_t)42, -5000000000LL, 18000000000000000000ULL, 5, 7);
+    ::syscon::logger::LogTrace("No argument");
+    ::syscon::logger::LogBuffer(LOG_LEVEL_TRACE, buffer, sizeof(buffer));
+    ::syscon::logger::LogPerf("Controller[%04x-%04x] Reading: %dus, Parsing: %dus", 1, 2, 3, 4); // Format string already known
+    ::syscon::logger::LogInfo("Text %d", 1);                                                        // Not a binary level
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> messages = ReadBinaryLogMessages();
+    ASSERT_EQ(messages.size(), 4 + 1 + (sizeof(buffer) + 15) / 16);
+    EXPECT_EQ(messages[0], "Controller[045e-02dd] Reading: 125us, Parsing: -3us");
+    EXPECT_EQ(messages[1], "ratio=12.35 % (x) 42 -5000000000 18000000000000000000     7|");
+    EXPECT_EQ(messages[2], "No argument");
+    EXPECT_EQ(messages[3], "Buffer (300): ");
+    EXPECT_EQ(messages[4], "00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F ");
+    EXPECT_EQ(messages[messages.size() - 2], "20 21 22 23 24 25 26 27 28 29 2A 2B ");
+    EXPECT_EQ(messages.back(), "Controller[0001-0002] Reading: 3us, Parsing: 4us");
+
+    std::vector<std::string> lines = ReadLogLines();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_NE(lines[0].find("Text 1"), std::string::npos);
+
+    StopLogger();
+}
+
+TEST(Logger, test_binary_log_format_not_literal)
+{
+    StartLogger();
+    ::syscon::logger::SetBinaryLogging(true);
+
+    // The format string is gone (Reused buffer) when the flusher writes the records
+    char format[64];
+    snprintf(format, sizeof(format), "First %s", "%d");
+    ::syscon::logger::LogPerf(format, 1);
+    snprintf(format, sizeof(format), "Second %s", "%d");
+    ::syscon::logger::LogPerf(format, 2);
+    snprintf(format, sizeof(format), "First %s", "%d");
+    ::syscon::logger::LogPerf(format, 3);
+    memset(format, 0, sizeof(format));
+    ::syscon::logger::Flush();
+
+    std::vector<std::string> messages = ReadBinaryLogMessages();
+    ASSERT_EQ(messages.size(), 3);
+    EXPECT_EQ(messages[0], "First 1");
+    EXPECT_EQ(messages[1], "Second 2");
+    EXPECT_EQ(messages[2], "First 3");
+
+    StopLogger();
+}
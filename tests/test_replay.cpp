@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "ReplayUSBDevice.h"
+#include "Controllers/Xbox360Controller.h"
+#include "mocks/Logger.h"
+#include <chrono>
+#include <vector>
+
+namespace
+{
+    const char *kReplayScript = R"(# Test device
+device 1234 5678
+interface 0 ff 5d 01
+endpoint 81 32 4
+endpoint 01 32 8
+
+0      ctrl 80 06 0100 0000 12 01 00 02
+100    out 01 01 03 02
+1000   in 81 00 14 01
+21000  in 81 00 14 02
+)";
+
+    std::shared_ptr<ReplayCapture> LoadScript(const char *script)
+    {
+        auto capture = std::make_shared<ReplayCapture>();
+        EXPECT_EQ(capture->LoadText(script), CONTROLLER_STATUS_SUCCESS) << capture->GetError();
+        return capture;
+    }
+
+    void AppendU32(std::vector<uint8_t> *data, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+            data->push_back((uint8_t)(value >> (i * 8)));
+    }
+
+    // Section header and one interface with the if_tsresol option (Little endian)
+    std::vector<uint8_t> MakePcapngHeader(uint8_t tsresol)
+    {
+        std::vector<uint8_t> data;
+        AppendU32(&data, 0x0A0D0D0A); // Section header block
+        AppendU32(&data, 28);
+        AppendU32(&data, 0x1A2B3C4D);
+        AppendU32(&data, 0x00000001); // Version 1.0
+        AppendU32(&data, 0xFFFFFFFF); // Unknown section length
+        AppendU32(&data, 0xFFFFFFFF);
+        AppendU32(&data, 28);
+
+        AppendU32(&data, 0x00000001); // Interface description block
+        AppendU32(&data, 32);
+        AppendU32(&data, 249);        // USBPcap
+        AppendU32(&data, 0xFFFF);     // Snap length
+        AppendU32(&data, 0x00010009); // if_tsresol, 1 byte
+        AppendU32(&data, tsresol);
+        AppendU32(&data, 0x00000000); // End of options
+        AppendU32(&data, 32);
+        return data;
+    }
+} // namespace
+
+TEST(Replay, test_load_script)
+{
+    std::shared_ptr<ReplayCapture> capture = LoadScript(kReplayScript);
+
+    EXPECT_EQ(capture->GetVendor(), 0x1234);
+    EXPECT_EQ(capture->GetProduct(), 0x5678);
+    ASSERT_EQ(capture->GetInterfaces().size(), 1);
+    EXPECT_EQ(capture->GetInterfaces()[0].descriptor.bInterfaceSubClass, 0x5d);
+    ASSERT_EQ(capture->GetInterfaces()[0].endpoints.size(), 2);
+    EXPECT_EQ(capture->GetInterfaces()[0].endpoints[0].wMaxPacketSize, 32);
+    EXPECT_EQ(capture->GetTransfers().size(), 4);
+    EXPECT_EQ(capture->GetReportCount(), 2);
+
+    // Saved script is loaded back identically
+    ReplayCapture reloaded;
+    ASSERT_EQ(reloaded.LoadText(capture->SaveText()), CONTROLLER_STATUS_SUCCESS) << reloaded.GetError();
+    EXPECT_EQ(reloaded.SaveText(), capture->SaveText());
+}
+
+TEST(Replay, test_load_script_invalid)
+{
+    ReplayCapture capture;
+
+    EXPECT_EQ(capture.LoadText("device 1234\n"), CONTROLLER_STATUS_UNEXPECTED_DATA);
+    EXPECT_EQ(capture.GetError().substr(0, 7), "Line 1:");
+
+    EXPECT_EQ(capture.LoadText("0 in 81 00\n1 in 01 00\n"), CONTROLLER_STATUS_UNEXPECTED_DATA); // OUT endpoint used as IN
+    EXPECT_EQ(capture.GetError().substr(0, 7), "Line 2:");
+
+    EXPECT_EQ(capture.LoadText("10 in 81 00\n5 in 81 00\n"), CONTROLLER_STATUS_UNEXPECTED_DATA);
+}
+
+TEST(Replay, test_load_usbpcap_capture)
+{
+    ReplayCapture capture;
+    ASSERT_EQ(capture.LoadFile(TEST_WIRESHARK_DIR "/XBOX360 - Official.pcapng"), CONTROLLER_STATUS_SUCCESS) << capture.GetError();
+
+    // From the device and configuration descriptors of the capture
+    EXPECT_EQ(capture.GetVendor(), 0x045e);
+    EXPECT_EQ(capture.GetProduct(), 0x028e);
+    ASSERT_EQ(capture.GetInterfaces().size(), 4);
+    ASSERT_EQ(capture.GetInterfaces()[0].endpoints.size(), 2);
+    EXPECT_EQ(capture.GetInterfaces()[0].endpoints[0].bEndpointAddress, 0x81);
+    EXPECT_EQ(capture.GetInterfaces()[0].endpoints[1].bEndpointAddress, 0x01);
+    EXPECT_GT(capture.GetReportCount(), 0);
+}
+
+TEST(Replay, test_load_pcapng_invalid_timestamp_resolution)
+{
+    ReplayCapture capture;
+
+    // 10^20 and 2^64 units per second don't fit in 64 bits: The load fails instead of dividing by 0
+    for (uint8_t tsresol : {20, 0x7F, 0x80 | 64})
+    {
+        std::vector<uint8_t> data = MakePcapngHeader(tsresol);
+        EXPECT_EQ(capture.LoadPcap(data.data(), data.size()), CONTROLLER_STATUS_UNEXPECTED_DATA) << (int)tsresol;
+        EXPECT_EQ(capture.GetError(), "Invalid pcap file");
+    }
+
+    // Largest resolutions: Valid file, without any transfer
+    for (uint8_t tsresol : {19, 0x80 | 63})
+    {
+        std::vector<uint8_t> data = MakePcapngHeader(tsresol);
+        EXPECT_EQ(capture.LoadPcap(data.data(), data.size()), CONTROLLER_STATUS_NO_DATA_AVAILABLE) << (int)tsresol;
+    }
+}
+
+TEST(Replay, test_load_usbmon_capture)
+{
+    ReplayCapture capture;
+    ASSERT_EQ(capture.LoadFile(TEST_WIRESHARK_DIR "/Switch Pro wired.pcap"), CONTROLLER_STATUS_SUCCESS) << capture.GetError();
+
+    // Enumeration not captured: Endpoints are found from the traffic
+    EXPECT_EQ(capture.GetVendor(), 0x0000);
+    ASSERT_EQ(capture.GetInterfaces().size(), 1);
+    ASSERT_EQ(capture.GetInterfaces()[0].endpoints.size(), 2);
+    EXPECT_EQ(capture.GetInterfaces()[0].endpoints[0].bEndpointAddress, 0x81);
+    EXPECT_EQ(capture.GetInterfaces()[0].endpoints[0].wMaxPacketSize, 64);
+    EXPECT_EQ(capture.GetInterfaces()[0].endpoints[1].bEndpointAddress, 0x01);
+    EXPECT_GT(capture.GetReportCount(), 0);
+}
+
+TEST(Replay, test_reports_original_timing)
+{
+    ReplayUSBDevice device(LoadScript(kReplayScript));
+    IUSBEndpoint *endpoint = device.GetInterfaces()[0]->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_IN, 0);
+    ASSERT_NE(endpoint, nullptr);
+
+    uint8_t buffer[64];
+    size_t size = sizeof(buffer);
+
+    // First report: Immediately
+    ASSERT_EQ(endpoint->Read(buffer, &size, 0), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(size, 3);
+    EXPECT_EQ(buffer[2], 0x01);
+
+    // Second report: 20ms later
+    auto start = std::chrono::steady_clock::now();
+    size = sizeof(buffer);
+    EXPECT_EQ(endpoint->Read(buffer, &size, 0), CONTROLLER_STATUS_TIMEOUT);
+
+    size = sizeof(buffer);
+    ASSERT_EQ(endpoint->Read(buffer, &size, 100000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(buffer[2], 0x02);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(15));
+
+    EXPECT_TRUE(device.IsFinished());
+    size = sizeof(buffer);
+    EXPECT_EQ(endpoint->Read(buffer, &size, 0), CONTROLLER_STATUS_TIMEOUT);
+    EXPECT_EQ(device.GetStats().reports_replayed, 2);
+}
+
+TEST(Replay, test_reports_loop_as_fast_as_possible)
+{
+    ReplayOptions options;
+    options.speed = 0;
+    options.loop = true;
+
+    ReplayUSBDevice device(LoadScript(kReplayScript), options);
+    IUSBEndpoint *endpoint = device.GetInterfaces()[0]->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_IN, 0);
+
+    uint8_t buffer[64];
+    for (int i = 0; i < 10; i++)
+    {
+        // Nothing already queued, a report for each blocking read
+        size_t size = sizeof(buffer);
+        EXPECT_EQ(endpoint->Read(buffer, &size, 0), CONTROLLER_STATUS_TIMEOUT);
+
+        size = sizeof(buffer);
+        ASSERT_EQ(endpoint->Read(buffer, &size, 1000), CONTROLLER_STATUS_SUCCESS);
+        EXPECT_EQ(buffer[2], (i % 2) + 1);
+    }
+
+    EXPECT_FALSE(device.IsFinished());
+}
+
+TEST(Replay, test_writes_and_control_transfers)
+{
+    ReplayOptions options;
+    options.strict = true;
+
+    ReplayUSBDevice device(LoadScript(kReplayScript), options);
+    IUSBInterface *interface = device.GetInterfaces()[0].get();
+    IUSBEndpoint *endpoint = interface->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_OUT, 0);
+
+    uint8_t expected[] = {0x01, 0x03, 0x02};
+    uint8_t unexpected[] = {0x01, 0x03, 0x03};
+    EXPECT_EQ(endpoint->Write(unexpected, sizeof(unexpected)), CONTROLLER_STATUS_WRITE_FAILED);
+    EXPECT_EQ(endpoint->Write(expected, sizeof(expected)), CONTROLLER_STATUS_SUCCESS);
+
+    // Control reads are answered from the capture, several times if needed
+    uint8_t descriptor[18];
+    for (int i = 0; i < 2; i++)
+    {
+        uint16_t length = sizeof(descriptor);
+        ASSERT_EQ(interface->ControlTransferInput(0x80, 0x06, 0x0100, 0x0000, descriptor, &length), CONTROLLER_STATUS_SUCCESS);
+        EXPECT_EQ(length, 4);
+        EXPECT_EQ(descriptor[0], 0x12);
+    }
+
+    uint16_t length = sizeof(descriptor);
+    EXPECT_EQ(interface->ControlTransferInput(0x80, 0x06, 0x0200, 0x0000, descriptor, &length), CONTROLLER_STATUS_READ_FAILED);
+
+    ReplayStats stats = device.GetStats();
+    EXPECT_EQ(stats.writes_matched, 1);
+    EXPECT_EQ(stats.writes_unexpected, 1);
+    EXPECT_EQ(stats.control_answered, 2);
+    EXPECT_EQ(stats.control_unanswered, 1);
+}
+
+TEST(Replay, test_xbox360_driver_replay)
+{
+    auto capture = std::make_shared<ReplayCapture>();
+    ASSERT_EQ(capture->LoadFile(TEST_WIRESHARK_DIR "/XBOX360 - Official.pcapng"), CONTROLLER_STATUS_SUCCESS) << capture->GetError();
+
+    ReplayOptions options;
+    options.speed = 0;
+
+    auto device = std::make_unique<ReplayUSBDevice>(capture, options);
+    ReplayUSBDevice *replay = device.get();
+
+    ControllerConfig config;
+    Xbox360Controller controller(std::move(device), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    while (!replay->IsFinished())
+    {
+        NormalizedButtonData normalData = {};
+        uint16_t input_idx = 0;
+        controller.ReadInput(&normalData, &input_idx, 1000);
+    }
+
+    ControllerMetricsSnapshot snapshot;
+    controller.GetMetrics().Snapshot(&snapshot);
+    EXPECT_GT(snapshot.counters[ControllerCounter_ReportsParsed], 0);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReadErrors], 0);
+}
@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include "report_recorder.h"
+#include "filemanager_std.h"
+#include "ReplayUSBDevice.h"
+#include "Controllers/Xbox360Controller.h"
+#include "Controllers/WiiController.h"
+#include "mocks/Logger.h"
+#include "mocks/Device.h"
+#include "mocks/USBInterface.h"
+#include "mocks/USBEndpoint.h"
+
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#define TEST_RECORDS_PATH "test_recorder/"
+
+namespace
+{
+    const char *kRecordedDevice = R"(device 1234 5678
+interface 0 ff 5d 01
+endpoint 81 32 4
+endpoint 01 32 8
+interface 1 ff 5d 02
+endpoint 82 64 1
+)";
+
+    void StartRecorder()
+    {
+        std::filesystem::remove_all(TEST_RECORDS_PATH);
+        ::syscon::recorder::Initialize(TEST_RECORDS_PATH, std::make_unique<syscon::StdFileManager>());
+    }
+
+    // Path of the single file recorded
+    std::string StopRecorder()
+    {
+        ::syscon::recorder::Exit();
+
+        std::vector<std::string> files;
+        for (const auto &entry : std::filesystem::directory_iterator(TEST_RECORDS_PATH))
+            files.push_back(entry.path().string());
+
+        EXPECT_EQ(files.size(), 1);
+        return files.empty() ? "" : files[0];
+    }
+
+    std::vector<IUSBInterface *> GetInterfaces(IUSBDevice *device)
+    {
+        std::vector<IUSBInterface *> interfaces;
+        for (auto &&interface : device->GetInterfaces())
+            interfaces.push_back(interface.get());
+        return interfaces;
+    }
+} // namespace
+
+TEST(ReportRecorder, test_disabled)
+{
+    EXPECT_FALSE(::syscon::recorder::IsEnabled());
+    EXPECT_EQ(::syscon::recorder::Create(0x1234, 0x5678), nullptr);
+}
+
+TEST(ReportRecorder, test_record_file)
+{
+    auto capture = std::make_shared<ReplayCapture>();
+    ASSERT_EQ(capture->LoadText(kRecordedDevice), CONTROLLER_STATUS_SUCCESS) << capture->GetError();
+    ReplayUSBDevice device(capture);
+    std::vector<IUSBInterface *> interfaces = GetInterfaces(&device);
+
+    StartRecorder();
+    {
+        std::unique_ptr<IReportRecorder> recorder = ::syscon::recorder::Create(0x1234, 0x5678);
+        ASSERT_NE(recorder, nullptr);
+
+        const uint8_t report1[] = {0x00, 0x14, 0x01};
+        const uint8_t report2[] = {0x02, 0x03};
+        recorder->Begin(0x1234, 0x5678, interfaces.data(), interfaces.size());
+        recorder->Record(0, CONTROLLER_STATUS_SUCCESS, report1, sizeof(report1));
+        recorder->Record(REPORT_RECORD_ENDPOINT_UNKNOWN, CONTROLLER_STATUS_READ_FAILED, nullptr, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        recorder->Record(1, CONTROLLER_STATUS_NOTHING_TODO, report2, sizeof(report2));
+    }
+    std::string path = StopRecorder();
+
+    // Raw content: The failed read is recorded
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t headerSize = sizeof(ReportRecordFileHeader) + 2 * sizeof(ReportRecordInterface) + 3 * sizeof(ReportRecordEndpoint);
+    ASSERT_EQ(content.size(), headerSize + 3 * sizeof(ReportRecordHeader) + 3 + 2);
+
+    ReportRecordHeader error;
+    memcpy(&error, &content[headerSize + sizeof(ReportRecordHeader) + 3], sizeof(error));
+    EXPECT_EQ(error.endpoint, REPORT_RECORD_ENDPOINT_UNKNOWN);
+    EXPECT_EQ(error.result, CONTROLLER_STATUS_READ_FAILED);
+    EXPECT_EQ(error.size, 0);
+
+    // Replayed: Same device, reports with their timing
+    ReplayCapture replay;
+    ASSERT_EQ(replay.LoadFile(path), CONTROLLER_STATUS_SUCCESS) << replay.GetError();
+    EXPECT_EQ(replay.GetVendor(), 0x1234);
+    EXPECT_EQ(replay.GetProduct(), 0x5678);
+    ASSERT_EQ(replay.GetInterfaces().size(), 2);
+    ASSERT_EQ(replay.GetInterfaces()[0].endpoints.size(), 2);
+    EXPECT_EQ(replay.GetInterfaces()[0].endpoints[0].bEndpointAddress, 0x81);
+    EXPECT_EQ(replay.GetInterfaces()[0].endpoints[0].wMaxPacketSize, 32);
+    EXPECT_EQ(replay.GetInterfaces()[0].endpoints[1].bEndpointAddress, 0x01);
+    EXPECT_EQ(replay.GetInterfaces()[1].descriptor.bInterfaceProtocol, 0x02);
+
+    ASSERT_EQ(replay.GetTransfers().size(), 2);
+    EXPECT_EQ(replay.GetTransfers()[0].endpoint, 0x81);
+    EXPECT_EQ(replay.GetTransfers()[0].timestamp_us, 0);
+    EXPECT_EQ(replay.GetTransfers()[1].endpoint, 0x82); // Second IN endpoint, on the second interface
+    EXPECT_GE(replay.GetTransfers()[1].timestamp_us, 5000);
+    EXPECT_EQ(replay.GetTransfers()[1].data, std::vector<uint8_t>({0x02, 0x03}));
+}
+
+TEST(ReportRecorder, test_record_burst)
+{
+    const int reportCount = 20000;
+    uint8_t report[64] = {};
+
+    StartRecorder();
+    {
+        std::unique_ptr<IReportRecorder> recorder = ::syscon::recorder::Create(0x1234, 0x5678);
+        recorder->Begin(0x1234, 0x5678, nullptr, 0);
+
+        // Much faster than the writer thread: Reports are dropped, but never partially
+        for (int i = 0; i < reportCount; i++)
+        {
+            memcpy(report, &i, sizeof(i));
+            recorder->Record(0, CONTROLLER_STATUS_SUCCESS, report, sizeof(report));
+        }
+    }
+    std::string path = StopRecorder();
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t offset = sizeof(ReportRecordFileHeader);
+    int previous = -1;
+    int recorded = 0;
+    while (offset < content.size())
+    {
+        ReportRecordHeader header;
+        ASSERT_LE(offset + sizeof(header) + sizeof(report), content.size());
+        memcpy(&header, &content[offset], sizeof(header));
+        ASSERT_EQ(header.size, sizeof(report));
+
+        int index;
+        memcpy(&index, &content[offset + sizeof(header)], sizeof(index));
+        EXPECT_GT(index, previous); // In order
+        previous = index;
+
+        offset += sizeof(header) + header.size;
+        recorded++;
+    }
+
+    EXPECT_GT(recorded, 0);
+    EXPECT_LE(recorded, reportCount);
+}
+
+TEST(ReportRecorder, test_record_xbox360_and_replay)
+{
+    auto capture = std::make_shared<ReplayCapture>();
+    ASSERT_EQ(capture->LoadFile(TEST_WIRESHARK_DIR "/XBOX360 - Official.pcapng"), CONTROLLER_STATUS_SUCCESS) << capture->GetError();
+
+    ReplayOptions options;
+    options.speed = 0;
+
+    // Record the capture replayed through the driver
+    StartRecorder();
+    uint64_t reportsParsed = 0;
+    {
+        auto device = std::make_unique<ReplayUSBDevice>(capture, options);
+        ReplayUSBDevice *replay = device.get();
+
+        ControllerConfig config;
+        Xbox360Controller controller(std::move(device), config, std::make_unique<MockLogger>());
+        controller.SetReportRecorder(::syscon::recorder::Create(0x045e, 0x028e));
+        ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+        while (!replay->IsFinished())
+        {
+            NormalizedButtonData normalData = {};
+            uint16_t input_idx = 0;
+            controller.ReadInput(&normalData, &input_idx, 1000);
+        }
+
+        ControllerMetricsSnapshot snapshot;
+        controller.GetMetrics().Snapshot(&snapshot);
+        reportsParsed = snapshot.counters[ControllerCounter_ReportsParsed];
+    }
+    std::string path = StopRecorder();
+
+    auto recorded = std::make_shared<ReplayCapture>();
+    ASSERT_EQ(recorded->LoadFile(path), CONTROLLER_STATUS_SUCCESS) << recorded->GetError();
+    EXPECT_EQ(recorded->GetVendor(), 0x045e);
+    EXPECT_EQ(recorded->GetProduct(), 0x028e);
+    EXPECT_EQ(recorded->GetInterfaces().size(), capture->GetInterfaces().size());
+    EXPECT_EQ(recorded->GetReportCount(), capture->GetReportCount());
+
+    // Replay the record: The driver sees the same reports
+    auto device = std::make_unique<ReplayUSBDevice>(recorded, options);
+    ReplayUSBDevice *replay = device.get();
+
+    ControllerConfig config;
+    Xbox360Controller controller(std::move(device), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    while (!replay->IsFinished())
+    {
+        NormalizedButtonData normalData = {};
+        uint16_t input_idx = 0;
+        controller.ReadInput(&normalData, &input_idx, 1000);
+    }
+
+    ControllerMetricsSnapshot snapshot;
+    controller.GetMetrics().Snapshot(&snapshot);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsParsed], reportsParsed);
+}
+
+TEST(ReportRecorder, test_record_raw_transfers)
+{
+    IUSBEndpoint::EndpointDescriptor descriptor = {};
+    descriptor.bEndpointAddress = 0x81;
+    descriptor.wMaxPacketSize = 64;
+
+    // Wii U adapter: 3 transfers already queued, the 2 last ones are drained behind the first one
+    std::deque<std::vector<uint8_t>> transfers;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        std::vector<uint8_t> transfer(37, 0x00);
+        transfer[0] = 0x21;
+        transfer[1] = 0x10; // Port 1 connected
+        transfer[2] = i;
+        transfers.push_back(transfer);
+    }
+
+    auto mockUSBEndpointIn = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_IN);
+    auto mockUSBEndpointOut = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_OUT);
+    ON_CALL(*mockUSBEndpointIn, GetDescriptor).WillByDefault(testing::Return(&descriptor));
+    ON_CALL(*mockUSBEndpointIn, Read).WillByDefault([&transfers](uint8_t *outBuffer, size_t *bufferSizeInOut, uint64_t aTimeoutUs) {
+        if (transfers.empty())
+        {
+            *bufferSizeInOut = 0;
+            return (aTimeoutUs == 0) ? CONTROLLER_STATUS_SUCCESS : CONTROLLER_STATUS_TIMEOUT;
+        }
+
+        memcpy(outBuffer, transfers.front().data(), transfers.front().size());
+        *bufferSizeInOut = transfers.front().size();
+        transfers.pop_front();
+        return CONTROLLER_STATUS_SUCCESS;
+    });
+
+    StartRecorder();
+    {
+        ControllerConfig config;
+        WiiController controller(std::make_unique<MockDevice>(0x057e, 0x0337, std::make_unique<testing::NiceMock<MockUSBInterface>>(std::move(mockUSBEndpointIn), std::move(mockUSBEndpointOut))), config, std::make_unique<MockLogger>());
+        controller.SetReportRecorder(::syscon::recorder::Create(0x057e, 0x0337));
+        ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+        ControllerInputBatch inputs;
+        ASSERT_EQ(controller.ReadInputs(&inputs, 1000), CONTROLLER_STATUS_SUCCESS);
+        EXPECT_EQ(inputs.count, 4);
+    }
+    std::string path = StopRecorder();
+
+    // The whole USB transfers on their IN endpoint, not the 9-byte port slices: The record is replayed as it was received
+    ReplayCapture replay;
+    ASSERT_EQ(replay.LoadFile(path), CONTROLLER_STATUS_SUCCESS) << replay.GetError();
+    ASSERT_EQ(replay.GetTransfers().size(), 3);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(replay.GetTransfers()[i].endpoint, 0x81);
+        ASSERT_EQ(replay.GetTransfers()[i].data.size(), 37);
+        EXPECT_EQ(replay.GetTransfers()[i].data[2], i);
+    }
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "resume_table.h"
+
+using namespace syscon::controllers;
+
+namespace
+{
+    class TestResumeData : public ControllerResumeData
+    {
+    public:
+        explicit TestResumeData(int value) : value(value) {}
+        int value;
+    };
+
+    ResumeEntry MakeEntry(uint16_t vendor_id, uint16_t product_id, const char *path, int value)
+    {
+        ResumeEntry entry;
+        entry.vendor_id = vendor_id;
+        entry.product_id = product_id;
+        entry.path = path;
+        entry.config.driver = "generic";
+        entry.data = std::make_shared<TestResumeData>(value);
+        return entry;
+    }
+
+    int GetValue(const ResumeEntry &entry)
+    {
+        return static_cast<const TestResumeData *>(entry.data.get())->value;
+    }
+} // namespace
+
+TEST(ResumeTable, test_take_by_port)
+{
+    ResumeTable table;
+    ResumeEntry entry;
+
+    // 2 identical pads and an Xbox 360 pad
+    std::vector<ResumeEntry> entries;
+    entries.push_back(MakeEntry(0x0079, 0x0006, "1-1", 1));
+    entries.push_back(MakeEntry(0x0079, 0x0006, "1-2", 2));
+    entries.push_back(MakeEntry(0x045e, 0x028e, "1-3", 3));
+    table.Suspend(std::move(entries));
+    EXPECT_EQ(table.GetWakeTime(), 0);
+
+    table.Wake(1000);
+    EXPECT_EQ(table.GetWakeTime(), 1000);
+
+    // Each pad gets what was resolved for its port
+    ASSERT_TRUE(table.Take(0x0079, 0x0006, "1-2", 2000, &entry));
+    EXPECT_EQ(GetValue(entry), 2);
+    EXPECT_EQ(entry.path, "1-2");
+    EXPECT_EQ(entry.config.driver, "generic");
+
+    // Moved to another port: The other entry of the same VID/PID
+    ASSERT_TRUE(table.Take(0x0079, 0x0006, "1-4", 2000, &entry));
+    EXPECT_EQ(GetValue(entry), 1);
+
+    // Taken only once
+    EXPECT_FALSE(table.Take(0x0079, 0x0006, "1-1", 2000, &entry));
+
+    // Never plugged before the sleep
+    EXPECT_FALSE(table.Take(0x054c, 0x0268, "1-1", 2000, &entry));
+    EXPECT_EQ(table.Size(), 1);
+}
+
+TEST(ResumeTable, test_resume_window)
+{
+    ResumeTable table;
+    ResumeEntry entry;
+
+    std::vector<ResumeEntry> entries;
+    entries.push_back(MakeEntry(0x0079, 0x0006, "1-1", 1));
+    entries.push_back(MakeEntry(0x045e, 0x028e, "1-2", 2));
+    table.Suspend(std::move(entries));
+
+    // Plugged again before the wake up is notified
+    ASSERT_TRUE(table.Take(0x0079, 0x0006, "1-1", 5000, &entry));
+
+    // Too late after the wake up: Initialized from scratch
+    table.Wake(1000);
+    EXPECT_FALSE(table.Take(0x045e, 0x028e, "1-2", 1000 + CONTROLLER_RESUME_WINDOW_US, &entry));
+    EXPECT_EQ(table.Size(), 0);
+
+    // Next sleep replaces the entries
+    entries.clear();
+    entries.push_back(MakeEntry(0x045e, 0x028e, "1-2", 3));
+    table.Suspend(std::move(entries));
+    EXPECT_EQ(table.GetWakeTime(), 0);
+    ASSERT_TRUE(table.Take(0x045e, 0x028e, "1-2", 0, &entry));
+    EXPECT_EQ(GetValue(entry), 3);
+}
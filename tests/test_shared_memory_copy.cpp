@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "SwitchSharedMemoryCopy.h"
+
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#define TEST_LIFO_BUFFER_COUNT 17
+
+namespace
+{
+    struct TestAtomicStorage
+    {
+        uint64_t sampling_number;
+        uint64_t state[63]; // Every word is set to the sampling number, a torn copy will mix 2 values
+    };
+
+    struct TestLifo
+    {
+        uint64_t unused;
+        uint64_t buffer_count;
+        uint64_t tail;
+        uint64_t count;
+        TestAtomicStorage storage[TEST_LIFO_BUFFER_COUNT];
+    };
+
+    bool IsTorn(const TestAtomicStorage &entry)
+    {
+        for (size_t i = 0; i < sizeof(entry.state) / sizeof(entry.state[0]); i++)
+        {
+            if (entry.state[i] != entry.sampling_number)
+                return true;
+        }
+        return false;
+    }
+} // namespace
+
+TEST(SharedMemoryCopy, test_copy_all_sizes_and_alignments)
+{
+    std::vector<uint8_t> src(512);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = (uint8_t)(i * 7 + 1);
+
+    for (size_t offset = 0; offset < 8; offset++)
+    {
+        for (size_t size = 0; size < 200; size++)
+        {
+            std::vector<uint8_t> dst(512, 0);
+            SharedMemoryCopy(dst.data() + offset, src.data() + offset, size);
+
+            EXPECT_EQ(memcmp(dst.data() + offset, src.data() + offset, size), 0);
+            EXPECT_EQ(dst[offset + size], 0); // No overflow
+        }
+    }
+}
+
+TEST(SharedMemoryCopy, test_write_lifo_entry_wraps)
+{
+    TestLifo lifo = {};
+    lifo.buffer_count = TEST_LIFO_BUFFER_COUNT;
+    lifo.tail = TEST_LIFO_BUFFER_COUNT - 1;
+
+    TestAtomicStorage entry = {};
+    entry.sampling_number = 42;
+
+    EXPECT_EQ(SharedMemoryWriteLifoEntry(lifo.storage, &lifo.tail, lifo.buffer_count, entry), 0);
+    EXPECT_EQ(lifo.tail, 0);
+    EXPECT_EQ(lifo.storage[0].sampling_number, 42);
+
+    EXPECT_EQ(SharedMemoryWriteLifoEntry(lifo.storage, &lifo.tail, lifo.buffer_count, entry), 1);
+    EXPECT_EQ(lifo.tail, 1);
+}
+
+TEST(SharedMemoryCopy, test_read_lifo_entry_uninitialized)
+{
+    TestLifo lifo = {};
+    TestAtomicStorage entry;
+
+    lifo.buffer_count = 0;
+    EXPECT_FALSE(SharedMemoryReadLifoEntry(&entry, lifo.storage, &lifo.tail, lifo.buffer_count));
+}
+
+TEST(SharedMemoryCopy, test_read_lifo_entry_no_torn_entries)
+{
+    static TestLifo lifo = {};
+    lifo.buffer_count = TEST_LIFO_BUFFER_COUNT;
+
+    std::atomic<bool> running(true);
+
+    // Writer behave like the HID sysmodule: fill storage[tail + 1] word by word, then publish the tail
+    std::thread writer([&]() {
+        uint64_t sampling_number = 1;
+        while (running.load(std::memory_order_relaxed))
+        {
+            uint64_t tail = (lifo.tail + 1) % TEST_LIFO_BUFFER_COUNT;
+            TestAtomicStorage *entry = &lifo.storage[tail];
+
+            __atomic_store_n(&entry->sampling_number, sampling_number, __ATOMIC_RELAXED);
+            for (size_t i = 0; i < sizeof(entry->state) / sizeof(entry->state[0]); i++)
+                __atomic_store_n(&entry->state[i], sampling_number, __ATOMIC_RELAXED);
+
+            __atomic_store_n(&lifo.tail, tail, __ATOMIC_RELEASE);
+            sampling_number++;
+        }
+    });
+
+    int valid_count = 0;
+    int torn_count = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        TestAtomicStorage entry;
+        if (!SharedMemoryReadLifoEntry(&entry, lifo.storage, &lifo.tail, lifo.buffer_count))
+            continue;
+
+        valid_count++;
+        if (IsTorn(entry))
+            torn_count++;
+    }
+
+    running = false;
+    writer.join();
+
+    EXPECT_GT(valid_count, 0);
+    EXPECT_EQ(torn_count, 0);
+}
@@ -0,0 +1,392 @@
+#include <gtest/gtest.h>
+#include "SyntheticUSBDevice.h"
+#include "ControllerRegistry.h"
+#include "Controllers/SwitchController.h"
+#include "Controllers/WiiController.h"
+#include "Controllers/Xbox360Controller.h"
+#include "Controllers/Xbox360WirelessController.h"
+#include "mocks/Logger.h"
+#include <thread>
+
+namespace
+{
+    // Pad N presses the button N+1 (Mapped on X, A, B, Y) and pushes the left stick right
+    void PadButtonScript(uint16_t pad, uint64_t report_idx, SyntheticPadState *state)
+    {
+        (void)report_idx;
+        state->input.buttons[pad + 1] = true;
+        state->input.analog[ControllerAnalogType_X] = 0.5f;
+    }
+
+    ControllerConfig MakeConfig()
+    {
+        ControllerConfig config;
+        config.buttonsPin[ControllerButton::X][0] = 1;
+        config.buttonsPin[ControllerButton::A][0] = 2;
+        config.buttonsPin[ControllerButton::B][0] = 3;
+        config.buttonsPin[ControllerButton::Y][0] = 4;
+        config.buttonsAnalog[ControllerButton::LSTICK_RIGHT].bind = ControllerAnalogBinding_X;
+        config.buttonsAnalog[ControllerButton::LSTICK_RIGHT].sign = 1.0f;
+        return config;
+    }
+
+    std::unique_ptr<IController> MakeController(SyntheticProtocol protocol, std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config)
+    {
+        static ControllerRegistry registry = [] {
+            ControllerRegistry builtIn;
+            builtIn.RegisterBuiltIn();
+            builtIn.BuildIndex();
+            return builtIn;
+        }();
+
+        return registry.FindByName(GetSyntheticLayout(protocol).driver)->factory(std::move(device), config, std::make_unique<MockLogger>());
+    }
+
+    SyntheticOptions VirtualClockOptions(SyntheticProtocol protocol)
+    {
+        SyntheticOptions options;
+        options.protocol = protocol;
+        options.realtime = false;
+        options.script = PadButtonScript;
+        return options;
+    }
+} // namespace
+
+TEST(Synthetic, test_protocol_names)
+{
+    for (int i = 0; i < SyntheticProtocol_Count; i++)
+    {
+        SyntheticProtocol protocol = static_cast<SyntheticProtocol>(i);
+        SyntheticProtocol found = SyntheticProtocol_Count;
+
+        EXPECT_TRUE(FindSyntheticProtocol(GetSyntheticLayout(protocol).name, &found));
+        EXPECT_EQ(found, protocol);
+    }
+
+    SyntheticProtocol found;
+    EXPECT_FALSE(FindSyntheticProtocol("unknown", &found));
+}
+
+TEST(Synthetic, test_reports_decoded_by_drivers)
+{
+    ControllerConfig config = MakeConfig();
+
+    for (int i = 0; i < SyntheticProtocol_Count; i++)
+    {
+        SyntheticProtocol protocol = static_cast<SyntheticProtocol>(i);
+        SCOPED_TRACE(GetSyntheticLayout(protocol).name);
+
+        std::unique_ptr<IController> controller = MakeController(protocol, std::make_unique<SyntheticUSBDevice>(VirtualClockOptions(protocol)), config);
+        ASSERT_NE(controller, nullptr);
+        ASSERT_EQ(controller->Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+        // Connection status reports first for wireless protocols
+        ControllerResult result = CONTROLLER_STATUS_NOTHING_TODO;
+        NormalizedButtonData normalData = {};
+        uint16_t input_idx = 0;
+        for (int read = 0; read < 10 && result != CONTROLLER_STATUS_SUCCESS; read++)
+        {
+            normalData = {};
+            result = controller->ReadInput(&normalData, &input_idx, 10000);
+        }
+
+        ASSERT_EQ(result, CONTROLLER_STATUS_SUCCESS);
+        EXPECT_EQ(input_idx, 0);
+        EXPECT_TRUE(normalData.buttons[ControllerButton::X]);
+        EXPECT_FALSE(normalData.buttons[ControllerButton::A]);
+        EXPECT_NEAR(normalData.sticks[0].axis_x, 0.5f, 0.02f);
+        EXPECT_TRUE(controller->IsControllerConnected(0));
+    }
+}
+
+TEST(Synthetic, test_multiple_pads)
+{
+    ControllerConfig config = MakeConfig();
+    const ControllerButton padButtons[] = {ControllerButton::X, ControllerButton::A, ControllerButton::B, ControllerButton::Y};
+
+    for (SyntheticProtocol protocol : {SyntheticProtocol_Xbox360Wireless, SyntheticProtocol_WiiU, SyntheticProtocol_Steam2026Puck})
+    {
+        SCOPED_TRACE(GetSyntheticLayout(protocol).name);
+
+        SyntheticOptions options = VirtualClockOptions(protocol);
+        options.pads = 4;
+
+        std::unique_ptr<IController> controller = MakeController(protocol, std::make_unique<SyntheticUSBDevice>(options), config);
+        ASSERT_EQ(controller->Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+        int reportsByPad[4] = {};
+        for (int read = 0; read < 64; read++)
+        {
+            NormalizedButtonData normalData = {};
+            uint16_t input_idx = 0;
+            if (controller->ReadInput(&normalData, &input_idx, 10000) != CONTROLLER_STATUS_SUCCESS)
+                continue;
+
+            ASSERT_LT(input_idx, 4);
+            for (uint16_t pad = 0; pad < 4; pad++)
+                EXPECT_EQ(normalData.buttons[padButtons[pad]], pad == input_idx);
+            reportsByPad[input_idx]++;
+        }
+
+        for (uint16_t pad = 0; pad < 4; pad++)
+        {
+            EXPECT_GT(reportsByPad[pad], 0) << "Pad " << pad;
+            EXPECT_TRUE(controller->IsControllerConnected(pad));
+        }
+    }
+}
+
+TEST(Synthetic, test_pad_disconnection)
+{
+    SyntheticOptions options = VirtualClockOptions(SyntheticProtocol_Xbox360Wireless);
+    options.script = [](uint16_t pad, uint64_t report_idx, SyntheticPadState *state) {
+        (void)pad;
+        state->connected = report_idx < 4;
+    };
+
+    Xbox360WirelessController controller(std::make_unique<SyntheticUSBDevice>(options), MakeConfig(), std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    for (int read = 0; read < 16; read++)
+    {
+        NormalizedButtonData normalData = {};
+        uint16_t input_idx = 0;
+        controller.ReadInput(&normalData, &input_idx, 10000);
+    }
+
+    EXPECT_FALSE(controller.IsControllerConnected(0));
+}
+
+TEST(Synthetic, test_status_reports_not_coalesced)
+{
+    // The connection status is queued with the first inputs of the burst: Read and drained in the same transfer
+    SyntheticOptions options = VirtualClockOptions(SyntheticProtocol_Xbox360Wireless);
+    options.rate_hz = 8000;
+    options.burst = 4;
+
+    Xbox360WirelessController controller(std::make_unique<SyntheticUSBDevice>(options), MakeConfig(), std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    NormalizedButtonData normalData = {};
+    uint16_t input_idx = 0;
+    ASSERT_EQ(controller.ReadInput(&normalData, &input_idx, 10000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(input_idx, 0);
+    EXPECT_TRUE(normalData.buttons[ControllerButton::X]);
+    EXPECT_TRUE(controller.IsControllerConnected(0));
+
+    ControllerMetricsSnapshot snapshot;
+    controller.GetMetrics().Snapshot(&snapshot);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsSide], 1);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ReportsParsed], 1);
+    EXPECT_EQ(snapshot.counters[ControllerCounter_ParseErrors], 0);
+}
+
+TEST(Synthetic, test_switch_handshake)
+{
+    auto device = std::make_unique<SyntheticUSBDevice>(VirtualClockOptions(SyntheticProtocol_Switch));
+    SyntheticUSBDevice *synthetic = device.get();
+
+    // No input report until the 0x80 0x04 command
+    ASSERT_EQ(device->Open(), CONTROLLER_STATUS_SUCCESS);
+    IUSBEndpoint *endpoint = device->GetInterfaces()[0]->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_IN, 0);
+    uint8_t buffer[64];
+    size_t size = sizeof(buffer);
+    EXPECT_EQ(endpoint->Read(buffer, &size, 100000), CONTROLLER_STATUS_TIMEOUT);
+    device->Close();
+
+    SwitchController controller(std::move(device), MakeConfig(), std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_GE(synthetic->GetStats().writes, 2);
+
+    NormalizedButtonData normalData = {};
+    uint16_t input_idx = 0;
+    ASSERT_EQ(controller.ReadInput(&normalData, &input_idx, 10000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(normalData.buttons[ControllerButton::X]);
+}
+
+TEST(Synthetic, test_burst_timing)
+{
+    SyntheticOptions options = VirtualClockOptions(SyntheticProtocol_Xbox360);
+    options.rate_hz = 1000;
+    options.burst = 4;
+
+    SyntheticUSBDevice device(options);
+    ASSERT_EQ(device.Open(), CONTROLLER_STATUS_SUCCESS);
+    IUSBEndpoint *endpoint = device.GetInterfaces()[0]->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_IN, 0);
+
+    uint8_t buffer[64];
+    for (uint64_t group = 0; group < 3; group++)
+    {
+        // One wait per burst, then the reports are already queued
+        size_t size = sizeof(buffer);
+        ASSERT_EQ(endpoint->Read(buffer, &size, 100000), CONTROLLER_STATUS_SUCCESS);
+        EXPECT_EQ(device.GetTimeUs(), group * 4000);
+
+        for (int i = 1; i < 4; i++)
+        {
+            size = sizeof(buffer);
+            EXPECT_EQ(endpoint->Read(buffer, &size, 0), CONTROLLER_STATUS_SUCCESS);
+        }
+
+        size = sizeof(buffer);
+        EXPECT_EQ(endpoint->Read(buffer, &size, 0), CONTROLLER_STATUS_TIMEOUT);
+    }
+
+    // Timeout shorter than the next burst
+    size_t size = sizeof(buffer);
+    EXPECT_EQ(endpoint->Read(buffer, &size, 1000), CONTROLLER_STATUS_TIMEOUT);
+    EXPECT_EQ(device.GetTimeUs(), 9000);
+}
+
+TEST(Synthetic, test_jitter_timing)
+{
+    SyntheticOptions options = VirtualClockOptions(SyntheticProtocol_Xbox360);
+    options.rate_hz = 1000;
+    options.jitter_us = 300;
+
+    SyntheticUSBDevice device(options);
+    ASSERT_EQ(device.Open(), CONTROLLER_STATUS_SUCCESS);
+    IUSBEndpoint *endpoint = device.GetInterfaces()[0]->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_IN, 0);
+
+    uint8_t buffer[64];
+    uint64_t previous_us = 0;
+    bool jittered = false;
+    for (uint64_t report = 0; report < 100; report++)
+    {
+        size_t size = sizeof(buffer);
+        ASSERT_EQ(endpoint->Read(buffer, &size, 100000), CONTROLLER_STATUS_SUCCESS);
+
+        uint64_t time_us = device.GetTimeUs();
+        EXPECT_GE(time_us, previous_us);
+        EXPECT_GE(time_us, report * 1000);
+        EXPECT_LE(time_us, report * 1000 + 300);
+        jittered |= time_us != report * 1000;
+        previous_us = time_us;
+    }
+
+    EXPECT_TRUE(jittered);
+}
+
+TEST(Synthetic, test_queue_overflow)
+{
+    SyntheticOptions options = VirtualClockOptions(SyntheticProtocol_Xbox360);
+    options.rate_hz = 1000;
+    options.queue_depth = 4;
+    options.realtime = true;
+
+    SyntheticUSBDevice device(options);
+    ASSERT_EQ(device.Open(), CONTROLLER_STATUS_SUCCESS);
+    IUSBEndpoint *endpoint = device.GetInterfaces()[0]->GetEndpoint(IUSBEndpoint::USB_ENDPOINT_IN, 0);
+
+    // Not read for 20ms: Only the 4 latest reports are kept
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    uint8_t buffer[64];
+    int queued = 0;
+    size_t size = sizeof(buffer);
+    while (endpoint->Read(buffer, &size, 0) == CONTROLLER_STATUS_SUCCESS)
+    {
+        queued++;
+        size = sizeof(buffer);
+    }
+
+    SyntheticStats stats = device.GetStats();
+    EXPECT_EQ(queued, 4);
+    EXPECT_GE(stats.reports_dropped, 10);
+    EXPECT_EQ(stats.reports_read + stats.reports_dropped, stats.reports_generated);
+}
+
+TEST(Synthetic, test_stress_10_devices_4_pads)
+{
+    const int deviceCount = 10;
+    const uint64_t reportLimit = 500;
+    ControllerConfig config = MakeConfig();
+
+    std::vector<std::unique_ptr<IController>> controllers;
+    std::vector<SyntheticUSBDevice *> devices;
+    for (int i = 0; i < deviceCount; i++)
+    {
+        SyntheticOptions options = VirtualClockOptions(i % 2 ? SyntheticProtocol_WiiU : SyntheticProtocol_Xbox360Wireless);
+        options.pads = 4;
+        options.rate_hz = 8000;
+        options.jitter_us = 100;
+        options.burst = 2;
+        options.report_limit = reportLimit;
+        options.seed = i + 1;
+
+        auto device = std::make_unique<SyntheticUSBDevice>(options);
+        devices.push_back(device.get());
+        controllers.push_back(MakeController(options.protocol, std::move(device), config));
+        ASSERT_EQ(controllers.back()->Initialize(), CONTROLLER_STATUS_SUCCESS);
+    }
+
+    for (int i = 0; i < deviceCount; i++)
+    {
+        SCOPED_TRACE(i);
+
+        // Each pad is read, reports queued during a blocking read on another pad are coalesced
+        int reportsByPad[4] = {};
+        for (int read = 0; read < 100000 && !devices[i]->IsFinished(); read++)
+        {
+            NormalizedButtonData normalData = {};
+            uint16_t input_idx = 0;
+            if (controllers[i]->ReadInput(&normalData, &input_idx, 1000) == CONTROLLER_STATUS_SUCCESS)
+                reportsByPad[input_idx]++;
+        }
+
+        ASSERT_TRUE(devices[i]->IsFinished());
+        for (uint16_t pad = 0; pad < 4; pad++)
+            EXPECT_GT(reportsByPad[pad], 0) << "Pad " << pad;
+
+        SyntheticStats stats = devices[i]->GetStats();
+        EXPECT_GE(stats.reports_generated, reportLimit);
+        EXPECT_GE(devices[i]->GetTimeUs(), (reportLimit - 2) * 125);
+    }
+}
+
+TEST(Synthetic, test_read_inputs_batch)
+{
+    ControllerConfig config = MakeConfig();
+    const ControllerButton padButtons[] = {ControllerButton::X, ControllerButton::A, ControllerButton::B, ControllerButton::Y};
+
+    // Wii U adapter: The 4 ports of one report in the same batch
+    SyntheticOptions options = VirtualClockOptions(SyntheticProtocol_WiiU);
+    options.pads = 4;
+
+    auto device = std::make_unique<SyntheticUSBDevice>(options);
+    SyntheticUSBDevice *synthetic = device.get();
+    WiiController controller(std::move(device), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    ControllerInputBatch inputs;
+    for (int transfer = 0; transfer < 3; transfer++)
+    {
+        ASSERT_EQ(controller.ReadInputs(&inputs, 10000), CONTROLLER_STATUS_SUCCESS);
+        ASSERT_EQ(inputs.count, 4);
+        for (uint16_t i = 0; i < 4; i++)
+        {
+            EXPECT_EQ(inputs.input_idx[i], i);
+            EXPECT_EQ(inputs.result[i], CONTROLLER_STATUS_SUCCESS);
+            EXPECT_TRUE(inputs.data[i].buttons[padButtons[i]]);
+        }
+    }
+    EXPECT_EQ(synthetic->GetStats().reports_read, 3);
+
+    // Ports not connected are in the batch too
+    options.pads = 2;
+    WiiController twoPads(std::make_unique<SyntheticUSBDevice>(options), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(twoPads.Initialize(), CONTROLLER_STATUS_SUCCESS);
+    ASSERT_EQ(twoPads.ReadInputs(&inputs, 10000), CONTROLLER_STATUS_SUCCESS);
+    ASSERT_EQ(inputs.count, 4);
+    EXPECT_EQ(inputs.result[1], CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(inputs.result[2], CONTROLLER_STATUS_NOTHING_TODO);
+    EXPECT_EQ(inputs.result[3], CONTROLLER_STATUS_NOTHING_TODO);
+
+    // One input per report: Same as ReadInput
+    Xbox360Controller xbox(std::make_unique<SyntheticUSBDevice>(VirtualClockOptions(SyntheticProtocol_Xbox360)), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(xbox.Initialize(), CONTROLLER_STATUS_SUCCESS);
+    ASSERT_EQ(xbox.ReadInputs(&inputs, 10000), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(inputs.count, 1);
+    EXPECT_EQ(inputs.input_idx[0], 0);
+    EXPECT_TRUE(inputs.data[0].buttons[ControllerButton::X]);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "SwitchUSBBufferPool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+TEST(USBTransferBufferPool, test_acquire_aligned_slabs)
+{
+    USBTransferBufferPool pool;
+
+    // Packet sizes of the endpoints (Full speed, high speed interrupt, control)
+    for (size_t size : {8, 64, 512, 1024, 0x1000, 0x1001})
+    {
+        USBTransferBuffer buffer = pool.Acquire(size);
+        ASSERT_TRUE(buffer) << size;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % USB_TRANSFER_BUFFER_ALIGNMENT, 0) << size;
+        EXPECT_GE(buffer.size(), size);
+        EXPECT_EQ(buffer.size() % USB_TRANSFER_BUFFER_ALIGNMENT, 0) << size;
+
+        memset(buffer.data(), 0xAA, buffer.size()); // Whole slab usable
+    }
+
+    EXPECT_EQ(pool.Acquire(0).size(), USB_TRANSFER_BUFFER_ALIGNMENT);
+    EXPECT_EQ(pool.Acquire(0x1001).size(), 2 * USB_TRANSFER_BUFFER_ALIGNMENT);
+}
+
+TEST(USBTransferBufferPool, test_slabs_reused)
+{
+    USBTransferBufferPool pool;
+    uint8_t *first = nullptr;
+
+    // A Steam controller: 5 interfaces, 1 control buffer + 1 endpoint each
+    {
+        std::vector<USBTransferBuffer> buffers;
+        for (int i = 0; i < 10; i++)
+            buffers.push_back(pool.Acquire(64));
+        first = buffers[0].data();
+
+        USBTransferBufferStats stats = pool.GetStats();
+        EXPECT_EQ(stats.acquires, 10);
+        EXPECT_EQ(stats.reuses, 0);
+        EXPECT_EQ(stats.slabs_in_use, 10);
+        EXPECT_EQ(stats.slabs_free, 0);
+        EXPECT_EQ(stats.bytes_reserved, 10 * USB_TRANSFER_BUFFER_ALIGNMENT);
+    }
+
+    USBTransferBufferStats stats = pool.GetStats();
+    EXPECT_EQ(stats.slabs_in_use, 0);
+    EXPECT_EQ(stats.slabs_free, 10);
+    EXPECT_EQ(stats.peak_in_use, 10);
+
+    // Reconnected: No new allocation
+    {
+        std::vector<USBTransferBuffer> buffers;
+        for (int i = 0; i < 10; i++)
+            buffers.push_back(pool.Acquire(512));
+
+        bool found = false;
+        for (const USBTransferBuffer &buffer : buffers)
+            found |= buffer.data() == first;
+        EXPECT_TRUE(found);
+    }
+
+    stats = pool.GetStats();
+    EXPECT_EQ(stats.acquires, 20);
+    EXPECT_EQ(stats.reuses, 10);
+    EXPECT_EQ(stats.bytes_reserved, 10 * USB_TRANSFER_BUFFER_ALIGNMENT);
+
+    pool.Trim();
+    stats = pool.GetStats();
+    EXPECT_EQ(stats.slabs_free, 0);
+    EXPECT_EQ(stats.bytes_reserved, 0);
+}
+
+TEST(USBTransferBufferPool, test_free_list_bounded)
+{
+    USBTransferBufferPool pool;
+
+    {
+        std::vector<USBTransferBuffer> buffers;
+        for (int i = 0; i < USB_TRANSFER_BUFFER_POOL_MAX_FREE + 4; i++)
+            buffers.push_back(pool.Acquire(64));
+    }
+
+    USBTransferBufferStats stats = pool.GetStats();
+    EXPECT_EQ(stats.slabs_in_use, 0);
+    EXPECT_EQ(stats.slabs_free, USB_TRANSFER_BUFFER_POOL_MAX_FREE);
+    EXPECT_EQ(stats.bytes_reserved, USB_TRANSFER_BUFFER_POOL_MAX_FREE * USB_TRANSFER_BUFFER_ALIGNMENT);
+}
+
+TEST(USBTransferBufferPool, test_move_keeps_ownership)
+{
+    USBTransferBufferPool pool;
+
+    USBTransferBuffer buffer = pool.Acquire(64);
+    uint8_t *data = buffer.data();
+
+    USBTransferBuffer moved = std::move(buffer);
+    EXPECT_FALSE(buffer);
+    EXPECT_EQ(moved.data(), data);
+    EXPECT_EQ(pool.GetStats().slabs_in_use, 1);
+
+    moved.Reset();
+    EXPECT_FALSE(moved);
+    EXPECT_EQ(pool.GetStats().slabs_in_use, 0);
+
+    std::string dump;
+    pool.GetStats().Format(&dump, "  ");
+    EXPECT_NE(dump.find("  slabs: 0 in use (peak: 1), 1 free\n"), std::string::npos);
+}
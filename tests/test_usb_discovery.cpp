@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "usb_discovery.h"
+#include <algorithm>
+
+using namespace syscon::usb;
+
+namespace
+{
+    UsbInterfaceInfo MakeInterface(int32_t id, uint16_t vendor_id, uint16_t product_id, uint8_t iclass, uint8_t isubclass = 0, uint8_t iprotocol = 0)
+    {
+        UsbInterfaceInfo info = {};
+        info.id = id;
+        info.vendor_id = vendor_id;
+        info.product_id = product_id;
+        info.descriptor.bInterfaceClass = iclass;
+        info.descriptor.bInterfaceSubClass = isubclass;
+        info.descriptor.bInterfaceProtocol = iprotocol;
+        return info;
+    }
+
+    ControllerRegistry MakeRegistry()
+    {
+        ControllerRegistry registry;
+        registry.RegisterBuiltIn();
+        registry.BuildIndex();
+        return registry;
+    }
+} // namespace
+
+TEST(UsbDiscovery, test_select_interfaces_priority)
+{
+    ControllerRegistry registry = MakeRegistry();
+
+    // Mass storage, HID pad, Xbox One (2 interfaces, the second one is audio), Xbox 360 wired
+    const UsbInterfaceInfo interfaces[] = {
+        MakeInterface(10, 0x0781, 0x5567, 0x08, 0x06, 0x50),
+        MakeInterface(11, 0x0079, 0x0006, 0x03),
+        MakeInterface(12, 0x045e, 0x02ea, 0xFF, 0x47, 0xD0),
+        MakeInterface(13, 0x045e, 0x02ea, 0xFF, 0x47, 0xD0),
+        MakeInterface(14, 0x045e, 0x028e, 0xFF, 0x5D, 0x01),
+    };
+    size_t selected[5];
+
+    // Same order as the queries by class: Xbox 360 first, then Xbox One, then HID
+    ASSERT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), interfaces, 5, 0, selected), 1);
+    EXPECT_EQ(selected[0], 4);
+
+    ASSERT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), interfaces, 4, 0, selected), 2);
+    EXPECT_EQ(selected[0], 2);
+    EXPECT_EQ(selected[1], 3);
+
+    ASSERT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), interfaces, 2, 0, selected), 1);
+    EXPECT_EQ(selected[0], 1);
+
+    // Neither a controller nor HID
+    EXPECT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), interfaces, 1, 0, selected), 0);
+}
+
+TEST(UsbDiscovery, test_select_interfaces_failed_probe)
+{
+    ControllerRegistry registry = MakeRegistry();
+
+    const UsbInterfaceInfo interfaces[] = {
+        MakeInterface(1, 0x045e, 0x028e, 0xFF, 0x5D, 0x01),
+        MakeInterface(2, 0x0079, 0x0006, 0x03),
+    };
+    size_t selected[2];
+
+    // The Xbox 360 pad failed: The HID pad is not blocked behind it
+    registry.SetProbeFailed(0x045e, 0x028e, 1, 1000);
+    ASSERT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), interfaces, 2, 2000, selected), 1);
+    EXPECT_EQ(selected[0], 1);
+
+    // Unplugged and plugged again (New interface ID): Not blocked
+    const UsbInterfaceInfo replugged[] = {
+        MakeInterface(3, 0x045e, 0x028e, 0xFF, 0x5D, 0x01),
+        MakeInterface(2, 0x0079, 0x0006, 0x03),
+    };
+    ASSERT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), replugged, 2, 2000, selected), 1);
+    EXPECT_EQ(selected[0], 0);
+
+    // Retried later
+    ASSERT_EQ(SelectInterfaces(registry, UsbDiscoveryFilter(), interfaces, 2, 1000 + CONTROLLER_PROBE_RETRY_US, selected), 1);
+    EXPECT_EQ(selected[0], 0);
+}
+
+TEST(UsbDiscovery, test_interface_table_diff)
+{
+    UsbInterfaceTable table;
+    std::vector<int32_t> added;
+    std::vector<int32_t> removed;
+
+    const UsbInterfaceInfo first[] = {MakeInterface(1, 0x045e, 0x02ea, 0xFF), MakeInterface(2, 0x045e, 0x02ea, 0xFF)};
+    table.Update(first, 2, &added, &removed);
+    std::sort(added.begin(), added.end());
+    EXPECT_EQ(added, std::vector<int32_t>({1, 2}));
+    EXPECT_TRUE(removed.empty());
+    EXPECT_EQ(table.Size(), 2);
+
+    // Same interfaces: Nothing changed
+    added.clear();
+    table.Update(first, 2, &added, &removed);
+    EXPECT_TRUE(added.empty());
+    EXPECT_TRUE(removed.empty());
+
+    // One unplugged, one plugged
+    const UsbInterfaceInfo second[] = {MakeInterface(2, 0x045e, 0x02ea, 0xFF), MakeInterface(3, 0x0079, 0x0006, 0x03)};
+    table.Update(second, 2, &added, &removed);
+    EXPECT_EQ(added, std::vector<int32_t>({3}));
+    EXPECT_EQ(removed, std::vector<int32_t>({1}));
+    EXPECT_FALSE(table.Contains(1));
+    EXPECT_TRUE(table.Contains(3));
+
+    // Added by a new controller, unplugged before the next query: Still reported as removed
+    table.Add(MakeInterface(4, 0x045e, 0x028e, 0xFF));
+    removed.clear();
+    table.Update(second, 2, nullptr, &removed);
+    EXPECT_EQ(removed, std::vector<int32_t>({4}));
+
+    // Everything unplugged
+    removed.clear();
+    table.Update(nullptr, 0, nullptr, &removed);
+    std::sort(removed.begin(), removed.end());
+    EXPECT_EQ(removed, std::vector<int32_t>({2, 3}));
+    EXPECT_EQ(table.Size(), 0);
+}
+
+TEST(UsbDiscovery, test_vidpid_allowlist)
+{
+    ControllerRegistry registry = MakeRegistry();
+
+    // More VID/PID than the kernel has events
+    UsbDiscoveryFilter filter;
+    filter.interface_rules = false;
+    filter.any_hid = false;
+    for (uint16_t pid = 1; pid <= 12; pid++)
+        filter.Allow(0x0f0d, pid);
+    filter.Allow(0x054c, 0x0000); // 054c-*
+    EXPECT_EQ(filter.AllowlistSize(), 13);
+
+    EXPECT_TRUE(filter.IsAllowed(0x0f0d, 0x000c));
+    EXPECT_FALSE(filter.IsAllowed(0x0f0d, 0x000d));
+    EXPECT_TRUE(filter.IsAllowed(0x054c, 0x0268));
+    EXPECT_FALSE(filter.IsAllowed(0x057e, 0x2009));
+
+    // Official Pro controller and Xbox 360 pad ignored, the last known HID pad is found
+    const UsbInterfaceInfo interfaces[] = {
+        MakeInterface(1, 0x057e, 0x2009, 0x03),
+        MakeInterface(2, 0x045e, 0x028e, 0xFF, 0x5D, 0x01),
+        MakeInterface(3, 0x0f0d, 0x000c, 0x03),
+    };
+    size_t selected[3];
+    ASSERT_EQ(SelectInterfaces(registry, filter, interfaces, 3, 0, selected), 1);
+    EXPECT_EQ(selected[0], 2);
+
+    // Known VID/PID + XBOX: The Xbox 360 pad first
+    filter.interface_rules = true;
+    ASSERT_EQ(SelectInterfaces(registry, filter, interfaces, 3, 0, selected), 1);
+    EXPECT_EQ(selected[0], 1);
+
+    // Whole vendor (054c-*)
+    const UsbInterfaceInfo known[] = {MakeInterface(4, 0x054c, 0x0268, 0x03)};
+    filter.interface_rules = false;
+    ASSERT_EQ(SelectInterfaces(registry, filter, known, 1, 0, selected), 1);
+
+    // Nothing allowed
+    UsbDiscoveryFilter empty;
+    empty.interface_rules = false;
+    empty.any_hid = false;
+    EXPECT_EQ(SelectInterfaces(registry, empty, interfaces, 3, 0, selected), 0);
+}
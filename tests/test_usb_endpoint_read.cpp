@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "Controllers/BaseController.h"
+#include "mocks/Logger.h"
+#include "mocks/Device.h"
+#include "mocks/USBInterface.h"
+#include "mocks/USBEndpoint.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+namespace
+{
+    // Minimal driver: Every report is valid, the last one parsed is kept
+    class ZeroCopyTestController : public BaseController
+    {
+    public:
+        using BaseController::BaseController;
+
+        const uint8_t *lastParsed = nullptr;
+
+        ControllerResult ParseData(uint8_t *buffer, size_t size, RawInputData *rawData, uint16_t *input_idx) override
+        {
+            (void)size;
+            (void)rawData;
+            (void)input_idx;
+
+            lastParsed = buffer;
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+    };
+
+    // Endpoint lending its own transfer buffers (Like SwitchUSBEndpoint), the copy API must not be used
+    class LendingUSBEndpoint : public testing::NiceMock<MockUSBEndpoint>
+    {
+    public:
+        LendingUSBEndpoint() : testing::NiceMock<MockUSBEndpoint>(USB_ENDPOINT_IN) {}
+
+        std::deque<std::vector<uint8_t>> reports;
+        uint8_t buffers[USB_ENDPOINT_READ_BUFFERS][64] = {};
+        bool lent[USB_ENDPOINT_READ_BUFFERS] = {};
+        int maxLent = 0;
+
+        ControllerResult AcquireRead(ReadBuffer *buffer, size_t maxSize, uint64_t aTimeoutUs) override
+        {
+            (void)aTimeoutUs;
+
+            if (reports.empty())
+                return CONTROLLER_STATUS_TIMEOUT;
+
+            uint8_t slot = lent[0] ? 1 : 0;
+            if (lent[slot])
+                return CONTROLLER_STATUS_OUT_OF_MEMORY;
+
+            buffer->size = std::min(maxSize, reports.front().size());
+            memcpy(buffers[slot], reports.front().data(), buffer->size);
+            buffer->data = buffers[slot];
+            buffer->slot = slot;
+            reports.pop_front();
+
+            lent[slot] = true;
+            maxLent = std::max(maxLent, (int)lent[0] + (int)lent[1]);
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+
+        void ReleaseRead(const ReadBuffer &buffer) override
+        {
+            EXPECT_TRUE(lent[buffer.slot]);
+            lent[buffer.slot] = false;
+        }
+    };
+} // namespace
+
+TEST(USBEndpointRead, test_zero_copy_drain)
+{
+    ControllerConfig config;
+    IUSBEndpoint::EndpointDescriptor descriptor = {};
+    descriptor.wMaxPacketSize = 64;
+
+    auto endpointIn = std::make_unique<LendingUSBEndpoint>();
+    LendingUSBEndpoint *endpoint = endpointIn.get();
+    ON_CALL(*endpoint, GetDescriptor).WillByDefault(testing::Return(&descriptor));
+    EXPECT_CALL(*endpoint, Read).Times(0);
+    endpoint->reports = {{0x01, 0x01}, {0x01, 0x02}, {0x01, 0x03}};
+
+    auto mockUSBEndpointOut = std::make_unique<testing::NiceMock<MockUSBEndpoint>>(IUSBEndpoint::USB_ENDPOINT_OUT);
+    ZeroCopyTestController controller(std::make_unique<MockDevice>(0x1234, 0x5678, std::make_unique<testing::NiceMock<MockUSBInterface>>(std::move(endpointIn), std::move(mockUSBEndpointOut))), config, std::make_unique<MockLogger>());
+    ASSERT_EQ(controller.Initialize(), CONTROLLER_STATUS_SUCCESS);
+
+    // The burst is drained in one read: Only the latest report is parsed, in the buffer of the endpoint
+    NormalizedButtonData normalData = {};
+    uint16_t input_idx = 0;
+    ASSERT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_SUCCESS);
+    ASSERT_NE(controller.lastParsed, nullptr);
+    EXPECT_EQ(controller.lastParsed[1], 0x03);
+    EXPECT_TRUE(controller.lastParsed == endpoint->buffers[0] || controller.lastParsed == endpoint->buffers[1]);
+
+    // Every buffer given back, never more than the latest and the drained one at once
+    EXPECT_FALSE(endpoint->lent[0]);
+    EXPECT_FALSE(endpoint->lent[1]);
+    EXPECT_EQ(endpoint->maxLent, 2);
+
+    EXPECT_EQ(controller.ReadInput(&normalData, &input_idx, 1000), CONTROLLER_STATUS_TIMEOUT);
+}
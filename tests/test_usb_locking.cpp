@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+#include "SwitchUSBLockLevels.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define TEST_CONTROLLER_COUNT 4
+#define TEST_INIT_COUNT       3
+
+namespace
+{
+    USBLockLevel g_violationLevel = USBLockLevel_Count;
+    USBLockLevel g_violationHeld = USBLockLevel_Count;
+
+    void RecordViolation(USBLockLevel level, USBLockLevel held)
+    {
+        g_violationLevel = level;
+        g_violationHeld = held;
+    }
+
+    // Locks of SwitchUSBEndpoint (Same lock sequences), the usbHs calls are replaced by sleeps
+    class StressEndpoint
+    {
+    public:
+        explicit StressEndpoint(USBLevelMutex &interfaceMutex) : m_interfaceMutex(interfaceMutex) {}
+
+        void Open() { USBEndpointSetupLock lock(m_interfaceMutex, m_mutex); }
+        void Close() { USBEndpointSetupLock lock(m_interfaceMutex, m_mutex); }
+
+        void Read()
+        {
+            USBInputTransferLock lock(m_mutex);
+            std::this_thread::sleep_for(std::chrono::microseconds(200)); // Waiting for the report
+            m_reads++;
+        }
+
+        void Write()
+        {
+            USBOutputTransferLock lock(m_mutex);
+            m_writing = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(200)); // Posted, then bInterval
+            m_writing = false;
+            m_writes++;
+        }
+
+        uint64_t GetReads() const { return m_reads.load(); }
+        uint64_t GetWrites() const { return m_writes.load(); }
+        bool IsWriting() const { return m_writing.load(); }
+
+    private:
+        USBLevelMutex &m_interfaceMutex;
+        USBLevelMutex m_mutex{USBLockLevel_Endpoint};
+        std::atomic<uint64_t> m_reads{0};
+        std::atomic<uint64_t> m_writes{0};
+        std::atomic<bool> m_writing{false};
+    };
+
+    // Locks of SwitchUSBInterface
+    class StressInterface
+    {
+    public:
+        StressInterface() : m_endpoint(m_mutex) {}
+
+        void Open()
+        {
+            USBInterfaceSetupLock lock(m_mutex);
+            m_endpoint.Open();
+        }
+
+        void Close()
+        {
+            USBInterfaceSetupLock lock(m_mutex);
+            m_endpoint.Close();
+        }
+
+        void ControlTransfer()
+        {
+            USBOutputTransferLock lock(m_mutex);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        StressEndpoint &GetEndpoint() { return m_endpoint; }
+
+    private:
+        USBLevelMutex m_mutex{USBLockLevel_Interface};
+        StressEndpoint m_endpoint;
+    };
+} // namespace
+
+TEST(USBLocking, test_reads_not_blocked_by_discovery)
+{
+    uint64_t violations = USBLockOrder::GetViolations();
+    std::vector<std::unique_ptr<StressInterface>> controllers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{true};
+
+    for (int i = 0; i < TEST_CONTROLLER_COUNT; i++)
+    {
+        controllers.push_back(std::make_unique<StressInterface>());
+        controllers.back()->Open();
+    }
+
+    // One input thread per controller
+    for (auto &controller : controllers)
+    {
+        StressEndpoint *endpoint = &controller->GetEndpoint();
+        threads.emplace_back([endpoint, &running]() {
+            while (running)
+                endpoint->Read();
+        });
+    }
+
+    // Rumble and leds of every controller
+    threads.emplace_back([&controllers, &running]() {
+        while (running)
+        {
+            for (auto &controller : controllers)
+                controller->ControlTransfer();
+        }
+    });
+
+    // New controllers plugged: Their initialization keeps the discovery lock and the init gate
+    for (int init = 0; init < TEST_INIT_COUNT; init++)
+    {
+        std::lock_guard<USBLevelMutex> discoveryLock(GetUSBDiscoveryMutex());
+        USBInitLock initLock;
+
+        StressInterface plugged;
+        plugged.Open();
+
+        std::vector<uint64_t> before;
+        for (auto &controller : controllers)
+            before.push_back(controller->GetEndpoint().GetReads());
+
+        plugged.GetEndpoint().Read();
+        plugged.ControlTransfer();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        for (size_t i = 0; i < controllers.size(); i++)
+            EXPECT_GT(controllers[i]->GetEndpoint().GetReads(), before[i]) << "Controller " << i << " blocked during init " << init;
+
+        plugged.Close();
+    }
+
+    running = false;
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (auto &controller : controllers)
+        controller->Close();
+
+    EXPECT_EQ(USBLockOrder::GetViolations(), violations);
+}
+
+TEST(USBLocking, test_init_excludes_output_transfers)
+{
+    uint64_t violations = USBLockOrder::GetViolations();
+    std::vector<std::unique_ptr<StressInterface>> controllers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{true};
+
+    for (int i = 0; i < TEST_CONTROLLER_COUNT; i++)
+    {
+        controllers.push_back(std::make_unique<StressInterface>());
+        controllers.back()->Open();
+    }
+
+    // Rumble of every controller, from its own thread
+    for (auto &controller : controllers)
+    {
+        StressEndpoint *endpoint = &controller->GetEndpoint();
+        threads.emplace_back([endpoint, &running]() {
+            while (running)
+                endpoint->Write();
+        });
+    }
+
+    for (int init = 0; init < TEST_INIT_COUNT; init++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        std::lock_guard<USBLevelMutex> discoveryLock(GetUSBDiscoveryMutex());
+        USBInitLock initLock;
+
+        // The writes in progress are completed, the next ones wait
+        std::vector<uint64_t> before;
+        for (auto &controller : controllers)
+        {
+            EXPECT_FALSE(controller->GetEndpoint().IsWriting()) << "Write during init " << init;
+            before.push_back(controller->GetEndpoint().GetWrites());
+        }
+
+        // The initialization writes to its own controller
+        StressInterface plugged;
+        plugged.Open();
+        plugged.GetEndpoint().Write();
+        plugged.ControlTransfer();
+        EXPECT_EQ(plugged.GetEndpoint().GetWrites(), 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        for (size_t i = 0; i < controllers.size(); i++)
+            EXPECT_EQ(controllers[i]->GetEndpoint().GetWrites(), before[i]) << "Controller " << i << " written during init " << init;
+
+        plugged.Close();
+    }
+
+    // Written again after the initializations
+    std::vector<uint64_t> after;
+    for (auto &controller : controllers)
+        after.push_back(controller->GetEndpoint().GetWrites());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    running = false;
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (size_t i = 0; i < controllers.size(); i++)
+    {
+        EXPECT_GT(controllers[i]->GetEndpoint().GetWrites(), after[i]);
+        controllers[i]->Close();
+    }
+
+    EXPECT_EQ(USBLockOrder::GetViolations(), violations);
+}
+
+TEST(USBLocking, test_order_violation_counted)
+{
+    USBLevelMutex interfaceMutex(USBLockLevel_Interface);
+    USBLevelMutex endpointMutex(USBLockLevel_Endpoint);
+    uint64_t violations = USBLockOrder::GetViolations();
+
+    // Right order, recursive locks
+    {
+        std::lock_guard<USBLevelMutex> discoveryLock(GetUSBDiscoveryMutex());
+        std::lock_guard<USBLevelMutex> interfaceLock(interfaceMutex);
+        std::lock_guard<USBLevelMutex> interfaceLockAgain(interfaceMutex);
+        std::lock_guard<USBLevelMutex> endpointLock(endpointMutex);
+        std::lock_guard<USBLevelMutex> endpointLockAgain(endpointMutex);
+
+        EXPECT_EQ(USBLockOrder::GetHeldCount(USBLockLevel_Interface), 2);
+        EXPECT_EQ(USBLockOrder::GetHeldCount(USBLockLevel_Endpoint), 2);
+    }
+    EXPECT_EQ(USBLockOrder::GetViolations(), violations);
+    EXPECT_EQ(USBLockOrder::GetHeldCount(USBLockLevel_Interface), 0);
+
+    // An endpoint lock held while the discovery lock is taken
+    {
+        std::lock_guard<USBLevelMutex> endpointLock(endpointMutex);
+        std::lock_guard<USBLevelMutex> discoveryLock(GetUSBDiscoveryMutex());
+    }
+    EXPECT_EQ(USBLockOrder::GetViolations(), violations + 1);
+
+    // Its interface taken by an endpoint, reported to the handler
+    USBLockOrder::SetViolationHandler(&RecordViolation);
+    {
+        std::lock_guard<USBLevelMutex> endpointLock(endpointMutex);
+        std::lock_guard<USBLevelMutex> interfaceLock(interfaceMutex);
+    }
+    EXPECT_EQ(USBLockOrder::GetViolations(), violations + 2);
+    EXPECT_EQ(g_violationLevel, USBLockLevel_Interface);
+    EXPECT_EQ(g_violationHeld, USBLockLevel_Endpoint);
+
+    // Also checked when the lock is free
+    {
+        std::lock_guard<USBLevelMutex> endpointLock(endpointMutex);
+        EXPECT_TRUE(GetUSBDiscoveryMutex().try_lock());
+        GetUSBDiscoveryMutex().unlock();
+    }
+    EXPECT_EQ(USBLockOrder::GetViolations(), violations + 3);
+    EXPECT_EQ(g_violationLevel, USBLockLevel_Discovery);
+    USBLockOrder::SetViolationHandler(nullptr);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "VirtualGamepadHandler.h"
+#include "mocks/Logger.h"
+#include "mocks/Device.h"
+#include "mocks/USBInterface.h"
+
+namespace
+{
+    // Driver returning the scripted state of a single input
+    class ScriptedController : public IController
+    {
+    public:
+        ScriptedController() : IController(std::make_unique<MockDevice>(0x1234, 0x5678, std::make_unique<MockUSBInterface>(nullptr, nullptr)), ControllerConfig(), std::make_unique<MockLogger>()) {}
+
+        ControllerResult Initialize() override { return CONTROLLER_STATUS_SUCCESS; }
+        void Exit() override {}
+        uint16_t GetInputCount() override { return 1; }
+        bool Support(ControllerFeature aFeature) override { return false; }
+        ControllerResult SetRumble(uint16_t input_idx, float amp_high, float amp_low) override { return CONTROLLER_STATUS_NOT_IMPLEMENTED; }
+        bool IsControllerConnected(uint16_t input_idx) override { return connected; }
+
+        ControllerResult ReadInput(NormalizedButtonData *normalData, uint16_t *input_idx, uint32_t timeout_us) override
+        {
+            *normalData = data;
+            *input_idx = 0;
+            return result;
+        }
+
+        bool connected = true;
+        ControllerResult result = CONTROLLER_STATUS_SUCCESS;
+        NormalizedButtonData data = {};
+    };
+
+    class TestGamepadHandler : public VirtualGamepadHandler
+    {
+    public:
+        TestGamepadHandler() : VirtualGamepadHandler(std::make_unique<ScriptedController>(), 10) {}
+
+        ScriptedController *GetScripted() { return static_cast<ScriptedController *>(m_controller.get()); }
+
+        bool attached = false;
+        int attachCount = 0;
+        int submitCount = 0;
+        uint64_t buttons = 0;
+        VirtualGamepadStick stick_l = {};
+
+    protected:
+        bool IsControllerAttached(uint16_t input_idx) override { return attached; }
+
+        ControllerResult AttachController(uint16_t input_idx) override
+        {
+            attached = true;
+            attachCount++;
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+
+        ControllerResult DetachController(uint16_t input_idx) override
+        {
+            attached = false;
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+
+        ControllerResult UpdateControllerState(uint64_t buttons_, const VirtualGamepadStick &stick_l_, const VirtualGamepadStick &stick_r_, uint16_t input_idx) override
+        {
+            buttons = buttons_;
+            stick_l = stick_l_;
+            submitCount++;
+            return CONTROLLER_STATUS_SUCCESS;
+        }
+    };
+} // namespace
+
+TEST(VirtualGamepadHandler, test_submit_converted_state)
+{
+    TestGamepadHandler handler;
+    handler.GetScripted()->data.buttons[ControllerButton::A] = true;
+    handler.GetScripted()->data.buttons[ControllerButton::HOME] = true;
+    handler.GetScripted()->data.sticks[0].axis_x = 1.0f;
+    handler.GetScripted()->data.sticks[0].axis_y = -1.0f;
+
+    EXPECT_EQ(handler.UpdateInput(0), CONTROLLER_STATUS_SUCCESS);
+
+    EXPECT_TRUE(handler.attached); // Attached on its first input
+    EXPECT_EQ(handler.submitCount, 1);
+    EXPECT_EQ(handler.buttons, VirtualGamepadButton_A | VirtualGamepadButton_Home);
+    EXPECT_EQ(handler.stick_l.x, VIRTUAL_GAMEPAD_JOYSTICK_MAX);
+    EXPECT_EQ(handler.stick_l.y, VIRTUAL_GAMEPAD_JOYSTICK_MAX);
+
+    ControllerMetricsSnapshot snapshot;
+    handler.GetController()->GetMetrics().Snapshot(&snapshot);
+    EXPECT_EQ(snapshot.histograms[ControllerHistogram_ReadToSubmitUs].count, 1);
+}
+
+TEST(VirtualGamepadHandler, test_detach_and_reattach)
+{
+    TestGamepadHandler handler;
+    EXPECT_EQ(handler.UpdateInput(0), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_EQ(handler.attachCount, 1);
+
+    // Disconnected: Detached, the read failure is returned
+    handler.GetScripted()->connected = false;
+    handler.GetScripted()->result = CONTROLLER_STATUS_READ_FAILED;
+    EXPECT_EQ(handler.UpdateInput(0), CONTROLLER_STATUS_READ_FAILED);
+    EXPECT_FALSE(handler.attached);
+    EXPECT_EQ(handler.submitCount, 1);
+
+    // Connected again: Re-attached on its next input
+    handler.GetScripted()->connected = true;
+    handler.GetScripted()->result = CONTROLLER_STATUS_SUCCESS;
+    EXPECT_EQ(handler.UpdateInput(0), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(handler.attached);
+    EXPECT_EQ(handler.attachCount, 2);
+
+    // Detached by the console (e.g. sync menu): Only L+R attaches it again
+    handler.attached = false;
+    EXPECT_EQ(handler.UpdateInput(0), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_FALSE(handler.attached);
+
+    handler.GetScripted()->data.buttons[ControllerButton::L] = true;
+    handler.GetScripted()->data.buttons[ControllerButton::R] = true;
+    EXPECT_EQ(handler.UpdateInput(0), CONTROLLER_STATUS_SUCCESS);
+    EXPECT_TRUE(handler.attached);
+    EXPECT_EQ(handler.attachCount, 3);
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <vector>
+
+#include "logger_binary.h"
+
+/*
+    Convert the binary log of sys-con (log.bin) to text
+
+    Usage: LogDecoder <log.bin> [output.txt]
+*/
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <log.bin> [output.txt]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Unable to open: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (argc >= 3)
+    {
+        outputFile.open(argv[2]);
+        if (!outputFile.is_open())
+        {
+            std::cerr << "Unable to create: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostream &output = outputFile.is_open() ? outputFile : std::cout;
+
+    syscon::logger::BinaryLogDecoder decoder;
+    std::vector<char> buffer(64 * 1024);
+    std::string text;
+
+    while (input)
+    {
+        input.read(buffer.data(), buffer.size());
+        size_t size = static_cast<size_t>(input.gcount());
+        if (size == 0)
+            break;
+
+        text.clear();
+        bool valid = decoder.Decode(reinterpret_cast<const uint8_t *>(buffer.data()), size, &text);
+        output << text;
+
+        if (!valid)
+        {
+            std::cerr << "Invalid binary log: " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
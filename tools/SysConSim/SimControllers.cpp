@@ -0,0 +1,40 @@
+#include "SimControllers.h"
+#include "logger.h"
+#include "ControllerRegistry.h"
+
+namespace
+{
+    const ControllerRegistry &GetRegistry()
+    {
+        static ControllerRegistry registry = [] {
+            ControllerRegistry builtIn;
+            builtIn.RegisterBuiltIn();
+            builtIn.BuildIndex();
+            return builtIn;
+        }();
+
+        return registry;
+    }
+} // namespace
+
+std::string GetDefaultProfile(uint16_t vendor_id, uint16_t product_id, const std::vector<ReplayInterface> &interfaces)
+{
+    if (interfaces.empty())
+        return "";
+
+    const ControllerDriver *driver = GetRegistry().FindByDevice(vendor_id, product_id, interfaces[0].descriptor);
+    return driver != nullptr ? driver->name : "";
+}
+
+ControllerResult CreateController(const std::string &driver, std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<IController> *controller)
+{
+    if (device->GetInterfaces().empty())
+        return CONTROLLER_STATUS_NO_INTERFACES;
+
+    const ControllerDriver *controllerDriver = GetRegistry().FindByName(driver);
+    if (controllerDriver == nullptr)
+        return CONTROLLER_STATUS_INVALID_ARGUMENT;
+
+    *controller = controllerDriver->factory(std::move(device), config, std::make_unique<syscon::logger::Logger>());
+    return CONTROLLER_STATUS_SUCCESS;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "IController.h"
+#include "ReplayCapture.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Creation of the simulated controllers, same drivers registry as usb_module.cpp
+ */
+
+// Profile selected by the sysmodule for a device that is not in config.ini (From its VID/PID or its first interface)
+std::string GetDefaultProfile(uint16_t vendor_id, uint16_t product_id, const std::vector<ReplayInterface> &interfaces);
+
+// Driver instance for config.driver (GenericHIDController if unknown) in *controller
+ControllerResult CreateController(const std::string &driver, std::unique_ptr<IUSBDevice> &&device, const ControllerConfig &config, std::unique_ptr<IController> *controller);
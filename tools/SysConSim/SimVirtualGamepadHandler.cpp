@@ -0,0 +1,134 @@
+#include "SimVirtualGamepadHandler.h"
+#include "logger.h"
+#include <chrono>
+#include <time.h>
+
+namespace
+{
+    uint64_t GetCurrentThreadCpuTimeUs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    uint32_t ElapsedUs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    }
+} // namespace
+
+SimVirtualGamepadHandler::SimVirtualGamepadHandler(std::unique_ptr<IController> &&controller, int32_t polling_timeout_ms)
+    : VirtualGamepadHandler(std::move(controller), polling_timeout_ms)
+{
+}
+
+SimVirtualGamepadHandler::~SimVirtualGamepadHandler()
+{
+    StopThread();
+}
+
+ControllerResult SimVirtualGamepadHandler::Initialize()
+{
+    syscon::logger::LogDebug("SimVirtualGamepadHandler[%04x-%04x] Initializing ...", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct());
+
+    return m_controller->Initialize();
+}
+
+void SimVirtualGamepadHandler::Exit()
+{
+    StopThread();
+
+    m_controller->Exit();
+
+    for (int i = 0; i < m_controller->GetInputCount(); i++)
+        DetachController(i);
+}
+
+void SimVirtualGamepadHandler::StartThread()
+{
+    m_threadIsRunning.store(true, std::memory_order_release);
+    m_thread = std::thread(&SimVirtualGamepadHandler::OnRun, this);
+}
+
+void SimVirtualGamepadHandler::StopThread()
+{
+    if (!m_threadIsRunning.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    m_thread.join();
+}
+
+void SimVirtualGamepadHandler::OnRun()
+{
+    uint32_t polling_timeout_us = GetPollingTimeoutUs();
+
+    do
+    {
+        auto startTimer = std::chrono::steady_clock::now();
+
+        ControllerResult rc = RunCycle(polling_timeout_us);
+
+        if (rc == CONTROLLER_STATUS_SUCCESS)
+            m_stages[SimStage_Loop].Record(ElapsedUs(startTimer, std::chrono::steady_clock::now()));
+        else if (NeedsBackOff(rc))
+            std::this_thread::sleep_for(std::chrono::microseconds(100)); // Same back off as the console (Controller disconnected)
+
+    } while (m_threadIsRunning.load(std::memory_order_acquire));
+
+    m_threadCpuTimeUs = GetCurrentThreadCpuTimeUs();
+}
+
+ControllerResult SimVirtualGamepadHandler::UpdateInput(uint32_t timeout_us)
+{
+    auto readTimer = std::chrono::steady_clock::now();
+    ControllerResult rc = ReadInputs(timeout_us);
+
+    auto submitTimer = std::chrono::steady_clock::now();
+    bool submitted = false;
+    rc = SubmitInputs(rc, &submitted);
+
+    if (submitted)
+    {
+        m_stages[SimStage_ReadInput].Record(ElapsedUs(readTimer, submitTimer));
+        m_stages[SimStage_Submit].Record(ElapsedUs(submitTimer, std::chrono::steady_clock::now()));
+    }
+
+    return rc;
+}
+
+bool SimVirtualGamepadHandler::IsControllerAttached(uint16_t input_idx)
+{
+    return m_pads[input_idx].attached;
+}
+
+ControllerResult SimVirtualGamepadHandler::AttachController(uint16_t input_idx)
+{
+    SYSCON_LOG_DEBUG("SimVirtualGamepadHandler[%04x-%04x] Attaching controller on idx: %d !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
+    m_pads[input_idx].attached = true;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult SimVirtualGamepadHandler::DetachController(uint16_t input_idx)
+{
+    SYSCON_LOG_DEBUG("SimVirtualGamepadHandler[%04x-%04x] Detaching controller on idx: %d !", m_controller->GetDevice()->GetVendor(), m_controller->GetDevice()->GetProduct(), input_idx);
+    m_pads[input_idx].attached = false;
+    return CONTROLLER_STATUS_SUCCESS;
+}
+
+ControllerResult SimVirtualGamepadHandler::UpdateControllerState(uint64_t buttons, const VirtualGamepadStick &stick_l, const VirtualGamepadStick &stick_r, uint16_t input_idx)
+{
+    SimHidPad &pad = m_pads[input_idx];
+    if (!pad.attached)
+        return CONTROLLER_STATUS_SUCCESS;
+
+    pad.buttons = buttons;
+    pad.stick_l[0] = stick_l.x;
+    pad.stick_l[1] = stick_l.y;
+    pad.stick_r[0] = stick_r.x;
+    pad.stick_r[1] = stick_r.y;
+    pad.updates++;
+
+    m_controller->GetMetrics().Increment(ControllerCounter_IpcSubmitted);
+    return CONTROLLER_STATUS_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "VirtualGamepadHandler.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+/*
+ * Host version of SwitchVirtualGamepadHandler: Same input loop (VirtualGamepadHandler) run in a std::thread,
+ * the state is submitted to a fake HID (SimHidPad) instead of HDL or the shared memory.
+ */
+
+enum SimStage
+{
+    SimStage_ReadInput = 0, // ReadInputs() returning a report (USB wait, parsing and mapping)
+    SimStage_Submit,        // Conversion to the HID state and submission of all the inputs of the transfer
+    SimStage_Loop,          // Whole iteration of the input loop
+
+    SimStage_Count
+};
+
+inline const char *SimStageName(SimStage stage)
+{
+    static const char *names[SimStage_Count] = {
+        "read_input_us",
+        "submit_us",
+        "loop_us",
+    };
+
+    return names[stage];
+}
+
+// Fake HID pad: Last state submitted
+class SimHidPad
+{
+public:
+    bool attached = false;
+    uint64_t buttons = 0;
+    int32_t stick_l[2] = {};
+    int32_t stick_r[2] = {};
+    uint64_t updates = 0;
+};
+
+class SimVirtualGamepadHandler : public VirtualGamepadHandler
+{
+public:
+    SimVirtualGamepadHandler(std::unique_ptr<IController> &&controller, int32_t polling_timeout_ms);
+    ~SimVirtualGamepadHandler();
+
+    ControllerResult Initialize();
+    void Exit();
+
+    // Input thread: Same loop as SwitchVirtualGamepadHandler::OnRun
+    void StartThread();
+    void StopThread();
+
+    ControllerResult UpdateInput(uint32_t timeout_us) override;
+
+    inline const SimHidPad &GetPad(uint16_t input_idx) const { return m_pads[input_idx]; }
+    inline ControllerLatencyHistogram &GetStage(SimStage stage) { return m_stages[stage]; }
+
+    // CPU time used by the input thread (Valid once stopped)
+    inline uint64_t GetThreadCpuTimeUs() const { return m_threadCpuTimeUs; }
+
+protected:
+    bool IsControllerAttached(uint16_t input_idx) override;
+    ControllerResult AttachController(uint16_t input_idx) override;
+    ControllerResult DetachController(uint16_t input_idx) override;
+    ControllerResult UpdateControllerState(uint64_t buttons, const VirtualGamepadStick &stick_l, const VirtualGamepadStick &stick_r, uint16_t input_idx) override;
+
+private:
+    void OnRun();
+
+    SimHidPad m_pads[CONTROLLER_MAX_INPUTS];
+    ControllerLatencyHistogram m_stages[SimStage_Count];
+
+    std::thread m_thread;
+    std::atomic<bool> m_threadIsRunning{false};
+    uint64_t m_threadCpuTimeUs = 0;
+};
@@ -0,0 +1,362 @@
+#include "SimControllers.h"
+#include "SimVirtualGamepadHandler.h"
+#include "ReplayUSBDevice.h"
+#include "SyntheticUSBDevice.h"
+#include "config_handler.h"
+#include "filemanager_std.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+/*
+    Headless simulator of the sysmodule input pipeline (Host only)
+
+    N controllers replay a capture (or generate synthetic reports) through the real drivers, the real config.ini
+    loading and the real logger. Each one runs the SwitchVirtualGamepadHandler loop in its own thread and submits
+    its state to a fake HID. At the end, latency per stage, throughput, CPU time and allocations are reported.
+
+    Usage: syscon-sim [options]
+        -n <count>                  Number of simulated controllers (Default: 1)
+        --duration <s>              Duration of the simulation (Default: 5)
+        --capture <file>            Capture to replay: .pcap, .pcapng, .txt or .rec (Default: synthetic controller)
+        --protocol <name>           Protocol of the synthetic controller: xbox360, xbox360w, xboxone, dualshock3, switch,
+                                    wiiu, steam2026, steam2026puck (Default: xbox360)
+        --pads <count>              Pads of the synthetic controller (Wireless receivers and adapters, default: 1)
+        --rate <hz>                 Report rate of the synthetic controller, per pad (Default: 1000)
+        --jitter <us>               Random delay of each synthetic report (Default: 0)
+        --burst <count>             Synthetic reports sent back to back, same average rate (Default: 1)
+        --speed <x>                 Replay speed, 0: as fast as possible (Default: 1)
+        --driver <name>             Force the driver (Default: config.ini, as the sysmodule)
+        --polling-timeout-ms <ms>   Override polling_timeout_ms of config.ini
+        --config <file>             config.ini to use (Default: dist/config/sys-con/config.ini)
+        --log-level <level>         Override log_level of config.ini (0: Trace ... 5: Error)
+
+    The config.ini is copied in ./syscon-sim/ (auto_add_controller can modify it), the log is written to ./syscon-sim/log.txt
+*/
+
+#define SIM_WORKING_PATH "syscon-sim/"
+
+namespace
+{
+    std::atomic<uint64_t> g_allocations{0};
+    std::atomic<uint64_t> g_allocated_bytes{0};
+
+    class SimOptions
+    {
+    public:
+        int controllers = 1;
+        double duration_s = 5.0;
+        std::string capture;
+        std::string protocol = "xbox360";
+        int pads = 1;
+        uint32_t rate_hz = 1000;
+        uint32_t jitter_us = 0;
+        int burst = 1;
+        float speed = 1.0f;
+        std::string driver;
+        int polling_timeout_ms = -1;
+        std::string config = SIM_CONFIG_FULLPATH;
+        int log_level = -1;
+    };
+
+    void PrintUsage(const char *name)
+    {
+        std::cerr << "Usage: " << name << " [-n count] [--duration s] [--capture file] [--protocol name] [--pads count] [--rate hz]" << std::endl
+                  << "       [--jitter us] [--burst count] [--speed x] [--driver name] [--polling-timeout-ms ms] [--config config.ini]" << std::endl
+                  << "       [--log-level level]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], SimOptions *options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                return false;
+
+            const char *value = argv[++i];
+            if (arg == "-n")
+                options->controllers = atoi(value);
+            else if (arg == "--duration")
+                options->duration_s = atof(value);
+            else if (arg == "--capture")
+                options->capture = value;
+            else if (arg == "--protocol")
+                options->protocol = value;
+            else if (arg == "--pads")
+                options->pads = atoi(value);
+            else if (arg == "--rate")
+                options->rate_hz = atoi(value);
+            else if (arg == "--jitter")
+                options->jitter_us = atoi(value);
+            else if (arg == "--burst")
+                options->burst = atoi(value);
+            else if (arg == "--speed")
+                options->speed = atof(value);
+            else if (arg == "--driver")
+                options->driver = value;
+            else if (arg == "--polling-timeout-ms")
+                options->polling_timeout_ms = atoi(value);
+            else if (arg == "--config")
+                options->config = value;
+            else if (arg == "--log-level")
+                options->log_level = atoi(value);
+            else
+                return false;
+        }
+
+        return options->controllers > 0 && options->controllers <= 64 && options->duration_s > 0 && options->rate_hz > 0 &&
+               options->pads > 0 && options->pads <= SYNTHETIC_MAX_PADS && options->burst > 0;
+    }
+
+    uint64_t GetProcessCpuTimeUs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    void PrintHistogram(const char *name, const ControllerHistogramSnapshot &histogram)
+    {
+        printf("  %-18s count=%-9llu mean=%-6u p50=%-6u p99=%-6u p99.9=%-6u max=%u\n", name, (unsigned long long)histogram.count,
+               histogram.Mean(), histogram.Percentile(50.0), histogram.Percentile(99.0), histogram.Percentile(99.9), histogram.max);
+    }
+} // namespace
+
+// Allocation counters: Every allocation of the process, once the controllers are initialized it should stay at 0
+void *operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+int main(int argc, char *argv[])
+{
+    SimOptions options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(SIM_WORKING_PATH, ec);
+    std::string configPath = SIM_WORKING_PATH "config.ini";
+    if (!std::filesystem::copy_file(options.config, configPath, std::filesystem::copy_options::overwrite_existing, ec))
+    {
+        std::cerr << "Unable to copy: " << options.config << " (" << ec.message() << ")" << std::endl;
+        return 1;
+    }
+
+    ::syscon::logger::Initialize(SIM_WORKING_PATH "log.txt", std::make_unique<syscon::StdFileManager>());
+    ::syscon::logger::LogInfo("-----------------------------------------------------");
+    ::syscon::logger::LogInfo("SYS-CON simulator started (Controllers: %d, duration: %.1fs)", options.controllers, options.duration_s);
+
+    ::syscon::config::GlobalConfig globalConfig;
+    ::syscon::config::Initialize(std::make_unique<syscon::StdFileManager>());
+    ::syscon::config::LoadGlobalConfig(configPath, &globalConfig);
+
+    ::syscon::logger::SetLogLevel(options.log_level >= 0 ? options.log_level : globalConfig.log_level);
+
+    int polling_timeout_ms = options.polling_timeout_ms >= 0 ? options.polling_timeout_ms : globalConfig.polling_timeout_ms;
+
+    // Device of each controller: The capture replayed, or the synthetic protocol
+    std::shared_ptr<ReplayCapture> capture;
+    SyntheticOptions syntheticOptions;
+    uint16_t vendor_id = 0;
+    uint16_t product_id = 0;
+    std::string defaultProfile;
+    std::string defaultDriver;
+
+    if (options.capture.empty())
+    {
+        if (!FindSyntheticProtocol(options.protocol, &syntheticOptions.protocol))
+        {
+            std::cerr << "Unknown protocol: " << options.protocol << std::endl;
+            ::syscon::logger::Exit();
+            return 1;
+        }
+
+        syntheticOptions.pads = options.pads;
+        syntheticOptions.rate_hz = options.rate_hz;
+        syntheticOptions.jitter_us = options.jitter_us;
+        syntheticOptions.burst = options.burst;
+        syntheticOptions.realtime = options.speed > 0; // As fast as possible: Virtual clock
+
+        const SyntheticLayout &layout = GetSyntheticLayout(syntheticOptions.protocol);
+        vendor_id = layout.vendor_id;
+        product_id = layout.product_id;
+        defaultProfile = GetDefaultProfile(vendor_id, product_id, layout.interfaces);
+        defaultDriver = layout.driver;
+    }
+    else
+    {
+        capture = std::make_shared<ReplayCapture>();
+        if (capture->LoadFile(options.capture) != CONTROLLER_STATUS_SUCCESS)
+        {
+            std::cerr << "Unable to load: " << options.capture << " (" << capture->GetError() << ")" << std::endl;
+            ::syscon::logger::Exit();
+            return 1;
+        }
+
+        vendor_id = capture->GetVendor();
+        product_id = capture->GetProduct();
+        defaultProfile = GetDefaultProfile(vendor_id, product_id, capture->GetInterfaces());
+    }
+
+    ReplayOptions replayOptions;
+    replayOptions.speed = options.speed;
+    replayOptions.loop = true;
+
+    std::vector<std::unique_ptr<SimVirtualGamepadHandler>> handlers;
+    for (int i = 0; i < options.controllers; i++)
+    {
+        ControllerConfig config;
+        ::syscon::config::LoadControllerConfig(configPath, &config, vendor_id, product_id, globalConfig.auto_add_controller, defaultProfile);
+
+        // Synthetic devices unknown from config.ini: Driver of their protocol
+        std::string driver = options.driver.empty() ? config.driver : options.driver;
+        if (driver.empty())
+            driver = defaultDriver;
+
+        std::unique_ptr<IUSBDevice> device;
+        if (capture)
+            device = std::make_unique<ReplayUSBDevice>(capture, replayOptions);
+        else
+        {
+            syntheticOptions.seed = i + 1;
+            device = std::make_unique<SyntheticUSBDevice>(syntheticOptions);
+        }
+
+        std::unique_ptr<IController> controller;
+        ControllerResult rc = CreateController(driver, std::move(device), config, &controller);
+        if (rc != CONTROLLER_STATUS_SUCCESS)
+        {
+            std::cerr << "Failed to create the controller (Driver: '" << driver << "', Error: " << (int)rc << ")" << std::endl;
+            ::syscon::logger::Exit();
+            return 1;
+        }
+
+        auto handler = std::make_unique<SimVirtualGamepadHandler>(std::move(controller), polling_timeout_ms);
+        rc = handler->Initialize();
+        if (rc != CONTROLLER_STATUS_SUCCESS)
+        {
+            ::syscon::logger::LogError("Controller %d failed to initialize (Error: %d)", i, rc);
+            continue;
+        }
+
+        handlers.push_back(std::move(handler));
+    }
+
+    if (handlers.empty())
+    {
+        std::cerr << "No controller initialized, see " SIM_WORKING_PATH "log.txt" << std::endl;
+        ::syscon::logger::Exit();
+        return 1;
+    }
+
+    printf("Simulating %zu controller(s) [%04x-%04x] for %.1fs (Speed: %.1f, polling timeout: %d ms)\n", handlers.size(),
+           vendor_id, product_id, options.duration_s, options.speed, polling_timeout_ms);
+
+    // Measure the steady state only: Initialization allocations and CPU are not counted
+    uint64_t allocationsStart = g_allocations.load();
+    uint64_t allocatedBytesStart = g_allocated_bytes.load();
+    uint64_t cpuStart = GetProcessCpuTimeUs();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto &&handler : handlers)
+        handler->StartThread();
+
+    std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(options.duration_s * 1000000)));
+
+    for (auto &&handler : handlers)
+        handler->StopThread();
+
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t cpu_us = GetProcessCpuTimeUs() - cpuStart;
+    uint64_t allocations = g_allocations.load() - allocationsStart;
+    uint64_t allocatedBytes = g_allocated_bytes.load() - allocatedBytesStart;
+
+    // Aggregated results: Histograms of all the controllers are merged
+    ControllerHistogramSnapshot stages[SimStage_Count];
+    uint64_t submitted = 0;
+    uint64_t threadsCpu_us = 0;
+
+    for (auto &&handler : handlers)
+    {
+        for (int stage = 0; stage < SimStage_Count; stage++)
+        {
+            ControllerHistogramSnapshot snapshot;
+            handler->GetStage(static_cast<SimStage>(stage)).Snapshot(&snapshot);
+
+            for (uint32_t bucket = 0; bucket < CONTROLLER_HISTOGRAM_BUCKETS; bucket++)
+                stages[stage].buckets[bucket] += snapshot.buckets[bucket];
+            stages[stage].count += snapshot.count;
+            stages[stage].sum += snapshot.sum;
+            stages[stage].max = std::max(stages[stage].max, snapshot.max);
+        }
+
+        ControllerMetricsSnapshot metrics;
+        handler->GetController()->GetMetrics().Snapshot(&metrics);
+        submitted += metrics.counters[ControllerCounter_IpcSubmitted];
+        threadsCpu_us += handler->GetThreadCpuTimeUs();
+    }
+
+    printf("\nThroughput:\n");
+    printf("  submitted:         %llu (%.1f/s, %.1f/s per controller)\n", (unsigned long long)submitted, submitted / elapsed_s, submitted / elapsed_s / handlers.size());
+
+    printf("\nLatency per stage (us):\n");
+    for (int stage = 0; stage < SimStage_Count; stage++)
+        PrintHistogram(SimStageName(static_cast<SimStage>(stage)), stages[stage]);
+
+    printf("\nCPU:\n");
+    printf("  process:           %.1f ms (%.1f%% of one core)\n", cpu_us / 1000.0, (cpu_us / 10000.0) / elapsed_s);
+    printf("  input threads:     %.1f ms (%.2f us per report)\n", threadsCpu_us / 1000.0, submitted ? (double)threadsCpu_us / submitted : 0.0);
+
+    printf("\nAllocations:\n");
+    printf("  count:             %llu (%.3f per report)\n", (unsigned long long)allocations, submitted ? (double)allocations / submitted : 0.0);
+    printf("  bytes:             %llu\n", (unsigned long long)allocatedBytes);
+
+    for (size_t i = 0; i < handlers.size(); i++)
+    {
+        ControllerMetricsSnapshot metrics;
+        handlers[i]->GetController()->GetMetrics().Snapshot(&metrics);
+
+        std::string text;
+        metrics.Format(&text, "  ");
+        printf("\nController %zu:\n%s", i, text.c_str());
+    }
+
+    for (auto &&handler : handlers)
+        handler->Exit();
+
+    ::syscon::logger::Exit();
+    return 0;
+}